@@ -121,6 +121,62 @@ typedef enum {
 	APT_LOG_MASKING_ENCRYPTED  /**< encrypt private data */
 } apt_log_masking_e;
 
+/** Log source */
+struct apt_log_source_t {
+	/** Unique name of the log source */
+	const char               *name;
+	/** Priority (log level) of the log source */
+	apt_log_priority_e        priority;
+	/** Masking mode of private data */
+	apt_log_masking_e         masking;
+	/** Max priority actually output, -1 if the output is disabled */
+	int                       threshold;
+};
+
+/**
+ * Check whether log entries of the priority are output for the log source.
+ * This is a single comparison, use it to skip the evaluation of costly arguments
+ * and the call of apt_log() on hot paths.
+ */
+#define APT_LOG_SOURCE_ENABLED(LOG_SOURCE,PRIORITY) ((int)(PRIORITY) <= (LOG_SOURCE)->threshold)
+
+/** Check whether log entries of the priority are output for the default log source */
+#define APT_LOG_ENABLED(PRIORITY) APT_LOG_SOURCE_ENABLED(&def_log_source,PRIORITY)
+
+/** Direction of traced data */
+typedef enum {
+	APT_LOG_TRACE_RECEIVE,  /**< data received from the peer */
+	APT_LOG_TRACE_SEND      /**< data sent to the peer */
+} apt_log_trace_direction_e;
+
+/*
+ * Structured binary trace.
+ *
+ * The trace file starts with the 4-byte signature "APTT" followed by the 32-bit
+ * magic number APT_LOG_TRACE_MAGIC and the 32-bit version APT_LOG_TRACE_VERSION,
+ * both in the byte order of the host, the decoder detects the byte order by the magic.
+ * Each record consists of apt_log_trace_record_t followed by the identifier
+ * (e.g. connection id) of id_length bytes and the raw data of data_length bytes.
+ */
+
+/** Magic number of the trace file */
+#define APT_LOG_TRACE_MAGIC   0x41505454
+/** Version of the trace file format */
+#define APT_LOG_TRACE_VERSION 1
+
+/** Header of the trace record */
+typedef struct apt_log_trace_record_t apt_log_trace_record_t;
+struct apt_log_trace_record_t {
+	/** Time of the record in usec since the epoch */
+	apr_int64_t               time;
+	/** Length of the traced data */
+	apr_uint32_t              data_length;
+	/** Length of the identifier */
+	apr_uint16_t              id_length;
+	/** Direction of the traced data (apt_log_trace_direction_e) */
+	apr_uint16_t              direction;
+};
+
 /** Opaque logger declaration */
 typedef struct apt_logger_t apt_logger_t;
 
@@ -286,6 +342,33 @@ APT_DECLARE(apt_log_masking_e) apt_log_masking_translate(const char *str);
  */
 APT_DECLARE(const char*) apt_log_data_mask(const char *data_in, apr_size_t *length, apr_pool_t *pool);
 
+/**
+ * Check whether the binary trace is enabled by configuration or not.
+ */
+APT_DECLARE(apt_bool_t) apt_log_trace_enabled(void);
+
+/**
+ * Open the binary trace file.
+ * @param dir_path the path to the log directory
+ * @param prefix the prefix used to compose the trace file name
+ * @param pool the memory pool to use
+ */
+APT_DECLARE(apt_bool_t) apt_log_trace_open(const char *dir_path, const char *prefix, apr_pool_t *pool);
+
+/**
+ * Close the binary trace file.
+ */
+APT_DECLARE(apt_bool_t) apt_log_trace_close(void);
+
+/**
+ * Write the data to the binary trace file, if open.
+ * @param id the identifier the data is associated with
+ * @param direction the direction of the data
+ * @param data the data to trace
+ * @param length the length of the data
+ */
+APT_DECLARE(apt_bool_t) apt_log_trace(const char *id, apt_log_trace_direction_e direction, const char *data, apr_size_t length);
+
 /**
  * Set the extended external log handler.
  * @param handler the handler to pass log events to
@@ -0,0 +1,68 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef APT_MPSC_QUEUE_H
+#define APT_MPSC_QUEUE_H
+
+/**
+ * @file apt_mpsc_queue.h
+ * @brief Bounded Lock-Free Multi-Producer Single-Consumer Queue of Opaque void* Objects
+ */ 
+
+#include "apt.h"
+
+APT_BEGIN_EXTERN_C
+
+/** Default size (number of elements) of MPSC queue */
+#define MPSC_QUEUE_DEFAULT_SIZE	1024
+
+/** Opaque MPSC queue declaration */
+typedef struct apt_mpsc_queue_t apt_mpsc_queue_t;
+
+/**
+ * Create MPSC queue.
+ * @param size the max number of elements, rounded up to a power of two
+ * @param pool the pool to allocate memory from, the queue is released with the pool
+ * @return the created queue
+ */
+APT_DECLARE(apt_mpsc_queue_t*) apt_mpsc_queue_create(apr_size_t size, apr_pool_t *pool);
+
+/**
+ * Push object to the queue, may be called from any thread.
+ * @param queue the queue to push object to
+ * @param obj the object to push
+ * @return FALSE if the queue is full, otherwise TRUE
+ */
+APT_DECLARE(apt_bool_t) apt_mpsc_queue_push(apt_mpsc_queue_t *queue, void *obj);
+
+/**
+ * Pop object from the queue, may be called from the consumer thread only.
+ * @param queue the queue to pop object from
+ * @return the popped object or NULL if the queue is empty
+ */
+APT_DECLARE(void*) apt_mpsc_queue_pop(apt_mpsc_queue_t *queue);
+
+/**
+ * Query whether the queue is empty, may be called from the consumer thread only.
+ * @param queue the queue to query
+ * @return TRUE if empty, otherwise FALSE
+ */
+APT_DECLARE(apt_bool_t) apt_mpsc_queue_is_empty(const apt_mpsc_queue_t *queue);
+
+
+APT_END_EXTERN_C
+
+#endif /* APT_MPSC_QUEUE_H */
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef APT_NLSML_READER_H
+#define APT_NLSML_READER_H
+
+/**
+ * @file apt_nlsml_reader.h
+ * @brief Streaming NLSML Result Reader
+ * @remark Unlike nlsml_result_parse(), which builds an XML tree, the reader extracts
+ *         the interpretations of NLSML result in a single pass over the document into
+ *         a flat structure, without building a tree. All the strings are stored in a
+ *         single buffer allocated once per document.
+ */
+
+#include "apt_string.h"
+
+APT_BEGIN_EXTERN_C
+
+/** Flat NLSML result declaration */
+typedef struct nlsml_flat_result_t nlsml_flat_result_t;
+/** Flat NLSML interpretation declaration */
+typedef struct nlsml_flat_interpretation_t nlsml_flat_interpretation_t;
+
+/** Interpretation read from NLSML result */
+struct nlsml_flat_interpretation_t {
+	/** Optional grammar attribute */
+	const char *grammar;
+	/** Confidence attribute [default: 1.0] */
+	float       confidence;
+
+	/** Contents of the <instance> elements */
+	apt_str_t  *instances;
+	/** Number of the <instance> elements */
+	apr_size_t  instance_count;
+
+	/** Content of the optional <input> element (NULL buf, if no input) */
+	apt_str_t   input;
+	/** Input mode attribute [default: "speech"], NULL if no input */
+	const char *input_mode;
+	/** Input confidence attribute [default: 1.0] */
+	float       input_confidence;
+	/** Optional input timestamp-start attribute */
+	const char *input_timestamp_start;
+	/** Optional input timestamp-end attribute */
+	const char *input_timestamp_end;
+};
+
+/** NLSML result read in a single pass */
+struct nlsml_flat_result_t {
+	/** Optional grammar attribute */
+	const char                  *grammar;
+	/** Array of the interpretations in document order */
+	nlsml_flat_interpretation_t *interpretations;
+	/** Number of the interpretations */
+	apr_size_t                   interpretation_count;
+	/** Number of the <enrollment-result> elements (skipped) */
+	apr_size_t                   enrollment_result_count;
+	/** Number of the <verification-result> elements (skipped) */
+	apr_size_t                   verification_result_count;
+};
+
+/**
+ * Read NLSML result.
+ * @param data the data to read
+ * @param length the length of the data
+ * @param pool the memory pool to use
+ * @return the result read or NULL on failure
+ * @remark The content of an element with no child elements is returned as text with
+ *         the entity and character references resolved, otherwise the inner markup is
+ *         returned as is. SWI_literal and SWI_meaning elements of an instance are
+ *         suppressed, as nlsml_instance_swi_suppress() does.
+ */
+APT_DECLARE(nlsml_flat_result_t*) nlsml_flat_result_read(const char *data, apr_size_t length, apr_pool_t *pool);
+
+APT_END_EXTERN_C
+
+#endif /* APT_NLSML_READER_H */
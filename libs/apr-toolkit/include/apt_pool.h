@@ -42,6 +42,34 @@ APT_DECLARE(apr_pool_t*) apt_pool_create(void);
  */
 APT_DECLARE(apr_pool_t*) apt_subpool_create(apr_pool_t *parent);
 
+/**
+ * Create the cache of arenas to acquire short-lived pools (sessions, connections) from
+ * @param max_count the max number of idle arenas retained in the shared list
+ * @param thread_max_count the max number of idle arenas retained per thread
+ * @param preload_count the number of arenas to create in advance
+ * @param max_free_size the max size of free memory retained by an arena (0 - unlimited)
+ * @remark Each arena is a root pool with own allocator. Pools acquired from the cache
+ *         are subpools of arenas, which are recycled on release instead of being destroyed.
+ */
+APT_DECLARE(apt_bool_t) apt_pool_cache_create(apr_size_t max_count, apr_size_t thread_max_count, apr_size_t preload_count, apr_size_t max_free_size);
+
+/**
+ * Destroy the cache of arenas
+ * @remark Pools acquired before and released after are destroyed along with their arenas.
+ */
+APT_DECLARE(apt_bool_t) apt_pool_cache_destroy(void);
+
+/**
+ * Acquire APR pool from the cache of arenas, or create a new one, if there is no cache
+ */
+APT_DECLARE(apr_pool_t*) apt_pool_acquire(void);
+
+/**
+ * Release APR pool acquired by apt_pool_acquire()
+ * @param pool the pool to release
+ */
+APT_DECLARE(void) apt_pool_release(apr_pool_t *pool);
+
 APT_END_EXTERN_C
 
 #endif /* APT_POOL_H */
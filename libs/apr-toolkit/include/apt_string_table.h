@@ -22,6 +22,7 @@
  * @brief Generic String Table
  */ 
 
+#include <string.h>
 #include "apt_string.h"
 
 APT_BEGIN_EXTERN_C
@@ -38,6 +39,116 @@ struct apt_str_table_item_t {
 	apr_size_t key;
 };
 
+/** String table hash declaration */
+typedef struct apt_str_table_hash_t apt_str_table_hash_t;
+
+/** 
+ * Minimal perfect hash of a string table, generated by strtablegen.
+ * A string is hashed (case-insensitive) to a bucket, the seed of the bucket
+ * is mixed into the hash to get a slot, and the slot refers to the only
+ * item the string can match. The number of slots equals the size of the table.
+ */
+struct apt_str_table_hash_t {
+	/** Number of buckets */
+	apr_size_t          bucket_count;
+	/** Seeds of the buckets */
+	const apr_uint16_t *seeds;
+	/** Ids of the items by slots */
+	const apr_byte_t   *ids;
+};
+
+/** Get 8 characters of a string as a little-endian word */
+static APR_INLINE apr_uint64_t apt_string_table_word64_get(const char *buf)
+{
+	apr_uint64_t word;
+#if (APR_IS_BIGENDIAN == 1)
+	int i;
+	for(word = 0, i = 7; i >= 0; i--) {
+		word = (word << 8) | (apr_byte_t)buf[i];
+	}
+#else
+	memcpy(&word,buf,sizeof(word));
+#endif
+	return word;
+}
+
+/** Get 4 characters of a string as a little-endian word */
+static APR_INLINE apr_uint32_t apt_string_table_word32_get(const char *buf)
+{
+	apr_uint32_t word;
+#if (APR_IS_BIGENDIAN == 1)
+	word = (apr_byte_t)buf[0] | ((apr_uint32_t)(apr_byte_t)buf[1] << 8) | 
+		((apr_uint32_t)(apr_byte_t)buf[2] << 16) | ((apr_uint32_t)(apr_byte_t)buf[3] << 24);
+#else
+	memcpy(&word,buf,sizeof(word));
+#endif
+	return word;
+}
+
+/** 
+ * Calculate the case-insensitive hash of a string, taking 8 characters at a time.
+ * Characters are folded by setting their 0x20 bit, the tail of a string is read
+ * by overlapping its preceding characters.
+ */
+static APR_INLINE apr_uint32_t apt_string_table_hash_calc(const apt_str_t *value)
+{
+	const apr_uint64_t fold = 0x2020202020202020ULL;
+	const apr_uint64_t prime = 0x9E3779B97F4A7C15ULL;
+	const char *buf = value->buf;
+	apr_size_t length = value->length;
+	apr_uint64_t hash = (apr_uint64_t)length * prime;
+	apr_uint64_t word;
+
+	if(length >= 8) {
+		const char *end = buf + length;
+		for(; buf + 8 <= end; buf += 8) {
+			hash = (hash ^ (apt_string_table_word64_get(buf) | fold)) * prime;
+		}
+		if(buf < end) {
+			hash = (hash ^ (apt_string_table_word64_get(end - 8) | fold)) * prime;
+		}
+	}
+	else {
+		if(length >= 4) {
+			word = apt_string_table_word32_get(buf) | 
+				((apr_uint64_t)apt_string_table_word32_get(buf + length - 4) << 32);
+		}
+		else if(length) {
+			word = (apr_byte_t)buf[0] | 
+				((apr_uint64_t)(apr_byte_t)buf[length / 2] << 8) | 
+				((apr_uint64_t)(apr_byte_t)buf[length - 1] << 16);
+		}
+		else {
+			word = 0;
+		}
+		hash = (hash ^ (word | fold)) * prime;
+	}
+	return (apr_uint32_t)(hash >> 32);
+}
+
+/** Map the hash onto the range [0, size) by means of multiplication instead of division */
+static APR_INLINE apr_size_t apt_string_table_hash_range(apr_uint32_t hash, apr_size_t size)
+{
+	return (apr_size_t)(((apr_uint64_t)hash * size) >> 32);
+}
+
+/** Get the bucket of the hash */
+static APR_INLINE apr_size_t apt_string_table_hash_bucket(apr_uint32_t hash, apr_size_t bucket_count)
+{
+	return apt_string_table_hash_range(hash,bucket_count);
+}
+
+/** Mix the seed of the bucket into the hash and get the slot */
+static APR_INLINE apr_size_t apt_string_table_hash_slot(apr_uint32_t hash, apr_uint32_t seed, apr_size_t size)
+{
+	hash ^= seed * 0x9E3779B9U;
+	hash ^= hash >> 16;
+	hash *= 0x85EBCA6BU;
+	hash ^= hash >> 13;
+	hash *= 0xC2B2AE35U;
+	hash ^= hash >> 16;
+	return apt_string_table_hash_range(hash,size);
+}
 
 /**
  * Get the string by a given id.
@@ -57,6 +168,16 @@ APT_DECLARE(const apt_str_t*) apt_string_table_str_get(const apt_str_table_item_
  */
 APT_DECLARE(apr_size_t) apt_string_table_id_find(const apt_str_table_item_t table[], apr_size_t size, const apt_str_t *value);
 
+/**
+ * Find the id associated with a given string by means of the perfect hash of the table.
+ * @param table the table to search for the id
+ * @param size the size of the table
+ * @param hash the perfect hash of the table (if NULL, the table is searched item by item)
+ * @param value the string to search for
+ * @return the id associated with the string, or invalid id if string cannot be matched
+ */
+APT_DECLARE(apr_size_t) apt_string_table_hash_id_find(const apt_str_table_item_t table[], apr_size_t size, const apt_str_table_hash_t *hash, const apt_str_t *value);
+
 
 APT_END_EXTERN_C
 
@@ -67,6 +67,16 @@ APT_DECLARE(apt_message_generator_t*) apt_message_generator_create(void *obj, co
 /** Generate message */
 APT_DECLARE(apt_message_status_e) apt_message_generator_run(apt_message_generator_t *generator, void *message, apt_text_stream_t *stream);
 
+/**
+ * Generate message header (start-line and header section) only.
+ * @param generator the generator to use
+ * @param message the message to generate
+ * @param stream the stream to generate the header to
+ * @param body the body of the message referenced in place (not copied to the stream)
+ * @remark The header and the body are supposed to be sent by a single gather write.
+ */
+APT_DECLARE(apt_message_status_e) apt_message_generator_header_run(apt_message_generator_t *generator, void *message, apt_text_stream_t *stream, apt_str_t *body);
+
 /** Get external object associated with generator */
 APT_DECLARE(void*) apt_message_generator_object_get(apt_message_generator_t *generator);
 
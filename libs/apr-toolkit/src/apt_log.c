@@ -18,10 +18,15 @@
 #pragma warning(disable: 4127)
 #else
 #include <sys/unistd.h>
+#include <sys/uio.h>
 #include <syslog.h>
 #endif
 #include <stdlib.h>
+#include <errno.h>
 #include <apr_ring.h>
+#include <apr_atomic.h>
+#include <apr_thread_proc.h>
+#include <apr_thread_cond.h>
 #include <apr_time.h>
 #include <apr_file_io.h>
 #include <apr_fnmatch.h>
@@ -34,6 +39,13 @@
 #define MAX_LOG_ENTRY_SIZE 4096
 #define MAX_PRIORITY_NAME_LENGTH 9
 
+/** Default size of the per-thread log buffer used in async mode (64Kb) */
+#define DEFAULT_LOG_BUFFER_SIZE (64 * 1024)
+/** Default max interval the buffered log entries are written after (msec) */
+#define DEFAULT_LOG_FLUSH_INTERVAL 10
+/** Max number of buffer segments written at once */
+#define MAX_LOG_IOV_COUNT 64
+
 static const char priority_snames[APT_PRIO_COUNT][MAX_PRIORITY_NAME_LENGTH+1] =
 {
 	"[EMERG]  ",
@@ -50,6 +62,9 @@ typedef struct apt_log_file_data_t apt_log_file_data_t;
 typedef struct apt_log_file_settings_t apt_log_file_settings_t;
 typedef struct apt_log_file_entry_t apt_log_file_entry_t;
 typedef struct apt_syslog_settings_t apt_syslog_settings_t;
+typedef struct apt_log_async_settings_t apt_log_async_settings_t;
+typedef struct apt_log_buffer_t apt_log_buffer_t;
+typedef struct apt_log_async_t apt_log_async_t;
 
 struct apt_log_file_entry_t {
 	APR_RING_ENTRY(apt_log_file_entry_t) link;
@@ -86,10 +101,42 @@ struct apt_log_file_data_t {
 	apt_log_file_settings_t   settings;
 };
 
-struct apt_log_source_t {
-	const char               *name;
-	apt_log_priority_e        priority;
-	apt_log_masking_e         masking;
+struct apt_log_async_settings_t {
+	apt_bool_t                enabled;
+	apr_size_t                buffer_size;        /* size of the per-thread buffer in bytes */
+	apr_size_t                flush_interval;     /* max interval in msec the buffered entries are written after */
+};
+
+/** Per-thread log buffer, a lock-free ring with the logging thread as producer and the writer thread as consumer */
+struct apt_log_buffer_t {
+	apt_log_buffer_t         *next;
+	volatile apr_uint32_t     in_use;             /* whether the buffer is owned by a thread */
+	volatile apr_uint32_t     head;               /* write position, advanced by the logging thread */
+	volatile apr_uint32_t     tail;               /* read position, advanced by the writer thread */
+	volatile apr_uint32_t     dropped;            /* number of entries dropped on buffer overflow */
+	apr_uint32_t              dropped_reported;   /* number of dropped entries already reported by the writer */
+	char                     *data;
+
+	/* timestamp prefix cached by the logging thread */
+	apr_time_t                cached_sec;
+	int                       cached_header;
+	char                      cached_prefix[32];
+	apr_size_t                cached_length;
+};
+
+/** Asynchronous log writer */
+struct apt_log_async_t {
+	apt_log_async_settings_t  settings;
+	apt_log_buffer_t * volatile buffers;
+	apr_threadkey_t          *key;
+	apr_thread_t             *thread;
+	apr_pool_t               *thread_pool;        /* pool of the writer thread, destroyed once the thread is joined */
+	apr_thread_mutex_t       *mutex;
+	apr_thread_cond_t        *cond;
+	apr_pool_t               *pool;
+	volatile apr_uint32_t     running;            /* whether the writer thread is running */
+	volatile apr_uint32_t     accepting;          /* whether the logging threads may write to the buffers */
+	volatile apr_uint32_t     loggers;            /* number of the logging threads accessing the buffers */
 };
 
 struct apt_logger_t {
@@ -99,10 +146,14 @@ struct apt_logger_t {
 	apt_log_ext_handler_f     ext_handler;
 	apt_log_file_data_t      *file_data;
 	apt_bool_t                syslog;
+	apt_log_async_t          *async;
+	apt_bool_t                trace_enabled;
+	FILE                     *trace_file;
+	apr_thread_mutex_t       *trace_mutex;        /* created on the first open, kept till the logger is destroyed */
 };
 
 static apt_logger_t *apt_logger = NULL;
-apt_log_source_t def_log_source;
+apt_log_source_t def_log_source = {NULL, APT_PRIO_INFO, APT_LOG_MASKING_NONE, -1};
 
 static apt_bool_t apt_do_log(apt_log_source_t *log_source, const char *file, int line, apt_log_priority_e priority, const char *format, va_list arg_ptr);
 
@@ -114,8 +165,17 @@ static void apt_log_files_purge(const apt_log_file_data_t *file_data);
 static void apt_log_files_populate(apt_log_file_data_t *file_data);
 static void apt_log_file_entries_clear(apt_log_file_data_t *file_data);
 static apt_bool_t apt_log_file_dump(apt_log_file_data_t *file_data, const char *log_entry, apr_size_t size);
+static apt_bool_t apt_log_file_rotate(apt_log_file_data_t *file_data);
 static apr_xml_doc* apt_log_doc_parse(const char *file_path, apr_pool_t *pool);
 
+static apt_bool_t apt_log_async_start(const apt_log_async_settings_t *settings, apr_pool_t *pool);
+static void apt_log_async_stop(void);
+static apt_bool_t apt_log_writer_start(apt_log_async_t *async);
+static void apt_log_writer_stop(apt_log_async_t *async);
+static apt_log_buffer_t* apt_log_buffer_get(apt_log_async_t *async);
+static apr_size_t apt_log_timestamp_cached_format(apt_log_buffer_t *buffer, int header, char *log_entry);
+static apt_bool_t apt_log_buffer_write(apt_log_async_t *async, apt_log_buffer_t *buffer, const char *log_entry, apr_size_t size);
+
 static void apt_log_file_settings_init(apt_log_file_settings_t *settings)
 {
 	settings->purge_existing = FALSE;
@@ -133,6 +193,10 @@ static apt_logger_t* apt_log_instance_alloc(apr_pool_t *pool)
 	logger->ext_handler = NULL;
 	logger->file_data = NULL;
 	logger->syslog = FALSE;
+	logger->async = NULL;
+	logger->trace_enabled = FALSE;
+	logger->trace_file = NULL;
+	logger->trace_mutex = NULL;
 
 	/* Create hash for custom log sources */
 	logger->log_sources = apr_hash_make(pool);
@@ -145,6 +209,36 @@ static apt_logger_t* apt_log_instance_alloc(apr_pool_t *pool)
 	return logger;
 }
 
+static APR_INLINE int apt_log_source_threshold_get(const apt_log_source_t *log_source, apt_bool_t output)
+{
+	return output == TRUE ? (int)log_source->priority : -1;
+}
+
+/** Update the max priority actually output for the log sources, whenever the settings change */
+static void apt_log_thresholds_update(void)
+{
+	apr_hash_index_t *it;
+	void *val;
+	apt_bool_t output = FALSE;
+
+	if(apt_logger && (apt_logger->ext_handler ||
+		(apt_logger->mode & (APT_LOG_OUTPUT_CONSOLE | APT_LOG_OUTPUT_FILE | APT_LOG_OUTPUT_SYSLOG)))) {
+		output = TRUE;
+	}
+
+	def_log_source.threshold = apt_log_source_threshold_get(&def_log_source,output);
+	if(!apt_logger) {
+		return;
+	}
+
+	for(it = apr_hash_first(NULL,apt_logger->log_sources); it; it = apr_hash_next(it)) {
+		apt_log_source_t *log_source;
+		apr_hash_this(it,NULL,NULL,&val);
+		log_source = val;
+		log_source->threshold = apt_log_source_threshold_get(log_source,output);
+	}
+}
+
 APT_DECLARE(apt_bool_t) apt_log_instance_create(apt_log_output_e mode, apt_log_priority_e priority, apr_pool_t *pool)
 {
 	if(apt_logger) {
@@ -153,6 +247,7 @@ APT_DECLARE(apt_bool_t) apt_log_instance_create(apt_log_output_e mode, apt_log_p
 	apt_logger = apt_log_instance_alloc(pool);
 	apt_logger->mode = mode;
 	def_log_source.priority = priority;
+	apt_log_thresholds_update();
 	return TRUE;
 }
 
@@ -189,6 +284,7 @@ static apt_bool_t apt_log_sources_load(const apr_xml_elem *sources_root, apr_poo
 				log_source->name = name;
 				log_source->priority = priority;
 				log_source->masking = masking;
+				log_source->threshold = -1;
 				apr_hash_set(apt_logger->log_sources,log_source->name,APR_HASH_KEY_STRING,log_source);
 			}
 		}
@@ -229,12 +325,31 @@ static apt_bool_t apt_log_file_settings_load(apt_log_file_settings_t *settings,
 	return TRUE;
 }
 
+static apt_bool_t apt_log_async_settings_load(apt_log_async_settings_t *settings, const apr_xml_elem *elem, apr_pool_t *pool)
+{
+	const apr_xml_attr *attr;
+
+	for(attr = elem->attr; attr; attr = attr->next) {
+		if(strcasecmp(attr->name,"enable") == 0) {
+			settings->enabled = (strcasecmp(attr->value,"true") == 0) ? TRUE : FALSE;
+		}
+		else if(strcasecmp(attr->name,"buffer-size") == 0) {
+			settings->buffer_size = atol(attr->value) * 1024;
+		}
+		else if(strcasecmp(attr->name,"flush-interval") == 0) {
+			settings->flush_interval = atol(attr->value);
+		}
+	}
+	return TRUE;
+}
+
 APT_DECLARE(apt_bool_t) apt_log_instance_load(const char *config_file, apr_pool_t *pool)
 {
 	apr_xml_doc *doc;
 	const apr_xml_elem *elem;
 	const apr_xml_elem *root;
 	char *text;
+	apt_log_async_settings_t async_settings;
 
 	if(apt_logger) {
 		return FALSE;
@@ -257,8 +372,26 @@ APT_DECLARE(apt_bool_t) apt_log_instance_load(const char *config_file, apr_pool_
 		return FALSE;
 	}
 
+	async_settings.enabled = FALSE;
+	async_settings.buffer_size = DEFAULT_LOG_BUFFER_SIZE;
+	async_settings.flush_interval = DEFAULT_LOG_FLUSH_INTERVAL;
+
 	/* Navigate through document */
 	for(elem = root->first_child; elem; elem = elem->next) {
+		if(strcasecmp(elem->name,"async") == 0) {
+			apt_log_async_settings_load(&async_settings,elem,pool);
+			continue;
+		}
+		if(strcasecmp(elem->name,"trace") == 0) {
+			const apr_xml_attr *attr;
+			for(attr = elem->attr; attr; attr = attr->next) {
+				if(strcasecmp(attr->name,"enable") == 0) {
+					apt_logger->trace_enabled = (strcasecmp(attr->value,"true") == 0) ? TRUE : FALSE;
+				}
+			}
+			continue;
+		}
+
 		if(!elem->first_cdata.first || !elem->first_cdata.first->text) 
 			continue;
 
@@ -284,6 +417,13 @@ APT_DECLARE(apt_bool_t) apt_log_instance_load(const char *config_file, apr_pool_
 			/* Unknown element */
 		}
 	}
+
+	apt_log_thresholds_update();
+
+	if(async_settings.enabled == TRUE) {
+		/* start the writer thread, fall back to synchronous output on failure */
+		apt_log_async_start(&async_settings,pool);
+	}
 	return TRUE;
 }
 
@@ -293,6 +433,9 @@ APT_DECLARE(apt_bool_t) apt_log_instance_destroy()
 		return FALSE;
 	}
 
+	/* write out the buffered log entries first */
+	apt_log_async_stop();
+
 	if(apt_logger->file_data) {
 		apt_log_file_close();
 	}
@@ -301,6 +444,16 @@ APT_DECLARE(apt_bool_t) apt_log_instance_destroy()
 		apt_syslog_close();
 	}
 
+	if(apt_logger->trace_mutex) {
+		apt_log_trace_close();
+		apr_thread_mutex_destroy(apt_logger->trace_mutex);
+		apt_logger->trace_mutex = NULL;
+	}
+
+	/* disable the output of all the log sources */
+	apt_logger->mode = APT_LOG_OUTPUT_NONE;
+	apt_logger->ext_handler = NULL;
+	apt_log_thresholds_update();
 	apt_logger = NULL;
 	return TRUE;
 }
@@ -316,13 +469,16 @@ APT_DECLARE(apt_bool_t) apt_log_instance_set(apt_logger_t *logger)
 		return FALSE;
 	}
 	apt_logger = logger;
+	apt_log_thresholds_update();
 	return TRUE;
 }
 
 APT_DECLARE(void) apt_def_log_source_set(apt_log_source_t *log_source)
 {
-	if(log_source)
+	if(log_source) {
 		def_log_source = *log_source;
+		apt_log_thresholds_update();
+	}
 }
 
 APT_DECLARE(apt_bool_t) apt_log_source_assign(const char *name, apt_log_source_t **log_source)
@@ -458,6 +614,12 @@ APT_DECLARE(apt_bool_t) apt_log_file_close()
 	if(!apt_logger || !apt_logger->file_data) {
 		return FALSE;
 	}
+	/* the writer thread must not access the log file while it is closed,
+	   the logging threads keep on buffering the entries meanwhile */
+	if(apt_logger->async) {
+		apt_log_writer_stop(apt_logger->async);
+	}
+
 	file_data = apt_logger->file_data;
 	if(file_data->file) {
 		/* close log file */
@@ -472,6 +634,11 @@ APT_DECLARE(apt_bool_t) apt_log_file_close()
 		file_data->pool = NULL;
 	}
 	apt_logger->file_data = NULL;
+
+	if(apt_logger->async) {
+		/* write out the buffered entries to the console and the next log file, if any */
+		apt_log_writer_start(apt_logger->async);
+	}
 	return TRUE;
 }
 
@@ -626,6 +793,7 @@ APT_DECLARE(apt_bool_t) apt_log_output_mode_set(apt_log_output_e mode)
 		return FALSE;
 	}
 	apt_logger->mode = mode;
+	apt_log_thresholds_update();
 	return TRUE;
 }
 
@@ -662,6 +830,7 @@ APT_DECLARE(apt_bool_t) apt_log_priority_set(apt_log_priority_e priority)
 		return FALSE;
 	}
 	def_log_source.priority = priority;
+	apt_log_thresholds_update();
 	return TRUE;
 }
 
@@ -765,9 +934,120 @@ APT_DECLARE(apt_bool_t) apt_log_ext_handler_set(apt_log_ext_handler_f handler)
 		return FALSE;
 	}
 	apt_logger->ext_handler = handler;
+	apt_log_thresholds_update();
+	return TRUE;
+}
+
+APT_DECLARE(apt_bool_t) apt_log_trace_enabled(void)
+{
+	if(!apt_logger) {
+		return FALSE;
+	}
+	return apt_logger->trace_enabled;
+}
+
+APT_DECLARE(apt_bool_t) apt_log_trace_open(const char *dir_path, const char *prefix, apr_pool_t *pool)
+{
+	const char *trace_file_name;
+	char *trace_file_path = NULL;
+	apr_time_exp_t result;
+	apr_uint32_t file_header[3];
+	FILE *trace_file;
+
+	if(!apt_logger || !dir_path || !prefix || apt_logger->trace_file) {
+		return FALSE;
+	}
+
+	/* compose trace file name based on current date and time */
+	apr_time_exp_lt(&result,apr_time_now());
+	trace_file_name = apr_psprintf(pool,"%s_%4d.%02d.%02d_%02d.%02d.%02d.%06d.trace",
+		prefix,
+		result.tm_year + 1900, result.tm_mon + 1, result.tm_mday,
+		result.tm_hour, result.tm_min, result.tm_sec,
+		result.tm_usec);
+	if(apr_filepath_merge(&trace_file_path,dir_path,trace_file_name,APR_FILEPATH_NATIVE,pool) != APR_SUCCESS) {
+		return FALSE;
+	}
+
+	trace_file = fopen(trace_file_path,"wb");
+	if(!trace_file) {
+		return FALSE;
+	}
+
+	/* write the signature, magic number and version */
+	memcpy(&file_header[0],"APTT",4);
+	file_header[1] = APT_LOG_TRACE_MAGIC;
+	file_header[2] = APT_LOG_TRACE_VERSION;
+	fwrite(file_header,sizeof(file_header),1,trace_file);
+
+	/* the mutex is never destroyed on close, since the tracing threads may be waiting for it */
+	if(!apt_logger->trace_mutex &&
+		apr_thread_mutex_create(&apt_logger->trace_mutex,APR_THREAD_MUTEX_DEFAULT,pool) != APR_SUCCESS) {
+		apt_logger->trace_mutex = NULL;
+		fclose(trace_file);
+		return FALSE;
+	}
+
+	apr_thread_mutex_lock(apt_logger->trace_mutex);
+	apt_logger->trace_file = trace_file;
+	apr_thread_mutex_unlock(apt_logger->trace_mutex);
+	return TRUE;
+}
+
+APT_DECLARE(apt_bool_t) apt_log_trace_close(void)
+{
+	FILE *trace_file;
+	if(!apt_logger || !apt_logger->trace_mutex) {
+		return FALSE;
+	}
+
+	apr_thread_mutex_lock(apt_logger->trace_mutex);
+	trace_file = apt_logger->trace_file;
+	apt_logger->trace_file = NULL;
+	apr_thread_mutex_unlock(apt_logger->trace_mutex);
+
+	if(!trace_file) {
+		return FALSE;
+	}
+	fclose(trace_file);
 	return TRUE;
 }
 
+APT_DECLARE(apt_bool_t) apt_log_trace(const char *id, apt_log_trace_direction_e direction, const char *data, apr_size_t length)
+{
+	apt_log_trace_record_t record;
+	apt_bool_t status = FALSE;
+	if(!apt_logger || !apt_logger->trace_mutex) {
+		/* trace has never been opened */
+		return FALSE;
+	}
+
+	/* private data is not traced as is */
+	if(def_log_source.masking != APT_LOG_MASKING_NONE) {
+		data = apt_log_data_mask(data,&length,NULL);
+	}
+
+	record.time = apr_time_now();
+	record.data_length = (apr_uint32_t)length;
+	record.id_length = id ? (apr_uint16_t)strlen(id) : 0;
+	record.direction = (apr_uint16_t)direction;
+
+	/* the records are written without formatting */
+	apr_thread_mutex_lock(apt_logger->trace_mutex);
+	if(apt_logger->trace_file) {
+		fwrite(&record,sizeof(record),1,apt_logger->trace_file);
+		if(record.id_length) {
+			fwrite(id,1,record.id_length,apt_logger->trace_file);
+		}
+		fwrite(data,1,length,apt_logger->trace_file);
+		/* a record is complete in the file, even if the process terminates abnormally */
+		fflush(apt_logger->trace_file);
+		status = TRUE;
+	}
+	apr_thread_mutex_unlock(apt_logger->trace_mutex);
+	return status;
+}
+
 APT_DECLARE(apt_bool_t) apt_log(apt_log_source_t *log_source, const char *file, int line, apt_log_priority_e priority, const char *format, ...)
 {
 	apt_bool_t status = TRUE;
@@ -843,22 +1123,41 @@ static apt_bool_t apt_do_log(apt_log_source_t *log_source, const char *file, int
 	apr_size_t max_size = MAX_LOG_ENTRY_SIZE - 2;
 	apr_size_t offset = 0;
 	apr_size_t data_offset;
-	apr_time_exp_t result;
-	apr_time_t now = apr_time_now();
-	apr_time_exp_lt(&result,now);
-
-	if(apt_logger->header & APT_LOG_HEADER_DATE) {
-		offset += apr_snprintf(log_entry+offset,max_size-offset,"%4d-%02d-%02d ",
-							result.tm_year+1900,
-							result.tm_mon+1,
-							result.tm_mday);
-	}
-	if(apt_logger->header & APT_LOG_HEADER_TIME) {
-		offset += apr_snprintf(log_entry+offset,max_size-offset,"%02d:%02d:%02d:%06d ",
-							result.tm_hour,
-							result.tm_min,
-							result.tm_sec,
-							result.tm_usec);
+	apt_log_buffer_t *buffer = NULL;
+	apt_log_async_t *async = apt_logger->async;
+
+	if(async && (apt_logger->mode & (APT_LOG_OUTPUT_CONSOLE | APT_LOG_OUTPUT_FILE))) {
+		/* console and file output is done by the writer thread, unless it is being stopped */
+		apr_atomic_inc32(&async->loggers);
+		if(apr_atomic_read32(&async->accepting)) {
+			buffer = apt_log_buffer_get(async);
+		}
+		if(!buffer) {
+			apr_atomic_dec32(&async->loggers);
+		}
+	}
+
+	if(buffer) {
+		offset = apt_log_timestamp_cached_format(buffer,apt_logger->header,log_entry);
+	}
+	else if(apt_logger->header & (APT_LOG_HEADER_DATE | APT_LOG_HEADER_TIME)) {
+		apr_time_exp_t result;
+		apr_time_t now = apr_time_now();
+		apr_time_exp_lt(&result,now);
+
+		if(apt_logger->header & APT_LOG_HEADER_DATE) {
+			offset += apr_snprintf(log_entry+offset,max_size-offset,"%4d-%02d-%02d ",
+								result.tm_year+1900,
+								result.tm_mon+1,
+								result.tm_mday);
+		}
+		if(apt_logger->header & APT_LOG_HEADER_TIME) {
+			offset += apr_snprintf(log_entry+offset,max_size-offset,"%02d:%02d:%02d:%06d ",
+								result.tm_hour,
+								result.tm_min,
+								result.tm_sec,
+								result.tm_usec);
+		}
 	}
 	if(apt_logger->header & APT_LOG_HEADER_MARK) {
 		offset += apr_snprintf(log_entry+offset,max_size-offset,"%s:%03d ",file,line);
@@ -875,12 +1174,18 @@ static apt_bool_t apt_do_log(apt_log_source_t *log_source, const char *file, int
 	offset += apr_vsnprintf(log_entry+offset,max_size-offset,format,arg_ptr);
 	log_entry[offset++] = '\n';
 	log_entry[offset] = '\0';
-	if((apt_logger->mode & APT_LOG_OUTPUT_CONSOLE) == APT_LOG_OUTPUT_CONSOLE) {
-		fwrite(log_entry,offset,1,stdout);
+	if(buffer) {
+		apt_log_buffer_write(async,buffer,log_entry,offset);
+		apr_atomic_dec32(&async->loggers);
 	}
-	
-	if((apt_logger->mode & APT_LOG_OUTPUT_FILE) == APT_LOG_OUTPUT_FILE && apt_logger->file_data) {
-		apt_log_file_dump(apt_logger->file_data,log_entry,offset);
+	else {
+		if((apt_logger->mode & APT_LOG_OUTPUT_CONSOLE) == APT_LOG_OUTPUT_CONSOLE) {
+			fwrite(log_entry,offset,1,stdout);
+		}
+
+		if((apt_logger->mode & APT_LOG_OUTPUT_FILE) == APT_LOG_OUTPUT_FILE && apt_logger->file_data) {
+			apt_log_file_dump(apt_logger->file_data,log_entry,offset);
+		}
 	}
 
 #ifndef WIN32
@@ -1124,6 +1429,444 @@ static apt_bool_t apt_log_file_dump(apt_log_file_data_t *file_data, const char *
 	return TRUE;
 }
 
+/** Write out the segments of log entries, the array of segments gets modified */
+static void apt_log_segments_write(FILE *file, struct iovec *iov, int count)
+{
+#ifdef WIN32
+	int i;
+	for(i=0; i<count; i++) {
+		fwrite(iov[i].iov_base,1,iov[i].iov_len,file);
+	}
+	fflush(file);
+#else
+	int fd = fileno(file);
+	ssize_t written;
+
+	/* anything written synchronously must go first */
+	fflush(file);
+	while(count > 0) {
+		written = writev(fd,iov,count);
+		if(written < 0) {
+			if(errno == EINTR) {
+				continue;
+			}
+			break;
+		}
+
+		/* skip the segments written completely, the rest is written on the next iteration */
+		while(count > 0 && (apr_size_t)written >= iov->iov_len) {
+			written -= iov->iov_len;
+			iov++;
+			count--;
+		}
+		if(count > 0) {
+			iov->iov_base = (char*)iov->iov_base + written;
+			iov->iov_len -= written;
+		}
+	}
+#endif
+}
+
+static apt_bool_t apt_log_file_segments_dump(apt_log_file_data_t *file_data, struct iovec *iov, int count, apr_size_t size)
+{
+	apr_thread_mutex_lock(file_data->mutex);
+
+	file_data->cur_size += size;
+	if(file_data->cur_size > file_data->settings.max_size) {
+		/* rotate log files */
+		if (apt_log_file_rotate(file_data) == FALSE) {
+			apr_thread_mutex_unlock(file_data->mutex);
+			return FALSE;
+		}
+
+		file_data->cur_size = size;
+	}
+	/* write to log file */
+	apt_log_segments_write(file_data->file,iov,count);
+
+	apr_thread_mutex_unlock(file_data->mutex);
+	return TRUE;
+}
+
+/** Output the segments to the console and the log file */
+static void apt_log_segments_output(struct iovec *iov, int count, apr_size_t size)
+{
+	struct iovec iov_copy[MAX_LOG_IOV_COUNT + 1];
+	if((apt_logger->mode & APT_LOG_OUTPUT_CONSOLE) == APT_LOG_OUTPUT_CONSOLE) {
+		memcpy(iov_copy,iov,sizeof(struct iovec) * count);
+		apt_log_segments_write(stdout,iov_copy,count);
+	}
+
+	if((apt_logger->mode & APT_LOG_OUTPUT_FILE) == APT_LOG_OUTPUT_FILE && apt_logger->file_data) {
+		memcpy(iov_copy,iov,sizeof(struct iovec) * count);
+		apt_log_file_segments_dump(apt_logger->file_data,iov_copy,count,size);
+	}
+}
+
+/** Write out the entries accumulated in the per-thread buffers (writer thread only) */
+static void apt_log_buffers_flush(apt_log_async_t *async)
+{
+	struct iovec iov[MAX_LOG_IOV_COUNT + 1];
+	apt_log_buffer_t *flushed[MAX_LOG_IOV_COUNT];
+	apr_uint32_t flushed_sizes[MAX_LOG_IOV_COUNT];
+	char notice[128];
+	apr_uint32_t buffer_size = (apr_uint32_t)async->settings.buffer_size;
+	apr_uint32_t dropped = 0;
+	apr_uint32_t head;
+	apr_uint32_t size;
+	apr_uint32_t offset;
+	apr_uint32_t chunk;
+	apr_size_t total;
+	int count;
+	int flushed_count;
+	int i;
+	apt_log_buffer_t *buffer;
+
+	/* report the entries dropped since the last flush */
+	for(buffer = async->buffers; buffer; buffer = buffer->next) {
+		head = apr_atomic_read32(&buffer->dropped);
+		dropped += head - buffer->dropped_reported;
+		buffer->dropped_reported = head;
+	}
+	if(dropped) {
+		iov[0].iov_base = notice;
+		iov[0].iov_len = apr_snprintf(notice,sizeof(notice),"%sLog Buffer Overflow [%u] Entries Dropped\n",
+			priority_snames[APT_PRIO_WARNING],dropped);
+		apt_log_segments_output(iov,1,iov[0].iov_len);
+	}
+
+	buffer = async->buffers;
+	while(buffer) {
+		count = 0;
+		flushed_count = 0;
+		total = 0;
+		for(; buffer && count + 2 <= MAX_LOG_IOV_COUNT; buffer = buffer->next) {
+			head = apr_atomic_read32(&buffer->head);
+			size = head - buffer->tail;
+			if(!size) {
+				continue;
+			}
+
+			/* the pending data is contiguous or wraps around the end of the buffer */
+			offset = buffer->tail & (buffer_size - 1);
+			chunk = buffer_size - offset;
+			if(chunk > size) {
+				chunk = size;
+			}
+			iov[count].iov_base = buffer->data + offset;
+			iov[count].iov_len = chunk;
+			count++;
+			if(chunk < size) {
+				iov[count].iov_base = buffer->data;
+				iov[count].iov_len = size - chunk;
+				count++;
+			}
+
+			flushed[flushed_count] = buffer;
+			flushed_sizes[flushed_count] = size;
+			flushed_count++;
+			total += size;
+		}
+
+		if(!count) {
+			break;
+		}
+
+		apt_log_segments_output(iov,count,total);
+
+		/* release the written space to the logging threads */
+		for(i=0; i<flushed_count; i++) {
+			apr_atomic_add32(&flushed[i]->tail,flushed_sizes[i]);
+		}
+	}
+}
+
+static void* APR_THREAD_FUNC apt_log_writer_run(apr_thread_t *thread, void *data)
+{
+	apt_log_async_t *async = data;
+	apr_interval_time_t timeout = apr_time_from_msec(async->settings.flush_interval);
+
+	while(apr_atomic_read32(&async->running)) {
+		apr_thread_mutex_lock(async->mutex);
+		if(apr_atomic_read32(&async->running)) {
+			apr_thread_cond_timedwait(async->cond,async->mutex,timeout);
+		}
+		apr_thread_mutex_unlock(async->mutex);
+
+		apt_log_buffers_flush(async);
+	}
+
+	/* write out what is left */
+	apt_log_buffers_flush(async);
+	return NULL;
+}
+
+/** Release the buffer of the exiting thread to be taken over by another thread */
+static void apt_log_buffer_release(void *data)
+{
+	apt_log_buffer_t *buffer = data;
+	apr_atomic_set32(&buffer->in_use,FALSE);
+}
+
+static apt_log_buffer_t* apt_log_buffer_get(apt_log_async_t *async)
+{
+	apt_log_buffer_t *buffer;
+	void *data = NULL;
+
+	if(apr_threadkey_private_get(&data,async->key) == APR_SUCCESS && data) {
+		return data;
+	}
+
+	/* take over a buffer released by an exited thread, if any */
+	for(buffer = async->buffers; buffer; buffer = buffer->next) {
+		if(apr_atomic_cas32(&buffer->in_use,TRUE,FALSE) == FALSE) {
+			break;
+		}
+	}
+
+	if(!buffer) {
+		/* allocate a new buffer, the logging thread may have no pool to use */
+		buffer = malloc(sizeof(apt_log_buffer_t));
+		if(!buffer) {
+			return NULL;
+		}
+		buffer->data = malloc(async->settings.buffer_size);
+		if(!buffer->data) {
+			free(buffer);
+			return NULL;
+		}
+		buffer->in_use = TRUE;
+		buffer->head = 0;
+		buffer->tail = 0;
+		buffer->dropped = 0;
+		buffer->dropped_reported = 0;
+		buffer->cached_sec = -1;
+		buffer->cached_header = 0;
+		buffer->cached_length = 0;
+
+		/* push the buffer to the list, buffers are never removed while the writer is running */
+		do {
+			buffer->next = async->buffers;
+		}
+		while(apr_atomic_casptr((volatile void**)&async->buffers,buffer,buffer->next) != buffer->next);
+	}
+
+	apr_threadkey_private_set(buffer,async->key);
+	return buffer;
+}
+
+/** Compose the date and time header, which is cached up to seconds per thread */
+static apr_size_t apt_log_timestamp_cached_format(apt_log_buffer_t *buffer, int header, char *log_entry)
+{
+	apr_time_t now;
+	apr_size_t offset;
+	apr_int32_t usec;
+	int i;
+
+	if(!(header & (APT_LOG_HEADER_DATE | APT_LOG_HEADER_TIME))) {
+		return 0;
+	}
+
+	now = apr_time_now();
+	if(apr_time_sec(now) != buffer->cached_sec || header != buffer->cached_header) {
+		apr_time_exp_t result;
+		apr_time_exp_lt(&result,now);
+
+		offset = 0;
+		if(header & APT_LOG_HEADER_DATE) {
+			offset += apr_snprintf(buffer->cached_prefix+offset,sizeof(buffer->cached_prefix)-offset,"%4d-%02d-%02d ",
+								result.tm_year+1900,
+								result.tm_mon+1,
+								result.tm_mday);
+		}
+		if(header & APT_LOG_HEADER_TIME) {
+			offset += apr_snprintf(buffer->cached_prefix+offset,sizeof(buffer->cached_prefix)-offset,"%02d:%02d:%02d:",
+								result.tm_hour,
+								result.tm_min,
+								result.tm_sec);
+		}
+		buffer->cached_length = offset;
+		buffer->cached_sec = apr_time_sec(now);
+		buffer->cached_header = header;
+	}
+
+	offset = buffer->cached_length;
+	memcpy(log_entry,buffer->cached_prefix,offset);
+	if(header & APT_LOG_HEADER_TIME) {
+		/* only microseconds are formatted per entry */
+		usec = (apr_int32_t)apr_time_usec(now);
+		for(i=5; i>=0; i--) {
+			log_entry[offset+i] = (char)('0' + usec % 10);
+			usec /= 10;
+		}
+		offset += 6;
+		log_entry[offset++] = ' ';
+	}
+	return offset;
+}
+
+static apt_bool_t apt_log_buffer_write(apt_log_async_t *async, apt_log_buffer_t *buffer, const char *log_entry, apr_size_t size)
+{
+	apr_uint32_t buffer_size = (apr_uint32_t)async->settings.buffer_size;
+	apr_uint32_t head = buffer->head;
+	apr_uint32_t used = head - apr_atomic_read32(&buffer->tail);
+	apr_uint32_t offset;
+	apr_uint32_t chunk;
+
+	if(size > buffer_size - used) {
+		/* never block the logging thread, the writer reports the dropped entries */
+		apr_atomic_inc32(&buffer->dropped);
+		return FALSE;
+	}
+
+	offset = head & (buffer_size - 1);
+	chunk = buffer_size - offset;
+	if(chunk > size) {
+		chunk = (apr_uint32_t)size;
+	}
+	memcpy(buffer->data + offset,log_entry,chunk);
+	if(chunk < size) {
+		memcpy(buffer->data,log_entry + chunk,size - chunk);
+	}
+
+	/* publish the entry to the writer thread */
+	apr_atomic_add32(&buffer->head,(apr_uint32_t)size);
+
+	if(used < buffer_size / 2 && used + size >= buffer_size / 2) {
+		/* wake up the writer before the flush interval elapses */
+		apr_thread_mutex_lock(async->mutex);
+		apr_thread_cond_signal(async->cond);
+		apr_thread_mutex_unlock(async->mutex);
+	}
+	return TRUE;
+}
+
+/** Start the writer thread */
+static apt_bool_t apt_log_writer_start(apt_log_async_t *async)
+{
+	/* the writer is restarted on every close of the log file, thus the thread
+	   is created in its own pool instead of the long-lived pool of the logger */
+	async->thread_pool = apt_pool_create();
+	if(!async->thread_pool) {
+		return FALSE;
+	}
+	apr_atomic_set32(&async->running,TRUE);
+	if(apr_thread_create(&async->thread,NULL,apt_log_writer_run,async,async->thread_pool) != APR_SUCCESS) {
+		apr_atomic_set32(&async->running,FALSE);
+		async->thread = NULL;
+		apr_pool_destroy(async->thread_pool);
+		async->thread_pool = NULL;
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/** Stop the writer thread after it writes out the buffered entries */
+static void apt_log_writer_stop(apt_log_async_t *async)
+{
+	apr_status_t retval;
+	if(!async->thread) {
+		return;
+	}
+
+	apr_thread_mutex_lock(async->mutex);
+	apr_atomic_set32(&async->running,FALSE);
+	apr_thread_cond_signal(async->cond);
+	apr_thread_mutex_unlock(async->mutex);
+	apr_thread_join(&retval,async->thread);
+	async->thread = NULL;
+	apr_pool_destroy(async->thread_pool);
+	async->thread_pool = NULL;
+}
+
+static apt_bool_t apt_log_async_start(const apt_log_async_settings_t *settings, apr_pool_t *pool)
+{
+	apt_log_async_t *async;
+	apr_size_t buffer_size = MAX_LOG_ENTRY_SIZE;
+
+	if(!apt_logger || apt_logger->async) {
+		return FALSE;
+	}
+
+	async = apr_palloc(pool,sizeof(apt_log_async_t));
+	async->settings = *settings;
+	/* the buffer size is a power of 2 to wrap the positions by mask, a log entry must always fit */
+	while(buffer_size < settings->buffer_size && buffer_size < (1 << 30)) {
+		buffer_size <<= 1;
+	}
+	async->settings.buffer_size = buffer_size;
+	if(!async->settings.flush_interval) {
+		async->settings.flush_interval = DEFAULT_LOG_FLUSH_INTERVAL;
+	}
+	async->buffers = NULL;
+	async->key = NULL;
+	async->thread = NULL;
+	async->thread_pool = NULL;
+	async->mutex = NULL;
+	async->cond = NULL;
+	async->pool = pool;
+	async->running = FALSE;
+	async->accepting = TRUE;
+	async->loggers = 0;
+
+	if(apr_threadkey_private_create(&async->key,apt_log_buffer_release,pool) != APR_SUCCESS) {
+		return FALSE;
+	}
+	if(apr_thread_mutex_create(&async->mutex,APR_THREAD_MUTEX_DEFAULT,pool) != APR_SUCCESS) {
+		apr_threadkey_private_delete(async->key);
+		return FALSE;
+	}
+	if(apr_thread_cond_create(&async->cond,pool) != APR_SUCCESS) {
+		apr_thread_mutex_destroy(async->mutex);
+		apr_threadkey_private_delete(async->key);
+		return FALSE;
+	}
+	if(apt_log_writer_start(async) == FALSE) {
+		apr_thread_cond_destroy(async->cond);
+		apr_thread_mutex_destroy(async->mutex);
+		apr_threadkey_private_delete(async->key);
+		return FALSE;
+	}
+
+	apt_logger->async = async;
+	return TRUE;
+}
+
+static void apt_log_async_stop(void)
+{
+	apt_log_async_t *async;
+	apt_log_buffer_t *buffer;
+
+	if(!apt_logger || !apt_logger->async) {
+		return;
+	}
+
+	/* log entries are output synchronously from now on */
+	async = apt_logger->async;
+	apt_logger->async = NULL;
+
+	/* the async object itself is allocated from the pool and stays valid, so a logging
+	   thread, which has just fetched it, sees it is not accepting and falls back */
+	apr_atomic_xchg32(&async->accepting,FALSE);
+	while(apr_atomic_read32(&async->loggers)) {
+		/* wait for the logging threads still writing to the buffers */
+		apr_thread_yield();
+	}
+
+	apt_log_writer_stop(async);
+
+	while(async->buffers) {
+		buffer = async->buffers;
+		async->buffers = buffer->next;
+		free(buffer->data);
+		free(buffer);
+	}
+
+	apr_threadkey_private_delete(async->key);
+	apr_thread_cond_destroy(async->cond);
+	apr_thread_mutex_destroy(async->mutex);
+}
+
 static apr_xml_doc* apt_log_doc_parse(const char *file_path, apr_pool_t *pool)
 {
 	apr_xml_parser *parser = NULL;
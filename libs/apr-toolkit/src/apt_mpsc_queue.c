@@ -0,0 +1,125 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <apr_atomic.h>
+#include "apt_mpsc_queue.h"
+
+/** Size of the padding, which keeps the producer and consumer positions in separate cache lines */
+#define MPSC_QUEUE_PADDING_SIZE 64
+
+/** Cell of the queue, the sequence number tells whose turn is to access the cell */
+typedef struct apt_mpsc_cell_t apt_mpsc_cell_t;
+struct apt_mpsc_cell_t {
+	volatile apr_uint32_t sequence;
+	void                 *obj;
+};
+
+/*
+ * The queue is a ring of cells, each cell carries a sequence number.
+ * The cell at position pos is free to be written when its sequence is pos,
+ * and ready to be read when its sequence is pos+1. Producers claim
+ * positions by cas on the shared tail, the single consumer advances
+ * its own head without any atomic operation but the release of the cell.
+ */
+struct apt_mpsc_queue_t {
+	apt_mpsc_cell_t      *cells;
+	apr_uint32_t          mask;
+	char                  padding1[MPSC_QUEUE_PADDING_SIZE];
+	/** Position to be claimed by the next producer */
+	volatile apr_uint32_t tail;
+	char                  padding2[MPSC_QUEUE_PADDING_SIZE];
+	/** Position to be read by the consumer */
+	apr_uint32_t          head;
+};
+
+APT_DECLARE(apt_mpsc_queue_t*) apt_mpsc_queue_create(apr_size_t size, apr_pool_t *pool)
+{
+	apr_uint32_t i;
+	apr_uint32_t capacity = 2;
+	apt_mpsc_queue_t *queue = apr_palloc(pool,sizeof(apt_mpsc_queue_t));
+
+	while(capacity < size) {
+		capacity <<= 1;
+	}
+	queue->cells = apr_palloc(pool,sizeof(apt_mpsc_cell_t) * capacity);
+	for(i=0; i<capacity; i++) {
+		queue->cells[i].sequence = i;
+		queue->cells[i].obj = NULL;
+	}
+	queue->mask = capacity - 1;
+	queue->tail = 0;
+	queue->head = 0;
+	return queue;
+}
+
+APT_DECLARE(apt_bool_t) apt_mpsc_queue_push(apt_mpsc_queue_t *queue, void *obj)
+{
+	apt_mpsc_cell_t *cell;
+	apr_uint32_t sequence;
+	apr_uint32_t pos = apr_atomic_read32(&queue->tail);
+	apr_uint32_t prev_pos;
+
+	for(;;) {
+		cell = &queue->cells[pos & queue->mask];
+		sequence = apr_atomic_read32(&cell->sequence);
+		if(sequence == pos) {
+			/* the cell is free, try to claim the position */
+			prev_pos = apr_atomic_cas32(&queue->tail,pos + 1,pos);
+			if(prev_pos == pos) {
+				break;
+			}
+			pos = prev_pos;
+		}
+		else if((apr_int32_t)(sequence - pos) < 0) {
+			/* the cell is not yet read by the consumer, the queue is full */
+			return FALSE;
+		}
+		else {
+			/* the position has been claimed by another producer */
+			pos = apr_atomic_read32(&queue->tail);
+		}
+	}
+
+	cell->obj = obj;
+	/* publish the object, sequence becomes pos+1 */
+	apr_atomic_inc32(&cell->sequence);
+	return TRUE;
+}
+
+APT_DECLARE(void*) apt_mpsc_queue_pop(apt_mpsc_queue_t *queue)
+{
+	void *obj;
+	apr_uint32_t sequence = queue->head + 1;
+	apt_mpsc_cell_t *cell = &queue->cells[queue->head & queue->mask];
+	if(apr_atomic_read32(&cell->sequence) != sequence) {
+		/* the queue is empty or the next object is not yet published */
+		return NULL;
+	}
+
+	/* the read above is a plain load, acquire the object by a cas which leaves the sequence as is */
+	apr_atomic_cas32(&cell->sequence,sequence,sequence);
+	obj = cell->obj;
+	/* release the cell for the round ahead, sequence becomes head+capacity */
+	apr_atomic_add32(&cell->sequence,queue->mask);
+	queue->head++;
+	return obj;
+}
+
+APT_DECLARE(apt_bool_t) apt_mpsc_queue_is_empty(const apt_mpsc_queue_t *queue)
+{
+	const apt_mpsc_cell_t *cell = &queue->cells[queue->head & queue->mask];
+	return (apr_atomic_read32((volatile apr_uint32_t*)&cell->sequence) != queue->head + 1) ? TRUE : FALSE;
+}
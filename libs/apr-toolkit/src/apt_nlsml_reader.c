@@ -0,0 +1,772 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <apr_tables.h>
+#include "apt_nlsml_reader.h"
+#include "apt_log.h"
+
+/** Max nesting depth of the elements */
+#define NLSML_MAX_DEPTH 64
+
+/** Type of tag */
+typedef enum {
+	NLSML_TAG_START,   /**< start tag <name> */
+	NLSML_TAG_EMPTY,   /**< empty-element tag <name/> */
+	NLSML_TAG_END,     /**< end tag </name> */
+	NLSML_TAG_NONE     /**< end of document */
+} nlsml_tag_type_e;
+
+/** Tag read from the document */
+typedef struct nlsml_tag_t nlsml_tag_t;
+struct nlsml_tag_t {
+	/** Type of the tag */
+	nlsml_tag_type_e type;
+	/** Beginning of the tag ('<') */
+	const char      *begin;
+	/** Name of the element */
+	const char      *name;
+	apr_size_t       name_length;
+	/** Attributes of the element */
+	const char      *attrs;
+	const char      *attrs_end;
+};
+
+/** Reader of NLSML result */
+typedef struct nlsml_reader_t nlsml_reader_t;
+struct nlsml_reader_t {
+	/** Current position in the document */
+	const char         *pos;
+	/** End of the document */
+	const char         *end;
+	/** Next free byte of the buffer the strings are stored in */
+	char               *out;
+	/** Array of the interpretations (nlsml_flat_interpretation_t) */
+	apr_array_header_t *interpretations;
+	/** Array of the instances of all the interpretations (apt_str_t) */
+	apr_array_header_t *instances;
+};
+
+static APR_INLINE apt_bool_t nlsml_is_space(char ch)
+{
+	return (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n') ? TRUE : FALSE;
+}
+
+/** Find the string in the span */
+static const char* nlsml_find(const char *pos, const char *end, const char *str, apr_size_t length)
+{
+	while(pos + length <= end) {
+		pos = memchr(pos,*str,end - pos);
+		if(!pos || pos + length > end) {
+			return NULL;
+		}
+		if(memcmp(pos,str,length) == 0) {
+			return pos;
+		}
+		pos++;
+	}
+	return NULL;
+}
+
+/** Check whether the span starts with the string */
+static APR_INLINE apt_bool_t nlsml_starts_with(const char *pos, const char *end, const char *str, apr_size_t length)
+{
+	return (pos + length <= end && memcmp(pos,str,length) == 0) ? TRUE : FALSE;
+}
+
+/** Compare the name, ignoring namespace prefix and case */
+static apt_bool_t nlsml_name_compare(const char *name, apr_size_t length, const char *str)
+{
+	const char *pos;
+	for(pos = name + length; pos > name; pos--) {
+		if(*(pos-1) == ':') {
+			length -= pos - name;
+			name = pos;
+			break;
+		}
+	}
+	return (length == strlen(str) && strncasecmp(name,str,length) == 0) ? TRUE : FALSE;
+}
+
+/** Resolve entity or character reference, return the number of bytes written */
+static apr_size_t nlsml_reference_resolve(const char *name, const char *end, char *out)
+{
+	apr_uint32_t code = 0;
+	apr_size_t length = end - name;
+	if(!length) {
+		return 0;
+	}
+
+	if(*name != '#') {
+		static const struct {
+			const char *name;
+			char        ch;
+		} entities[] = {{"lt",'<'},{"gt",'>'},{"amp",'&'},{"quot",'"'},{"apos",'\''}};
+		apr_size_t i;
+		for(i=0; i<sizeof(entities)/sizeof(entities[0]); i++) {
+			if(length == strlen(entities[i].name) && memcmp(name,entities[i].name,length) == 0) {
+				*out = entities[i].ch;
+				return 1;
+			}
+		}
+		return 0;
+	}
+
+	name++;
+	if(name < end && (*name == 'x' || *name == 'X')) {
+		for(name++; name < end && code <= 0x10FFFF; name++) {
+			if(*name >= '0' && *name <= '9')      code = code * 16 + (*name - '0');
+			else if(*name >= 'a' && *name <= 'f') code = code * 16 + (*name - 'a' + 10);
+			else if(*name >= 'A' && *name <= 'F') code = code * 16 + (*name - 'A' + 10);
+			else return 0;
+		}
+	}
+	else {
+		for(; name < end && code <= 0x10FFFF; name++) {
+			if(*name >= '0' && *name <= '9')      code = code * 10 + (*name - '0');
+			else return 0;
+		}
+	}
+	if(name < end || !code || code > 0x10FFFF) {
+		return 0;
+	}
+
+	/* encode in UTF-8, the encoding is never longer than the reference */
+	if(code < 0x80) {
+		out[0] = (char)code;
+		return 1;
+	}
+	if(code < 0x800) {
+		out[0] = (char)(0xC0 | (code >> 6));
+		out[1] = (char)(0x80 | (code & 0x3F));
+		return 2;
+	}
+	if(code < 0x10000) {
+		out[0] = (char)(0xE0 | (code >> 12));
+		out[1] = (char)(0x80 | ((code >> 6) & 0x3F));
+		out[2] = (char)(0x80 | (code & 0x3F));
+		return 3;
+	}
+	out[0] = (char)(0xF0 | (code >> 18));
+	out[1] = (char)(0x80 | ((code >> 12) & 0x3F));
+	out[2] = (char)(0x80 | ((code >> 6) & 0x3F));
+	out[3] = (char)(0x80 | (code & 0x3F));
+	return 4;
+}
+
+/** Normalize line ends in place, as an XML processor does */
+static apr_size_t nlsml_line_ends_normalize(char *buf, apr_size_t length)
+{
+	const char *src = memchr(buf,'\r',length);
+	const char *end = buf + length;
+	char *dst;
+	if(!src) {
+		return length;
+	}
+
+	dst = buf + (src - buf);
+	while(src < end) {
+		if(*src == '\r') {
+			/* translate both CR LF and a single CR to LF */
+			*dst++ = '\n';
+			src++;
+			if(src < end && *src == '\n') {
+				src++;
+			}
+			continue;
+		}
+		*dst++ = *src++;
+	}
+	return dst - buf;
+}
+
+/** Decode text in place: resolve references, unwrap CDATA sections, drop comments and PIs */
+static apr_size_t nlsml_text_decode(char *buf, apr_size_t length)
+{
+	const char *src = buf;
+	const char *end = buf + length;
+	const char *pos;
+	char *dst = buf;
+	apr_size_t n;
+
+	while(src < end) {
+		if(*src == '&') {
+			pos = memchr(src,';',end - src);
+			if(pos) {
+				n = nlsml_reference_resolve(src + 1,pos,dst);
+				if(n) {
+					dst += n;
+					src = pos + 1;
+					continue;
+				}
+			}
+		}
+		else if(*src == '<') {
+			if(nlsml_starts_with(src,end,"<![CDATA[",9) == TRUE) {
+				pos = nlsml_find(src + 9,end,"]]>",3);
+				if(pos) {
+					n = pos - (src + 9);
+					memmove(dst,src + 9,n);
+					dst += n;
+					src = pos + 3;
+					continue;
+				}
+			}
+			else if(nlsml_starts_with(src,end,"<!--",4) == TRUE) {
+				pos = nlsml_find(src + 4,end,"-->",3);
+				if(pos) {
+					src = pos + 3;
+					continue;
+				}
+			}
+			else if(nlsml_starts_with(src,end,"<?",2) == TRUE) {
+				pos = nlsml_find(src + 2,end,"?>",2);
+				if(pos) {
+					src = pos + 2;
+					continue;
+				}
+			}
+		}
+		*dst++ = *src++;
+	}
+	return dst - buf;
+}
+
+/** Append the span to the buffer */
+static APR_INLINE void nlsml_span_append(nlsml_reader_t *reader, const char *begin, const char *end)
+{
+	apr_size_t length = end - begin;
+	memcpy(reader->out,begin,length);
+	reader->out += length;
+}
+
+/** Copy the text to the buffer, decode and terminate it */
+static const char* nlsml_text_copy(nlsml_reader_t *reader, const char *begin, const char *end)
+{
+	char *buf = reader->out;
+	apr_size_t length = end - begin;
+	memcpy(buf,begin,length);
+	length = nlsml_text_decode(buf,length);
+	buf[length] = '\0';
+	reader->out = buf + length + 1;
+	return buf;
+}
+
+/** Skip the markup up to and including the terminator */
+static apt_bool_t nlsml_markup_skip(nlsml_reader_t *reader, apr_size_t offset, const char *terminator)
+{
+	apr_size_t length = strlen(terminator);
+	const char *pos = nlsml_find(reader->pos + offset,reader->end,terminator,length);
+	if(!pos) {
+		return FALSE;
+	}
+	reader->pos = pos + length;
+	return TRUE;
+}
+
+/** Read the tag at the current position */
+static apt_bool_t nlsml_tag_read(nlsml_reader_t *reader, nlsml_tag_t *tag)
+{
+	const char *pos = reader->pos + 1;
+	const char *end = reader->end;
+	char quote = 0;
+
+	tag->begin = reader->pos;
+	tag->type = NLSML_TAG_START;
+	if(pos < end && *pos == '/') {
+		tag->type = NLSML_TAG_END;
+		pos++;
+	}
+
+	tag->name = pos;
+	while(pos < end && nlsml_is_space(*pos) == FALSE && *pos != '>' && *pos != '/') {
+		pos++;
+	}
+	tag->name_length = pos - tag->name;
+	if(!tag->name_length) {
+		return FALSE;
+	}
+
+	/* find the end of the tag, skipping quoted attribute values */
+	tag->attrs = pos;
+	for(; pos < end; pos++) {
+		if(quote) {
+			if(*pos == quote) {
+				quote = 0;
+			}
+		}
+		else if(*pos == '"' || *pos == '\'') {
+			quote = *pos;
+		}
+		else if(*pos == '>') {
+			break;
+		}
+	}
+	if(pos == end) {
+		return FALSE;
+	}
+	tag->attrs_end = pos;
+	if(pos > tag->attrs && *(pos-1) == '/') {
+		if(tag->type == NLSML_TAG_END) {
+			return FALSE;
+		}
+		tag->type = NLSML_TAG_EMPTY;
+		tag->attrs_end--;
+	}
+	reader->pos = pos + 1;
+	return TRUE;
+}
+
+/** Read the next tag, skipping text, comments, CDATA sections, PIs and declarations */
+static apt_bool_t nlsml_tag_next(nlsml_reader_t *reader, nlsml_tag_t *tag)
+{
+	const char *pos;
+	apt_bool_t status = TRUE;
+	for(;;) {
+		pos = memchr(reader->pos,'<',reader->end - reader->pos);
+		if(!pos) {
+			reader->pos = reader->end;
+			tag->type = NLSML_TAG_NONE;
+			return TRUE;
+		}
+
+		reader->pos = pos;
+		if(nlsml_starts_with(pos,reader->end,"<!--",4) == TRUE) {
+			status = nlsml_markup_skip(reader,4,"-->");
+		}
+		else if(nlsml_starts_with(pos,reader->end,"<![CDATA[",9) == TRUE) {
+			status = nlsml_markup_skip(reader,9,"]]>");
+		}
+		else if(nlsml_starts_with(pos,reader->end,"<?",2) == TRUE) {
+			status = nlsml_markup_skip(reader,2,"?>");
+		}
+		else if(nlsml_starts_with(pos,reader->end,"<!",2) == TRUE) {
+			/* document type declaration, possibly with an internal subset */
+			const char *gt = memchr(pos,'>',reader->end - pos);
+			if(gt && memchr(pos,'[',gt - pos)) {
+				status = nlsml_markup_skip(reader,2,"]>");
+			}
+			else {
+				status = nlsml_markup_skip(reader,2,">");
+			}
+		}
+		else {
+			break;
+		}
+
+		if(status == FALSE) {
+			return FALSE;
+		}
+	}
+	return nlsml_tag_read(reader,tag);
+}
+
+/** Check the end tag matches the start tag */
+static APR_INLINE apt_bool_t nlsml_tag_end_check(const nlsml_tag_t *start_tag, const nlsml_tag_t *end_tag)
+{
+	return (end_tag->type == NLSML_TAG_END &&
+		end_tag->name_length == start_tag->name_length &&
+		memcmp(end_tag->name,start_tag->name,start_tag->name_length) == 0) ? TRUE : FALSE;
+}
+
+/** Skip the element up to and including its end tag */
+static apt_bool_t nlsml_element_skip(nlsml_reader_t *reader, const nlsml_tag_t *start_tag, apr_size_t depth, nlsml_tag_t *end_tag)
+{
+	nlsml_tag_t tag;
+	if(start_tag->type == NLSML_TAG_EMPTY) {
+		if(end_tag) {
+			*end_tag = *start_tag;
+		}
+		return TRUE;
+	}
+	if(depth >= NLSML_MAX_DEPTH) {
+		return FALSE;
+	}
+
+	for(;;) {
+		if(nlsml_tag_next(reader,&tag) == FALSE) {
+			return FALSE;
+		}
+		if(tag.type == NLSML_TAG_START || tag.type == NLSML_TAG_EMPTY) {
+			if(nlsml_element_skip(reader,&tag,depth + 1,NULL) == FALSE) {
+				return FALSE;
+			}
+		}
+		else if(tag.type == NLSML_TAG_END) {
+			if(end_tag) {
+				*end_tag = tag;
+			}
+			return nlsml_tag_end_check(start_tag,&tag);
+		}
+		else {
+			return FALSE;
+		}
+	}
+}
+
+/** Read the next attribute of the tag */
+static apt_bool_t nlsml_attr_next(const char **attrs, const char *end, const char **name, apr_size_t *name_length, const char **value, const char **value_end)
+{
+	const char *pos = *attrs;
+	char quote;
+
+	while(pos < end && nlsml_is_space(*pos) == TRUE) pos++;
+	if(pos >= end) {
+		return FALSE;
+	}
+	*name = pos;
+	while(pos < end && *pos != '=' && nlsml_is_space(*pos) == FALSE) pos++;
+	*name_length = pos - *name;
+
+	while(pos < end && nlsml_is_space(*pos) == TRUE) pos++;
+	if(pos >= end || *pos != '=') {
+		return FALSE;
+	}
+	pos++;
+	while(pos < end && nlsml_is_space(*pos) == TRUE) pos++;
+	if(pos >= end || (*pos != '"' && *pos != '\'')) {
+		return FALSE;
+	}
+	quote = *pos++;
+	*value = pos;
+	while(pos < end && *pos != quote) pos++;
+	if(pos >= end) {
+		return FALSE;
+	}
+	*value_end = pos;
+	*attrs = pos + 1;
+	return TRUE;
+}
+
+/** Check whether the attribute is a namespace declaration */
+static APR_INLINE apt_bool_t nlsml_attr_is_xmlns(const char *name, apr_size_t length)
+{
+	return (length >= 5 && memcmp(name,"xmlns",5) == 0 && (length == 5 || name[5] == ':')) ? TRUE : FALSE;
+}
+
+/** Parse confidence value */
+static float nlsml_confidence_parse(const char *str)
+{
+	float confidence = (float) atof(str);
+	if(confidence > 1.0)
+		confidence /= 100;
+
+	return confidence;
+}
+
+/** Check whether the text consists of white space only */
+static apt_bool_t nlsml_text_is_blank(const char *buf, apr_size_t length)
+{
+	const char *end = buf + length;
+	for(; buf < end; buf++) {
+		if(nlsml_is_space(*buf) == FALSE) {
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+/** Read the content of the element up to and including its end tag */
+static apt_bool_t nlsml_content_read(nlsml_reader_t *reader, const nlsml_tag_t *start_tag, apr_size_t depth, apt_bool_t swi_suppress, apt_str_t *content)
+{
+	nlsml_tag_t tag;
+	nlsml_tag_t end_tag;
+	const char *chunk = reader->pos;
+	const char *literal = NULL;
+	const char *literal_end = NULL;
+	const char *inner;
+	apt_bool_t markup = FALSE;
+	char *buf = reader->out;
+	apr_size_t length;
+
+	if(start_tag->type != NLSML_TAG_EMPTY) {
+		for(;;) {
+			if(nlsml_tag_next(reader,&tag) == FALSE || tag.type == NLSML_TAG_NONE) {
+				return FALSE;
+			}
+			if(tag.type == NLSML_TAG_END) {
+				if(nlsml_tag_end_check(start_tag,&tag) == FALSE) {
+					return FALSE;
+				}
+				break;
+			}
+
+			if(swi_suppress == TRUE &&
+				(nlsml_name_compare(tag.name,tag.name_length,"SWI_literal") == TRUE ||
+				nlsml_name_compare(tag.name,tag.name_length,"SWI_meaning") == TRUE)) {
+				/* copy the content preceding the suppressed element */
+				inner = reader->pos;
+				nlsml_span_append(reader,chunk,tag.begin);
+				if(nlsml_element_skip(reader,&tag,depth + 1,&end_tag) == FALSE) {
+					return FALSE;
+				}
+				if(tag.type == NLSML_TAG_START && nlsml_name_compare(tag.name,tag.name_length,"SWI_literal") == TRUE) {
+					literal = inner;
+					literal_end = end_tag.begin;
+				}
+				chunk = reader->pos;
+				continue;
+			}
+
+			/* the inner markup is kept as is */
+			markup = TRUE;
+			if(nlsml_element_skip(reader,&tag,depth + 1,NULL) == FALSE) {
+				return FALSE;
+			}
+		}
+		nlsml_span_append(reader,chunk,tag.begin);
+	}
+
+	length = nlsml_line_ends_normalize(buf,reader->out - buf);
+	if(markup == FALSE) {
+		length = nlsml_text_decode(buf,length);
+		if(literal && nlsml_text_is_blank(buf,length) == TRUE) {
+			/* nothing but the suppressed elements, the literal stands for the content */
+			reader->out = buf;
+			nlsml_span_append(reader,literal,literal_end);
+			length = nlsml_line_ends_normalize(buf,reader->out - buf);
+			length = nlsml_text_decode(buf,length);
+		}
+	}
+	buf[length] = '\0';
+	reader->out = buf + length + 1;
+
+	content->buf = buf;
+	content->length = length;
+	return TRUE;
+}
+
+/** Read <input> element */
+static apt_bool_t nlsml_input_read(nlsml_reader_t *reader, const nlsml_tag_t *start_tag, nlsml_flat_interpretation_t *interpretation)
+{
+	const char *attrs = start_tag->attrs;
+	const char *name;
+	apr_size_t name_length;
+	const char *value;
+	const char *value_end;
+
+	interpretation->input_mode = "speech";
+	interpretation->input_confidence = 1.0;
+	while(nlsml_attr_next(&attrs,start_tag->attrs_end,&name,&name_length,&value,&value_end) == TRUE) {
+		if(nlsml_name_compare(name,name_length,"mode") == TRUE) {
+			interpretation->input_mode = nlsml_text_copy(reader,value,value_end);
+		}
+		else if(nlsml_name_compare(name,name_length,"confidence") == TRUE) {
+			interpretation->input_confidence = nlsml_confidence_parse(nlsml_text_copy(reader,value,value_end));
+		}
+		else if(nlsml_name_compare(name,name_length,"timestamp-start") == TRUE) {
+			interpretation->input_timestamp_start = nlsml_text_copy(reader,value,value_end);
+		}
+		else if(nlsml_name_compare(name,name_length,"timestamp-end") == TRUE) {
+			interpretation->input_timestamp_end = nlsml_text_copy(reader,value,value_end);
+		}
+		else if(nlsml_attr_is_xmlns(name,name_length) == FALSE) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unknown attribute '%.*s' for <input>",(int)name_length,name);
+		}
+	}
+
+	return nlsml_content_read(reader,start_tag,3,FALSE,&interpretation->input);
+}
+
+/** Read <interpretation> element */
+static apt_bool_t nlsml_interpretation_read(nlsml_reader_t *reader, const nlsml_tag_t *start_tag)
+{
+	nlsml_tag_t tag;
+	apt_str_t *instance;
+	const char *attrs = start_tag->attrs;
+	const char *name;
+	apr_size_t name_length;
+	const char *value;
+	const char *value_end;
+
+	/* Initialize interpretation */
+	nlsml_flat_interpretation_t *interpretation = apr_array_push(reader->interpretations);
+	interpretation->grammar = NULL;
+	interpretation->confidence = 1.0;
+	interpretation->instances = NULL;
+	interpretation->instance_count = 0;
+	apt_string_reset(&interpretation->input);
+	interpretation->input_mode = NULL;
+	interpretation->input_confidence = 1.0;
+	interpretation->input_timestamp_start = NULL;
+	interpretation->input_timestamp_end = NULL;
+
+	/* Find optional grammar and confidence attributes */
+	while(nlsml_attr_next(&attrs,start_tag->attrs_end,&name,&name_length,&value,&value_end) == TRUE) {
+		if(nlsml_name_compare(name,name_length,"grammar") == TRUE) {
+			interpretation->grammar = nlsml_text_copy(reader,value,value_end);
+		}
+		else if(nlsml_name_compare(name,name_length,"confidence") == TRUE) {
+			interpretation->confidence = nlsml_confidence_parse(nlsml_text_copy(reader,value,value_end));
+		}
+		else if(nlsml_attr_is_xmlns(name,name_length) == FALSE) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unknown attribute '%.*s' for <interpretation>",(int)name_length,name);
+		}
+	}
+	if(start_tag->type == NLSML_TAG_EMPTY) {
+		return TRUE;
+	}
+
+	/* Find input and instance elements */
+	for(;;) {
+		if(nlsml_tag_next(reader,&tag) == FALSE || tag.type == NLSML_TAG_NONE) {
+			return FALSE;
+		}
+		if(tag.type == NLSML_TAG_END) {
+			return nlsml_tag_end_check(start_tag,&tag);
+		}
+
+		if(nlsml_name_compare(tag.name,tag.name_length,"instance") == TRUE) {
+			instance = apr_array_push(reader->instances);
+			if(nlsml_content_read(reader,&tag,3,TRUE,instance) == FALSE) {
+				return FALSE;
+			}
+			interpretation->instance_count++;
+		}
+		else if(nlsml_name_compare(tag.name,tag.name_length,"input") == TRUE) {
+			if(nlsml_input_read(reader,&tag,interpretation) == FALSE) {
+				return FALSE;
+			}
+		}
+		else {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unknown child element <%.*s> for <interpretation>",(int)tag.name_length,tag.name);
+			if(nlsml_element_skip(reader,&tag,3,NULL) == FALSE) {
+				return FALSE;
+			}
+		}
+	}
+}
+
+/** Read <result> element */
+static apt_bool_t nlsml_result_element_read(nlsml_reader_t *reader, const nlsml_tag_t *start_tag, nlsml_flat_result_t *result)
+{
+	nlsml_tag_t tag;
+	const char *attrs = start_tag->attrs;
+	const char *name;
+	apr_size_t name_length;
+	const char *value;
+	const char *value_end;
+
+	/* Find optional grammar attribute */
+	while(nlsml_attr_next(&attrs,start_tag->attrs_end,&name,&name_length,&value,&value_end) == TRUE) {
+		if(nlsml_name_compare(name,name_length,"grammar") == TRUE) {
+			result->grammar = nlsml_text_copy(reader,value,value_end);
+		}
+		else if(nlsml_attr_is_xmlns(name,name_length) == FALSE) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unknown attribute '%.*s' for <result>",(int)name_length,name);
+		}
+	}
+	if(start_tag->type == NLSML_TAG_EMPTY) {
+		return TRUE;
+	}
+
+	/* Find interpretation, enrollment-result, or verification-result elements */
+	for(;;) {
+		if(nlsml_tag_next(reader,&tag) == FALSE || tag.type == NLSML_TAG_NONE) {
+			return FALSE;
+		}
+		if(tag.type == NLSML_TAG_END) {
+			return nlsml_tag_end_check(start_tag,&tag);
+		}
+
+		if(nlsml_name_compare(tag.name,tag.name_length,"interpretation") == TRUE) {
+			if(nlsml_interpretation_read(reader,&tag) == FALSE) {
+				return FALSE;
+			}
+			continue;
+		}
+
+		if(nlsml_name_compare(tag.name,tag.name_length,"enrollment-result") == TRUE) {
+			result->enrollment_result_count++;
+		}
+		else if(nlsml_name_compare(tag.name,tag.name_length,"verification-result") == TRUE) {
+			result->verification_result_count++;
+		}
+		else {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unknown child element <%.*s> for <result>",(int)tag.name_length,tag.name);
+		}
+		if(nlsml_element_skip(reader,&tag,2,NULL) == FALSE) {
+			return FALSE;
+		}
+	}
+}
+
+/** Read NLSML result */
+APT_DECLARE(nlsml_flat_result_t*) nlsml_flat_result_read(const char *data, apr_size_t length, apr_pool_t *pool)
+{
+	nlsml_reader_t reader;
+	nlsml_tag_t tag;
+	nlsml_flat_result_t *result;
+	nlsml_flat_interpretation_t *interpretation;
+	apt_str_t *instances;
+	apr_size_t i;
+
+	if(!data || !length) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"No NLSML data available");
+		return NULL;
+	}
+
+	/* the strings read never exceed the document, each one is terminated
+	   in place of the delimiter following it */
+	reader.pos = data;
+	reader.end = data + length;
+	reader.out = apr_palloc(pool,length + 1);
+	reader.interpretations = apr_array_make(pool,2,sizeof(nlsml_flat_interpretation_t));
+	reader.instances = apr_array_make(pool,2,sizeof(apt_str_t));
+
+	/* Initialize result */
+	result = apr_palloc(pool,sizeof(nlsml_flat_result_t));
+	result->grammar = NULL;
+	result->interpretations = NULL;
+	result->interpretation_count = 0;
+	result->enrollment_result_count = 0;
+	result->verification_result_count = 0;
+
+	if(nlsml_tag_next(&reader,&tag) == FALSE || tag.type == NLSML_TAG_NONE || tag.type == NLSML_TAG_END) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"No NLSML root element");
+		return NULL;
+	}
+
+	/* NLSML validity check: root element must be <result> */
+	if(nlsml_name_compare(tag.name,tag.name_length,"result") == FALSE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unexpected NLSML root element <%.*s>",(int)tag.name_length,tag.name);
+		return NULL;
+	}
+
+	if(nlsml_result_element_read(&reader,&tag,result) == FALSE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Read NLSML Result at offset [%"APR_SIZE_T_FMT"]",
+			(apr_size_t)(reader.pos - data));
+		return NULL;
+	}
+
+	/* the instances of the interpretations follow each other in document order */
+	instances = (apt_str_t*)reader.instances->elts;
+	interpretation = (nlsml_flat_interpretation_t*)reader.interpretations->elts;
+	for(i=0; i<(apr_size_t)reader.interpretations->nelts; i++) {
+		if(interpretation[i].instance_count) {
+			interpretation[i].instances = instances;
+			instances += interpretation[i].instance_count;
+		}
+	}
+	result->interpretations = interpretation;
+	result->interpretation_count = reader.interpretations->nelts;
+
+	if(!result->interpretation_count && !result->enrollment_result_count && !result->verification_result_count) {
+		/* at least one of <interpretation>, <enrollment-result>, <verification-result> MUST be specified */
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Invalid NLSML document: at least one child element MUST be specified for <result>");
+	}
+	return result;
+}
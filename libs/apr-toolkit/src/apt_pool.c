@@ -14,22 +14,56 @@
  * limitations under the License.
  */
 
+#include <stdlib.h>
+#include <apr_atomic.h>
+#include <apr_thread_proc.h>
+#include <apr_thread_mutex.h>
 #include "apt_pool.h"
 #include "apt_log.h"
 
 #define OWN_ALLOCATOR_PER_POOL
 
+/** Key of the user data marking the root pools of the arena cache */
+#define APT_POOL_ARENA_KEY "apt_pool_arena"
+
+typedef struct apt_pool_cache_t apt_pool_cache_t;
+typedef struct apt_pool_cache_list_t apt_pool_cache_list_t;
+
+/** Per-thread list of idle arenas, accessed by the owner thread only */
+struct apt_pool_cache_list_t {
+	apt_pool_cache_list_t    *next;
+	volatile apr_uint32_t     in_use;   /* whether the list is owned by a thread */
+	apr_size_t                count;
+	apr_pool_t              **arenas;
+};
+
+/** Cache of arenas (root pools with own allocators) to acquire short-lived pools from */
+struct apt_pool_cache_t {
+	apr_size_t                max_count;         /* max number of idle arenas in the shared list */
+	apr_size_t                thread_max_count;  /* max number of idle arenas in a per-thread list */
+	apr_size_t                max_free_size;     /* max size of free memory retained by an arena */
+
+	apr_pool_t              **arenas;            /* shared list of idle arenas */
+	apr_size_t                count;
+	apr_thread_mutex_t       *mutex;             /* guard of the shared list */
+
+	apt_pool_cache_list_t * volatile lists;      /* per-thread lists, never removed while the cache exists */
+	apr_threadkey_t          *key;
+	apr_pool_t               *pool;
+};
+
+static apt_pool_cache_t *pool_cache = NULL;
+
 static int apt_abort_fn(int retcode)
 {
 	apt_log(APT_LOG_MARK,APT_PRIO_CRITICAL,"APR Abort Called [%d]", retcode);
 	return 0;
 }
 
-APT_DECLARE(apr_pool_t*) apt_pool_create()
+/** Create a root pool with own allocator guarded by a mutex */
+static apr_pool_t* apt_pool_own_allocator_create(apr_size_t max_free_size)
 {
 	apr_pool_t *pool = NULL;
-
-#ifdef OWN_ALLOCATOR_PER_POOL
 	apr_allocator_t *allocator = NULL;
 	apr_thread_mutex_t *mutex = NULL;
 
@@ -39,8 +73,23 @@ APT_DECLARE(apr_pool_t*) apt_pool_create()
 			apr_thread_mutex_create(&mutex,APR_THREAD_MUTEX_NESTED,pool);
 			apr_allocator_mutex_set(allocator,mutex);
 			apr_pool_mutex_set(pool,mutex); 
+			if(max_free_size) {
+				apr_allocator_max_free_set(allocator,max_free_size);
+			}
+		}
+		else {
+			apr_allocator_destroy(allocator);
 		}
 	}
+	return pool;
+}
+
+APT_DECLARE(apr_pool_t*) apt_pool_create()
+{
+	apr_pool_t *pool = NULL;
+
+#ifdef OWN_ALLOCATOR_PER_POOL
+	pool = apt_pool_own_allocator_create(0);
 #else
 	apr_pool_create(&pool,NULL);
 #endif
@@ -53,3 +102,247 @@ APT_DECLARE(apr_pool_t*) apt_subpool_create(apr_pool_t *parent)
 	apr_pool_create(&pool,parent);
 	return pool;
 }
+
+/** Create an arena, which is marked to be recognized on release */
+static apr_pool_t* apt_pool_arena_create(apt_pool_cache_t *cache)
+{
+	apr_pool_t *arena = apt_pool_own_allocator_create(cache->max_free_size);
+	if(arena) {
+		apr_pool_userdata_setn(cache,APT_POOL_ARENA_KEY,NULL,arena);
+	}
+	return arena;
+}
+
+/** Release the list of the exiting thread to be taken over by another thread */
+static void apt_pool_cache_list_release(void *data)
+{
+	apt_pool_cache_list_t *list = data;
+	apr_atomic_set32(&list->in_use,FALSE);
+}
+
+static apt_pool_cache_list_t* apt_pool_cache_list_get(apt_pool_cache_t *cache)
+{
+	apt_pool_cache_list_t *list;
+	void *data = NULL;
+
+	if(!cache->thread_max_count) {
+		return NULL;
+	}
+
+	if(apr_threadkey_private_get(&data,cache->key) == APR_SUCCESS && data) {
+		return data;
+	}
+
+	/* take over a list released by an exited thread, if any */
+	for(list = cache->lists; list; list = list->next) {
+		if(apr_atomic_cas32(&list->in_use,TRUE,FALSE) == FALSE) {
+			break;
+		}
+	}
+
+	if(!list) {
+		/* allocate a new list, the thread may have no pool to use */
+		list = malloc(sizeof(apt_pool_cache_list_t));
+		if(!list) {
+			return NULL;
+		}
+		list->arenas = malloc(sizeof(apr_pool_t*) * cache->thread_max_count);
+		if(!list->arenas) {
+			free(list);
+			return NULL;
+		}
+		list->in_use = TRUE;
+		list->count = 0;
+
+		do {
+			list->next = cache->lists;
+		}
+		while(apr_atomic_casptr((volatile void**)&cache->lists,list,list->next) != list->next);
+	}
+
+	apr_threadkey_private_set(list,cache->key);
+	return list;
+}
+
+/** Take an idle arena, refilling the per-thread list from the shared one in a batch */
+static apr_pool_t* apt_pool_arena_take(apt_pool_cache_t *cache)
+{
+	apr_pool_t *arena = NULL;
+	apt_pool_cache_list_t *list = apt_pool_cache_list_get(cache);
+	if(list && list->count) {
+		return list->arenas[--list->count];
+	}
+
+	apr_thread_mutex_lock(cache->mutex);
+	if(cache->count) {
+		arena = cache->arenas[--cache->count];
+		if(list) {
+			apr_size_t batch = cache->thread_max_count / 2;
+			while(batch-- && cache->count) {
+				list->arenas[list->count++] = cache->arenas[--cache->count];
+			}
+		}
+	}
+	apr_thread_mutex_unlock(cache->mutex);
+	return arena;
+}
+
+/** Put an idle arena back, spilling the per-thread list to the shared one in a batch */
+static void apt_pool_arena_put(apt_pool_cache_t *cache, apr_pool_t *arena)
+{
+	apr_size_t batch;
+	apt_pool_cache_list_t *list = apt_pool_cache_list_get(cache);
+	if(list && list->count < cache->thread_max_count) {
+		list->arenas[list->count++] = arena;
+		return;
+	}
+
+	apr_thread_mutex_lock(cache->mutex);
+	if(list) {
+		batch = (cache->thread_max_count + 1) / 2;
+		while(batch-- && cache->count < cache->max_count) {
+			cache->arenas[cache->count++] = list->arenas[--list->count];
+		}
+		if(list->count < cache->thread_max_count) {
+			list->arenas[list->count++] = arena;
+			arena = NULL;
+		}
+	}
+	if(arena && cache->count < cache->max_count) {
+		cache->arenas[cache->count++] = arena;
+		arena = NULL;
+	}
+	apr_thread_mutex_unlock(cache->mutex);
+
+	if(arena) {
+		/* the retention limit is reached */
+		apr_pool_destroy(arena);
+	}
+}
+
+APT_DECLARE(apt_bool_t) apt_pool_cache_create(apr_size_t max_count, apr_size_t thread_max_count, apr_size_t preload_count, apr_size_t max_free_size)
+{
+	apt_pool_cache_t *cache;
+	apr_pool_t *pool;
+	apr_pool_t *arena;
+
+	if(pool_cache) {
+		return FALSE;
+	}
+
+	pool = apt_pool_create();
+	if(!pool) {
+		return FALSE;
+	}
+
+	cache = apr_palloc(pool,sizeof(apt_pool_cache_t));
+	cache->pool = pool;
+	cache->max_count = max_count;
+	cache->thread_max_count = thread_max_count;
+	cache->max_free_size = max_free_size;
+	cache->arenas = apr_palloc(pool,sizeof(apr_pool_t*) * (max_count ? max_count : 1));
+	cache->count = 0;
+	cache->lists = NULL;
+	cache->mutex = NULL;
+	cache->key = NULL;
+
+	if(apr_thread_mutex_create(&cache->mutex,APR_THREAD_MUTEX_DEFAULT,pool) != APR_SUCCESS ||
+		apr_threadkey_private_create(&cache->key,apt_pool_cache_list_release,pool) != APR_SUCCESS) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Create Pool Cache");
+		apr_pool_destroy(pool);
+		return FALSE;
+	}
+
+	/* create arenas in advance */
+	while(cache->count < preload_count && cache->count < max_count) {
+		arena = apt_pool_arena_create(cache);
+		if(!arena) {
+			break;
+		}
+		cache->arenas[cache->count++] = arena;
+	}
+
+	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Create Pool Cache [%"APR_SIZE_T_FMT"/%"APR_SIZE_T_FMT"] max-free [%"APR_SIZE_T_FMT"]",
+		cache->count,max_count,max_free_size);
+	pool_cache = cache;
+	return TRUE;
+}
+
+APT_DECLARE(apt_bool_t) apt_pool_cache_destroy(void)
+{
+	apt_pool_cache_t *cache = pool_cache;
+	apt_pool_cache_list_t *list;
+	if(!cache) {
+		return FALSE;
+	}
+	pool_cache = NULL;
+
+	while(cache->lists) {
+		list = cache->lists;
+		cache->lists = list->next;
+		while(list->count) {
+			apr_pool_destroy(list->arenas[--list->count]);
+		}
+		free(list->arenas);
+		free(list);
+	}
+	while(cache->count) {
+		apr_pool_destroy(cache->arenas[--cache->count]);
+	}
+
+	apr_threadkey_private_delete(cache->key);
+	apr_pool_destroy(cache->pool);
+	return TRUE;
+}
+
+APT_DECLARE(apr_pool_t*) apt_pool_acquire(void)
+{
+	apt_pool_cache_t *cache = pool_cache;
+	apr_pool_t *arena;
+	apr_pool_t *pool = NULL;
+	if(!cache) {
+		return apt_pool_create();
+	}
+
+	arena = apt_pool_arena_take(cache);
+	if(!arena) {
+		arena = apt_pool_arena_create(cache);
+		if(!arena) {
+			return NULL;
+		}
+	}
+
+	/* the pool takes its memory from the free blocks retained by the arena allocator */
+	if(apr_pool_create_ex(&pool,arena,apt_abort_fn,NULL) != APR_SUCCESS) {
+		apt_pool_arena_put(cache,arena);
+		return NULL;
+	}
+	return pool;
+}
+
+APT_DECLARE(void) apt_pool_release(apr_pool_t *pool)
+{
+	apt_pool_cache_t *cache;
+	apr_pool_t *arena;
+	void *data = NULL;
+	if(!pool) {
+		return;
+	}
+
+	arena = apr_pool_parent_get(pool);
+	if(!arena || apr_pool_userdata_get(&data,APT_POOL_ARENA_KEY,arena) != APR_SUCCESS || !data) {
+		/* not acquired from the cache */
+		apr_pool_destroy(pool);
+		return;
+	}
+
+	apr_pool_destroy(pool);
+
+	cache = pool_cache;
+	if(!cache || cache != data) {
+		/* the cache the arena belongs to no longer exists */
+		apr_pool_destroy(arena);
+		return;
+	}
+	apt_pool_arena_put(cache,arena);
+}
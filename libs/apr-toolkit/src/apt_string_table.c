@@ -64,3 +64,26 @@ APT_DECLARE(apr_size_t) apt_string_table_id_find(const apt_str_table_item_t tabl
 	/* no match found, return invalid id */
 	return size;
 }
+
+/* Find the id associated with a given string by means of the perfect hash of the table */
+APT_DECLARE(apr_size_t) apt_string_table_hash_id_find(const apt_str_table_item_t table[], apr_size_t size, const apt_str_table_hash_t *hash, const apt_str_t *value)
+{
+	apr_uint32_t h;
+	apr_size_t id;
+	if(!hash || size < 4) {
+		/* a few items are scanned faster than a string is hashed */
+		return apt_string_table_id_find(table,size,value);
+	}
+	if(!size || !value->length) {
+		return size;
+	}
+
+	/* the only candidate is compared, no matter how many items the table has */
+	h = apt_string_table_hash_calc(value);
+	id = hash->ids[apt_string_table_hash_slot(h,hash->seeds[apt_string_table_hash_bucket(h,hash->bucket_count)],size)];
+	if(id < size && apt_string_compare(&table[id].value,value) == TRUE) {
+		return id;
+	}
+	/* no match found, return invalid id */
+	return size;
+}
@@ -381,6 +381,34 @@ static apt_message_status_e apt_message_generator_break(apt_message_generator_t
 	return APT_MESSAGE_STATUS_INVALID;
 }
 
+/** Generate start-line and header section */
+static apt_message_status_e apt_message_header_generate(apt_message_generator_t *generator, apt_text_stream_t *stream)
+{
+	/* generate start-line */
+	if(generator->vtable->on_start(generator,&generator->context,stream) == FALSE) {
+		return apt_message_generator_break(generator,stream);
+	}
+
+	if(!generator->context.header || !generator->context.body) {
+		return APT_MESSAGE_STATUS_INVALID;
+	}
+
+	/* generate header */
+	if(apt_header_section_generate(generator->context.header,stream) == FALSE) {
+		return apt_message_generator_break(generator,stream);
+	}
+
+	if(generator->vtable->on_header_complete) {
+		generator->vtable->on_header_complete(generator,&generator->context,stream);
+	}
+	if(generator->verbose == TRUE) {
+		apr_size_t length = stream->pos - stream->text.buf;
+		apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Generated Message Header [%"APR_SIZE_T_FMT" bytes]\n%.*s",
+				length, length, stream->text.buf);
+	}
+	return APT_MESSAGE_STATUS_COMPLETE;
+}
+
 /** Generate message */
 APT_DECLARE(apt_message_status_e) apt_message_generator_run(apt_message_generator_t *generator, void *message, apt_text_stream_t *stream)
 {
@@ -396,27 +424,9 @@ APT_DECLARE(apt_message_status_e) apt_message_generator_run(apt_message_generato
 	}
 
 	if(generator->stage == APT_MESSAGE_STAGE_START_LINE) {
-		/* generate start-line */
-		if(generator->vtable->on_start(generator,&generator->context,stream) == FALSE) {
-			return apt_message_generator_break(generator,stream);
-		}
-
-		if(!generator->context.header || !generator->context.body) {
-			return APT_MESSAGE_STATUS_INVALID;
-		}
-
-		/* generate header */
-		if(apt_header_section_generate(generator->context.header,stream) == FALSE) {
-			return apt_message_generator_break(generator,stream);
-		}
-
-		if(generator->vtable->on_header_complete) {
-			generator->vtable->on_header_complete(generator,&generator->context,stream);
-		}
-		if(generator->verbose == TRUE) {
-			apr_size_t length = stream->pos - stream->text.buf;
-			apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Generated Message Header [%"APR_SIZE_T_FMT" bytes]\n%.*s",
-					length, length, stream->text.buf);
+		apt_message_status_e status = apt_message_header_generate(generator,stream);
+		if(status != APT_MESSAGE_STATUS_COMPLETE) {
+			return status;
 		}
 
 		generator->stage = APT_MESSAGE_STAGE_START_LINE;
@@ -438,6 +448,34 @@ APT_DECLARE(apt_message_status_e) apt_message_generator_run(apt_message_generato
 	return APT_MESSAGE_STATUS_COMPLETE;
 }
 
+/** Generate message header only, the body is referenced in place */
+APT_DECLARE(apt_message_status_e) apt_message_generator_header_run(apt_message_generator_t *generator, void *message, apt_text_stream_t *stream, apt_str_t *body)
+{
+	apt_message_status_e status;
+	if(!message || !body) {
+		return APT_MESSAGE_STATUS_INVALID;
+	}
+
+	generator->stage = APT_MESSAGE_STAGE_START_LINE;
+	generator->context.message = message;
+	generator->context.header = NULL;
+	generator->context.body = NULL;
+
+	status = apt_message_header_generate(generator,stream);
+	if(status == APT_MESSAGE_STATUS_COMPLETE) {
+		*body = *generator->context.body;
+		if(generator->verbose == TRUE && body->length) {
+			apr_size_t length = body->length;
+			const char *masked_data = apt_log_data_mask(body->buf,&length,generator->pool);
+			apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Referenced Message Body [%"APR_SIZE_T_FMT" bytes]\n%.*s",
+					body->length, length, masked_data);
+		}
+	}
+	/* the next message, even the same one, is generated from the start-line */
+	generator->context.message = NULL;
+	return status;
+}
+
 /** Get external object associated with generator */
 APT_DECLARE(void*) apt_message_generator_object_get(apt_message_generator_t *generator)
 {
@@ -17,19 +17,58 @@
 #ifdef WIN32
 #pragma warning(disable: 4127)
 #endif
-#include <apr_ring.h> 
+#include <apr_ring.h>
 #include "apt_timer_queue.h"
 #include "apt_log.h"
 
+/*
+ * The timer queue is a hierarchical timing wheel with the resolution of 1 msec.
+ * The root wheel has a slot per each msec of the next 256 msec. Each of the 4 node
+ * wheels has 64 slots, a slot of the node wheel N spans 2^(8+6*N) msec. Together
+ * the wheels cover the whole 32-bit range of timeouts.
+ * A timer is placed into the slot of the lowest wheel, which covers its scheduled
+ * time. Whenever the root wheel turns around, the current slot of the next wheel
+ * is cascaded (the timers are placed again into the lower wheels) and so on.
+ * Set and kill are O(1), the cost of advance is O(1) per msec plus per elapsed timer.
+ */
+
+/** Number of bits of the root wheel */
+#define TIMER_ROOT_BITS   8
+/** Number of bits of a node wheel */
+#define TIMER_NODE_BITS   6
+/** Number of slots of the root wheel */
+#define TIMER_ROOT_SIZE   (1 << TIMER_ROOT_BITS)
+/** Number of slots of a node wheel */
+#define TIMER_NODE_SIZE   (1 << TIMER_NODE_BITS)
+#define TIMER_ROOT_MASK   (TIMER_ROOT_SIZE - 1)
+#define TIMER_NODE_MASK   (TIMER_NODE_SIZE - 1)
+/** Number of node wheels */
+#define TIMER_NODE_LEVELS 4
+
+/** Shift of the time value to get the slot index of the node wheel */
+#define TIMER_NODE_SHIFT(level) (TIMER_ROOT_BITS + (level) * TIMER_NODE_BITS)
+
+/** Slot of a wheel (list of timers) */
+APR_RING_HEAD(apt_timer_head_t, apt_timer_t);
+typedef struct apt_timer_head_t apt_timer_head_t;
+
 /** Timer queue */
 struct apt_timer_queue_t {
-	/** Ring head */
-	APR_RING_HEAD(apt_timer_head_t, apt_timer_t) head;
-
-	/** Elapsed time */
-	apr_uint32_t  elapsed_time;
-	/** Whether elapsed_time is reset or not */
-	apt_bool_t    reset;
+	/** Root wheel */
+	apt_timer_head_t root[TIMER_ROOT_SIZE];
+	/** Node wheels */
+	apt_timer_head_t nodes[TIMER_NODE_LEVELS][TIMER_NODE_SIZE];
+	/** Timers being elapsed */
+	apt_timer_head_t expired;
+
+	/** Elapsed time (all the slots up to this time are processed) */
+	apr_uint32_t     elapsed_time;
+	/** Time to advance to, timers set while advancing are scheduled relative to it */
+	apr_uint32_t     target_time;
+	/** Number of scheduled timers */
+	apr_size_t       count;
+	/** Whether the queue has just become empty or not */
+	apt_bool_t       reset;
 };
 
 /** Timer */
@@ -41,6 +80,8 @@ struct apt_timer_t {
 	apt_timer_queue_t   *queue;
 	/** Time next report is scheduled at */
 	apr_uint32_t         scheduled_time;
+	/** Whether the timer is scheduled or not */
+	apt_bool_t           scheduled;
 
 	/** Timer proc */
 	apt_timer_proc_f     proc;
@@ -48,16 +89,28 @@ struct apt_timer_t {
 	void                *obj;
 };
 
-static apt_bool_t apt_timer_insert(apt_timer_queue_t *timer_queue, apt_timer_t *timer);
+static void apt_timer_place(apt_timer_queue_t *timer_queue, apt_timer_t *timer);
 static apt_bool_t apt_timer_remove(apt_timer_queue_t *timer_queue, apt_timer_t *timer);
-static void apt_timers_reschedule(apt_timer_queue_t *timer_queue);
+static apr_uint32_t apt_timers_cascade(apt_timer_queue_t *timer_queue, int level);
 
 /** Create timer queue */
 APT_DECLARE(apt_timer_queue_t*) apt_timer_queue_create(apr_pool_t *pool)
 {
+	int i;
+	int level;
 	apt_timer_queue_t *timer_queue = apr_palloc(pool,sizeof(apt_timer_queue_t));
-	APR_RING_INIT(&timer_queue->head, apt_timer_t, link);
+	for(i=0; i<TIMER_ROOT_SIZE; i++) {
+		APR_RING_INIT(&timer_queue->root[i], apt_timer_t, link);
+	}
+	for(level=0; level<TIMER_NODE_LEVELS; level++) {
+		for(i=0; i<TIMER_NODE_SIZE; i++) {
+			APR_RING_INIT(&timer_queue->nodes[level][i], apt_timer_t, link);
+		}
+	}
+	APR_RING_INIT(&timer_queue->expired, apt_timer_t, link);
 	timer_queue->elapsed_time = 0;
+	timer_queue->target_time = 0;
+	timer_queue->count = 0;
 	timer_queue->reset = FALSE;
 	return timer_queue;
 }
@@ -71,59 +124,91 @@ APT_DECLARE(void) apt_timer_queue_destroy(apt_timer_queue_t *timer_queue)
 /** Advance scheduled timers */
 APT_DECLARE(void) apt_timer_queue_advance(apt_timer_queue_t *timer_queue, apr_uint32_t elapsed_time)
 {
+	apt_timer_head_t *expired = &timer_queue->expired;
+	/* the ring of the elapsed timers is only accessed through its sentinel element in the loop below */
+	apt_timer_t *sentinel = APR_RING_SENTINEL(expired, apt_timer_t, link);
+	apt_timer_head_t *slot;
 	apt_timer_t *timer;
+	apr_uint32_t index;
+	int level;
 
-	if(APR_RING_EMPTY(&timer_queue->head, apt_timer_t, link)) {
+	if(!timer_queue->count) {
 		/* just return, nothing to do */
 		return;
 	}
 
 	if(timer_queue->reset == TRUE) {
-		/* elapsed_time has just been reset, do not advance */
+		/* the queue has just become empty, do not advance */
 		return;
 	}
 
-	/* increment elapsed time */
-	timer_queue->elapsed_time += elapsed_time;
-	if(timer_queue->elapsed_time >= 0xFFFF) {
-#ifdef APT_TIMER_DEBUG
-		apt_log(APT_LOG_MARK,APT_PRIO_DEBUG,"Reschedule Timers [%u]",timer_queue->elapsed_time);
-#endif
-		apt_timers_reschedule(timer_queue);
-	}
-
-	/* process timers */
-	do {
-		/* get first node (timer) */
-		timer = APR_RING_FIRST(&timer_queue->head);
+	timer_queue->target_time = timer_queue->elapsed_time + elapsed_time;
+	while(timer_queue->elapsed_time != timer_queue->target_time && timer_queue->count) {
+		index = (timer_queue->elapsed_time + 1) & TIMER_ROOT_MASK;
+		if(!index) {
+			/* the root wheel turns around, cascade the node wheels as long as they turn around too */
+			for(level=0; level<TIMER_NODE_LEVELS; level++) {
+				if(apt_timers_cascade(timer_queue,level) != 0) {
+					break;
+				}
+			}
+		}
 
-		if(timer->scheduled_time > timer_queue->elapsed_time) {
-			/* scheduled time is not elapsed yet */
-			break;
+		timer_queue->elapsed_time++;
+		slot = &timer_queue->root[index];
+		if(APR_RING_EMPTY(slot, apt_timer_t, link)) {
+			continue;
 		}
 
+		/* process the elapsed timers, the procs may set and kill any timers */
+		APR_RING_CONCAT(expired, slot, apt_timer_t, link);
+		while((timer = APR_RING_NEXT(sentinel, link)) != sentinel) {
 #ifdef APT_TIMER_DEBUG
-		apt_log(APT_LOG_MARK,APT_PRIO_DEBUG,"Timer Elapsed 0x%x [%u]",timer,timer->scheduled_time);
+			apt_log(APT_LOG_MARK,APT_PRIO_DEBUG,"Timer Elapsed 0x%x [%u]",timer,timer->scheduled_time);
 #endif
-		/* remove the elapsed timer from the list */
-		APR_RING_REMOVE(timer, link);
-		timer->scheduled_time = 0;
-		/* process the elapsed timer */
-		timer->proc(timer,timer->obj);
+			APR_RING_REMOVE(timer, link);
+			timer->scheduled = FALSE;
+			timer_queue->count--;
+			timer->proc(timer,timer->obj);
+		}
+	}
+
+	if(!timer_queue->count) {
+		/* no timers left, skip the rest of the elapsed time */
+		timer_queue->elapsed_time = timer_queue->target_time;
 	}
-	while(!APR_RING_EMPTY(&timer_queue->head, apt_timer_t, link));
 }
 
 /** Is timer queue empty */
 APT_DECLARE(apt_bool_t) apt_timer_queue_is_empty(const apt_timer_queue_t *timer_queue)
 {
-	return APR_RING_EMPTY(&timer_queue->head, apt_timer_t, link) ? TRUE : FALSE;
+	return timer_queue->count ? FALSE : TRUE;
+}
+
+/** Get the nearest scheduled time of the timers in the slot, relative to base_time */
+static apr_uint32_t apt_timer_slot_nearest_get(apt_timer_head_t *slot, apr_uint32_t base_time)
+{
+	apt_timer_t *timer;
+	apr_uint32_t nearest = 0xFFFFFFFF;
+	for(timer = APR_RING_FIRST(slot);
+			timer != APR_RING_SENTINEL(slot, apt_timer_t, link);
+				timer = APR_RING_NEXT(timer, link)) {
+		if(timer->scheduled_time - base_time < nearest) {
+			nearest = timer->scheduled_time - base_time;
+		}
+	}
+	return nearest;
 }
 
 /** Get current timeout */
 APT_DECLARE(apt_bool_t) apt_timer_queue_timeout_get(apt_timer_queue_t *timer_queue, apr_uint32_t *timeout)
 {
-	apt_timer_t *timer;
+	apr_uint32_t base_time;
+	apr_uint32_t nearest = 0xFFFFFFFF;
+	apr_uint32_t candidate;
+	apr_uint32_t index;
+	apr_uint32_t i;
+	int level;
 
 	/* clear reset flag, if set */
 	if(timer_queue->reset == TRUE) {
@@ -131,17 +216,45 @@ APT_DECLARE(apt_bool_t) apt_timer_queue_timeout_get(apt_timer_queue_t *timer_que
 	}
 
 	/* is queue empty */
-	if(APR_RING_EMPTY(&timer_queue->head, apt_timer_t, link)) {
+	if(!timer_queue->count) {
 		return FALSE;
 	}
 
-	/* get first node (timer) */
-	timer = APR_RING_FIRST(&timer_queue->head);
-	if(!timer) {
-		return FALSE;
+	/* the first non-empty slot of the root wheel is the nearest one, if it is before the root wheel turns around */
+	base_time = timer_queue->elapsed_time + 1;
+	index = base_time & TIMER_ROOT_MASK;
+	for(i=0; i<TIMER_ROOT_SIZE; i++) {
+		if(!APR_RING_EMPTY(&timer_queue->root[(index + i) & TIMER_ROOT_MASK], apt_timer_t, link)) {
+			nearest = i;
+			break;
+		}
 	}
 
-	*timeout = timer->scheduled_time - timer_queue->elapsed_time;
+	if(index == 0 || nearest >= TIMER_ROOT_SIZE - index) {
+		/* otherwise, look for the first non-empty slot of each node wheel;
+		the current slot holds either the timers to be cascaded next or the farthest ones */
+		for(level=0; level<TIMER_NODE_LEVELS; level++) {
+			apt_timer_head_t *slots = timer_queue->nodes[level];
+			index = (base_time >> TIMER_NODE_SHIFT(level)) & TIMER_NODE_MASK;
+			if(!APR_RING_EMPTY(&slots[index], apt_timer_t, link)) {
+				candidate = apt_timer_slot_nearest_get(&slots[index],base_time);
+				if(candidate < nearest) {
+					nearest = candidate;
+				}
+			}
+			for(i=1; i<TIMER_NODE_SIZE; i++) {
+				if(!APR_RING_EMPTY(&slots[(index + i) & TIMER_NODE_MASK], apt_timer_t, link)) {
+					candidate = apt_timer_slot_nearest_get(&slots[(index + i) & TIMER_NODE_MASK],base_time);
+					if(candidate < nearest) {
+						nearest = candidate;
+					}
+					break;
+				}
+			}
+		}
+	}
+
+	*timeout = nearest + 1;
 	return TRUE;
 }
 
@@ -152,6 +265,7 @@ APT_DECLARE(apt_timer_t*) apt_timer_create(apt_timer_queue_t *timer_queue, apt_t
 	APR_RING_ELEM_INIT(timer,link);
 	timer->queue = timer_queue;
 	timer->scheduled_time = 0;
+	timer->scheduled = FALSE;
 	timer->proc = proc;
 	timer->obj = obj;
 	return timer;
@@ -166,29 +280,26 @@ APT_DECLARE(apt_bool_t) apt_timer_set(apt_timer_t *timer, apr_uint32_t timeout)
 		return FALSE;
 	}
 
-	if(timer->scheduled_time) {
+	if(timer->scheduled == TRUE) {
 		/* remove timer first */
 		apt_timer_remove(queue,timer);
 	}
 
 	/* calculate time to elapse */
-	timer->scheduled_time = queue->elapsed_time + timeout;
+	timer->scheduled_time = queue->target_time + timeout;
+	timer->scheduled = TRUE;
 #ifdef APT_TIMER_DEBUG
 	apt_log(APT_LOG_MARK,APT_PRIO_DEBUG,"Set Timer 0x%x [%u]",timer,timer->scheduled_time);
 #endif
-	if(APR_RING_EMPTY(&queue->head, apt_timer_t, link)) {
-		APR_RING_INSERT_TAIL(&queue->head,timer,apt_timer_t,link);
-		return TRUE;
-	}
-
-	/* insert new node (timer) to sorted by scheduled time list */
-	return apt_timer_insert(queue,timer);
+	apt_timer_place(queue,timer);
+	queue->count++;
+	return TRUE;
 }
 
 /** Kill timer */
 APT_DECLARE(apt_bool_t) apt_timer_kill(apt_timer_t *timer)
 {
-	if(!timer->scheduled_time) {
+	if(timer->scheduled == FALSE) {
 		return FALSE;
 	}
 
@@ -198,47 +309,61 @@ APT_DECLARE(apt_bool_t) apt_timer_kill(apt_timer_t *timer)
 	return apt_timer_remove(timer->queue,timer);
 }
 
-static apt_bool_t apt_timer_insert(apt_timer_queue_t *timer_queue, apt_timer_t *timer)
+/** Place timer into the slot of the lowest wheel, which covers its scheduled time */
+static void apt_timer_place(apt_timer_queue_t *timer_queue, apt_timer_t *timer)
 {
-	apt_timer_t *it;
-	for(it = APR_RING_LAST(&timer_queue->head);
-			it != APR_RING_SENTINEL(&timer_queue->head, apt_timer_t, link);
-				it = APR_RING_PREV(it, link)) {
-		
-		if(it->scheduled_time <= timer->scheduled_time) {
-			APR_RING_INSERT_AFTER(it,timer,link);
-			return TRUE;
+	apt_timer_head_t *slot;
+	/* time left to the scheduled time, relative to the next slot to process */
+	apr_uint32_t time_left = timer->scheduled_time - (timer_queue->elapsed_time + 1);
+	int level;
+
+	if(time_left < TIMER_ROOT_SIZE) {
+		slot = &timer_queue->root[timer->scheduled_time & TIMER_ROOT_MASK];
+	}
+	else {
+		for(level=0; level<TIMER_NODE_LEVELS-1; level++) {
+			if(time_left < (apr_uint32_t)1 << TIMER_NODE_SHIFT(level+1)) {
+				break;
+			}
 		}
+		slot = &timer_queue->nodes[level][(timer->scheduled_time >> TIMER_NODE_SHIFT(level)) & TIMER_NODE_MASK];
 	}
-	APR_RING_INSERT_HEAD(&timer_queue->head,timer,apt_timer_t,link);
-	return TRUE;
+	APR_RING_INSERT_TAIL(slot,timer,apt_timer_t,link);
 }
 
 static apt_bool_t apt_timer_remove(apt_timer_queue_t *timer_queue, apt_timer_t *timer)
 {
-	/* remove node (timer) from the list */
+	/* remove node (timer) from the slot */
 	APR_RING_REMOVE(timer,link);
-	timer->scheduled_time = 0;
+	timer->scheduled = FALSE;
+	timer_queue->count--;
 
-	if(APR_RING_EMPTY(&timer_queue->head, apt_timer_t, link)) {
-		/* reset elapsed time if no timers set */
-		timer_queue->elapsed_time = 0;
-		/* set reset flag */
+	if(!timer_queue->count) {
+		/* set reset flag if no timers set */
 		timer_queue->reset = TRUE;
 	}
 	return TRUE;
 }
 
-static void apt_timers_reschedule(apt_timer_queue_t *timer_queue)
+/** Place the timers of the current slot of the node wheel into the lower wheels, return the slot index */
+static apr_uint32_t apt_timers_cascade(apt_timer_queue_t *timer_queue, int level)
 {
-	apt_timer_t *it;
-	for(it = APR_RING_LAST(&timer_queue->head);
-			it != APR_RING_SENTINEL(&timer_queue->head, apt_timer_t, link);
-				it = APR_RING_PREV(it, link)) {
-		if (it->scheduled_time > timer_queue->elapsed_time)
-			it->scheduled_time -= timer_queue->elapsed_time;
-		else
-			it->scheduled_time = 0;
+	apt_timer_t *timer;
+	apt_timer_t *next;
+	apr_uint32_t index = ((timer_queue->elapsed_time + 1) >> TIMER_NODE_SHIFT(level)) & TIMER_NODE_MASK;
+	apt_timer_head_t *slot = &timer_queue->nodes[level][index];
+	apt_timer_t *sentinel = APR_RING_SENTINEL(slot, apt_timer_t, link);
+
+	/* detach the timers from the slot, they always fall into the lower wheels */
+	timer = APR_RING_FIRST(slot);
+	APR_RING_INIT(slot, apt_timer_t, link);
+	while(timer != sentinel) {
+		next = APR_RING_NEXT(timer, link);
+#ifdef APT_TIMER_DEBUG
+		apt_log(APT_LOG_MARK,APT_PRIO_DEBUG,"Cascade Timer 0x%x [%d:%u]",timer,level,index);
+#endif
+		apt_timer_place(timer_queue,timer);
+		timer = next;
 	}
-	timer_queue->elapsed_time = 0;
+	return index;
 }
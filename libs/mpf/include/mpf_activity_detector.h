@@ -38,6 +38,12 @@ typedef enum {
 	MPF_DETECTOR_EVENT_NOINPUT     /**< noinput event occurred */
 } mpf_detector_event_e;
 
+/** Modes of activity detector */
+typedef enum {
+	MPF_DETECTOR_MODE_LEVEL,   /**< compare the level of each frame against the fixed threshold (default) */
+	MPF_DETECTOR_MODE_ADAPTIVE /**< also track the noise floor and take the zero-crossing rate into account */
+} mpf_detector_mode_e;
+
 
 /** Create activity detector */
 MPF_DECLARE(mpf_activity_detector_t*) mpf_activity_detector_create(apr_pool_t *pool);
@@ -45,6 +51,9 @@ MPF_DECLARE(mpf_activity_detector_t*) mpf_activity_detector_create(apr_pool_t *p
 /** Reset activity detector */
 MPF_DECLARE(void) mpf_activity_detector_reset(mpf_activity_detector_t *detector);
 
+/** Set detection mode */
+MPF_DECLARE(void) mpf_activity_detector_mode_set(mpf_activity_detector_t *detector, mpf_detector_mode_e mode);
+
 /** Set threshold of voice activity (silence) level */
 MPF_DECLARE(void) mpf_activity_detector_level_set(mpf_activity_detector_t *detector, apr_size_t level_threshold);
 
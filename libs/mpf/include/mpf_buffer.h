@@ -26,6 +26,9 @@
 
 APT_BEGIN_EXTERN_C
 
+/** Default size of the media chunks the audio is stored in */
+#define MPF_BUFFER_DEFAULT_CHUNK_SIZE 1024
+
 /** Opaque media buffer declaration */
 typedef struct mpf_buffer_t mpf_buffer_t;
 
@@ -33,6 +36,14 @@ typedef struct mpf_buffer_t mpf_buffer_t;
 /** Create buffer */
 mpf_buffer_t* mpf_buffer_create(apr_pool_t *pool);
 
+/**
+ * Create buffer with the specified chunk size and high-water mark.
+ * @param chunk_size the size of the recycled chunks the audio is stored in
+ * @param high_water_mark the size of buffered audio at which the buffer is considered full (0 - no limit)
+ * @param pool the pool to allocate memory from
+ */
+mpf_buffer_t* mpf_buffer_create_ex(apr_size_t chunk_size, apr_size_t high_water_mark, apr_pool_t *pool);
+
 /** Destroy buffer */
 void mpf_buffer_destroy(mpf_buffer_t *buffer);
 
@@ -51,6 +62,9 @@ apt_bool_t mpf_buffer_frame_read(mpf_buffer_t *buffer, mpf_frame_t *media_frame)
 /** Get size of buffer **/
 apr_size_t mpf_buffer_get_size(const mpf_buffer_t *buffer);
 
+/** Check whether the size of buffer reached the high-water mark, the producer should slow down then */
+apt_bool_t mpf_buffer_is_full(const mpf_buffer_t *buffer);
+
 APT_END_EXTERN_C
 
 #endif /* MPF_BUFFER_H */
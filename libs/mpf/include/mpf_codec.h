@@ -71,6 +71,8 @@ struct mpf_codec_vtable_t {
 
 	/** Virtual fill with silence method */
 	apt_bool_t (*fill)(mpf_codec_t *codec, mpf_codec_frame_t *frame_out);
+	/** Virtual conceal lost frame method (loss_count is 1 for the first frame lost in a row) */
+	apt_bool_t (*conceal)(mpf_codec_t *codec, const mpf_codec_frame_t *frame_in, apr_size_t loss_count, mpf_codec_frame_t *frame_out);
 
 	/** Virtual format matching method */
 	mpf_codec_format_match_f match_formats;
@@ -228,6 +230,56 @@ static APR_INLINE apt_bool_t mpf_codec_fill(mpf_codec_t *codec, mpf_codec_frame_
 	return rv;
 }
 
+/**
+ * Conceal lost codec frame.
+ * @param codec the codec
+ * @param frame_in the last received frame
+ * @param loss_count the number of the lost frame in a row (1, 2, ...)
+ * @param frame_out the frame to substitute the lost one with
+ * @return FALSE, if the codec provides no (further) concealment
+ */
+static APR_INLINE apt_bool_t mpf_codec_conceal(mpf_codec_t *codec, const mpf_codec_frame_t *frame_in, apr_size_t loss_count, mpf_codec_frame_t *frame_out)
+{
+	if(codec->vtable->conceal) {
+		return codec->vtable->conceal(codec,frame_in,loss_count,frame_out);
+	}
+	return FALSE;
+}
+
+/** Number of frames lost in a row, the concealment fades out within, following the first (repeated) one */
+#define MPF_CODEC_CONCEAL_FADE_FRAMES 4
+
+/**
+ * Fade out linear samples repeated to conceal a lost frame.
+ * The first lost frame is repeated as is, the following ones fade out
+ * to silence within MPF_CODEC_CONCEAL_FADE_FRAMES frames.
+ * @param samples the samples to fade out in place
+ * @param count the number of samples
+ * @param offset the offset of the samples in the frame
+ * @param frame_samples the number of samples in the frame
+ * @param loss_count the number of the lost frame in a row (1, 2, ...)
+ * @return FALSE, if the concealment has already faded out
+ */
+static APR_INLINE apt_bool_t mpf_codec_linear_conceal(apr_int16_t *samples, apr_size_t count, apr_size_t offset, apr_size_t frame_samples, apr_size_t loss_count)
+{
+	apr_size_t i;
+	apr_int32_t total;
+	apr_int32_t pos;
+	if(!loss_count || loss_count > MPF_CODEC_CONCEAL_FADE_FRAMES + 1) {
+		return FALSE;
+	}
+	if(loss_count == 1) {
+		return TRUE;
+	}
+
+	total = (apr_int32_t)(MPF_CODEC_CONCEAL_FADE_FRAMES * frame_samples);
+	pos = (apr_int32_t)((loss_count - 2) * frame_samples + offset);
+	for(i=0; i<count; i++, pos++) {
+		samples[i] = (apr_int16_t)(samples[i] * (total - pos) / total);
+	}
+	return TRUE;
+}
+
 APT_END_EXTERN_C
 
 #endif /* MPF_CODEC_H */
@@ -44,6 +44,12 @@ MPF_DECLARE(void) mpf_context_factory_destroy(mpf_context_factory_t *factory);
  */
 MPF_DECLARE(apt_bool_t) mpf_context_factory_process(mpf_context_factory_t *factory);
 
+/**
+ * Get the number of contexts created in the scope of the factory and not destroyed yet.
+ * @param factory the factory to get the load of
+ */
+MPF_DECLARE(apr_size_t) mpf_context_factory_load_get(const mpf_context_factory_t *factory);
+
 /**
  * Create MPF context.
  * @param factory the factory context belongs to
@@ -71,6 +77,12 @@ MPF_DECLARE(apt_bool_t) mpf_context_destroy(mpf_context_t *context);
  */
 MPF_DECLARE(void*) mpf_context_object_get(const mpf_context_t *context);
 
+/**
+ * Get factory the context belongs to.
+ * @param context the context to get factory of
+ */
+MPF_DECLARE(mpf_context_factory_t*) mpf_context_factory_get(const mpf_context_t *context);
+
 /**
  * Add termination to context.
  * @param context the context to add termination to
@@ -110,6 +110,20 @@ MPF_DECLARE(void) mpf_dtmf_detector_get_frame(
 								struct mpf_dtmf_detector_t *detector,
 								const struct mpf_frame_t *frame);
 
+/**
+ * Detect DTMF digits in the frames of many detectors at once.
+ * The result is the same as of mpf_dtmf_detector_get_frame() called for
+ * every pair, but the in-band analysis of the detectors which get frames of
+ * the same length and sampling rate is done in parallel vector lanes.
+ * @param detectors The array of detectors, NULL entries are skipped.
+ * @param frames    The array of frames, one per detector.
+ * @param count     The number of detectors and frames.
+ */
+MPF_DECLARE(void) mpf_dtmf_detector_get_frames(
+								struct mpf_dtmf_detector_t **detectors,
+								const struct mpf_frame_t **frames,
+								apr_size_t count);
+
 /**
  * Free all resources associated with the detector.
  * @param detector  The detector.
@@ -37,6 +37,35 @@ typedef apt_task_msg_t mpf_task_msg_t;
  */
 MPF_DECLARE(mpf_engine_t*) mpf_engine_create(const char *id, apr_pool_t *pool);
 
+/**
+ * Create MPF engine with the specified number of media processing workers.
+ * @param id the identifier of the engine
+ * @param worker_count the number of workers (threads) to process media contexts by
+ * @param pool the pool to allocate memory from
+ * @remark Each worker runs its own scheduler and processes its own subset of
+ *         media contexts. A new context is assigned to the least loaded worker.
+ */
+MPF_DECLARE(mpf_engine_t*) mpf_engine_create_ex(const char *id, apr_size_t worker_count, apr_pool_t *pool);
+
+/**
+ * Enable event-driven RTP receive.
+ * @param engine the engine to enable RTP poller for
+ * @remark Each worker polls the RTP sockets of its own terminations once per tick
+ *         and reads packets only from the ready ones, instead of trying to read
+ *         every RTP socket in turn. Must be called before the engine is started.
+ */
+MPF_DECLARE(apt_bool_t) mpf_engine_rtp_poller_enable(mpf_engine_t *engine);
+
+/**
+ * Enable batched RTP transmit.
+ * @param engine the engine to enable RTP sender for
+ * @param batch_size the number of RTP packets of a stream sent by a single system call
+ * @remark RTP packets of each stream are held over several media ticks and sent
+ *         at once, which delays the first packet of a batch by up to (batch_size - 1)
+ *         packet times. Must be called before the engine is started.
+ */
+MPF_DECLARE(apt_bool_t) mpf_engine_rtp_sender_enable(mpf_engine_t *engine, apr_size_t batch_size);
+
 /**
  * Create MPF codec manager.
  * @param pool the pool to allocate memory from
@@ -157,6 +186,12 @@ MPF_DECLARE(apt_bool_t) mpf_engine_scheduler_rate_set(mpf_engine_t *engine, unsi
  */
 MPF_DECLARE(const char*) mpf_engine_id_get(const mpf_engine_t *engine);
 
+/**
+ * Get the number of media processing workers.
+ * @param engine the engine to get the number of workers of
+ */
+MPF_DECLARE(apr_size_t) mpf_engine_worker_count_get(const mpf_engine_t *engine);
+
 
 APT_END_EXTERN_C
 
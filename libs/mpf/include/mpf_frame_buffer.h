@@ -26,7 +26,7 @@
 
 APT_BEGIN_EXTERN_C
 
-/** Opaque frame buffer declaration */
+/** Opaque frame buffer declaration, wait-free for a single writer and a single reader thread */
 typedef struct mpf_frame_buffer_t mpf_frame_buffer_t;
 
 
@@ -39,9 +39,19 @@ void mpf_frame_buffer_destroy(mpf_frame_buffer_t *buffer);
 /** Restart frame buffer */
 apt_bool_t mpf_frame_buffer_restart(mpf_frame_buffer_t *buffer);
 
-/** Write frame to buffer */
+/** Write frame to buffer, the frame may consist of several frames of frame_size each */
 apt_bool_t mpf_frame_buffer_write(mpf_frame_buffer_t *buffer, const mpf_frame_t *frame);
 
+/**
+ * Acquire the next free frame slot to write to in place, returns NULL if the buffer is full.
+ * The codec frame of the slot points to frame_size bytes owned by the buffer.
+ * The frame is not visible to the reader until mpf_frame_buffer_frame_commit() is called.
+ */
+mpf_frame_t* mpf_frame_buffer_frame_acquire(mpf_frame_buffer_t *buffer);
+
+/** Commit the frame slot previously acquired */
+apt_bool_t mpf_frame_buffer_frame_commit(mpf_frame_buffer_t *buffer);
+
 /** Read frame from buffer */
 apt_bool_t mpf_frame_buffer_read(mpf_frame_buffer_t *buffer, mpf_frame_t *frame);
 
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MPF_G711_KERNEL_H
+#define MPF_G711_KERNEL_H
+
+/**
+ * @file mpf_g711_kernel.h
+ * @brief MPF G.711 Conversion Kernels
+ */
+
+#include "mpf_types.h"
+
+APT_BEGIN_EXTERN_C
+
+/** Enumeration of G.711 kernel types */
+typedef enum {
+	MPF_G711_KERNEL_SCALAR, /**< sample by sample conversion */
+	MPF_G711_KERNEL_LUT,    /**< table driven conversion (64K encode and 256 decode entries) */
+	MPF_G711_KERNEL_SSE2,   /**< SSE2 conversion (8 samples at once) */
+	MPF_G711_KERNEL_AVX2,   /**< AVX2 conversion (16 samples at once) */
+
+	MPF_G711_KERNEL_COUNT   /**< number of kernel types */
+} mpf_g711_kernel_type_e;
+
+/** Prototype of G.711 encoder */
+typedef void (*mpf_g711_encode_f)(const apr_int16_t *linear, apr_byte_t *encoded, apr_size_t count);
+/** Prototype of G.711 decoder */
+typedef void (*mpf_g711_decode_f)(const apr_byte_t *encoded, apr_int16_t *linear, apr_size_t count);
+
+/** G.711 kernel declaration */
+typedef struct mpf_g711_kernel_t mpf_g711_kernel_t;
+
+/** G.711 kernel */
+struct mpf_g711_kernel_t {
+	/** Informative name of the kernel */
+	const char       *name;
+	/** Linear to u-law encoder */
+	mpf_g711_encode_f ulaw_encode;
+	/** U-law to linear decoder */
+	mpf_g711_decode_f ulaw_decode;
+	/** Linear to A-law encoder */
+	mpf_g711_encode_f alaw_encode;
+	/** A-law to linear decoder */
+	mpf_g711_decode_f alaw_decode;
+};
+
+/**
+ * Get G.711 kernel by type.
+ * @param type the type of the kernel to get
+ * @return the kernel or NULL, if not supported by the build or CPU
+ */
+MPF_DECLARE(const mpf_g711_kernel_t*) mpf_g711_kernel_get(mpf_g711_kernel_type_e type);
+
+/**
+ * Get the fastest G.711 kernel supported by the CPU.
+ * @remark The selection is made on the first call, which is supposed
+ *         to be done on startup (codec creation).
+ */
+MPF_DECLARE(const mpf_g711_kernel_t*) mpf_g711_kernel_default_get(void);
+
+
+APT_END_EXTERN_C
+
+#endif /* MPF_G711_KERNEL_H */
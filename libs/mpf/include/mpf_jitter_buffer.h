@@ -58,6 +58,13 @@ jb_result_t mpf_jitter_buffer_event_write(mpf_jitter_buffer_t *jb, const mpf_nam
 /** Read media frame from jitter buffer */
 apt_bool_t mpf_jitter_buffer_read(mpf_jitter_buffer_t *jb, mpf_frame_t *media_frame);
 
+/**
+ * Read media frame from jitter buffer without copying audio data.
+ * The audio buffer of the frame is referred to the slot of the jitter buffer,
+ * which remains valid until the next write (the next media tick).
+ */
+apt_bool_t mpf_jitter_buffer_borrow(mpf_jitter_buffer_t *jb, mpf_frame_t *media_frame);
+
 /** Get current playout delay */
 apr_uint32_t mpf_jitter_buffer_playout_delay_get(const mpf_jitter_buffer_t *jb);
 
@@ -26,6 +26,14 @@
 
 APT_BEGIN_EXTERN_C
 
+/** Mixing modes */
+typedef enum {
+	/** sum up the sources and saturate the sum (default) */
+	MPF_MIXER_MODE_SATURATE,
+	/** sum up the sources and attenuate the mix whenever the sum exceeds the range of samples */
+	MPF_MIXER_MODE_NORMALIZE
+} mpf_mixer_mode_e;
+
 /**
  * Create audio stream mixer.
  * @param source_arr the array of audio sources
@@ -43,6 +51,25 @@ MPF_DECLARE(mpf_object_t*) mpf_mixer_create(
 								const char *name,
 								apr_pool_t *pool);
 
+/**
+ * Create audio stream mixer (advanced).
+ * @param source_arr the array of audio sources
+ * @param source_count the number of audio sources
+ * @param sink the audio sink
+ * @param codec_manager the codec manager
+ * @param mode the mixing mode
+ * @param name the informative name used for debugging
+ * @param pool the pool to allocate memory from
+ */
+MPF_DECLARE(mpf_object_t*) mpf_mixer_create_ex(
+								mpf_audio_stream_t **source_arr, 
+								apr_size_t source_count, 
+								mpf_audio_stream_t *sink, 
+								const mpf_codec_manager_t *codec_manager,
+								mpf_mixer_mode_e mode,
+								const char *name,
+								apr_pool_t *pool);
+
 
 APT_END_EXTERN_C
 
@@ -27,13 +27,23 @@
 APT_BEGIN_EXTERN_C
 
 /**
- * Create audio stream resampler.
+ * Create audio stream resampler placed after the source.
  * @param source the source stream to resample
  * @param sink the sink stream to resample to
  * @param pool the pool to allocate memory from
+ * @remark Linear PCM at 8, 16, 32 and 48 kHz is supported.
  */
 MPF_DECLARE(mpf_audio_stream_t*) mpf_resampler_create(mpf_audio_stream_t *source, mpf_audio_stream_t *sink, apr_pool_t *pool);
 
+/**
+ * Create audio stream resampler placed before the sink.
+ * @param source the source stream to resample
+ * @param sink the sink stream to resample to
+ * @param pool the pool to allocate memory from
+ * @remark Frames written to the resampler are expected at the sampling rate of the source.
+ */
+MPF_DECLARE(mpf_audio_stream_t*) mpf_resampler_sink_create(mpf_audio_stream_t *source, mpf_audio_stream_t *sink, apr_pool_t *pool);
+
 
 APT_END_EXTERN_C
 
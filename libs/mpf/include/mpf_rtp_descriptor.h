@@ -97,10 +97,12 @@ struct mpf_jb_config_t {
 	apr_uint32_t initial_playout_delay;
 	/** Max playout delay in msec */
 	apr_uint32_t max_playout_delay;
-	/** Mode of operation of the jitter buffer: static - 0, adaptive - 1 */
+	/** Mode of operation of the jitter buffer: static - 0, adaptive - 1, adaptive minimizing delay - 2 */
 	apr_byte_t adaptive;
 	/** Enable/disable time skew detection */
 	apr_byte_t time_skew_detection;
+	/** Enable/disable concealment of lost frames */
+	apr_byte_t plc;
 };
 
 /** RTCP BYE transmission policy */
@@ -182,6 +184,7 @@ static APR_INLINE void mpf_jb_config_init(mpf_jb_config_t *jb_config)
 	jb_config->min_playout_delay = 0;
 	jb_config->max_playout_delay = 0;
 	jb_config->time_skew_detection = 1;
+	jb_config->plc = 0;
 }
 
 /** Allocate RTP config */
@@ -0,0 +1,83 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MPF_RTP_POLLER_H
+#define MPF_RTP_POLLER_H
+
+/**
+ * @file mpf_rtp_poller.h
+ * @brief MPF RTP Receive Poller
+ */
+
+#include <apr_network_io.h>
+#include "mpf_types.h"
+
+APT_BEGIN_EXTERN_C
+
+/** Opaque RTP poller descriptor (socket registered in the poller) declaration */
+typedef struct mpf_rtp_poller_descriptor_t mpf_rtp_poller_descriptor_t;
+
+/** Prototype of the handler invoked for each packet received from a registered socket */
+typedef void (*mpf_rtp_poller_packet_handler_f)(void *obj, void *buffer, apr_size_t size);
+
+/**
+ * Create RTP poller.
+ * @param max_socket_count the max number of sockets reported ready per poll
+ * @param pool the pool to allocate memory from
+ * @remark The poller is processed from the media processing thread only,
+ *         so sockets must be added and removed from the same thread.
+ */
+MPF_DECLARE(mpf_rtp_poller_t*) mpf_rtp_poller_create(apr_size_t max_socket_count, apr_pool_t *pool);
+
+/**
+ * Destroy RTP poller.
+ * @param poller the poller to destroy
+ */
+MPF_DECLARE(void) mpf_rtp_poller_destroy(mpf_rtp_poller_t *poller);
+
+/**
+ * Add socket to RTP poller.
+ * @param poller the poller to add socket to
+ * @param socket the non-blocking socket to receive packets from
+ * @param handler the handler to pass received packets to
+ * @param obj the external object to pass to the handler
+ * @param pool the pool to allocate memory from
+ */
+MPF_DECLARE(mpf_rtp_poller_descriptor_t*) mpf_rtp_poller_socket_add(
+										mpf_rtp_poller_t *poller,
+										apr_socket_t *socket,
+										mpf_rtp_poller_packet_handler_f handler,
+										void *obj,
+										apr_pool_t *pool);
+
+/**
+ * Remove socket from RTP poller.
+ * @param poller the poller to remove socket from
+ * @param descriptor the descriptor returned by mpf_rtp_poller_socket_add()
+ */
+MPF_DECLARE(apt_bool_t) mpf_rtp_poller_socket_remove(mpf_rtp_poller_t *poller, mpf_rtp_poller_descriptor_t *descriptor);
+
+/**
+ * Receive pending packets from the sockets which are ready for reading.
+ * @param poller the poller to process
+ * @remark The function doesn't block. It is supposed to be called once per media tick.
+ */
+MPF_DECLARE(apt_bool_t) mpf_rtp_poller_process(mpf_rtp_poller_t *poller);
+
+
+APT_END_EXTERN_C
+
+#endif /* MPF_RTP_POLLER_H */
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MPF_RTP_SENDER_H
+#define MPF_RTP_SENDER_H
+
+/**
+ * @file mpf_rtp_sender.h
+ * @brief MPF RTP Batch Sender
+ * @remark The sender accumulates RTP packets of a single RTP stream over several
+ *         media ticks and sends them by a single system call. The sender is used
+ *         from the media processing thread only.
+ */
+
+#include <apr_network_io.h>
+#include "mpf_types.h"
+
+APT_BEGIN_EXTERN_C
+
+/** Default max size of RTP packet queued by the sender */
+#define MPF_RTP_SENDER_DEFAULT_PACKET_SIZE 1500
+
+/**
+ * Check whether packets can be sent by a single system call on this platform.
+ */
+MPF_DECLARE(apt_bool_t) mpf_rtp_sender_is_supported(void);
+
+/**
+ * Create RTP sender.
+ * @param max_packet_count the max number of packets sent at once
+ * @param max_packet_size the max size of packet to queue (0 - default)
+ * @param max_hold_ticks the max number of media ticks the first queued packet is held for
+ * @param pool the pool to allocate memory from
+ */
+MPF_DECLARE(mpf_rtp_sender_t*) mpf_rtp_sender_create(apr_size_t max_packet_count, apr_size_t max_packet_size, apr_size_t max_hold_ticks, apr_pool_t *pool);
+
+/**
+ * Queue RTP packet to send.
+ * @param sender the sender to queue packet in
+ * @param socket the socket to send packet from
+ * @param sockaddr the address to send packet to
+ * @param data the packet data to copy
+ * @param size the size of packet data
+ * @return FALSE if the packet is larger than the max size, or the sender must be flushed first
+ * @remark All the packets queued till the next flush must be sent from the same socket.
+ */
+MPF_DECLARE(apt_bool_t) mpf_rtp_sender_packet_add(
+							mpf_rtp_sender_t *sender,
+							apr_socket_t *socket,
+							apr_sockaddr_t *sockaddr,
+							const void *data,
+							apr_size_t size);
+
+/**
+ * Check whether the sender is full and must be flushed.
+ * @param sender the sender to check
+ */
+MPF_DECLARE(apt_bool_t) mpf_rtp_sender_is_full(const mpf_rtp_sender_t *sender);
+
+/**
+ * Advance the sender by one media tick.
+ * @param sender the sender to advance
+ * @return TRUE if the queued packets have been held long enough and must be flushed
+ */
+MPF_DECLARE(apt_bool_t) mpf_rtp_sender_tick(mpf_rtp_sender_t *sender);
+
+/**
+ * Send all the queued packets.
+ * @param sender the sender to flush
+ * @param packet_count the number of packets actually sent
+ * @param octet_count the number of octets actually sent
+ * @return TRUE if all the queued packets have been sent
+ * @remark The packets which cannot be sent are dropped, as apr_socket_sendto() would do.
+ */
+MPF_DECLARE(apt_bool_t) mpf_rtp_sender_flush(mpf_rtp_sender_t *sender, apr_size_t *packet_count, apr_size_t *octet_count);
+
+
+APT_END_EXTERN_C
+
+#endif /* MPF_RTP_SENDER_H */
@@ -33,6 +33,9 @@ APT_BEGIN_EXTERN_C
 /** Declaration of virtual table of audio stream */
 typedef struct mpf_audio_stream_vtable_t mpf_audio_stream_vtable_t;
 
+/** Prototype of borrow frame method, refers the audio buffer of the frame to stream's own data instead of copying */
+typedef apt_bool_t (*mpf_audio_stream_borrow_f)(mpf_audio_stream_t *stream, mpf_frame_t *frame);
+
 /** Audio stream */
 struct mpf_audio_stream_t {
 	/** External object */
@@ -55,6 +58,13 @@ struct mpf_audio_stream_t {
 	mpf_codec_descriptor_t          *tx_descriptor;
 	/** Tx event descriptor */
 	mpf_codec_descriptor_t          *tx_event_descriptor;
+
+	/**
+	 * Optional borrow frame method, set by the streams of the MPF library only.
+	 * @remark Kept out of the virtual table, which plugins built against
+	 *         the earlier headers provide with fewer methods.
+	 */
+	mpf_audio_stream_borrow_f        borrow_frame;
 };
 
 /** Video stream */
@@ -137,6 +147,21 @@ static APR_INLINE apt_bool_t mpf_audio_stream_frame_read(mpf_audio_stream_t *str
 	return TRUE;
 }
 
+/**
+ * Read frame, allowing the stream to refer the audio buffer of the frame to its own data.
+ * @remark The frame must be provided with a buffer on each call, which is either
+ *         filled in or replaced with a buffer valid until the next media tick.
+ *         The buffer is replaced only if the frame has audio.
+ */
+static APR_INLINE apt_bool_t mpf_audio_stream_frame_borrow(mpf_audio_stream_t *stream, mpf_frame_t *frame)
+{
+	if(stream->borrow_frame)
+		return stream->borrow_frame(stream,frame);
+	if(stream->vtable->read_frame)
+		return stream->vtable->read_frame(stream,frame);
+	return TRUE;
+}
+
 /** Open audio stream transmitter */
 static APR_INLINE apt_bool_t mpf_audio_stream_tx_open(mpf_audio_stream_t *stream, mpf_codec_t *codec)
 {
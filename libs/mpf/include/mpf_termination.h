@@ -63,6 +63,10 @@ struct mpf_termination_t {
 	const mpf_codec_manager_t      *codec_manager;
 	/** Timer queue */
 	apt_timer_queue_t              *timer_queue;
+	/** RTP receive poller (optional) */
+	mpf_rtp_poller_t               *rtp_poller;
+	/** Number of RTP packets sent at once (0 - no batching) */
+	apr_size_t                     rtp_batch_size;
 	/** Termination factory entire termination created by */
 	mpf_termination_factory_t      *termination_factory;
 	/** Table of virtual methods */
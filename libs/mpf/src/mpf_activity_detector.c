@@ -17,6 +17,21 @@
 #include "mpf_activity_detector.h"
 #include "apt_log.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+/** Use SSE2 to analyze frames */
+#define MPF_DETECTOR_SSE2
+/** Max number of samples accumulated in vector lanes before they are summed up */
+#define DETECTOR_SSE2_BLOCK    (8 * 4096)
+#endif
+
+/** Number of fractional bits of the noise floor */
+#define NOISE_FLOOR_SHIFT      4
+/** Ratio the activity level should exceed the noise floor by (6 dB) */
+#define NOISE_FLOOR_RATIO      2
+/** Max zero-crossing rate (percent) of voiced frame, frames crossing zero more often need twice the level */
+#define ZCR_VOICE_MAX          40
+
 /** Detector states */
 typedef enum {
 	DETECTOR_STATE_INACTIVITY,           /**< inactivity detected */
@@ -27,8 +42,12 @@ typedef enum {
 
 /** Activity detector */
 struct mpf_activity_detector_t {
+	/* detection mode */
+	mpf_detector_mode_e  mode;
 	/* voice activity (silence) level threshold */
 	apr_size_t           level_threshold;
+	/* noise floor (adaptive mode only) */
+	apr_size_t           noise_floor;
 
 	/* period of activity required to complete transition to active state */
 	apr_size_t           speech_timeout;
@@ -49,7 +68,9 @@ struct mpf_activity_detector_t {
 MPF_DECLARE(mpf_activity_detector_t*) mpf_activity_detector_create(apr_pool_t *pool)
 {
 	mpf_activity_detector_t *detector = apr_palloc(pool,sizeof(mpf_activity_detector_t));
+	detector->mode = MPF_DETECTOR_MODE_LEVEL;
 	detector->level_threshold = 2; /* 0 .. 255 */
+	detector->noise_floor = 0;
 	detector->speech_timeout = 300; /* 0.3 s */
 	detector->silence_timeout = 300; /* 0.3 s */
 	detector->noinput_timeout = 5000; /* 5 s */
@@ -62,10 +83,18 @@ MPF_DECLARE(mpf_activity_detector_t*) mpf_activity_detector_create(apr_pool_t *p
 /** Reset activity detector */
 MPF_DECLARE(void) mpf_activity_detector_reset(mpf_activity_detector_t *detector)
 {
+	/* the noise floor is a property of the channel, keep it */
 	detector->duration = 0;
 	detector->state = DETECTOR_STATE_INACTIVITY;
 }
 
+/** Set detection mode */
+MPF_DECLARE(void) mpf_activity_detector_mode_set(mpf_activity_detector_t *detector, mpf_detector_mode_e mode)
+{
+	detector->mode = mode;
+	detector->noise_floor = 0;
+}
+
 /** Set threshold of voice activity (silence) level */
 MPF_DECLARE(void) mpf_activity_detector_level_set(mpf_activity_detector_t *detector, apr_size_t level_threshold)
 {
@@ -102,40 +131,121 @@ static APR_INLINE void mpf_activity_detector_state_change(mpf_activity_detector_
 	detector->state = state;
 }
 
-static apr_size_t mpf_activity_detector_level_calculate(const mpf_frame_t *frame)
+/** Sum up absolute values of samples */
+static apr_size_t mpf_activity_detector_abs_sum(const apr_int16_t *samples, apr_size_t count)
 {
 	apr_size_t sum = 0;
-	apr_size_t count = frame->codec_frame.size/2;
-	const apr_int16_t *cur = frame->codec_frame.buffer;
-	const apr_int16_t *end = cur + count;
+	apr_size_t i = 0;
+#ifdef MPF_DETECTOR_SSE2
+	const __m128i one = _mm_set1_epi16(1);
+	apr_uint32_t result[4];
+	apr_size_t end;
+	__m128i acc;
+	__m128i x;
+	__m128i sign;
+	while(i + 8 <= count) {
+		acc = _mm_setzero_si128();
+		end = (count - i > DETECTOR_SSE2_BLOCK) ? i + DETECTOR_SSE2_BLOCK : count;
+		for(; i + 8 <= end; i += 8) {
+			x = _mm_loadu_si128((const __m128i*)(samples + i));
+			sign = _mm_srai_epi16(x,15);
+			/* |x| = (x ^ sign) - sign, the terms are summed up separately not to overflow on -32768 */
+			acc = _mm_add_epi32(acc,_mm_madd_epi16(_mm_xor_si128(x,sign),one));
+			acc = _mm_sub_epi32(acc,_mm_madd_epi16(sign,one));
+		}
+		_mm_storeu_si128((__m128i*)result,acc);
+		sum += (apr_size_t)result[0] + result[1] + result[2] + result[3];
+	}
+#endif
+	for(; i < count; i++) {
+		sum += (samples[i] < 0) ? -samples[i] : samples[i];
+	}
+	return sum;
+}
 
-	for(; cur < end; cur++) {
-		if(*cur < 0) {
-			sum -= *cur;
+/** Count sign changes between adjacent samples */
+static apr_size_t mpf_activity_detector_zero_crossings(const apr_int16_t *samples, apr_size_t count)
+{
+	apr_size_t crossings = 0;
+	apr_size_t i = 0;
+#ifdef MPF_DETECTOR_SSE2
+	const __m128i one = _mm_set1_epi16(1);
+	apr_uint32_t result[4];
+	apr_size_t end;
+	__m128i acc;
+	__m128i x;
+	while(i + 9 <= count) {
+		acc = _mm_setzero_si128();
+		end = (count - i > DETECTOR_SSE2_BLOCK) ? i + DETECTOR_SSE2_BLOCK : count;
+		for(; i + 9 <= end; i += 8) {
+			/* the sign bit of x[i] ^ x[i+1] is set on crossing, count it as -1 */
+			x = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(samples + i)),_mm_loadu_si128((const __m128i*)(samples + i + 1)));
+			acc = _mm_sub_epi16(acc,_mm_srai_epi16(x,15));
 		}
-		else {
-			sum += *cur;
+		_mm_storeu_si128((__m128i*)result,_mm_madd_epi16(acc,one));
+		crossings += (apr_size_t)result[0] + result[1] + result[2] + result[3];
+	}
+#endif
+	for(; i + 1 < count; i++) {
+		if((samples[i] ^ samples[i+1]) < 0) {
+			crossings++;
 		}
 	}
+	return crossings;
+}
+
+/** Calculate activity level of the frame and, in adaptive mode, update the noise floor */
+static apt_bool_t mpf_activity_detector_frame_analyze(mpf_activity_detector_t *detector, const mpf_frame_t *frame)
+{
+	apt_bool_t active;
+	apr_size_t level;
+	apr_size_t threshold;
+	apr_size_t zcr;
+	apr_size_t count = frame->codec_frame.size/2;
+	const apr_int16_t *samples = frame->codec_frame.buffer;
+
+	if(!count) {
+		return FALSE;
+	}
+
+	level = mpf_activity_detector_abs_sum(samples,count) / count;
+#if 0
+	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Activity Detector [%"APR_SIZE_T_FMT"]",level);
+#endif
+	if(detector->mode != MPF_DETECTOR_MODE_ADAPTIVE) {
+		return (level >= detector->level_threshold) ? TRUE : FALSE;
+	}
+
+	threshold = (detector->noise_floor * NOISE_FLOOR_RATIO) >> NOISE_FLOOR_SHIFT;
+	if(threshold < detector->level_threshold) {
+		threshold = detector->level_threshold;
+	}
+	zcr = mpf_activity_detector_zero_crossings(samples,count) * 100 / count;
+	active = (level >= threshold && (zcr <= ZCR_VOICE_MAX || level >= 2 * threshold)) ? TRUE : FALSE;
 
-	return sum / count;
+	/* the floor follows decreasing level fast, and rises slowly, the slower during activity */
+	level <<= NOISE_FLOOR_SHIFT;
+	if(level < detector->noise_floor) {
+		detector->noise_floor -= (detector->noise_floor - level) >> 1;
+	}
+	else {
+		detector->noise_floor += (level - detector->noise_floor) >> (active == TRUE ? 9 : 4);
+	}
+	return active;
 }
 
 /** Process current frame */
 MPF_DECLARE(mpf_detector_event_e) mpf_activity_detector_process(mpf_activity_detector_t *detector, const mpf_frame_t *frame)
 {
 	mpf_detector_event_e det_event = MPF_DETECTOR_EVENT_NONE;
-	apr_size_t level = 0;
+	apt_bool_t active = FALSE;
 	if((frame->type & MEDIA_FRAME_TYPE_AUDIO) == MEDIA_FRAME_TYPE_AUDIO) {
-		/* first, calculate current activity level of processed frame */
-		level = mpf_activity_detector_level_calculate(frame);
-#if 0
-		apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Activity Detector [%"APR_SIZE_T_FMT"]",level);
-#endif
+		/* first, check whether the processed frame is active */
+		active = mpf_activity_detector_frame_analyze(detector,frame);
 	}
 
 	if(detector->state == DETECTOR_STATE_INACTIVITY) {
-		if(level >= detector->level_threshold) {
+		if(active == TRUE) {
 			/* start to detect activity */
 			mpf_activity_detector_state_change(detector,DETECTOR_STATE_ACTIVITY_TRANSITION);
 		}
@@ -148,7 +258,7 @@ MPF_DECLARE(mpf_detector_event_e) mpf_activity_detector_process(mpf_activity_det
 		}
 	}
 	else if(detector->state == DETECTOR_STATE_ACTIVITY_TRANSITION) {
-		if(level >= detector->level_threshold) {
+		if(active == TRUE) {
 			detector->duration += detector->frame_duration;
 			if(detector->duration >= detector->speech_timeout) {
 				/* finally detected activity */
@@ -162,7 +272,7 @@ MPF_DECLARE(mpf_detector_event_e) mpf_activity_detector_process(mpf_activity_det
 		}
 	}
 	else if(detector->state == DETECTOR_STATE_ACTIVITY) {
-		if(level >= detector->level_threshold) {
+		if(active == TRUE) {
 			detector->duration += detector->frame_duration;
 		}
 		else {
@@ -171,7 +281,7 @@ MPF_DECLARE(mpf_detector_event_e) mpf_activity_detector_process(mpf_activity_det
 		}
 	}
 	else if(detector->state == DETECTOR_STATE_INACTIVITY_TRANSITION) {
-		if(level >= detector->level_threshold) {
+		if(active == TRUE) {
 			/* fallback to activity */
 			mpf_activity_detector_state_change(detector,DETECTOR_STATE_ACTIVITY);
 		}
@@ -35,6 +35,8 @@ struct mpf_bridge_t {
 	mpf_codec_t        *codec;
 	/** Media frame used to read data from source and write it to sink */
 	mpf_frame_t         frame;
+	/** Own buffer of the frame, which may be referred to the source data */
+	void               *buffer;
 	/** Number of ticks in a frame (frame_duration/CODEC_FRAME_TIME_BASE) */
 	apr_byte_t          base_ticks;
 	/** Number of ticks incremented on every CODEC_FRAME_TIME_BASE */
@@ -60,7 +62,8 @@ static apt_bool_t mpf_bridge_process(mpf_object_t *object)
 		return TRUE;
 	bridge->frame.type = MEDIA_FRAME_TYPE_NONE;
 	bridge->frame.marker = MPF_MARKER_NONE;
-	bridge->source->vtable->read_frame(bridge->source,&bridge->frame);
+	bridge->frame.codec_frame.buffer = bridge->buffer;
+	mpf_audio_stream_frame_borrow(bridge->source,&bridge->frame);
 	
 	if((bridge->frame.type & MEDIA_FRAME_TYPE_AUDIO) == 0) {
 		memset(	bridge->frame.codec_frame.buffer,
@@ -79,7 +82,8 @@ static apt_bool_t mpf_null_bridge_process(mpf_object_t *object)
 		return TRUE;
 	bridge->frame.type = MEDIA_FRAME_TYPE_NONE;
 	bridge->frame.marker = MPF_MARKER_NONE;
-	bridge->source->vtable->read_frame(bridge->source,&bridge->frame);
+	bridge->frame.codec_frame.buffer = bridge->buffer;
+	mpf_audio_stream_frame_borrow(bridge->source,&bridge->frame);
 
 	if((bridge->frame.type & MEDIA_FRAME_TYPE_AUDIO) == 0) {
 		/* generate silence frame */
@@ -155,7 +159,8 @@ static mpf_object_t* mpf_linear_bridge_create(mpf_audio_stream_t *source, mpf_au
 	descriptor = source->rx_descriptor;
 	frame_size = mpf_codec_linear_frame_size_calculate(descriptor->sampling_rate,descriptor->channel_count,frame_duration);
 	bridge->frame.codec_frame.size = frame_size;
-	bridge->frame.codec_frame.buffer = apr_palloc(pool,frame_size);
+	bridge->buffer = apr_palloc(pool,frame_size);
+	bridge->frame.codec_frame.buffer = bridge->buffer;
 	
 	if(mpf_audio_stream_rx_open(source,NULL) == FALSE) {
 		return NULL;
@@ -196,7 +201,8 @@ static mpf_object_t* mpf_null_bridge_create(mpf_audio_stream_t *source, mpf_audi
 		codec->attribs->bits_per_sample);
 	bridge->codec = codec;
 	bridge->frame.codec_frame.size = frame_size;
-	bridge->frame.codec_frame.buffer = apr_palloc(pool,frame_size);
+	bridge->buffer = apr_palloc(pool,frame_size);
+	bridge->frame.codec_frame.buffer = bridge->buffer;
 
 	if(mpf_audio_stream_rx_open(source,codec) == FALSE) {
 		return NULL;
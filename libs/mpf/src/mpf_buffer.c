@@ -22,6 +22,7 @@
 
 typedef struct mpf_chunk_t mpf_chunk_t;
 
+/** Media chunk, the audio data of chunk_size bytes follows the chunk */
 struct mpf_chunk_t {
 	APR_RING_ENTRY(mpf_chunk_t) link;
 	mpf_frame_t                 frame;
@@ -29,21 +30,36 @@ struct mpf_chunk_t {
 
 struct mpf_buffer_t {
 	APR_RING_HEAD(mpf_chunk_head_t, mpf_chunk_t) head;
+	/** Chunks read out and recycled for subsequent writes */
+	struct mpf_chunk_head_t                      free_head;
 	mpf_chunk_t                                 *cur_chunk;
+	/** Last audio chunk, which has room to append to */
+	mpf_chunk_t                                 *tail_chunk;
 	apr_size_t                                   remaining_chunk_size;
+	apr_size_t                                   chunk_size;
+	apr_size_t                                   high_water_mark;
 	apr_thread_mutex_t                          *guard;
 	apr_pool_t                                  *pool;
 	apr_size_t                                   size; /* total size */
 };
 
 mpf_buffer_t* mpf_buffer_create(apr_pool_t *pool)
+{
+	return mpf_buffer_create_ex(MPF_BUFFER_DEFAULT_CHUNK_SIZE,0,pool);
+}
+
+mpf_buffer_t* mpf_buffer_create_ex(apr_size_t chunk_size, apr_size_t high_water_mark, apr_pool_t *pool)
 {
 	mpf_buffer_t *buffer = apr_palloc(pool,sizeof(mpf_buffer_t));
 	buffer->pool = pool;
 	buffer->cur_chunk = NULL;
+	buffer->tail_chunk = NULL;
 	buffer->remaining_chunk_size = 0;
+	buffer->chunk_size = chunk_size ? chunk_size : MPF_BUFFER_DEFAULT_CHUNK_SIZE;
+	buffer->high_water_mark = high_water_mark;
 	buffer->size = 0;
 	APR_RING_INIT(&buffer->head, mpf_chunk_t, link);
+	APR_RING_INIT(&buffer->free_head, mpf_chunk_t, link);
 	apr_thread_mutex_create(&buffer->guard,APR_THREAD_MUTEX_UNNESTED,pool);
 	return buffer;
 }
@@ -56,17 +72,44 @@ void mpf_buffer_destroy(mpf_buffer_t *buffer)
 	}
 }
 
+static APR_INLINE void mpf_buffer_chunk_release(mpf_buffer_t *buffer, mpf_chunk_t *chunk)
+{
+	APR_RING_INSERT_TAIL(&buffer->free_head,chunk,mpf_chunk_t,link);
+}
+
 apt_bool_t mpf_buffer_restart(mpf_buffer_t *buffer)
 {
 	apr_thread_mutex_lock(buffer->guard);
-	buffer->cur_chunk = NULL;
+	/* recycle all the chunks instead of leaving them to the pool */
+	if(buffer->cur_chunk) {
+		mpf_buffer_chunk_release(buffer,buffer->cur_chunk);
+		buffer->cur_chunk = NULL;
+	}
+	APR_RING_CONCAT(&buffer->free_head, &buffer->head, mpf_chunk_t, link);
+	buffer->tail_chunk = NULL;
 	buffer->remaining_chunk_size = 0;
 	buffer->size = 0;
-	APR_RING_INIT(&buffer->head, mpf_chunk_t, link);
 	apr_thread_mutex_unlock(buffer->guard);
 	return TRUE;
 }
 
+static mpf_chunk_t* mpf_buffer_chunk_alloc(mpf_buffer_t *buffer)
+{
+	mpf_chunk_t *chunk;
+	if(!APR_RING_EMPTY(&buffer->free_head,mpf_chunk_t,link)) {
+		chunk = APR_RING_FIRST(&buffer->free_head);
+		APR_RING_REMOVE(chunk,link);
+	}
+	else {
+		/* the audio data is allocated along with the chunk */
+		chunk = apr_palloc(buffer->pool,sizeof(mpf_chunk_t) + buffer->chunk_size);
+	}
+	APR_RING_ELEM_INIT(chunk,link);
+	chunk->frame.codec_frame.buffer = chunk + 1;
+	chunk->frame.codec_frame.size = 0;
+	return chunk;
+}
+
 static APR_INLINE apt_bool_t mpf_buffer_chunk_write(mpf_buffer_t *buffer, mpf_chunk_t *chunk)
 {
 	APR_RING_INSERT_TAIL(&buffer->head,chunk,mpf_chunk_t,link);
@@ -79,6 +122,10 @@ static APR_INLINE mpf_chunk_t* mpf_buffer_chunk_read(mpf_buffer_t *buffer)
 	if(!APR_RING_EMPTY(&buffer->head,mpf_chunk_t,link)) {
 		chunk = APR_RING_FIRST(&buffer->head);
 		APR_RING_REMOVE(chunk,link);
+		if(chunk == buffer->tail_chunk) {
+			/* nothing can be appended to the chunk being read */
+			buffer->tail_chunk = NULL;
+		}
 	}
 	return chunk;
 }
@@ -86,18 +133,31 @@ static APR_INLINE mpf_chunk_t* mpf_buffer_chunk_read(mpf_buffer_t *buffer)
 apt_bool_t mpf_buffer_audio_write(mpf_buffer_t *buffer, void *data, apr_size_t size)
 {
 	mpf_chunk_t *chunk;
-	apt_bool_t status;
+	apr_size_t chunk_size;
+	apt_bool_t status = TRUE;
 	apr_thread_mutex_lock(buffer->guard);
 
-	chunk = apr_palloc(buffer->pool,sizeof(mpf_chunk_t));
-	APR_RING_ELEM_INIT(chunk,link);
-	chunk->frame.codec_frame.buffer = apr_palloc(buffer->pool,size);
-	memcpy(chunk->frame.codec_frame.buffer,data,size);
-	chunk->frame.codec_frame.size = size;
-	chunk->frame.type = MEDIA_FRAME_TYPE_AUDIO;
-	status = mpf_buffer_chunk_write(buffer,chunk);
-	
 	buffer->size += size;
+	while(size) {
+		chunk = buffer->tail_chunk;
+		if(!chunk || chunk->frame.codec_frame.size == buffer->chunk_size) {
+			chunk = mpf_buffer_chunk_alloc(buffer);
+			chunk->frame.type = MEDIA_FRAME_TYPE_AUDIO;
+			status = mpf_buffer_chunk_write(buffer,chunk);
+			buffer->tail_chunk = chunk;
+		}
+
+		/* append as much as fits in the chunk */
+		chunk_size = buffer->chunk_size - chunk->frame.codec_frame.size;
+		if(chunk_size > size) {
+			chunk_size = size;
+		}
+		memcpy((char*)chunk->frame.codec_frame.buffer + chunk->frame.codec_frame.size,data,chunk_size);
+		chunk->frame.codec_frame.size += chunk_size;
+		data = (char*)data + chunk_size;
+		size -= chunk_size;
+	}
+	
 	apr_thread_mutex_unlock(buffer->guard);
 	return status;
 }
@@ -108,12 +168,11 @@ apt_bool_t mpf_buffer_event_write(mpf_buffer_t *buffer, mpf_frame_type_e event_t
 	apt_bool_t status;
 	apr_thread_mutex_lock(buffer->guard);
 
-	chunk = apr_palloc(buffer->pool,sizeof(mpf_chunk_t));
-	APR_RING_ELEM_INIT(chunk,link);
-	chunk->frame.codec_frame.buffer = NULL;
-	chunk->frame.codec_frame.size = 0;
+	chunk = mpf_buffer_chunk_alloc(buffer);
 	chunk->frame.type = event_type;
 	status = mpf_buffer_chunk_write(buffer,chunk);
+	/* audio written after the event must not be merged with the audio before */
+	buffer->tail_chunk = NULL;
 	
 	apr_thread_mutex_unlock(buffer->guard);
 	return status;
@@ -157,6 +216,7 @@ apt_bool_t mpf_buffer_frame_read(mpf_buffer_t *buffer, mpf_frame_t *media_frame)
 			remaining_frame_size -= buffer->remaining_chunk_size;
 			buffer->size -= buffer->remaining_chunk_size;
 			buffer->remaining_chunk_size = 0;
+			mpf_buffer_chunk_release(buffer,buffer->cur_chunk);
 			buffer->cur_chunk = NULL;
 		}
 	}
@@ -174,3 +234,11 @@ apr_size_t mpf_buffer_get_size(const mpf_buffer_t *buffer)
 {
 	return buffer->size;
 }
+
+apt_bool_t mpf_buffer_is_full(const mpf_buffer_t *buffer)
+{
+	if(buffer->high_water_mark && buffer->size >= buffer->high_water_mark) {
+		return TRUE;
+	}
+	return FALSE;
+}
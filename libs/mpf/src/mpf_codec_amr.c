@@ -397,6 +397,7 @@ static const mpf_codec_vtable_t mpf_amr_wb_vtable = {
 	mpf_amr_wb_pack,
 	mpf_amr_wb_dissect,
 	mpf_amr_wb_fill,
+	NULL,
 	mpf_amr_wb_format_match
 };
 
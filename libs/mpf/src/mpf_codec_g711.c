@@ -16,7 +16,7 @@
 
 #include "mpf_codec.h"
 #include "mpf_rtp_pt.h"
-#include "g711/g711.h"
+#include "mpf_g711_kernel.h"
 
 #define G711u_CODEC_NAME        "PCMU"
 #define G711u_CODEC_NAME_LENGTH (sizeof(G711u_CODEC_NAME)-1)
@@ -24,98 +24,97 @@
 #define G711a_CODEC_NAME        "PCMA"
 #define G711a_CODEC_NAME_LENGTH (sizeof(G711a_CODEC_NAME)-1)
 
-static apt_bool_t g711u_encode(mpf_codec_t *codec, const mpf_codec_frame_t *frame_in, mpf_codec_frame_t *frame_out)
-{
-	const apr_int16_t *decode_buf;
-	unsigned char *encode_buf;
-	apr_size_t i;
+/** Encoded silence, linear_to_ulaw(0) and linear_to_alaw(0) */
+#define G711u_SILENCE           0xFF
+#define G711a_SILENCE           0xD5
 
-	decode_buf = frame_in->buffer;
-	encode_buf = frame_out->buffer;
+/** Number of samples concealed at a time */
+#define G711_CONCEAL_CHUNK_SAMPLES 160
 
-	frame_out->size = frame_in->size / sizeof(apr_int16_t);
-
-	for(i=0; i<frame_out->size; i++) {
-		encode_buf[i] = linear_to_ulaw(decode_buf[i]);
-	}
+/** G.711 kernel selected on codec creation */
+static const mpf_g711_kernel_t *g711_kernel = NULL;
 
+static apt_bool_t g711u_encode(mpf_codec_t *codec, const mpf_codec_frame_t *frame_in, mpf_codec_frame_t *frame_out)
+{
+	frame_out->size = frame_in->size / sizeof(apr_int16_t);
+	g711_kernel->ulaw_encode(frame_in->buffer,frame_out->buffer,frame_out->size);
 	return TRUE;
 }
 
 static apt_bool_t g711u_decode(mpf_codec_t *codec, const mpf_codec_frame_t *frame_in, mpf_codec_frame_t *frame_out)
 {
-	apr_int16_t *decode_buf;
-	const unsigned char *encode_buf;
-	apr_size_t i;
-
-	decode_buf = frame_out->buffer;
-	encode_buf = frame_in->buffer;
-
 	frame_out->size = frame_in->size * sizeof(apr_int16_t);
-
-	for(i=0; i<frame_in->size; i++) {
-		decode_buf[i] = ulaw_to_linear(encode_buf[i]);
-	}
-
+	g711_kernel->ulaw_decode(frame_in->buffer,frame_out->buffer,frame_in->size);
 	return TRUE;
 }
 
 static apt_bool_t g711u_fill(mpf_codec_t *codec, mpf_codec_frame_t *frame_out)
 {
-	apr_size_t i;
-	unsigned char *encode_buf = frame_out->buffer;
-	for(i=0; i<frame_out->size; i++) {
-		encode_buf[i] = linear_to_ulaw(0);
-	}
-
+	memset(frame_out->buffer,G711u_SILENCE,frame_out->size);
 	return TRUE;
 }
 
 static apt_bool_t g711a_encode(mpf_codec_t *codec, const mpf_codec_frame_t *frame_in, mpf_codec_frame_t *frame_out)
 {
-	const apr_int16_t *decode_buf;
-	unsigned char *encode_buf;
-	apr_size_t i;
-
-	decode_buf = frame_in->buffer;
-	encode_buf = frame_out->buffer;
-
 	frame_out->size = frame_in->size / sizeof(apr_int16_t);
-
-	for(i=0; i<frame_out->size; i++) {
-		encode_buf[i] = linear_to_alaw(decode_buf[i]);
-	}
-
+	g711_kernel->alaw_encode(frame_in->buffer,frame_out->buffer,frame_out->size);
 	return TRUE;
 }
 
 static apt_bool_t g711a_decode(mpf_codec_t *codec, const mpf_codec_frame_t *frame_in, mpf_codec_frame_t *frame_out)
 {
-	apr_int16_t *decode_buf;
-	const unsigned char *encode_buf;
-	apr_size_t i;
+	frame_out->size = frame_in->size * sizeof(apr_int16_t);
+	g711_kernel->alaw_decode(frame_in->buffer,frame_out->buffer,frame_in->size);
+	return TRUE;
+}
 
-	decode_buf = frame_out->buffer;
-	encode_buf = frame_in->buffer;
+static apt_bool_t g711a_fill(mpf_codec_t *codec, mpf_codec_frame_t *frame_out)
+{
+	memset(frame_out->buffer,G711a_SILENCE,frame_out->size);
+	return TRUE;
+}
 
-	frame_out->size = frame_in->size * sizeof(apr_int16_t);
+/** Conceal lost G.711 frame by means of the given kernel functions, a chunk of samples at a time */
+static apt_bool_t g711_conceal(const mpf_codec_frame_t *frame_in, apr_size_t loss_count, mpf_codec_frame_t *frame_out,
+							   mpf_g711_decode_f decode, mpf_g711_encode_f encode)
+{
+	apr_int16_t samples[G711_CONCEAL_CHUNK_SAMPLES];
+	const apr_byte_t *buf_in = frame_in->buffer;
+	apr_byte_t *buf_out = frame_out->buffer;
+	apr_size_t offset;
+	apr_size_t count;
+
+	if(loss_count == 1) {
+		/* repeat the last frame as is */
+		memcpy(frame_out->buffer,frame_in->buffer,frame_in->size);
+		frame_out->size = frame_in->size;
+		return TRUE;
+	}
 
-	for(i=0; i<frame_in->size; i++) {
-		decode_buf[i] = alaw_to_linear(encode_buf[i]);
+	for(offset=0; offset<frame_in->size; offset+=count) {
+		count = frame_in->size - offset;
+		if(count > G711_CONCEAL_CHUNK_SAMPLES) {
+			count = G711_CONCEAL_CHUNK_SAMPLES;
+		}
+		decode(buf_in + offset,samples,count);
+		if(mpf_codec_linear_conceal(samples,count,offset,frame_in->size,loss_count) == FALSE) {
+			return FALSE;
+		}
+		encode(samples,buf_out + offset,count);
 	}
 
+	frame_out->size = frame_in->size;
 	return TRUE;
 }
 
-static apt_bool_t g711a_fill(mpf_codec_t *codec, mpf_codec_frame_t *frame_out)
+static apt_bool_t g711u_conceal(mpf_codec_t *codec, const mpf_codec_frame_t *frame_in, apr_size_t loss_count, mpf_codec_frame_t *frame_out)
 {
-	apr_size_t i;
-	unsigned char *encode_buf = frame_out->buffer;
-	for(i=0; i<frame_out->size; i++) {
-		encode_buf[i] = linear_to_alaw(0);
-	}
+	return g711_conceal(frame_in,loss_count,frame_out,g711_kernel->ulaw_decode,g711_kernel->ulaw_encode);
+}
 
-	return TRUE;
+static apt_bool_t g711a_conceal(mpf_codec_t *codec, const mpf_codec_frame_t *frame_in, apr_size_t loss_count, mpf_codec_frame_t *frame_out)
+{
+	return g711_conceal(frame_in,loss_count,frame_out,g711_kernel->alaw_decode,g711_kernel->alaw_encode);
 }
 
 static const mpf_codec_vtable_t g711u_vtable = {
@@ -128,6 +127,7 @@ static const mpf_codec_vtable_t g711u_vtable = {
 	NULL,
 	NULL,
 	g711u_fill,
+	g711u_conceal,
 	NULL
 };
 
@@ -141,6 +141,7 @@ static const mpf_codec_vtable_t g711a_vtable = {
 	NULL,
 	NULL,
 	g711a_fill,
+	g711a_conceal,
 	NULL
 };
 
@@ -186,10 +187,12 @@ static const mpf_codec_attribs_t g711a_attribs = {
 
 mpf_codec_t* mpf_codec_g711u_create(apr_pool_t *pool)
 {
+	g711_kernel = mpf_g711_kernel_default_get();
 	return mpf_codec_create(&g711u_vtable,&g711u_attribs,&g711u_descriptor,pool);
 }
 
 mpf_codec_t* mpf_codec_g711a_create(apr_pool_t *pool)
 {
+	g711_kernel = mpf_g711_kernel_default_get();
 	return mpf_codec_create(&g711a_vtable,&g711a_attribs,&g711a_descriptor,pool);
 }
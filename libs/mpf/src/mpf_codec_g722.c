@@ -127,6 +127,7 @@ static const mpf_codec_vtable_t g722_vtable = {
 	NULL,
 	NULL,
 	mpf_g722_fill,
+	NULL,
 	NULL
 };
 
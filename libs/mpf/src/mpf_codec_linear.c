@@ -55,6 +55,34 @@ static apt_bool_t l16_decode(mpf_codec_t *codec, const mpf_codec_frame_t *frame_
 	return TRUE;
 }
 
+static apt_bool_t l16_conceal(mpf_codec_t *codec, const mpf_codec_frame_t *frame_in, apr_size_t loss_count, mpf_codec_frame_t *frame_out)
+{
+	apr_uint32_t i;
+	const apr_int16_t *buf_in = frame_in->buffer;
+	apr_int16_t *buf_out = frame_out->buffer;
+	apr_size_t samples = frame_in->size / sizeof(apr_int16_t);
+
+	if(loss_count == 1) {
+		/* repeat the last frame as is */
+		memcpy(frame_out->buffer,frame_in->buffer,frame_in->size);
+		frame_out->size = frame_in->size;
+		return TRUE;
+	}
+
+	for(i=0; i<samples; i++) {
+		buf_out[i] = ntohs(buf_in[i]);
+	}
+	if(mpf_codec_linear_conceal(buf_out,samples,0,samples,loss_count) == FALSE) {
+		return FALSE;
+	}
+	for(i=0; i<samples; i++) {
+		buf_out[i] = htons(buf_out[i]);
+	}
+
+	frame_out->size = frame_in->size;
+	return TRUE;
+}
+
 static const mpf_codec_vtable_t l16_vtable = {
 	NULL,
 	NULL,
@@ -65,6 +93,7 @@ static const mpf_codec_vtable_t l16_vtable = {
 	NULL,
 	NULL,
 	NULL,
+	l16_conceal,
 	NULL
 };
 
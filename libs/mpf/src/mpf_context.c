@@ -18,6 +18,7 @@
 #pragma warning(disable: 4127)
 #endif
 #include <apr_ring.h> 
+#include <apr_atomic.h>
 #include "mpf_context.h"
 #include "mpf_termination.h"
 #include "mpf_stream.h"
@@ -44,6 +45,8 @@ struct mpf_context_t {
 	APR_RING_ENTRY(mpf_context_t) link;
 	/** Back pointer to the context factory */
 	mpf_context_factory_t        *factory;
+	/** Indicates whether the context has already been destroyed */
+	apt_bool_t                    destroyed;
 	/** Pool to allocate memory from */
 	apr_pool_t                   *pool;
 	/** Informative name of the context used for debugging */
@@ -69,6 +72,8 @@ struct mpf_context_t {
 struct mpf_context_factory_t {
 	/** Ring head */
 	APR_RING_HEAD(mpf_context_head_t, mpf_context_t) head;
+	/** Number of created and not yet destroyed contexts (modified from signaling threads) */
+	volatile apr_uint32_t load;
 };
 
 
@@ -82,6 +87,7 @@ MPF_DECLARE(mpf_context_factory_t*) mpf_context_factory_create(apr_pool_t *pool)
 {
 	mpf_context_factory_t *factory = apr_palloc(pool, sizeof(mpf_context_factory_t));
 	APR_RING_INIT(&factory->head, mpf_context_t, link);
+	factory->load = 0;
 	return factory;
 }
 
@@ -108,6 +114,11 @@ MPF_DECLARE(apt_bool_t) mpf_context_factory_process(mpf_context_factory_t *facto
 	return TRUE;
 }
 
+MPF_DECLARE(apr_size_t) mpf_context_factory_load_get(const mpf_context_factory_t *factory)
+{
+	return apr_atomic_read32((volatile apr_uint32_t*)&factory->load);
+}
+
  
 MPF_DECLARE(mpf_context_t*) mpf_context_create(
 								mpf_context_factory_t *factory,
@@ -122,6 +133,7 @@ MPF_DECLARE(mpf_context_t*) mpf_context_create(
 	mpf_context_t *context = apr_palloc(pool,sizeof(mpf_context_t));
 	APR_RING_ELEM_INIT(context,link);
 	context->factory = factory;
+	context->destroyed = FALSE;
 	context->obj = obj;
 	context->pool = pool;
 	context->name = name;
@@ -145,6 +157,7 @@ MPF_DECLARE(mpf_context_t*) mpf_context_create(
 		}
 	}
 
+	apr_atomic_inc32(&factory->load);
 	return context;
 }
 
@@ -159,6 +172,11 @@ MPF_DECLARE(apt_bool_t) mpf_context_destroy(mpf_context_t *context)
 			mpf_termination_subtract(termination);
 		}
 	}
+
+	if(context->destroyed == FALSE) {
+		context->destroyed = TRUE;
+		apr_atomic_dec32(&context->factory->load);
+	}
 	return TRUE;
 }
 
@@ -167,6 +185,11 @@ MPF_DECLARE(void*) mpf_context_object_get(const mpf_context_t *context)
 	return context->obj;
 }
 
+MPF_DECLARE(mpf_context_factory_t*) mpf_context_factory_get(const mpf_context_t *context)
+{
+	return context->factory;
+}
+
 MPF_DECLARE(apt_bool_t) mpf_context_termination_add(mpf_context_t *context, mpf_termination_t *termination)
 {
 	apr_size_t i;
@@ -24,6 +24,8 @@ struct mpf_decoder_t {
 	mpf_audio_stream_t *source;
 	mpf_codec_t        *codec;
 	mpf_frame_t         frame_in;
+	/** Own buffer of the input frame, which may be referred to the source data */
+	void               *buffer_in;
 };
 
 static apt_bool_t mpf_decoder_destroy(mpf_audio_stream_t *stream)
@@ -57,7 +59,9 @@ static apt_bool_t mpf_decoder_process(mpf_audio_stream_t *stream, mpf_frame_t *f
 	mpf_decoder_t *decoder = stream->obj;
 	decoder->frame_in.type = MEDIA_FRAME_TYPE_NONE;
 	decoder->frame_in.marker = MPF_MARKER_NONE;
-	if(mpf_audio_stream_frame_read(decoder->source,&decoder->frame_in) != TRUE) {
+	decoder->frame_in.codec_frame.buffer = decoder->buffer_in;
+	/* decode straight from the data of the source, if it's lent */
+	if(mpf_audio_stream_frame_borrow(decoder->source,&decoder->frame_in) != TRUE) {
 		return FALSE;
 	}
 
@@ -132,6 +136,7 @@ MPF_DECLARE(mpf_audio_stream_t*) mpf_decoder_create(mpf_audio_stream_t *source,
 		source->rx_descriptor->frame_duration,
 		codec->attribs->bits_per_sample);
 	decoder->frame_in.codec_frame.size = frame_size;
-	decoder->frame_in.codec_frame.buffer = apr_palloc(pool,frame_size);
+	decoder->buffer_in = apr_palloc(pool,frame_size);
+	decoder->frame_in.codec_frame.buffer = decoder->buffer_in;
 	return decoder->base;
 }
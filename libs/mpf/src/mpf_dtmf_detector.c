@@ -24,6 +24,46 @@
 #	define M_PI 3.141592653589793238462643
 #endif
 
+/*
+ * The Goertzel's filters of all the DTMF frequencies are run in single
+ * precision vectors: one AVX register or two SSE registers hold the states
+ * of the eight filters of a detector. The batch processing runs the same
+ * vectors across detectors, one lane per detector.
+ */
+#if defined(__AVX__)
+#include <immintrin.h>
+typedef __m256 dtmf_vec_t;
+#define DTMF_VEC_LANES           8
+#define DTMF_VEC_LOAD(p)         _mm256_loadu_ps(p)
+#define DTMF_VEC_STORE(p,v)      _mm256_storeu_ps(p,v)
+#define DTMF_VEC_SET1(x)         _mm256_set1_ps(x)
+#define DTMF_VEC_ZERO()          _mm256_setzero_ps()
+#define DTMF_VEC_ADD(a,b)        _mm256_add_ps(a,b)
+#define DTMF_VEC_SUB(a,b)        _mm256_sub_ps(a,b)
+#define DTMF_VEC_MUL(a,b)        _mm256_mul_ps(a,b)
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+typedef __m128 dtmf_vec_t;
+#define DTMF_VEC_LANES           4
+#define DTMF_VEC_LOAD(p)         _mm_loadu_ps(p)
+#define DTMF_VEC_STORE(p,v)      _mm_storeu_ps(p,v)
+#define DTMF_VEC_SET1(x)         _mm_set1_ps(x)
+#define DTMF_VEC_ZERO()          _mm_setzero_ps()
+#define DTMF_VEC_ADD(a,b)        _mm_add_ps(a,b)
+#define DTMF_VEC_SUB(a,b)        _mm_sub_ps(a,b)
+#define DTMF_VEC_MUL(a,b)        _mm_mul_ps(a,b)
+#else
+typedef float dtmf_vec_t;
+#define DTMF_VEC_LANES           1
+#define DTMF_VEC_LOAD(p)         (*(p))
+#define DTMF_VEC_STORE(p,v)      (*(p) = (v))
+#define DTMF_VEC_SET1(x)         (x)
+#define DTMF_VEC_ZERO()          (0.0f)
+#define DTMF_VEC_ADD(a,b)        ((a) + (b))
+#define DTMF_VEC_SUB(a,b)        ((a) - (b))
+#define DTMF_VEC_MUL(a,b)        ((a) * (b))
+#endif
+
 /** Max detected DTMF digits buffer length */
 #define MPF_DTMFDET_BUFFER_LEN  32
 
@@ -36,23 +76,11 @@
 /** See RFC4733 */
 #define DTMF_EVENT_ID_MAX       15  /* 0123456789*#ABCD */
 
-/**
- * Goertzel frequency detector (second-order IIR filter) state:
- *
- * s(t) = x(t) + coef * s(t-1) - s(t-2), where s(0)=0; s(1) = 0;
- * x(t) is the input signal
- *
- * Then energy of frequency f in the signal is:
- * X(f)X'(f) = s(t-2)^2 + s(t-1)^2 - coef*s(t-2)*s(t-1)
- */
-typedef struct goertzel_state_t {
-	/** coef = cos(2*pi*f_tone/f_sampling) */
-	double coef;
-	/** s(t-2) or resulting energy @see goertzel_state_t */
-	double s1;
-	/** s(t-1) @see goertzel_state_t */
-	double s2;
-} goertzel_state_t;
+/** Number of vectors to hold a value per DTMF frequency */
+#define DTMF_VEC_COUNT          (DTMF_FREQUENCIES / DTMF_VEC_LANES)
+
+/** Number of samples transposed at once for the batch processing */
+#define DTMF_BATCH_CHUNK        32
 
 /** DTMF frequencies */
 static const double dtmf_freqs[DTMF_FREQUENCIES] = {
@@ -78,8 +106,21 @@ struct mpf_dtmf_detector_t {
 	apr_size_t                     digits;
 	/** Number of lost digits due to full buffer */
 	apr_size_t                     lost_digits;
-	/** Frequency analyzators */
-	struct goertzel_state_t        energies[DTMF_FREQUENCIES];
+	/**
+	 * Goertzel frequency detectors (second-order IIR filters):
+	 *
+	 * s(t) = x(t) + coef * s(t-1) - s(t-2), where s(0)=0; s(1) = 0;
+	 * x(t) is the input signal
+	 *
+	 * Then energy of frequency f in the signal is:
+	 * X(f)X'(f) = s(t-2)^2 + s(t-1)^2 - coef*s(t-2)*s(t-1)
+	 */
+	/** coef = 2*cos(2*pi*f_tone/f_sampling) */
+	float                          coef[DTMF_FREQUENCIES];
+	/** s(t-2) */
+	float                          s1[DTMF_FREQUENCIES];
+	/** s(t-1) */
+	float                          s2[DTMF_FREQUENCIES];
 	/** Total energy of signal */
 	double                         totenergy;
 	/** Number of samples in a window */
@@ -120,10 +161,10 @@ MPF_DECLARE(struct mpf_dtmf_detector_t *) mpf_dtmf_detector_create_ex(
 	if (det->band & MPF_DTMF_DETECTOR_INBAND) {
 		apr_size_t i;
 		for (i = 0; i < DTMF_FREQUENCIES; i++) {
-			det->energies[i].coef = 2 * cos(2 * M_PI * dtmf_freqs[i] /
-				stream->tx_descriptor->sampling_rate);
-			det->energies[i].s1 = 0;
-			det->energies[i].s2 = 0;
+			det->coef[i] = (float) (2 * cos(2 * M_PI * dtmf_freqs[i] /
+				stream->tx_descriptor->sampling_rate));
+			det->s1[i] = 0;
+			det->s2[i] = 0;
 		}
 		det->nsamples = 0;
 		det->wsamples = GOERTZEL_SAMPLES_8K * (stream->tx_descriptor->sampling_rate / 8000);
@@ -161,6 +202,8 @@ MPF_DECLARE(void) mpf_dtmf_detector_reset(struct mpf_dtmf_detector_t *detector)
 	detector->curr = detector->last1 = detector->last2 = 0;
 	detector->nsamples = 0;
 	detector->totenergy = 0;
+	memset(detector->s1, 0, sizeof(detector->s1));
+	memset(detector->s2, 0, sizeof(detector->s2));
 	apr_thread_mutex_unlock(detector->mutex);
 }
 
@@ -178,19 +221,109 @@ static APR_INLINE void mpf_dtmf_detector_add_digit(
 	apr_thread_mutex_unlock(detector->mutex);
 }
 
-static APR_INLINE void goertzel_sample(
+/** Run the filters of all the frequencies over the samples within a window */
+static void goertzel_samples(
 								struct mpf_dtmf_detector_t *detector,
-								apr_int16_t sample)
+								const apr_int16_t *samples,
+								apr_size_t count)
 {
-	apr_size_t i;
-	double s;
-	for (i = 0; i < DTMF_FREQUENCIES; i++) {
-		s = detector->energies[i].s1;
-		detector->energies[i].s1 = detector->energies[i].s2;
-		detector->energies[i].s2 = sample +
-			detector->energies[i].coef * detector->energies[i].s1 - s;
+	dtmf_vec_t coef[DTMF_VEC_COUNT];
+	dtmf_vec_t s1[DTMF_VEC_COUNT];
+	dtmf_vec_t s2[DTMF_VEC_COUNT];
+	dtmf_vec_t s, x;
+	double totenergy = 0;
+	apr_size_t i, k;
+
+	for (k = 0; k < DTMF_VEC_COUNT; k++) {
+		coef[k] = DTMF_VEC_LOAD(detector->coef + k * DTMF_VEC_LANES);
+		s1[k] = DTMF_VEC_LOAD(detector->s1 + k * DTMF_VEC_LANES);
+		s2[k] = DTMF_VEC_LOAD(detector->s2 + k * DTMF_VEC_LANES);
+	}
+	for (i = 0; i < count; i++) {
+		x = DTMF_VEC_SET1((float) samples[i]);
+		for (k = 0; k < DTMF_VEC_COUNT; k++) {
+			s = s1[k];
+			s1[k] = s2[k];
+			s2[k] = DTMF_VEC_ADD(x, DTMF_VEC_SUB(DTMF_VEC_MUL(coef[k], s1[k]), s));
+		}
+		totenergy += samples[i] * samples[i];
+	}
+	for (k = 0; k < DTMF_VEC_COUNT; k++) {
+		DTMF_VEC_STORE(detector->s1 + k * DTMF_VEC_LANES, s1[k]);
+		DTMF_VEC_STORE(detector->s2 + k * DTMF_VEC_LANES, s2[k]);
+	}
+	detector->totenergy += totenergy;
+}
+
+/**
+ * Run the filters of up to DTMF_VEC_LANES detectors over the samples within
+ * a window, one lane per detector. The states are transposed into
+ * structure-of-arrays form, so every vector holds one frequency of all
+ * the detectors. All the detectors must have the same sampling rate.
+ */
+static void goertzel_batch_samples(
+								struct mpf_dtmf_detector_t **detectors,
+								const apr_int16_t **samples,
+								apr_size_t lanes,
+								apr_size_t offset,
+								apr_size_t count)
+{
+	float s1_soa[DTMF_FREQUENCIES][DTMF_VEC_LANES];
+	float s2_soa[DTMF_FREQUENCIES][DTMF_VEC_LANES];
+	float energy_soa[DTMF_VEC_LANES];
+	float x_soa[DTMF_BATCH_CHUNK][DTMF_VEC_LANES];
+	dtmf_vec_t coef[DTMF_FREQUENCIES];
+	dtmf_vec_t s1[DTMF_FREQUENCIES];
+	dtmf_vec_t s2[DTMF_FREQUENCIES];
+	dtmf_vec_t energy = DTMF_VEC_ZERO();
+	dtmf_vec_t s, x;
+	apr_size_t i, j, k, chunk;
+
+	for (k = 0; k < DTMF_FREQUENCIES; k++) {
+		for (j = 0; j < DTMF_VEC_LANES; j++) {
+			s1_soa[k][j] = j < lanes ? detectors[j]->s1[k] : 0;
+			s2_soa[k][j] = j < lanes ? detectors[j]->s2[k] : 0;
+		}
+		coef[k] = DTMF_VEC_SET1(detectors[0]->coef[k]);
+		s1[k] = DTMF_VEC_LOAD(s1_soa[k]);
+		s2[k] = DTMF_VEC_LOAD(s2_soa[k]);
+	}
+	for (j = lanes; j < DTMF_VEC_LANES; j++) {
+		for (i = 0; i < DTMF_BATCH_CHUNK; i++)
+			x_soa[i][j] = 0;
+	}
+
+	while (count) {
+		chunk = count > DTMF_BATCH_CHUNK ? DTMF_BATCH_CHUNK : count;
+		for (j = 0; j < lanes; j++) {
+			const apr_int16_t *src = samples[j] + offset;
+			for (i = 0; i < chunk; i++)
+				x_soa[i][j] = (float) src[i];
+		}
+		for (i = 0; i < chunk; i++) {
+			x = DTMF_VEC_LOAD(x_soa[i]);
+			for (k = 0; k < DTMF_FREQUENCIES; k++) {
+				s = s1[k];
+				s1[k] = s2[k];
+				s2[k] = DTMF_VEC_ADD(x, DTMF_VEC_SUB(DTMF_VEC_MUL(coef[k], s1[k]), s));
+			}
+			energy = DTMF_VEC_ADD(energy, DTMF_VEC_MUL(x, x));
+		}
+		offset += chunk;
+		count -= chunk;
+	}
+
+	DTMF_VEC_STORE(energy_soa, energy);
+	for (k = 0; k < DTMF_FREQUENCIES; k++) {
+		DTMF_VEC_STORE(s1_soa[k], s1[k]);
+		DTMF_VEC_STORE(s2_soa[k], s2[k]);
+		for (j = 0; j < lanes; j++) {
+			detectors[j]->s1[k] = s1_soa[k][j];
+			detectors[j]->s2[k] = s2_soa[k][j];
+		}
 	}
-	detector->totenergy += sample * sample;
+	for (j = 0; j < lanes; j++)
+		detectors[j]->totenergy += energy_soa[j];
 }
 
 static void goertzel_energies_digit(struct mpf_dtmf_detector_t *detector)
@@ -201,9 +334,9 @@ static void goertzel_energies_digit(struct mpf_dtmf_detector_t *detector)
 
 	/* Calculate energies and maxims */
 	for (i = 0; i < DTMF_FREQUENCIES; i++) {
-		double eng = detector->energies[i].s1 * detector->energies[i].s1 +
-			detector->energies[i].s2 * detector->energies[i].s2 -
-			detector->energies[i].coef * detector->energies[i].s1 * detector->energies[i].s2;
+		double s1 = detector->s1[i];
+		double s2 = detector->s2[i];
+		double eng = s1 * s1 + s2 * s2 - detector->coef[i] * s1 * s2;
 		if (i < DTMF_FREQUENCIES/2) {
 			if (eng > reng) {
 				rmax = i;
@@ -254,13 +387,14 @@ static void goertzel_energies_digit(struct mpf_dtmf_detector_t *detector)
 
 	/* Reset Goertzel's detectors */
 	for (i = 0; i < DTMF_FREQUENCIES; i++) {
-		detector->energies[i].s1 = 0;
-		detector->energies[i].s2 = 0;
+		detector->s1[i] = 0;
+		detector->s2[i] = 0;
 	}
 	detector->totenergy = 0;
 }
 
-MPF_DECLARE(void) mpf_dtmf_detector_get_frame(
+/** Process out-of-band digit, return TRUE if the frame is consumed */
+static apt_bool_t mpf_dtmf_detector_event_process(
 								struct mpf_dtmf_detector_t *detector,
 								const struct mpf_frame_t *frame)
 {
@@ -276,16 +410,61 @@ MPF_DECLARE(void) mpf_dtmf_detector_get_frame(
 		}
 		mpf_dtmf_detector_add_digit(detector, mpf_event_id_to_dtmf_char(
 			frame->event_frame.event_id));
-		return;
+		return TRUE;
+	}
+	return FALSE;
+}
+
+/** Process samples of the detectors in vector lanes, splitting them at window boundaries */
+static void goertzel_batch_process(
+								struct mpf_dtmf_detector_t **detectors,
+								const apr_int16_t **samples,
+								apr_size_t lanes,
+								apr_size_t count)
+{
+	apr_size_t offset = 0;
+	apr_size_t run, left, j;
+
+	while (offset < count) {
+		run = count - offset;
+		for (j = 0; j < lanes; j++) {
+			left = detectors[j]->wsamples - detectors[j]->nsamples;
+			if (left < run) run = left;
+		}
+
+		goertzel_batch_samples(detectors, samples, lanes, offset, run);
+		offset += run;
+
+		for (j = 0; j < lanes; j++) {
+			detectors[j]->nsamples += run;
+			if (detectors[j]->nsamples >= detectors[j]->wsamples) {
+				goertzel_energies_digit(detectors[j]);
+				detectors[j]->nsamples = 0;
+			}
+		}
 	}
+}
+
+MPF_DECLARE(void) mpf_dtmf_detector_get_frame(
+								struct mpf_dtmf_detector_t *detector,
+								const struct mpf_frame_t *frame)
+{
+	if (mpf_dtmf_detector_event_process(detector, frame) == TRUE)
+		return;
 
 	if ((detector->band & MPF_DTMF_DETECTOR_INBAND) && (frame->type & MEDIA_FRAME_TYPE_AUDIO)) {
-		apr_int16_t *samples = frame->codec_frame.buffer;
-		apr_size_t i;
+		const apr_int16_t *samples = frame->codec_frame.buffer;
+		apr_size_t count = frame->codec_frame.size / 2;
+		apr_size_t run;
 
-		for (i = 0; i < frame->codec_frame.size / 2; i++) {
-			goertzel_sample(detector, samples[i]);
-			if (++detector->nsamples >= detector->wsamples) {
+		while (count) {
+			run = detector->wsamples - detector->nsamples;
+			if (run > count) run = count;
+			goertzel_samples(detector, samples, run);
+			samples += run;
+			count -= run;
+			detector->nsamples += run;
+			if (detector->nsamples >= detector->wsamples) {
 				goertzel_energies_digit(detector);
 				detector->nsamples = 0;
 			}
@@ -293,6 +472,50 @@ MPF_DECLARE(void) mpf_dtmf_detector_get_frame(
 	}
 }
 
+MPF_DECLARE(void) mpf_dtmf_detector_get_frames(
+								struct mpf_dtmf_detector_t **detectors,
+								const struct mpf_frame_t **frames,
+								apr_size_t count)
+{
+	struct mpf_dtmf_detector_t *lane_detectors[DTMF_VEC_LANES];
+	const apr_int16_t *lane_samples[DTMF_VEC_LANES];
+	apr_size_t lanes = 0;
+	apr_size_t lane_count = 0;
+	apr_size_t samples;
+	apr_size_t i;
+
+	for (i = 0; i < count; i++) {
+		struct mpf_dtmf_detector_t *detector = detectors[i];
+		const struct mpf_frame_t *frame = frames[i];
+		if (!detector || !frame) continue;
+
+		if (mpf_dtmf_detector_event_process(detector, frame) == TRUE)
+			continue;
+		if (!(detector->band & MPF_DTMF_DETECTOR_INBAND) || !(frame->type & MEDIA_FRAME_TYPE_AUDIO))
+			continue;
+
+		/* lanes are filled by frames of the same length and sampling rate */
+		samples = frame->codec_frame.size / 2;
+		if (lanes && (samples != lane_count || detector->wsamples != lane_detectors[0]->wsamples ||
+			detector->coef[0] != lane_detectors[0]->coef[0]))
+		{
+			goertzel_batch_process(lane_detectors, lane_samples, lanes, lane_count);
+			lanes = 0;
+		}
+
+		lane_detectors[lanes] = detector;
+		lane_samples[lanes] = frame->codec_frame.buffer;
+		lane_count = samples;
+		if (++lanes == DTMF_VEC_LANES) {
+			goertzel_batch_process(lane_detectors, lane_samples, lanes, lane_count);
+			lanes = 0;
+		}
+	}
+
+	if (lanes)
+		goertzel_batch_process(lane_detectors, lane_samples, lanes, lane_count);
+}
+
 MPF_DECLARE(void) mpf_dtmf_detector_destroy(struct mpf_dtmf_detector_t *detector)
 {
 	apr_thread_mutex_destroy(detector->mutex);
@@ -21,21 +21,35 @@
 #include "mpf_scheduler.h"
 #include "mpf_codec_descriptor.h"
 #include "mpf_codec_manager.h"
+#include "mpf_rtp_poller.h"
+#include "mpf_rtp_sender.h"
 #include "apt_obj_list.h"
-#include "apt_cyclic_queue.h"
+#include "apt_mpsc_queue.h"
 #include "apt_log.h"
 
-#define MPF_TIMER_RESOLUTION 100 /* 100 ms */
+#define MPF_TIMER_RESOLUTION   100 /* 100 ms */
+#define MPF_RTP_POLLER_SIZE    1024
+#define MPF_REQUEST_QUEUE_SIZE 4096
+
+/** Media processing worker (thread), which owns a shard of media contexts */
+typedef struct mpf_engine_worker_t mpf_engine_worker_t;
+
+struct mpf_engine_worker_t {
+	mpf_engine_t              *engine;
+	apt_mpsc_queue_t          *request_queue;
+	mpf_context_factory_t     *context_factory;
+	mpf_scheduler_t           *scheduler;
+	apt_timer_queue_t         *timer_queue;
+	mpf_rtp_poller_t          *rtp_poller;
+};
 
 struct mpf_engine_t {
 	apr_pool_t                *pool;
 	apt_task_t                *task;
 	apt_task_msg_type_e        task_msg_type;
-	apr_thread_mutex_t        *request_queue_guard;
-	apt_cyclic_queue_t        *request_queue;
-	mpf_context_factory_t     *context_factory;
-	mpf_scheduler_t           *scheduler;
-	apt_timer_queue_t         *timer_queue;
+	mpf_engine_worker_t       *workers;
+	apr_size_t                 worker_count;
+	apr_size_t                 rtp_batch_size;
 	const mpf_codec_manager_t *codec_manager;
 };
 
@@ -59,17 +73,29 @@ APT_LOG_SOURCE_IMPLEMENT(MPF,mpf_log_source,"MPF")
 
 MPF_DECLARE(mpf_engine_t*) mpf_engine_create(const char *id, apr_pool_t *pool)
 {
+	return mpf_engine_create_ex(id,1,pool);
+}
+
+MPF_DECLARE(mpf_engine_t*) mpf_engine_create_ex(const char *id, apr_size_t worker_count, apr_pool_t *pool)
+{
+	apr_size_t i;
+	mpf_engine_worker_t *worker;
 	apt_task_vtable_t *vtable;
 	apt_task_msg_pool_t *msg_pool;
 	mpf_engine_t *engine = apr_palloc(pool,sizeof(mpf_engine_t));
 	engine->pool = pool;
-	engine->request_queue = NULL;
-	engine->context_factory = NULL;
 	engine->codec_manager = NULL;
 
+	if(!worker_count) {
+		worker_count = 1;
+	}
+	engine->worker_count = worker_count;
+	engine->rtp_batch_size = 0;
+	engine->workers = apr_palloc(pool,sizeof(mpf_engine_worker_t) * worker_count);
+
 	msg_pool = apt_task_msg_pool_create_dynamic(sizeof(mpf_message_container_t),pool);
 
-	apt_log(MPF_LOG_MARK,APT_PRIO_NOTICE,"Create Media Engine [%s]",id);
+	apt_log(MPF_LOG_MARK,APT_PRIO_NOTICE,"Create Media Engine [%s] workers [%"APR_SIZE_T_FMT"]",id,worker_count);
 	engine->task = apt_task_create(engine,msg_pool,pool);
 	if(!engine->task) {
 		return NULL;
@@ -88,18 +114,77 @@ MPF_DECLARE(mpf_engine_t*) mpf_engine_create(const char *id, apr_pool_t *pool)
 
 	engine->task_msg_type = TASK_MSG_USER;
 
-	engine->context_factory = mpf_context_factory_create(engine->pool);
-	engine->request_queue = apt_cyclic_queue_create(CYCLIC_QUEUE_DEFAULT_SIZE);
-	apr_thread_mutex_create(&engine->request_queue_guard,APR_THREAD_MUTEX_UNNESTED,engine->pool);
+	for(i=0; i<worker_count; i++) {
+		worker = &engine->workers[i];
+		worker->engine = engine;
+		worker->context_factory = mpf_context_factory_create(engine->pool);
+		worker->request_queue = apt_mpsc_queue_create(MPF_REQUEST_QUEUE_SIZE,engine->pool);
 
-	engine->scheduler = mpf_scheduler_create(engine->pool);
-	mpf_scheduler_media_clock_set(engine->scheduler,CODEC_FRAME_TIME_BASE,mpf_engine_main,engine);
+		worker->scheduler = mpf_scheduler_create(engine->pool);
+		mpf_scheduler_media_clock_set(worker->scheduler,CODEC_FRAME_TIME_BASE,mpf_engine_main,worker);
 
-	engine->timer_queue = apt_timer_queue_create(engine->pool);
-	mpf_scheduler_timer_clock_set(engine->scheduler,MPF_TIMER_RESOLUTION,mpf_engine_timer_proc,engine);
+		worker->timer_queue = apt_timer_queue_create(engine->pool);
+		mpf_scheduler_timer_clock_set(worker->scheduler,MPF_TIMER_RESOLUTION,mpf_engine_timer_proc,worker);
+
+		worker->rtp_poller = NULL;
+	}
 	return engine;
 }
 
+MPF_DECLARE(apt_bool_t) mpf_engine_rtp_poller_enable(mpf_engine_t *engine)
+{
+	apr_size_t i;
+	mpf_engine_worker_t *worker;
+	for(i=0; i<engine->worker_count; i++) {
+		worker = &engine->workers[i];
+		if(worker->rtp_poller) {
+			continue;
+		}
+		worker->rtp_poller = mpf_rtp_poller_create(MPF_RTP_POLLER_SIZE,engine->pool);
+		if(!worker->rtp_poller) {
+			return FALSE;
+		}
+	}
+	apt_log(MPF_LOG_MARK,APT_PRIO_INFO,"Enable RTP Poller [%s]",apt_task_name_get(engine->task));
+	return TRUE;
+}
+
+MPF_DECLARE(apt_bool_t) mpf_engine_rtp_sender_enable(mpf_engine_t *engine, apr_size_t batch_size)
+{
+	if(batch_size < 2) {
+		engine->rtp_batch_size = 0;
+		return FALSE;
+	}
+	if(mpf_rtp_sender_is_supported() == FALSE) {
+		apt_log(MPF_LOG_MARK,APT_PRIO_WARNING,"RTP Batch Sender Not Supported [%s]",apt_task_name_get(engine->task));
+		engine->rtp_batch_size = 0;
+		return FALSE;
+	}
+	engine->rtp_batch_size = batch_size;
+	apt_log(MPF_LOG_MARK,APT_PRIO_INFO,"Enable RTP Batch Sender [%s] packets [%"APR_SIZE_T_FMT"]",
+		apt_task_name_get(engine->task),
+		batch_size);
+	return TRUE;
+}
+
+/** Find the worker the specified context is processed by */
+static mpf_engine_worker_t* mpf_engine_worker_find(const mpf_engine_t *engine, const mpf_context_t *context)
+{
+	apr_size_t i;
+	mpf_context_factory_t *context_factory;
+	if(engine->worker_count == 1 || !context) {
+		return &engine->workers[0];
+	}
+
+	context_factory = mpf_context_factory_get(context);
+	for(i=0; i<engine->worker_count; i++) {
+		if(engine->workers[i].context_factory == context_factory) {
+			return &engine->workers[i];
+		}
+	}
+	return &engine->workers[0];
+}
+
 MPF_DECLARE(mpf_context_t*) mpf_engine_context_create(
 								mpf_engine_t *engine,
 								const char *name,
@@ -107,7 +192,20 @@ MPF_DECLARE(mpf_context_t*) mpf_engine_context_create(
 								apr_size_t max_termination_count,
 								apr_pool_t *pool)
 {
-	return mpf_context_create(engine->context_factory,name,obj,max_termination_count,pool);
+	apr_size_t i;
+	apr_size_t load;
+	mpf_engine_worker_t *worker = &engine->workers[0];
+	apr_size_t min_load = mpf_context_factory_load_get(worker->context_factory);
+
+	/* assign new context to the least loaded worker */
+	for(i=1; i<engine->worker_count && min_load; i++) {
+		load = mpf_context_factory_load_get(engine->workers[i].context_factory);
+		if(load < min_load) {
+			min_load = load;
+			worker = &engine->workers[i];
+		}
+	}
+	return mpf_context_create(worker->context_factory,name,obj,max_termination_count,pool);
 }
 
 MPF_DECLARE(apt_bool_t) mpf_engine_context_destroy(mpf_context_t *context)
@@ -228,30 +326,42 @@ MPF_DECLARE(apt_bool_t) mpf_engine_message_send(mpf_engine_t *engine, mpf_task_m
 
 static apt_bool_t mpf_engine_destroy(apt_task_t *task)
 {
+	apr_size_t i;
+	mpf_engine_worker_t *worker;
 	mpf_engine_t *engine = apt_task_object_get(task);
 
-	apt_timer_queue_destroy(engine->timer_queue);
-	mpf_scheduler_destroy(engine->scheduler);
-	mpf_context_factory_destroy(engine->context_factory);
-	apt_cyclic_queue_destroy(engine->request_queue);
-	apr_thread_mutex_destroy(engine->request_queue_guard);
+	for(i=0; i<engine->worker_count; i++) {
+		worker = &engine->workers[i];
+		if(worker->rtp_poller) {
+			mpf_rtp_poller_destroy(worker->rtp_poller);
+		}
+		apt_timer_queue_destroy(worker->timer_queue);
+		mpf_scheduler_destroy(worker->scheduler);
+		mpf_context_factory_destroy(worker->context_factory);
+	}
 	return TRUE;
 }
 
 static apt_bool_t mpf_engine_start(apt_task_t *task)
 {
+	apr_size_t i;
 	mpf_engine_t *engine = apt_task_object_get(task);
 
-	mpf_scheduler_start(engine->scheduler);
+	for(i=0; i<engine->worker_count; i++) {
+		mpf_scheduler_start(engine->workers[i].scheduler);
+	}
 	apt_task_start_request_process(task);
 	return TRUE;
 }
 
 static apt_bool_t mpf_engine_terminate(apt_task_t *task)
 {
+	apr_size_t i;
 	mpf_engine_t *engine = apt_task_object_get(task);
 
-	mpf_scheduler_stop(engine->scheduler);
+	for(i=0; i<engine->worker_count; i++) {
+		mpf_scheduler_stop(engine->workers[i].scheduler);
+	}
 	apt_task_terminate_request_process(task);
 	return TRUE;
 }
@@ -289,12 +399,21 @@ static apt_bool_t mpf_engine_event_raise(mpf_termination_t *termination, int eve
 static apt_bool_t mpf_engine_msg_signal(apt_task_t *task, apt_task_msg_t *msg)
 {
 	mpf_engine_t *engine = apt_task_object_get(task);
-	
-	apr_thread_mutex_lock(engine->request_queue_guard);
-	if(apt_cyclic_queue_push(engine->request_queue,msg) == FALSE) {
+	mpf_engine_worker_t *worker = &engine->workers[0];
+
+	if(msg->type != TASK_MSG_CORE) {
+		/* requests accumulated in a task message belong to the same context,
+		route them to the worker the context is assigned to */
+		const mpf_message_container_t *request = (const mpf_message_container_t*) msg->data;
+		if(request->count) {
+			worker = mpf_engine_worker_find(engine,request->messages[0].context);
+		}
+	}
+
+	if(apt_mpsc_queue_push(worker->request_queue,msg) == FALSE) {
 		apt_log(MPF_LOG_MARK,APT_PRIO_ERROR,"MPF Request Queue is Full [%s]",apt_task_name_get(task));
+		return FALSE;
 	}
-	apr_thread_mutex_unlock(engine->request_queue_guard);
 	return TRUE;
 }
 
@@ -333,10 +452,13 @@ static apt_bool_t mpf_engine_msg_process(apt_task_t *task, apt_task_msg_t *msg)
 		switch(mpf_request->command_id) {
 			case MPF_ADD_TERMINATION:
 			{
+				mpf_engine_worker_t *worker = mpf_engine_worker_find(engine,context);
 				termination->media_engine = engine;
 				termination->event_handler = mpf_engine_event_raise;
 				termination->codec_manager = engine->codec_manager;
-				termination->timer_queue = engine->timer_queue;
+				termination->timer_queue = worker->timer_queue;
+				termination->rtp_poller = worker->rtp_poller;
+				termination->rtp_batch_size = engine->rtp_batch_size;
 
 				mpf_termination_add(termination,mpf_request->descriptor);
 				if(mpf_context_termination_add(context,termination) == FALSE) {
@@ -397,28 +519,29 @@ static apt_bool_t mpf_engine_msg_process(apt_task_t *task, apt_task_msg_t *msg)
 
 static void mpf_engine_main(mpf_scheduler_t *scheduler, void *obj)
 {
-	mpf_engine_t *engine = obj;
+	mpf_engine_worker_t *worker = obj;
 	apt_task_msg_t *msg;
 
 	/* process request queue */
-	apr_thread_mutex_lock(engine->request_queue_guard);
-	msg = apt_cyclic_queue_pop(engine->request_queue);
+	msg = apt_mpsc_queue_pop(worker->request_queue);
 	while(msg) {
-		apr_thread_mutex_unlock(engine->request_queue_guard);
-		apt_task_msg_process(engine->task,msg);
-		apr_thread_mutex_lock(engine->request_queue_guard);
-		msg = apt_cyclic_queue_pop(engine->request_queue);
+		apt_task_msg_process(worker->engine->task,msg);
+		msg = apt_mpsc_queue_pop(worker->request_queue);
+	}
+
+	/* receive RTP packets from the ready sockets */
+	if(worker->rtp_poller) {
+		mpf_rtp_poller_process(worker->rtp_poller);
 	}
-	apr_thread_mutex_unlock(engine->request_queue_guard);
 
 	/* process factory of media contexts */
-	mpf_context_factory_process(engine->context_factory);
+	mpf_context_factory_process(worker->context_factory);
 }
 
 static void mpf_engine_timer_proc(mpf_scheduler_t *scheduler, void *obj)
 {
-	mpf_engine_t *engine = obj;
-	apt_timer_queue_advance(engine->timer_queue,MPF_TIMER_RESOLUTION);
+	mpf_engine_worker_t *worker = obj;
+	apt_timer_queue_advance(worker->timer_queue,MPF_TIMER_RESOLUTION);
 }
 
 MPF_DECLARE(mpf_codec_manager_t*) mpf_engine_codec_manager_create(apr_pool_t *pool)
@@ -455,10 +578,19 @@ MPF_DECLARE(apt_bool_t) mpf_engine_codec_manager_register(mpf_engine_t *engine,
 
 MPF_DECLARE(apt_bool_t) mpf_engine_scheduler_rate_set(mpf_engine_t *engine, unsigned long rate)
 {
-	return mpf_scheduler_rate_set(engine->scheduler,rate);
+	apr_size_t i;
+	for(i=0; i<engine->worker_count; i++) {
+		mpf_scheduler_rate_set(engine->workers[i].scheduler,rate);
+	}
+	return TRUE;
 }
 
 MPF_DECLARE(const char*) mpf_engine_id_get(const mpf_engine_t *engine)
 {
 	return apt_task_name_get(engine->task);
 }
+
+MPF_DECLARE(apr_size_t) mpf_engine_worker_count_get(const mpf_engine_t *engine)
+{
+	return engine->worker_count;
+}
@@ -14,19 +14,32 @@
  * limitations under the License.
  */
 
+#include <apr_atomic.h>
 #include "mpf_frame_buffer.h"
 
+/*
+ * The positions are free running counters, the writer owns write_pos and
+ * the reader owns read_pos. Each side reads the position of the other one
+ * and publishes its own by an atomic operation, which orders the accesses
+ * to the frame slots, thus neither side ever waits for the other.
+ *
+ * On restart the writer may not move read_pos, so it publishes restart_pos
+ * and reuses the slots before it at once. The reader skips to restart_pos and
+ * drops a frame it was copying while the restart took place, since the slot
+ * may have been overwritten meanwhile.
+ */
 struct mpf_frame_buffer_t {
-	apr_byte_t         *raw_data;
-	mpf_frame_t        *frames;
-	apr_size_t          frame_count;
-	apr_size_t          frame_size;
+	apr_byte_t           *raw_data;
+	mpf_frame_t          *frames;
+	apr_size_t            frame_count;
+	apr_size_t            frame_size;
 
-	apr_size_t          write_pos;
-	apr_size_t          read_pos;
+	volatile apr_uint32_t write_pos;
+	volatile apr_uint32_t read_pos;
+	/** Position the reader skips to, set by the writer on restart */
+	volatile apr_uint32_t restart_pos;
 
-	apr_thread_mutex_t *guard;
-	apr_pool_t         *pool;
+	apr_pool_t           *pool;
 
 #ifdef MPF_FRAME_BUFFER_DEBUG
 	FILE               *utt_in;
@@ -53,8 +66,7 @@ mpf_frame_buffer_t* mpf_frame_buffer_create(apr_size_t frame_size, apr_size_t fr
 		frame->codec_frame.buffer = buffer->raw_data + i*buffer->frame_size;
 	}
 
-	buffer->write_pos = buffer->read_pos = 0;
-	apr_thread_mutex_create(&buffer->guard,APR_THREAD_MUTEX_UNNESTED,pool);
+	buffer->write_pos = buffer->read_pos = buffer->restart_pos = 0;
 
 #ifdef MPF_FRAME_BUFFER_DEBUG
 	buffer->utt_in = NULL;
@@ -95,24 +107,55 @@ apt_bool_t mpf_frame_buffer_file_open(mpf_frame_buffer_t *buffer, const char *ut
 
 void mpf_frame_buffer_destroy(mpf_frame_buffer_t *buffer)
 {
-	if(buffer->guard) {
-		apr_thread_mutex_destroy(buffer->guard);
-		buffer->guard = NULL;
-	}
 }
 
 apt_bool_t mpf_frame_buffer_restart(mpf_frame_buffer_t *buffer)
 {
-	buffer->write_pos = buffer->read_pos;
+	/* the frames written so far are dropped by the reader on its next read,
+	since the writer may not move the position of the reader */
+	apr_atomic_xchg32(&buffer->restart_pos,buffer->write_pos);
 	return TRUE;
 }
 
-static APR_INLINE mpf_frame_t* mpf_frame_buffer_frame_get(mpf_frame_buffer_t *buffer, apr_size_t pos)
+static APR_INLINE mpf_frame_t* mpf_frame_buffer_frame_get(mpf_frame_buffer_t *buffer, apr_uint32_t pos)
 {
 	apr_size_t index = pos % buffer->frame_count;
 	return &buffer->frames[index];
 }
 
+mpf_frame_t* mpf_frame_buffer_frame_acquire(mpf_frame_buffer_t *buffer)
+{
+	mpf_frame_t *frame;
+	apr_uint32_t read_pos = apr_atomic_read32(&buffer->read_pos);
+	if((apr_int32_t)(buffer->restart_pos - read_pos) > 0) {
+		/* the frames written before restart are free, even if the reader has not skipped them yet */
+		read_pos = buffer->restart_pos;
+	}
+	if(buffer->write_pos - read_pos >= buffer->frame_count) {
+		/* buffer is full */
+		return NULL;
+	}
+
+	frame = mpf_frame_buffer_frame_get(buffer,buffer->write_pos);
+	frame->type = MEDIA_FRAME_TYPE_NONE;
+	frame->marker = MPF_MARKER_NONE;
+	frame->codec_frame.size = buffer->frame_size;
+	return frame;
+}
+
+apt_bool_t mpf_frame_buffer_frame_commit(mpf_frame_buffer_t *buffer)
+{
+#ifdef MPF_FRAME_BUFFER_DEBUG
+	if(buffer->utt_in) {
+		mpf_frame_t *frame = mpf_frame_buffer_frame_get(buffer,buffer->write_pos);
+		fwrite(frame->codec_frame.buffer,1,frame->codec_frame.size,buffer->utt_in);
+	}
+#endif
+	/* publish the frame to the reader */
+	apr_atomic_inc32(&buffer->write_pos);
+	return TRUE;
+}
+
 apt_bool_t mpf_frame_buffer_write(mpf_frame_buffer_t *buffer, const mpf_frame_t *frame)
 {
 	mpf_frame_t *write_frame;
@@ -125,11 +168,13 @@ apt_bool_t mpf_frame_buffer_write(mpf_frame_buffer_t *buffer, const mpf_frame_t
 	}
 #endif
 
-	apr_thread_mutex_lock(buffer->guard);
-	while(buffer->write_pos - buffer->read_pos < buffer->frame_count && size >= buffer->frame_size) {
-		write_frame = mpf_frame_buffer_frame_get(buffer,buffer->write_pos);
+	while(size >= buffer->frame_size) {
+		write_frame = mpf_frame_buffer_frame_acquire(buffer);
+		if(!write_frame) {
+			/* buffer is full */
+			break;
+		}
 		write_frame->type = frame->type;
-		write_frame->codec_frame.size = buffer->frame_size;
 		memcpy(
 			write_frame->codec_frame.buffer,
 			data,
@@ -137,18 +182,22 @@ apt_bool_t mpf_frame_buffer_write(mpf_frame_buffer_t *buffer, const mpf_frame_t
 
 		data = (char*)data + buffer->frame_size;
 		size -= buffer->frame_size;
-		buffer->write_pos ++;
+		apr_atomic_inc32(&buffer->write_pos);
 	}
 
-	apr_thread_mutex_unlock(buffer->guard);
 	/* if size != 0 => non frame alligned or buffer is full */
 	return size == 0 ? TRUE : FALSE;
 }
 
 apt_bool_t mpf_frame_buffer_read(mpf_frame_buffer_t *buffer, mpf_frame_t *media_frame)
 {
-	apr_thread_mutex_lock(buffer->guard);
-	if(buffer->write_pos > buffer->read_pos) {
+	apr_uint32_t restart_pos = apr_atomic_read32(&buffer->restart_pos);
+	if((apr_int32_t)(restart_pos - buffer->read_pos) > 0) {
+		/* drop the frames written before restart */
+		apr_atomic_set32(&buffer->read_pos,restart_pos);
+	}
+
+	if(apr_atomic_read32(&buffer->write_pos) != buffer->read_pos) {
 		/* normal read */
 		mpf_frame_t *src_media_frame = mpf_frame_buffer_frame_get(buffer,buffer->read_pos);
 		media_frame->type = src_media_frame->type;
@@ -168,15 +217,21 @@ apt_bool_t mpf_frame_buffer_read(mpf_frame_buffer_t *buffer, mpf_frame_t *media_
 		if(media_frame->type & MEDIA_FRAME_TYPE_EVENT) {
 			media_frame->event_frame = src_media_frame->event_frame;
 		}
-		src_media_frame->type = MEDIA_FRAME_TYPE_NONE;
-		src_media_frame->marker = MPF_MARKER_NONE;
-		buffer->read_pos ++;
+
+		/* the slot is not modified by the reader, the writer resets it on acquire */
+		if(apr_atomic_cas32(&buffer->restart_pos,restart_pos,restart_pos) != restart_pos) {
+			/* restarted while the frame was copied, the slot may have been reused */
+			media_frame->type = MEDIA_FRAME_TYPE_NONE;
+			media_frame->marker = MPF_MARKER_NONE;
+			return TRUE;
+		}
+		/* release the frame slot to the writer */
+		apr_atomic_inc32(&buffer->read_pos);
 	}
 	else {
 		/* underflow */
 		media_frame->type = MEDIA_FRAME_TYPE_NONE;
 		media_frame->marker = MPF_MARKER_NONE;
 	}
-	apr_thread_mutex_unlock(buffer->guard);
 	return TRUE;
 }
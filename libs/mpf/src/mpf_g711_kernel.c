@@ -0,0 +1,495 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mpf_g711_kernel.h"
+#include "g711/g711.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+/** Build SSE2 kernel (SSE2 is a part of the baseline instruction set of the target) */
+#define MPF_G711_SSE2
+#endif
+
+#if defined(MPF_G711_SSE2) && (defined(__clang__) || \
+	(defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))) || \
+	(defined(_MSC_VER) && _MSC_VER >= 1800))
+#include <immintrin.h>
+/** Build AVX2 kernel (used only if supported by the CPU at run-time) */
+#define MPF_G711_AVX2
+#if defined(__GNUC__)
+#define MPF_G711_AVX2_TARGET __attribute__((target("avx2")))
+#else
+#include <intrin.h>
+#define MPF_G711_AVX2_TARGET
+#endif
+#endif
+
+/** Number of entries in the encode tables (all 16-bit linear samples) */
+#define G711_ENCODE_TABLE_SIZE 65536
+/** Number of entries in the decode tables (all 8-bit encoded samples) */
+#define G711_DECODE_TABLE_SIZE 256
+
+static apr_byte_t  ulaw_encode_table[G711_ENCODE_TABLE_SIZE];
+static apr_byte_t  alaw_encode_table[G711_ENCODE_TABLE_SIZE];
+static apr_int16_t ulaw_decode_table[G711_DECODE_TABLE_SIZE];
+static apr_int16_t alaw_decode_table[G711_DECODE_TABLE_SIZE];
+static volatile apt_bool_t g711_tables_initialized = FALSE;
+
+/** Fill the tables, the result of concurrent calls is the same */
+static void mpf_g711_tables_init(void)
+{
+	apr_size_t i;
+	if(g711_tables_initialized == TRUE) {
+		return;
+	}
+
+	for(i=0; i<G711_ENCODE_TABLE_SIZE; i++) {
+		ulaw_encode_table[i] = linear_to_ulaw((apr_int16_t)i);
+		alaw_encode_table[i] = linear_to_alaw((apr_int16_t)i);
+	}
+	for(i=0; i<G711_DECODE_TABLE_SIZE; i++) {
+		ulaw_decode_table[i] = ulaw_to_linear((apr_byte_t)i);
+		alaw_decode_table[i] = alaw_to_linear((apr_byte_t)i);
+	}
+	g711_tables_initialized = TRUE;
+}
+
+
+static void scalar_ulaw_encode(const apr_int16_t *linear, apr_byte_t *encoded, apr_size_t count)
+{
+	apr_size_t i;
+	for(i=0; i<count; i++) {
+		encoded[i] = linear_to_ulaw(linear[i]);
+	}
+}
+
+static void scalar_ulaw_decode(const apr_byte_t *encoded, apr_int16_t *linear, apr_size_t count)
+{
+	apr_size_t i;
+	for(i=0; i<count; i++) {
+		linear[i] = ulaw_to_linear(encoded[i]);
+	}
+}
+
+static void scalar_alaw_encode(const apr_int16_t *linear, apr_byte_t *encoded, apr_size_t count)
+{
+	apr_size_t i;
+	for(i=0; i<count; i++) {
+		encoded[i] = linear_to_alaw(linear[i]);
+	}
+}
+
+static void scalar_alaw_decode(const apr_byte_t *encoded, apr_int16_t *linear, apr_size_t count)
+{
+	apr_size_t i;
+	for(i=0; i<count; i++) {
+		linear[i] = alaw_to_linear(encoded[i]);
+	}
+}
+
+
+static void lut_ulaw_encode(const apr_int16_t *linear, apr_byte_t *encoded, apr_size_t count)
+{
+	apr_size_t i;
+	for(i=0; i<count; i++) {
+		encoded[i] = ulaw_encode_table[(apr_uint16_t)linear[i]];
+	}
+}
+
+static void lut_ulaw_decode(const apr_byte_t *encoded, apr_int16_t *linear, apr_size_t count)
+{
+	apr_size_t i;
+	for(i=0; i<count; i++) {
+		linear[i] = ulaw_decode_table[encoded[i]];
+	}
+}
+
+static void lut_alaw_encode(const apr_int16_t *linear, apr_byte_t *encoded, apr_size_t count)
+{
+	apr_size_t i;
+	for(i=0; i<count; i++) {
+		encoded[i] = alaw_encode_table[(apr_uint16_t)linear[i]];
+	}
+}
+
+static void lut_alaw_decode(const apr_byte_t *encoded, apr_int16_t *linear, apr_size_t count)
+{
+	apr_size_t i;
+	for(i=0; i<count; i++) {
+		linear[i] = alaw_decode_table[encoded[i]];
+	}
+}
+
+
+/*
+ * The vectorized kernels operate on 16-bit lanes and follow the scalar
+ * routines of g711.h bit by bit.
+ *  - The segment (position of the leading one) is found by comparing
+ *    the magnitude against the 7 segment boundaries.
+ *  - Variable shifts, which SSE2/AVX2 lack for 16-bit lanes, are done by
+ *    multiplication: x >> s is the high word of x * 2^(16-s) and
+ *    x << s is the low word of x * 2^s.
+ */
+
+#ifdef MPF_G711_SSE2
+/** Get 2^e of e in the range [0..7] */
+static APR_INLINE __m128i sse2_pow2(__m128i e)
+{
+	const __m128i one = _mm_set1_epi16(1);
+	__m128i b0 = _mm_and_si128(e,one);
+	__m128i b1 = _mm_and_si128(_mm_srli_epi16(e,1),one);
+	__m128i b2 = _mm_and_si128(_mm_srli_epi16(e,2),one);
+	/* (1 + b0) * (1 + 3*b1) * (1 + 15*b2) */
+	__m128i f0 = _mm_add_epi16(one,b0);
+	__m128i f1 = _mm_add_epi16(one,_mm_sub_epi16(_mm_slli_epi16(b1,2),b1));
+	__m128i f2 = _mm_add_epi16(one,_mm_sub_epi16(_mm_slli_epi16(b2,4),b2));
+	return _mm_mullo_epi16(_mm_mullo_epi16(f0,f1),f2);
+}
+
+/** Count a segment boundary of m and scale the multiplier accordingly */
+static APR_INLINE void sse2_segment_step(__m128i m, short bound, short step, __m128i *seg, __m128i *mul)
+{
+	__m128i gt = _mm_cmpgt_epi16(m,_mm_set1_epi16(bound));
+	*seg = _mm_sub_epi16(*seg,gt);
+	*mul = _mm_sub_epi16(*mul,_mm_and_si128(gt,_mm_set1_epi16(step)));
+}
+
+/** Get (seg << 4) | ((m >> shift) & 0xF), where shift is given by mul of the first segment */
+static APR_INLINE __m128i sse2_segment_quantize(__m128i m, short mul0, short step0)
+{
+	__m128i seg = _mm_setzero_si128();
+	__m128i mul = _mm_set1_epi16(mul0);
+	sse2_segment_step(m,0x00FF,step0,&seg,&mul);
+	sse2_segment_step(m,0x01FF,0x0800,&seg,&mul);
+	sse2_segment_step(m,0x03FF,0x0400,&seg,&mul);
+	sse2_segment_step(m,0x07FF,0x0200,&seg,&mul);
+	sse2_segment_step(m,0x0FFF,0x0100,&seg,&mul);
+	sse2_segment_step(m,0x1FFF,0x0080,&seg,&mul);
+	sse2_segment_step(m,0x3FFF,0x0040,&seg,&mul);
+	return _mm_or_si128(_mm_slli_epi16(seg,4),_mm_and_si128(_mm_mulhi_epu16(m,mul),_mm_set1_epi16(0x0F)));
+}
+
+static APR_INLINE __m128i sse2_linear_to_ulaw(__m128i x)
+{
+	__m128i sign = _mm_srai_epi16(x,15);
+	__m128i m;
+
+	/* biased magnitude, clipped to 0x7FFF (the same code as seg >= 8 in g711.h) */
+	m = _mm_min_epi16(_mm_xor_si128(x,sign),_mm_set1_epi16(0x7FFF - ULAW_BIAS));
+	m = _mm_add_epi16(m,_mm_set1_epi16(ULAW_BIAS));
+	/* shift is seg + 3 */
+	m = sse2_segment_quantize(m,0x2000,0x1000);
+	return _mm_xor_si128(m,_mm_xor_si128(_mm_set1_epi16(0xFF),_mm_and_si128(sign,_mm_set1_epi16(0x80))));
+}
+
+static APR_INLINE __m128i sse2_linear_to_alaw(__m128i x)
+{
+	__m128i sign = _mm_srai_epi16(x,15);
+	__m128i m;
+
+	/* shift is seg ? seg + 3 : 4 */
+	m = sse2_segment_quantize(_mm_xor_si128(x,sign),0x1000,0);
+	return _mm_xor_si128(m,_mm_xor_si128(_mm_set1_epi16(ALAW_AMI_MASK | 0x80),_mm_and_si128(sign,_mm_set1_epi16(0x80))));
+}
+
+static APR_INLINE __m128i sse2_ulaw_to_linear(__m128i u)
+{
+	__m128i t;
+	__m128i neg;
+
+	u = _mm_xor_si128(u,_mm_set1_epi16(0xFF));
+	t = _mm_add_epi16(_mm_slli_epi16(_mm_and_si128(u,_mm_set1_epi16(0x0F)),3),_mm_set1_epi16(ULAW_BIAS));
+	t = _mm_mullo_epi16(t,sse2_pow2(_mm_srli_epi16(_mm_and_si128(u,_mm_set1_epi16(0x70)),4)));
+	t = _mm_sub_epi16(t,_mm_set1_epi16(ULAW_BIAS));
+	/* negate if the sign bit is set */
+	neg = _mm_cmpgt_epi16(u,_mm_set1_epi16(0x7F));
+	return _mm_sub_epi16(_mm_xor_si128(t,neg),neg);
+}
+
+static APR_INLINE __m128i sse2_alaw_to_linear(__m128i a)
+{
+	__m128i i;
+	__m128i seg;
+	__m128i neg;
+
+	a = _mm_xor_si128(a,_mm_set1_epi16(ALAW_AMI_MASK));
+	seg = _mm_srli_epi16(_mm_and_si128(a,_mm_set1_epi16(0x70)),4);
+	/* seg ? (i + 0x108) << (seg - 1) : i + 8 */
+	i = _mm_add_epi16(_mm_slli_epi16(_mm_and_si128(a,_mm_set1_epi16(0x0F)),4),_mm_set1_epi16(8));
+	i = _mm_add_epi16(i,_mm_and_si128(_mm_cmpgt_epi16(seg,_mm_setzero_si128()),_mm_set1_epi16(0x100)));
+	seg = _mm_max_epi16(_mm_sub_epi16(seg,_mm_set1_epi16(1)),_mm_setzero_si128());
+	i = _mm_mullo_epi16(i,sse2_pow2(seg));
+	/* negate if the sign bit is not set */
+	neg = _mm_cmplt_epi16(a,_mm_set1_epi16(0x80));
+	return _mm_sub_epi16(_mm_xor_si128(i,neg),neg);
+}
+
+static void sse2_ulaw_encode(const apr_int16_t *linear, apr_byte_t *encoded, apr_size_t count)
+{
+	apr_size_t i;
+	__m128i v;
+	for(i=0; i+8<=count; i+=8) {
+		v = sse2_linear_to_ulaw(_mm_loadu_si128((const __m128i*)(linear+i)));
+		_mm_storel_epi64((__m128i*)(encoded+i),_mm_packus_epi16(v,v));
+	}
+	scalar_ulaw_encode(linear+i,encoded+i,count-i);
+}
+
+static void sse2_ulaw_decode(const apr_byte_t *encoded, apr_int16_t *linear, apr_size_t count)
+{
+	apr_size_t i;
+	__m128i v;
+	for(i=0; i+8<=count; i+=8) {
+		v = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(encoded+i)),_mm_setzero_si128());
+		_mm_storeu_si128((__m128i*)(linear+i),sse2_ulaw_to_linear(v));
+	}
+	scalar_ulaw_decode(encoded+i,linear+i,count-i);
+}
+
+static void sse2_alaw_encode(const apr_int16_t *linear, apr_byte_t *encoded, apr_size_t count)
+{
+	apr_size_t i;
+	__m128i v;
+	for(i=0; i+8<=count; i+=8) {
+		v = sse2_linear_to_alaw(_mm_loadu_si128((const __m128i*)(linear+i)));
+		_mm_storel_epi64((__m128i*)(encoded+i),_mm_packus_epi16(v,v));
+	}
+	scalar_alaw_encode(linear+i,encoded+i,count-i);
+}
+
+static void sse2_alaw_decode(const apr_byte_t *encoded, apr_int16_t *linear, apr_size_t count)
+{
+	apr_size_t i;
+	__m128i v;
+	for(i=0; i+8<=count; i+=8) {
+		v = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(encoded+i)),_mm_setzero_si128());
+		_mm_storeu_si128((__m128i*)(linear+i),sse2_alaw_to_linear(v));
+	}
+	scalar_alaw_decode(encoded+i,linear+i,count-i);
+}
+#endif /* MPF_G711_SSE2 */
+
+
+#ifdef MPF_G711_AVX2
+/** Get 2^e of e in the range [0..7] */
+static APR_INLINE MPF_G711_AVX2_TARGET __m256i avx2_pow2(__m256i e)
+{
+	const __m256i one = _mm256_set1_epi16(1);
+	__m256i b0 = _mm256_and_si256(e,one);
+	__m256i b1 = _mm256_and_si256(_mm256_srli_epi16(e,1),one);
+	__m256i b2 = _mm256_and_si256(_mm256_srli_epi16(e,2),one);
+	/* (1 + b0) * (1 + 3*b1) * (1 + 15*b2) */
+	__m256i f0 = _mm256_add_epi16(one,b0);
+	__m256i f1 = _mm256_add_epi16(one,_mm256_sub_epi16(_mm256_slli_epi16(b1,2),b1));
+	__m256i f2 = _mm256_add_epi16(one,_mm256_sub_epi16(_mm256_slli_epi16(b2,4),b2));
+	return _mm256_mullo_epi16(_mm256_mullo_epi16(f0,f1),f2);
+}
+
+static APR_INLINE MPF_G711_AVX2_TARGET void avx2_segment_step(__m256i m, short bound, short step, __m256i *seg, __m256i *mul)
+{
+	__m256i gt = _mm256_cmpgt_epi16(m,_mm256_set1_epi16(bound));
+	*seg = _mm256_sub_epi16(*seg,gt);
+	*mul = _mm256_sub_epi16(*mul,_mm256_and_si256(gt,_mm256_set1_epi16(step)));
+}
+
+static APR_INLINE MPF_G711_AVX2_TARGET __m256i avx2_segment_quantize(__m256i m, short mul0, short step0)
+{
+	__m256i seg = _mm256_setzero_si256();
+	__m256i mul = _mm256_set1_epi16(mul0);
+	avx2_segment_step(m,0x00FF,step0,&seg,&mul);
+	avx2_segment_step(m,0x01FF,0x0800,&seg,&mul);
+	avx2_segment_step(m,0x03FF,0x0400,&seg,&mul);
+	avx2_segment_step(m,0x07FF,0x0200,&seg,&mul);
+	avx2_segment_step(m,0x0FFF,0x0100,&seg,&mul);
+	avx2_segment_step(m,0x1FFF,0x0080,&seg,&mul);
+	avx2_segment_step(m,0x3FFF,0x0040,&seg,&mul);
+	return _mm256_or_si256(_mm256_slli_epi16(seg,4),_mm256_and_si256(_mm256_mulhi_epu16(m,mul),_mm256_set1_epi16(0x0F)));
+}
+
+static APR_INLINE MPF_G711_AVX2_TARGET __m256i avx2_linear_to_ulaw(__m256i x)
+{
+	__m256i sign = _mm256_srai_epi16(x,15);
+	__m256i m;
+
+	m = _mm256_min_epi16(_mm256_xor_si256(x,sign),_mm256_set1_epi16(0x7FFF - ULAW_BIAS));
+	m = _mm256_add_epi16(m,_mm256_set1_epi16(ULAW_BIAS));
+	m = avx2_segment_quantize(m,0x2000,0x1000);
+	return _mm256_xor_si256(m,_mm256_xor_si256(_mm256_set1_epi16(0xFF),_mm256_and_si256(sign,_mm256_set1_epi16(0x80))));
+}
+
+static APR_INLINE MPF_G711_AVX2_TARGET __m256i avx2_linear_to_alaw(__m256i x)
+{
+	__m256i sign = _mm256_srai_epi16(x,15);
+	__m256i m;
+
+	m = avx2_segment_quantize(_mm256_xor_si256(x,sign),0x1000,0);
+	return _mm256_xor_si256(m,_mm256_xor_si256(_mm256_set1_epi16(ALAW_AMI_MASK | 0x80),_mm256_and_si256(sign,_mm256_set1_epi16(0x80))));
+}
+
+static APR_INLINE MPF_G711_AVX2_TARGET __m256i avx2_ulaw_to_linear(__m256i u)
+{
+	__m256i t;
+	__m256i neg;
+
+	u = _mm256_xor_si256(u,_mm256_set1_epi16(0xFF));
+	t = _mm256_add_epi16(_mm256_slli_epi16(_mm256_and_si256(u,_mm256_set1_epi16(0x0F)),3),_mm256_set1_epi16(ULAW_BIAS));
+	t = _mm256_mullo_epi16(t,avx2_pow2(_mm256_srli_epi16(_mm256_and_si256(u,_mm256_set1_epi16(0x70)),4)));
+	t = _mm256_sub_epi16(t,_mm256_set1_epi16(ULAW_BIAS));
+	neg = _mm256_cmpgt_epi16(u,_mm256_set1_epi16(0x7F));
+	return _mm256_sub_epi16(_mm256_xor_si256(t,neg),neg);
+}
+
+static APR_INLINE MPF_G711_AVX2_TARGET __m256i avx2_alaw_to_linear(__m256i a)
+{
+	__m256i i;
+	__m256i seg;
+	__m256i neg;
+
+	a = _mm256_xor_si256(a,_mm256_set1_epi16(ALAW_AMI_MASK));
+	seg = _mm256_srli_epi16(_mm256_and_si256(a,_mm256_set1_epi16(0x70)),4);
+	i = _mm256_add_epi16(_mm256_slli_epi16(_mm256_and_si256(a,_mm256_set1_epi16(0x0F)),4),_mm256_set1_epi16(8));
+	i = _mm256_add_epi16(i,_mm256_and_si256(_mm256_cmpgt_epi16(seg,_mm256_setzero_si256()),_mm256_set1_epi16(0x100)));
+	seg = _mm256_max_epi16(_mm256_sub_epi16(seg,_mm256_set1_epi16(1)),_mm256_setzero_si256());
+	i = _mm256_mullo_epi16(i,avx2_pow2(seg));
+	neg = _mm256_cmpgt_epi16(_mm256_set1_epi16(0x80),a);
+	return _mm256_sub_epi16(_mm256_xor_si256(i,neg),neg);
+}
+
+/** Pack 16 words of the range [0..255] to 16 bytes */
+static APR_INLINE MPF_G711_AVX2_TARGET void avx2_store_bytes(apr_byte_t *encoded, __m256i v)
+{
+	_mm_storeu_si128((__m128i*)encoded,_mm_packus_epi16(_mm256_castsi256_si128(v),_mm256_extracti128_si256(v,1)));
+}
+
+static MPF_G711_AVX2_TARGET void avx2_ulaw_encode(const apr_int16_t *linear, apr_byte_t *encoded, apr_size_t count)
+{
+	apr_size_t i;
+	for(i=0; i+16<=count; i+=16) {
+		avx2_store_bytes(encoded+i,avx2_linear_to_ulaw(_mm256_loadu_si256((const __m256i*)(linear+i))));
+	}
+	sse2_ulaw_encode(linear+i,encoded+i,count-i);
+}
+
+static MPF_G711_AVX2_TARGET void avx2_ulaw_decode(const apr_byte_t *encoded, apr_int16_t *linear, apr_size_t count)
+{
+	apr_size_t i;
+	__m256i v;
+	for(i=0; i+16<=count; i+=16) {
+		v = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(encoded+i)));
+		_mm256_storeu_si256((__m256i*)(linear+i),avx2_ulaw_to_linear(v));
+	}
+	sse2_ulaw_decode(encoded+i,linear+i,count-i);
+}
+
+static MPF_G711_AVX2_TARGET void avx2_alaw_encode(const apr_int16_t *linear, apr_byte_t *encoded, apr_size_t count)
+{
+	apr_size_t i;
+	for(i=0; i+16<=count; i+=16) {
+		avx2_store_bytes(encoded+i,avx2_linear_to_alaw(_mm256_loadu_si256((const __m256i*)(linear+i))));
+	}
+	sse2_alaw_encode(linear+i,encoded+i,count-i);
+}
+
+static MPF_G711_AVX2_TARGET void avx2_alaw_decode(const apr_byte_t *encoded, apr_int16_t *linear, apr_size_t count)
+{
+	apr_size_t i;
+	__m256i v;
+	for(i=0; i+16<=count; i+=16) {
+		v = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(encoded+i)));
+		_mm256_storeu_si256((__m256i*)(linear+i),avx2_alaw_to_linear(v));
+	}
+	sse2_alaw_decode(encoded+i,linear+i,count-i);
+}
+
+/** Check whether the CPU and the OS support AVX2 */
+static apt_bool_t mpf_g711_avx2_supported(void)
+{
+#if defined(__GNUC__)
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") ? TRUE : FALSE;
+#else
+	int info[4];
+	__cpuid(info,0);
+	if(info[0] < 7) {
+		return FALSE;
+	}
+	__cpuid(info,1);
+	/* OSXSAVE and AVX */
+	if((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0) {
+		return FALSE;
+	}
+	/* XMM and YMM state enabled by the OS */
+	if((_xgetbv(0) & 0x6) != 0x6) {
+		return FALSE;
+	}
+	__cpuidex(info,7,0);
+	return (info[1] & (1 << 5)) ? TRUE : FALSE;
+#endif
+}
+#endif /* MPF_G711_AVX2 */
+
+
+static const mpf_g711_kernel_t g711_kernels[MPF_G711_KERNEL_COUNT] = {
+	{"scalar", scalar_ulaw_encode, scalar_ulaw_decode, scalar_alaw_encode, scalar_alaw_decode},
+	{"lut",    lut_ulaw_encode,    lut_ulaw_decode,    lut_alaw_encode,    lut_alaw_decode},
+#ifdef MPF_G711_SSE2
+	{"sse2",   sse2_ulaw_encode,   sse2_ulaw_decode,   sse2_alaw_encode,   sse2_alaw_decode},
+#else
+	{"sse2",   NULL, NULL, NULL, NULL},
+#endif
+#ifdef MPF_G711_AVX2
+	{"avx2",   avx2_ulaw_encode,   avx2_ulaw_decode,   avx2_alaw_encode,   avx2_alaw_decode}
+#else
+	{"avx2",   NULL, NULL, NULL, NULL}
+#endif
+};
+
+static const mpf_g711_kernel_t *g711_default_kernel = NULL;
+
+/** Get G.711 kernel by type */
+MPF_DECLARE(const mpf_g711_kernel_t*) mpf_g711_kernel_get(mpf_g711_kernel_type_e type)
+{
+	if(type >= MPF_G711_KERNEL_COUNT || !g711_kernels[type].ulaw_encode) {
+		return NULL;
+	}
+
+	if(type == MPF_G711_KERNEL_LUT) {
+		mpf_g711_tables_init();
+	}
+#ifdef MPF_G711_AVX2
+	else if(type == MPF_G711_KERNEL_AVX2 && mpf_g711_avx2_supported() == FALSE) {
+		return NULL;
+	}
+#endif
+	return &g711_kernels[type];
+}
+
+/** Get the fastest G.711 kernel supported by the CPU */
+MPF_DECLARE(const mpf_g711_kernel_t*) mpf_g711_kernel_default_get(void)
+{
+	if(!g711_default_kernel) {
+		const mpf_g711_kernel_t *kernel = mpf_g711_kernel_get(MPF_G711_KERNEL_AVX2);
+		if(!kernel) {
+			kernel = mpf_g711_kernel_get(MPF_G711_KERNEL_SSE2);
+		}
+		if(!kernel) {
+			kernel = mpf_g711_kernel_get(MPF_G711_KERNEL_LUT);
+		}
+		apt_log(MPF_LOG_MARK,APT_PRIO_INFO,"Select G.711 Kernel [%s]",kernel->name);
+		g711_default_kernel = kernel;
+	}
+	return g711_default_kernel;
+}
@@ -19,6 +19,11 @@
 
 #define MAX_FRAMES_PER_PACKET 16
 
+/* multiplier of the estimated jitter, the playout delay is minimized to cover */
+#define JB_JITTER_FACTOR      3
+/* number of reads the playout delay must stay above the target, before an audio frame is dropped */
+#define JB_SHRINK_INTERVAL    50
+
 #if ENABLE_JB_TRACE == 1
 #define JB_TRACE printf
 #elif ENABLE_JB_TRACE == 2
@@ -71,6 +76,24 @@ struct mpf_jitter_buffer_t {
 	/* number of statistical measurements made */
 	apr_uint32_t     measurment_count;
 
+	/* min playout delay in timestamp units */
+	apr_uint32_t     min_playout_delay_ts;
+	/* estimated interarrival jitter in timestamp units, scaled by 16 (RFC3550) */
+	apr_uint32_t     jitter_q4;
+	/* relative transit time of the last written packet */
+	apr_int32_t      transit_ts;
+	/* transit time of the last written packet is available */
+	apr_byte_t       transit_valid;
+	/* number of reads since the playout delay was last changed */
+	apr_uint32_t     delay_read_count;
+
+	/* slot of the last frame read with audio */
+	mpf_frame_t       *plc_source;
+	/* copy of the last frame read with audio, used to conceal lost frames */
+	mpf_codec_frame_t  plc_frame;
+	/* number of frames lost in a row */
+	apr_size_t         plc_loss_count;
+
 	/* timestamp event starts at */
 	apr_uint32_t                   event_write_base_ts;
 	/* the first (base) frame of the event */
@@ -133,6 +156,27 @@ mpf_jitter_buffer_t* mpf_jitter_buffer_create(mpf_jb_config_t *jb_config, mpf_co
 	jb->min_length_ts = jb->max_length_ts = 0;
 	jb->measurment_count = 0;
 
+	jb->min_playout_delay_ts = jb->frame_ts * jb->config->min_playout_delay / jb->frame_duration;
+	if(jb->min_playout_delay_ts < jb->frame_ts) {
+		jb->min_playout_delay_ts = jb->frame_ts;
+	}
+	/* start from the jitter the initial playout delay is supposed to cover */
+	jb->jitter_q4 = 0;
+	if(jb->playout_delay_ts > jb->frame_ts) {
+		jb->jitter_q4 = 16 * (jb->playout_delay_ts - jb->frame_ts) / JB_JITTER_FACTOR;
+	}
+	jb->transit_ts = 0;
+	jb->transit_valid = 0;
+	jb->delay_read_count = 0;
+
+	jb->plc_source = NULL;
+	jb->plc_frame.buffer = NULL;
+	jb->plc_frame.size = 0;
+	jb->plc_loss_count = 0;
+	if(jb->config->plc) {
+		jb->plc_frame.buffer = apr_palloc(pool,jb->frame_size);
+	}
+
 	jb->event_write_base_ts = 0;
 	memset(&jb->event_write_base,0,sizeof(mpf_named_event_frame_t));
 	jb->event_write_update = NULL;
@@ -154,6 +198,10 @@ apt_bool_t mpf_jitter_buffer_restart(mpf_jitter_buffer_t *jb)
 	memset(&jb->event_write_base,0,sizeof(mpf_named_event_frame_t));
 	jb->event_write_update = NULL;
 
+	jb->transit_valid = 0;
+	jb->plc_source = NULL;
+	jb->plc_loss_count = 0;
+
 	if(jb->config->adaptive && jb->playout_delay_ts == jb->max_playout_delay_ts) {
 		jb->playout_delay_ts = jb->frame_ts * jb->config->initial_playout_delay / jb->frame_duration;
 	}
@@ -201,6 +249,38 @@ static APR_INLINE void mpf_jitter_buffer_frame_allign(mpf_jitter_buffer_t *jb, a
 		*ts -= *ts % jb->frame_ts;
 }
 
+static APR_INLINE void mpf_jitter_buffer_jitter_update(mpf_jitter_buffer_t *jb, apr_uint32_t ts)
+{
+	/* the read pos advances on every media tick, which makes it the arrival clock */
+	apr_int32_t transit_ts = (apr_int32_t)(jb->read_ts - ts);
+	if(jb->transit_valid) {
+		apr_int32_t delta_ts = transit_ts - jb->transit_ts;
+		if(delta_ts < 0) {
+			delta_ts = -delta_ts;
+		}
+		/* J = J + (|D| - J)/16 */
+		jb->jitter_q4 = (apr_uint32_t)((apr_int32_t)jb->jitter_q4 + delta_ts - (apr_int32_t)((jb->jitter_q4 + 8) >> 4));
+	}
+	jb->transit_ts = transit_ts;
+	jb->transit_valid = 1;
+}
+
+static APR_INLINE apr_uint32_t mpf_jitter_buffer_target_delay_get(const mpf_jitter_buffer_t *jb)
+{
+	/* the frame being read plus a few times the estimated jitter */
+	apr_uint32_t delay_ts = jb->frame_ts + JB_JITTER_FACTOR * (jb->jitter_q4 >> 4);
+	if(delay_ts % jb->frame_ts != 0) {
+		delay_ts += jb->frame_ts - delay_ts % jb->frame_ts;
+	}
+	if(delay_ts < jb->min_playout_delay_ts) {
+		delay_ts = jb->min_playout_delay_ts;
+	}
+	else if(delay_ts > jb->max_playout_delay_ts) {
+		delay_ts = jb->max_playout_delay_ts;
+	}
+	return delay_ts;
+}
+
 static APR_INLINE jb_result_t mpf_jitter_buffer_write_prepare(mpf_jitter_buffer_t *jb, apr_uint32_t ts, apr_uint32_t *write_ts)
 {
 	if(jb->write_sync) {
@@ -208,6 +288,14 @@ static APR_INLINE jb_result_t mpf_jitter_buffer_write_prepare(mpf_jitter_buffer_
 		/* calculate the offset */
 		jb->write_ts_offset = ts - jb->read_ts;
 		jb->write_sync = 0;
+		jb->transit_valid = 0;
+
+		if(jb->config->adaptive == 2) {
+			/* new talkspurt, the delay may be reduced at once to cover the estimated jitter only */
+			jb->playout_delay_ts = mpf_jitter_buffer_target_delay_get(jb);
+			jb->delay_read_count = 0;
+			JB_TRACE("JB set playout delay=%u jitter=%u\n",jb->playout_delay_ts,jb->jitter_q4 >> 4);
+		}
 	
 		if(jb->config->time_skew_detection) {
 			/* reset the statistics */
@@ -252,6 +340,11 @@ jb_result_t mpf_jitter_buffer_write(mpf_jitter_buffer_t *jb, void *buffer, apr_s
 		return result;
 	}
 
+	if(jb->config->adaptive == 2) {
+		/* estimate jitter by every packet, including the ones arrived too late */
+		mpf_jitter_buffer_jitter_update(jb,ts);
+	}
+
 	if(write_ts >= jb->read_ts) {
 		if(write_ts >= jb->write_ts) {
 			/* normal order */
@@ -321,6 +414,7 @@ jb_result_t mpf_jitter_buffer_write(mpf_jitter_buffer_t *jb, void *buffer, apr_s
 
 			/* adjust the playout delay */
 			jb->playout_delay_ts += delta_ts;
+			jb->delay_read_count = 0;
 			write_ts += delta_ts;
 			JB_TRACE("JB adjust playout delay=%u delta=%u\n",jb->playout_delay_ts,delta_ts);
 
@@ -442,6 +536,7 @@ jb_result_t mpf_jitter_buffer_event_write(mpf_jitter_buffer_t *jb, const mpf_nam
 
 		/* adjust the playout delay */
 		jb->playout_delay_ts += delta_ts;
+		jb->delay_read_count = 0;
 		write_ts += delta_ts;
 		if(marker) {
 			jb->event_write_base_ts = write_ts;
@@ -476,9 +571,90 @@ jb_result_t mpf_jitter_buffer_event_write(mpf_jitter_buffer_t *jb, const mpf_nam
 	return result;
 }
 
-apt_bool_t mpf_jitter_buffer_read(mpf_jitter_buffer_t *jb, mpf_frame_t *media_frame)
+static APR_INLINE apt_bool_t mpf_jitter_buffer_drop_check(mpf_jitter_buffer_t *jb, const mpf_frame_t *src_media_frame)
+{
+	if(jb->write_ts <= jb->read_ts + jb->frame_ts) {
+		/* nothing to play out instead */
+		return FALSE;
+	}
+	if(jb->playout_delay_ts < mpf_jitter_buffer_target_delay_get(jb) + jb->frame_ts) {
+		/* the delay doesn't exceed the target by a frame */
+		return FALSE;
+	}
+	if(src_media_frame->type == MEDIA_FRAME_TYPE_NONE) {
+		/* a gap (silence suppressed or lost), drop it at once */
+		return TRUE;
+	}
+	if(src_media_frame->type & MEDIA_FRAME_TYPE_EVENT) {
+		return FALSE;
+	}
+	/* continuous audio, drop a frame once the delay has been in excess for a while */
+	return jb->delay_read_count >= JB_SHRINK_INTERVAL ? TRUE : FALSE;
+}
+
+static APR_INLINE mpf_frame_t* mpf_jitter_buffer_frame_drop(mpf_jitter_buffer_t *jb, mpf_frame_t *src_media_frame)
+{
+	JB_TRACE("JB drop ts=%u playout delay=%u\n",jb->read_ts,jb->playout_delay_ts);
+	src_media_frame->type = MEDIA_FRAME_TYPE_NONE;
+	src_media_frame->marker = MPF_MARKER_NONE;
+	jb->read_ts += jb->frame_ts;
+
+	/* reduce the playout delay, keeping the write pos of the next packets */
+	jb->playout_delay_ts -= jb->frame_ts;
+	jb->write_ts_offset -= jb->frame_ts;
+	jb->delay_read_count = 0;
+	if(jb->config->time_skew_detection) {
+		/* adjust the statistics */
+		jb->min_length_ts -= jb->frame_ts;
+		jb->max_length_ts -= jb->frame_ts;
+	}
+	return mpf_jitter_buffer_frame_get(jb,jb->read_ts);
+}
+
+static APR_INLINE void mpf_jitter_buffer_frame_conceal(mpf_jitter_buffer_t *jb, mpf_frame_t *src_media_frame, mpf_frame_t *media_frame)
+{
+	if(media_frame->type & MEDIA_FRAME_TYPE_AUDIO) {
+		/* keep the slot, it's copied only if the next frame is lost */
+		jb->plc_source = src_media_frame;
+		jb->plc_loss_count = 0;
+		return;
+	}
+	if(media_frame->type != MEDIA_FRAME_TYPE_NONE || !jb->plc_source) {
+		/* an event or nothing to conceal with */
+		jb->plc_source = NULL;
+		return;
+	}
+
+	if(!jb->plc_loss_count) {
+		/* the first frame lost, copy the last one unless its slot has been written over */
+		if(jb->plc_source->type != MEDIA_FRAME_TYPE_NONE) {
+			jb->plc_source = NULL;
+			return;
+		}
+		jb->plc_frame.size = jb->plc_source->codec_frame.size;
+		memcpy(jb->plc_frame.buffer,jb->plc_source->codec_frame.buffer,jb->plc_frame.size);
+	}
+
+	jb->plc_loss_count++;
+	if(mpf_codec_conceal(jb->codec,&jb->plc_frame,jb->plc_loss_count,&media_frame->codec_frame) == FALSE) {
+		/* not supported by the codec or faded out */
+		jb->plc_source = NULL;
+		return;
+	}
+	JB_TRACE("JB conceal ts=%u loss=%"APR_SIZE_T_FMT"\n",jb->read_ts,jb->plc_loss_count);
+	media_frame->type = MEDIA_FRAME_TYPE_AUDIO;
+}
+
+static APR_INLINE apt_bool_t mpf_jitter_buffer_frame_read(mpf_jitter_buffer_t *jb, mpf_frame_t *media_frame, apt_bool_t borrow)
 {
 	mpf_frame_t *src_media_frame = mpf_jitter_buffer_frame_get(jb,jb->read_ts);
+	if(jb->config->adaptive == 2) {
+		if(mpf_jitter_buffer_drop_check(jb,src_media_frame) == TRUE) {
+			src_media_frame = mpf_jitter_buffer_frame_drop(jb,src_media_frame);
+		}
+		jb->delay_read_count++;
+	}
+
 	if(jb->write_ts > jb->read_ts) {
 		/* normal read */
 		JB_TRACE("JB read ts=%u\n",	jb->read_ts);
@@ -486,7 +662,13 @@ apt_bool_t mpf_jitter_buffer_read(mpf_jitter_buffer_t *jb, mpf_frame_t *media_fr
 		media_frame->marker = src_media_frame->marker;
 		if(media_frame->type & MEDIA_FRAME_TYPE_AUDIO) {
 			media_frame->codec_frame.size = src_media_frame->codec_frame.size;
-			memcpy(media_frame->codec_frame.buffer,src_media_frame->codec_frame.buffer,media_frame->codec_frame.size);
+			if(borrow == TRUE) {
+				/* the slot is not written until the read position advances by the whole buffer */
+				media_frame->codec_frame.buffer = src_media_frame->codec_frame.buffer;
+			}
+			else {
+				memcpy(media_frame->codec_frame.buffer,src_media_frame->codec_frame.buffer,media_frame->codec_frame.size);
+			}
 		}
 		if(media_frame->type & MEDIA_FRAME_TYPE_EVENT) {
 			media_frame->event_frame = src_media_frame->event_frame;
@@ -498,6 +680,9 @@ apt_bool_t mpf_jitter_buffer_read(mpf_jitter_buffer_t *jb, mpf_frame_t *media_fr
 		media_frame->type = MEDIA_FRAME_TYPE_NONE;
 		media_frame->marker = MPF_MARKER_NONE;
 	}
+	if(jb->plc_frame.buffer) {
+		mpf_jitter_buffer_frame_conceal(jb,src_media_frame,media_frame);
+	}
 	src_media_frame->type = MEDIA_FRAME_TYPE_NONE;
 	src_media_frame->marker = MPF_MARKER_NONE;
 	/* advance read pos */
@@ -510,6 +695,16 @@ apt_bool_t mpf_jitter_buffer_read(mpf_jitter_buffer_t *jb, mpf_frame_t *media_fr
 	return TRUE;
 }
 
+apt_bool_t mpf_jitter_buffer_read(mpf_jitter_buffer_t *jb, mpf_frame_t *media_frame)
+{
+	return mpf_jitter_buffer_frame_read(jb,media_frame,FALSE);
+}
+
+apt_bool_t mpf_jitter_buffer_borrow(mpf_jitter_buffer_t *jb, mpf_frame_t *media_frame)
+{
+	return mpf_jitter_buffer_frame_read(jb,media_frame,TRUE);
+}
+
 apr_uint32_t mpf_jitter_buffer_playout_delay_get(const mpf_jitter_buffer_t *jb)
 {
 	if(jb->config->adaptive == 0) {
@@ -21,6 +21,19 @@
 #include "mpf_codec_manager.h"
 #include "apt_log.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+/** Use SSE2 to mix frames */
+#define MPF_MIXER_SSE2
+#endif
+
+/** Max linear sample value */
+#define MIXER_SAMPLE_MAX       32767
+/** Fraction of the distance to the unity gain recovered per frame after the mix has been attenuated */
+#define MIXER_GAIN_RELEASE     0.0625f
+/** Gain considered as unity */
+#define MIXER_GAIN_UNITY       0.999f
+
 typedef struct mpf_mixer_t mpf_mixer_t;
 
 /** MPF mixer derived from MPF object */
@@ -33,51 +46,223 @@ struct mpf_mixer_t {
 	apr_size_t           source_count;
 	/** Audio sink */
 	mpf_audio_stream_t  *sink;
+	/** Mixing mode */
+	mpf_mixer_mode_e     mode;
 
-	/** Frame to read from audio source */
-	mpf_frame_t          frame;
+	/** Frames to read from audio sources, one per source */
+	mpf_frame_t         *frames;
+	/** Samples of the sources which have audio in the current frame */
+	const apr_int16_t  **mix_samples;
 	/** Mixed frame to write to audio sink */
 	mpf_frame_t          mix_frame;
+	/** Buffer of the mixed frame */
+	apr_int16_t         *mix_buffer;
+	/** Whether the buffer of the mixed frame holds silence */
+	apt_bool_t           mix_silent;
+	/** Accumulator of the sums of samples (normalize mode only) */
+	apr_int32_t         *accumulator;
+	/** Current gain (normalize mode only) */
+	float                gain;
 };
 
-static apt_bool_t mpf_frames_mix(mpf_frame_t *mix_frame, const mpf_frame_t *frame)
+/** Saturate the sum of samples to 16 bits */
+static APR_INLINE apr_int16_t mpf_mixer_saturate(apr_int32_t sum)
 {
-	apr_size_t i;
-	apr_int16_t *mix_buf = mix_frame->codec_frame.buffer;
-	const apr_int16_t *buf = frame->codec_frame.buffer;
-	apr_size_t samples = frame->codec_frame.size / sizeof(apr_int16_t);
+	if(sum > MIXER_SAMPLE_MAX) {
+		return MIXER_SAMPLE_MAX;
+	}
+	if(sum < -MIXER_SAMPLE_MAX - 1) {
+		return -MIXER_SAMPLE_MAX - 1;
+	}
+	return (apr_int16_t)sum;
+}
+
+#ifdef MPF_MIXER_SSE2
+/** Sum up 8 samples of all the sources in 32 bits, the sources are taken by pairs and summed by multiply-add */
+static APR_INLINE void mpf_mixer_sum_sse2(const apr_int16_t **src, apr_size_t src_count, apr_size_t i, __m128i *lo, __m128i *hi)
+{
+	const __m128i one = _mm_set1_epi16(1);
+	const __m128i zero = _mm_setzero_si128();
+	__m128i x;
+	__m128i y;
+	apr_size_t k;
 
-	if(mix_frame->codec_frame.size != frame->codec_frame.size) {
-		return FALSE;
+	*lo = zero;
+	*hi = zero;
+	for(k=0; k + 2 <= src_count; k += 2) {
+		x = _mm_loadu_si128((const __m128i*)(src[k] + i));
+		y = _mm_loadu_si128((const __m128i*)(src[k+1] + i));
+		*lo = _mm_add_epi32(*lo,_mm_madd_epi16(_mm_unpacklo_epi16(x,y),one));
+		*hi = _mm_add_epi32(*hi,_mm_madd_epi16(_mm_unpackhi_epi16(x,y),one));
 	}
+	if(k < src_count) {
+		x = _mm_loadu_si128((const __m128i*)(src[k] + i));
+		*lo = _mm_add_epi32(*lo,_mm_madd_epi16(_mm_unpacklo_epi16(x,zero),one));
+		*hi = _mm_add_epi32(*hi,_mm_madd_epi16(_mm_unpackhi_epi16(x,zero),one));
+	}
+}
+#endif
 
-	if((frame->type & MEDIA_FRAME_TYPE_AUDIO) == MEDIA_FRAME_TYPE_AUDIO) {
-		for(i=0; i<samples; i++) {
-			/* overflow MUST be considered */
-			mix_buf[i] = mix_buf[i] + buf[i];
+/** Sum up the samples of all the sources in 32 bits and saturate the sums to 16 bits once */
+static void mpf_mixer_sum_saturate(apr_int16_t *dst, const apr_int16_t **src, apr_size_t src_count, apr_size_t samples)
+{
+	apr_size_t i = 0;
+	apr_size_t k;
+#ifdef MPF_MIXER_SSE2
+	__m128i lo;
+	__m128i hi;
+	for(; i + 8 <= samples; i += 8) {
+		mpf_mixer_sum_sse2(src,src_count,i,&lo,&hi);
+		_mm_storeu_si128((__m128i*)(dst + i),_mm_packs_epi32(lo,hi));
+	}
+#endif
+	for(; i<samples; i++) {
+		apr_int32_t sum = src[0][i];
+		for(k=1; k<src_count; k++) {
+			sum += src[k][i];
 		}
-		mix_frame->type |= MEDIA_FRAME_TYPE_AUDIO;
+		dst[i] = mpf_mixer_saturate(sum);
 	}
+}
 
-	return TRUE;
+/** Sum up the samples of all the sources in 32 bits and return the peak magnitude of the sums */
+static apr_int32_t mpf_mixer_sum_accumulate(apr_int32_t *acc, const apr_int16_t **src, apr_size_t src_count, apr_size_t samples)
+{
+	apr_int32_t max = 0;
+	apr_int32_t min = 0;
+	apr_size_t i = 0;
+	apr_size_t k;
+#ifdef MPF_MIXER_SSE2
+	apr_int32_t result[8];
+	__m128i max_v = _mm_setzero_si128();
+	__m128i min_v = _mm_setzero_si128();
+	__m128i mask;
+	__m128i lo;
+	__m128i hi;
+	for(; i + 8 <= samples; i += 8) {
+		mpf_mixer_sum_sse2(src,src_count,i,&lo,&hi);
+		_mm_storeu_si128((__m128i*)(acc + i),lo);
+		_mm_storeu_si128((__m128i*)(acc + i + 4),hi);
+
+		/* SSE2 has no 32-bit min/max, select by comparison masks */
+		mask = _mm_cmpgt_epi32(lo,max_v);
+		max_v = _mm_or_si128(_mm_and_si128(mask,lo),_mm_andnot_si128(mask,max_v));
+		mask = _mm_cmpgt_epi32(hi,max_v);
+		max_v = _mm_or_si128(_mm_and_si128(mask,hi),_mm_andnot_si128(mask,max_v));
+		mask = _mm_cmplt_epi32(lo,min_v);
+		min_v = _mm_or_si128(_mm_and_si128(mask,lo),_mm_andnot_si128(mask,min_v));
+		mask = _mm_cmplt_epi32(hi,min_v);
+		min_v = _mm_or_si128(_mm_and_si128(mask,hi),_mm_andnot_si128(mask,min_v));
+	}
+	_mm_storeu_si128((__m128i*)result,max_v);
+	_mm_storeu_si128((__m128i*)(result + 4),min_v);
+	for(k=0; k<4; k++) {
+		if(result[k] > max) max = result[k];
+		if(result[k + 4] < min) min = result[k + 4];
+	}
+#endif
+	for(; i<samples; i++) {
+		apr_int32_t sum = src[0][i];
+		for(k=1; k<src_count; k++) {
+			sum += src[k][i];
+		}
+		acc[i] = sum;
+		if(sum > max) max = sum;
+		if(sum < min) min = sum;
+	}
+	return (max > -min) ? max : -min;
+}
+
+/** Scale the sums by the gain and saturate them to 16 bits */
+static void mpf_mixer_sum_scale(apr_int16_t *dst, const apr_int32_t *acc, apr_size_t samples, float gain)
+{
+	apr_size_t i = 0;
+#ifdef MPF_MIXER_SSE2
+	const __m128 gain_v = _mm_set1_ps(gain);
+	__m128i lo;
+	__m128i hi;
+	for(; i + 8 <= samples; i += 8) {
+		lo = _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)(acc + i))),gain_v));
+		hi = _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)(acc + i + 4))),gain_v));
+		_mm_storeu_si128((__m128i*)(dst + i),_mm_packs_epi32(lo,hi));
+	}
+#endif
+	for(; i<samples; i++) {
+		float value = acc[i] * gain;
+		dst[i] = mpf_mixer_saturate((apr_int32_t)(value < 0 ? value - 0.5f : value + 0.5f));
+	}
+}
+
+/** Mix the sources into 32-bit sums and normalize them by the gain which follows the peak of the mix */
+static void mpf_mixer_sum_normalize(mpf_mixer_t *mixer, apr_size_t src_count, apr_size_t samples)
+{
+	apr_int32_t peak = mpf_mixer_sum_accumulate(mixer->accumulator,mixer->mix_samples,src_count,samples);
+	float target = 1.0f;
+	if(peak > MIXER_SAMPLE_MAX) {
+		target = (float)MIXER_SAMPLE_MAX / peak;
+	}
+
+	if(target < mixer->gain) {
+		/* attenuate at once not to clip */
+		mixer->gain = target;
+	}
+	else if(mixer->gain < 1.0f) {
+		/* recover gradually */
+		mixer->gain += (target - mixer->gain) * MIXER_GAIN_RELEASE;
+		if(mixer->gain > MIXER_GAIN_UNITY) {
+			mixer->gain = 1.0f;
+		}
+	}
+
+	mpf_mixer_sum_scale(mixer->mix_buffer,mixer->accumulator,samples,mixer->gain);
 }
 
 static apt_bool_t mpf_mixer_process(mpf_object_t *object)
 {
 	apr_size_t i;
+	apr_size_t src_count = 0;
 	mpf_audio_stream_t *source;
+	mpf_frame_t *frame;
 	mpf_mixer_t *mixer = (mpf_mixer_t*) object;
+	apr_size_t frame_size = mixer->mix_frame.codec_frame.size;
+	apr_size_t samples = frame_size / sizeof(apr_int16_t);
 
-	mixer->mix_frame.type = MEDIA_FRAME_TYPE_NONE;
-	mixer->mix_frame.marker = MPF_MARKER_NONE;
-	memset(mixer->mix_frame.codec_frame.buffer,0,mixer->mix_frame.codec_frame.size);
 	for(i=0; i<mixer->source_count; i++) {
 		source = mixer->source_arr[i];
 		if(source) {
-			mixer->frame.type = MEDIA_FRAME_TYPE_NONE;
-			mixer->frame.marker = MPF_MARKER_NONE;
-			source->vtable->read_frame(source,&mixer->frame);
-			mpf_frames_mix(&mixer->mix_frame,&mixer->frame);
+			frame = &mixer->frames[i];
+			frame->type = MEDIA_FRAME_TYPE_NONE;
+			frame->marker = MPF_MARKER_NONE;
+			source->vtable->read_frame(source,frame);
+			/* silent and absent sources are not mixed at all */
+			if((frame->type & MEDIA_FRAME_TYPE_AUDIO) == MEDIA_FRAME_TYPE_AUDIO && frame->codec_frame.size == frame_size) {
+				mixer->mix_samples[src_count++] = frame->codec_frame.buffer;
+			}
+		}
+	}
+
+	mixer->mix_frame.marker = MPF_MARKER_NONE;
+	mixer->mix_frame.codec_frame.buffer = mixer->mix_buffer;
+	if(src_count == 0) {
+		mixer->mix_frame.type = MEDIA_FRAME_TYPE_NONE;
+		if(mixer->mix_silent == FALSE) {
+			memset(mixer->mix_buffer,0,frame_size);
+			mixer->mix_silent = TRUE;
+		}
+	}
+	else if(src_count == 1 && (mixer->mode == MPF_MIXER_MODE_SATURATE || mixer->gain >= 1.0f)) {
+		/* pass the only audio frame through as is */
+		mixer->mix_frame.type = MEDIA_FRAME_TYPE_AUDIO;
+		mixer->mix_frame.codec_frame.buffer = (void*)mixer->mix_samples[0];
+	}
+	else {
+		mixer->mix_frame.type = MEDIA_FRAME_TYPE_AUDIO;
+		mixer->mix_silent = FALSE;
+		if(mixer->mode == MPF_MIXER_MODE_NORMALIZE) {
+			mpf_mixer_sum_normalize(mixer,src_count,samples);
+		}
+		else {
+			mpf_mixer_sum_saturate(mixer->mix_buffer,mixer->mix_samples,src_count,samples);
 		}
 	}
 	mixer->sink->vtable->write_frame(mixer->sink,&mixer->mix_frame);
@@ -139,6 +324,18 @@ MPF_DECLARE(mpf_object_t*) mpf_mixer_create(
 								const mpf_codec_manager_t *codec_manager, 
 								const char *name,
 								apr_pool_t *pool)
+{
+	return mpf_mixer_create_ex(source_arr,source_count,sink,codec_manager,MPF_MIXER_MODE_SATURATE,name,pool);
+}
+
+MPF_DECLARE(mpf_object_t*) mpf_mixer_create_ex(
+								mpf_audio_stream_t **source_arr, 
+								apr_size_t source_count, 
+								mpf_audio_stream_t *sink, 
+								const mpf_codec_manager_t *codec_manager, 
+								mpf_mixer_mode_e mode,
+								const char *name,
+								apr_pool_t *pool)
 {
 	apr_size_t i;
 	apr_size_t frame_size;
@@ -155,6 +352,9 @@ MPF_DECLARE(mpf_object_t*) mpf_mixer_create(
 	mixer->source_arr = NULL;
 	mixer->source_count = 0;
 	mixer->sink = NULL;
+	mixer->mode = mode;
+	mixer->accumulator = NULL;
+	mixer->gain = 1.0f;
 	mpf_object_init(&mixer->base,name);
 	mixer->base.process = mpf_mixer_process;
 	mixer->base.destroy = mpf_mixer_destroy;
@@ -201,6 +401,14 @@ MPF_DECLARE(mpf_object_t*) mpf_mixer_create(
 		}
 
 		source->rx_descriptor->frame_duration = frame_duration;
+		if(source->rx_descriptor->sampling_rate != sink->tx_descriptor->sampling_rate) {
+			/* set resampler before mixer */
+			mpf_audio_stream_t *resampler = mpf_resampler_create(source,sink,pool);
+			if(!resampler) {
+				continue;
+			}
+			source = resampler;
+		}
 		source_arr[i] = source;
 		mpf_audio_stream_rx_open(source,NULL);
 	}
@@ -209,9 +417,18 @@ MPF_DECLARE(mpf_object_t*) mpf_mixer_create(
 
 	descriptor = sink->tx_descriptor;
 	frame_size = mpf_codec_linear_frame_size_calculate(descriptor->sampling_rate,descriptor->channel_count,frame_duration);
-	mixer->frame.codec_frame.size = frame_size;
-	mixer->frame.codec_frame.buffer = apr_palloc(pool,frame_size);
+	mixer->frames = apr_palloc(pool,sizeof(mpf_frame_t) * source_count);
+	for(i=0; i<source_count; i++) {
+		mixer->frames[i].codec_frame.size = frame_size;
+		mixer->frames[i].codec_frame.buffer = apr_palloc(pool,frame_size);
+	}
+	mixer->mix_samples = apr_palloc(pool,sizeof(apr_int16_t*) * source_count);
+	mixer->mix_buffer = apr_pcalloc(pool,frame_size);
+	mixer->mix_silent = TRUE;
 	mixer->mix_frame.codec_frame.size = frame_size;
-	mixer->mix_frame.codec_frame.buffer = apr_palloc(pool,frame_size);
+	mixer->mix_frame.codec_frame.buffer = mixer->mix_buffer;
+	if(mode == MPF_MIXER_MODE_NORMALIZE) {
+		mixer->accumulator = apr_palloc(pool,sizeof(apr_int32_t) * frame_size / sizeof(apr_int16_t));
+	}
 	return &mixer->base;
 }
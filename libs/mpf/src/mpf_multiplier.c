@@ -36,6 +36,8 @@ struct mpf_multiplier_t {
 
 	/** Media frame used to read data from source and write it to sinks */
 	mpf_frame_t          frame;
+	/** Own buffer of the frame, which may be referred to the source data */
+	void                *buffer;
 };
 
 static apt_bool_t mpf_multiplier_process(mpf_object_t *object)
@@ -46,7 +48,8 @@ static apt_bool_t mpf_multiplier_process(mpf_object_t *object)
 
 	multiplier->frame.type = MEDIA_FRAME_TYPE_NONE;
 	multiplier->frame.marker = MPF_MARKER_NONE;
-	multiplier->source->vtable->read_frame(multiplier->source,&multiplier->frame);
+	multiplier->frame.codec_frame.buffer = multiplier->buffer;
+	mpf_audio_stream_frame_borrow(multiplier->source,&multiplier->frame);
 	
 	if((multiplier->frame.type & MEDIA_FRAME_TYPE_AUDIO) == 0) {
 		memset(	multiplier->frame.codec_frame.buffer,
@@ -180,6 +183,14 @@ MPF_DECLARE(mpf_object_t*) mpf_multiplier_create(
 		}
 
 		sink->tx_descriptor->frame_duration = frame_duration;
+		if(sink->tx_descriptor->sampling_rate != source->rx_descriptor->sampling_rate) {
+			/* set resampler after multiplier */
+			mpf_audio_stream_t *resampler = mpf_resampler_sink_create(source,sink,pool);
+			if(!resampler) {
+				continue;
+			}
+			sink = resampler;
+		}
 		sink_arr[i] = sink;
 		mpf_audio_stream_tx_open(sink,NULL);
 	}
@@ -189,6 +200,7 @@ MPF_DECLARE(mpf_object_t*) mpf_multiplier_create(
 	descriptor = source->rx_descriptor;
 	frame_size = mpf_codec_linear_frame_size_calculate(descriptor->sampling_rate,descriptor->channel_count,frame_duration);
 	multiplier->frame.codec_frame.size = frame_size;
-	multiplier->frame.codec_frame.buffer = apr_palloc(pool,frame_size);
+	multiplier->buffer = apr_palloc(pool,frame_size);
+	multiplier->frame.codec_frame.buffer = multiplier->buffer;
 	return &multiplier->base;
 }
@@ -14,13 +14,501 @@
  * limitations under the License.
  */
 
+#include <stdlib.h>
+#include <math.h>
+#include <apr_atomic.h>
 #include "mpf_resampler.h"
 #include "apt_log.h"
 
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+/** Use SSE in the inner loop of the filter */
+#define MPF_RESAMPLER_SSE
+#endif
+
+/** Min number of filter taps per phase (multiple of 4) */
+#define RESAMPLER_TAPS       32
+/** Cutoff frequency relative to the Nyquist frequency of the lower rate */
+#define RESAMPLER_CUTOFF     0.9
+/** Number of supported sampling rates (8, 16, 32, 48 kHz) */
+#define RESAMPLER_RATE_COUNT 4
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/** Polyphase filter bank for a pair of sampling rates */
+typedef struct mpf_resampler_bank_t mpf_resampler_bank_t;
+struct mpf_resampler_bank_t {
+	/** Interpolation factor (number of phases) */
+	apr_size_t up;
+	/** Decimation factor */
+	apr_size_t down;
+	/** Number of taps per phase */
+	apr_size_t taps;
+	/** Coefficients of all the phases, each phase is stored in reverse order */
+	float     *coeffs;
+};
+
+/** Filter banks shared by all the resamplers, created on demand and kept for the lifetime of the process */
+static void* volatile resampler_banks[RESAMPLER_RATE_COUNT][RESAMPLER_RATE_COUNT];
+
+typedef struct mpf_resampler_t mpf_resampler_t;
+
+/** Resampler */
+struct mpf_resampler_t {
+	/** Base audio stream */
+	mpf_audio_stream_t         *base;
+	/** Source stream to read frames from (receive direction) */
+	mpf_audio_stream_t         *source;
+	/** Sink stream to write frames to (send direction) */
+	mpf_audio_stream_t         *sink;
+	/** Filter bank */
+	const mpf_resampler_bank_t *bank;
+	/** Number of channels */
+	apr_size_t                  channel_count;
+	/** Number of input samples per channel in a frame */
+	apr_size_t                  samples_in;
+	/** Number of output samples per channel in a frame */
+	apr_size_t                  samples_out;
+	/** Filter history (taps-1 + samples_in) per channel */
+	float                     **history;
+	/** Intermediate frame */
+	mpf_frame_t                 frame;
+	/** Own buffer of the intermediate frame, which may be referred to the source data */
+	void                       *buffer;
+};
+
+static int mpf_resampler_rate_index_get(apr_uint16_t sampling_rate)
+{
+	switch(sampling_rate) {
+		case 8000:
+			return 0;
+		case 16000:
+			return 1;
+		case 32000:
+			return 2;
+		case 48000:
+			return 3;
+	}
+	return -1;
+}
+
+static apr_size_t mpf_gcd(apr_size_t a, apr_size_t b)
+{
+	apr_size_t t;
+	while(b) {
+		t = a % b;
+		a = b;
+		b = t;
+	}
+	return a;
+}
+
+/** Design windowed-sinc (Blackman) lowpass prototype and split it into polyphase filter bank */
+static mpf_resampler_bank_t* mpf_resampler_bank_create(apr_uint16_t rate_in, apr_uint16_t rate_out)
+{
+	apr_size_t n;
+	apr_size_t p;
+	apr_size_t m;
+	apr_size_t length;
+	double center;
+	double cutoff;
+	double sum = 0;
+	double *prototype;
+	apr_size_t gcd = mpf_gcd(rate_in,rate_out);
+	mpf_resampler_bank_t *bank = malloc(sizeof(mpf_resampler_bank_t));
+	if(!bank) {
+		return NULL;
+	}
+	bank->up = rate_out / gcd;
+	bank->down = rate_in / gcd;
+	/* the narrower the passband relative to the upsampled rate, the longer the filter */
+	bank->taps = RESAMPLER_TAPS * (bank->down > bank->up ? bank->down : bank->up) / bank->up;
+	bank->taps = (bank->taps + 3) & ~(apr_size_t)3;
+	length = bank->taps * bank->up;
+
+	prototype = malloc(sizeof(double) * length);
+	bank->coeffs = malloc(sizeof(float) * length);
+	if(!prototype || !bank->coeffs) {
+		free(prototype);
+		free(bank->coeffs);
+		free(bank);
+		return NULL;
+	}
+
+	center = (double)(length - 1) / 2;
+	cutoff = RESAMPLER_CUTOFF / (bank->down > bank->up ? bank->down : bank->up);
+	for(n=0; n<length; n++) {
+		double x = n - center;
+		double sinc = (x == 0) ? cutoff : sin(M_PI * cutoff * x) / (M_PI * x);
+		double window = 0.42 - 0.5 * cos(2 * M_PI * n / (length - 1)) + 0.08 * cos(4 * M_PI * n / (length - 1));
+		prototype[n] = sinc * window;
+		sum += prototype[n];
+	}
+
+	/* normalize to unity gain at DC for each phase */
+	for(p=0; p<bank->up; p++) {
+		for(m=0; m<bank->taps; m++) {
+			n = p + (bank->taps - 1 - m) * bank->up;
+			bank->coeffs[p * bank->taps + m] = (float)(prototype[n] * bank->up / sum);
+		}
+	}
+	free(prototype);
+	return bank;
+}
+
+/** Get filter bank for the specified pair of sampling rates */
+static const mpf_resampler_bank_t* mpf_resampler_bank_get(apr_uint16_t rate_in, apr_uint16_t rate_out)
+{
+	mpf_resampler_bank_t *bank;
+	mpf_resampler_bank_t *existing;
+	int in = mpf_resampler_rate_index_get(rate_in);
+	int out = mpf_resampler_rate_index_get(rate_out);
+	if(in < 0 || out < 0 || in == out) {
+		return NULL;
+	}
+
+	bank = resampler_banks[in][out];
+	if(bank) {
+		return bank;
+	}
+
+	bank = mpf_resampler_bank_create(rate_in,rate_out);
+	if(!bank) {
+		return NULL;
+	}
+	/* the bank may be concurrently created by another media processing worker */
+	existing = apr_atomic_casptr((volatile void**)&resampler_banks[in][out],bank,NULL);
+	if(existing) {
+		free(bank->coeffs);
+		free(bank);
+		return existing;
+	}
+	return bank;
+}
+
+static APR_INLINE float mpf_dot_product(const float *x, const float *h, apr_size_t count)
+{
+	apr_size_t i;
+#ifdef MPF_RESAMPLER_SSE
+	float result[4];
+	__m128 sum = _mm_setzero_ps();
+	for(i=0; i<count; i+=4) {
+		sum = _mm_add_ps(sum,_mm_mul_ps(_mm_loadu_ps(x+i),_mm_loadu_ps(h+i)));
+	}
+	_mm_storeu_ps(result,sum);
+	return (result[0] + result[1]) + (result[2] + result[3]);
+#else
+	float sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+	for(i=0; i<count; i+=4) {
+		sum0 += x[i] * h[i];
+		sum1 += x[i+1] * h[i+1];
+		sum2 += x[i+2] * h[i+2];
+		sum3 += x[i+3] * h[i+3];
+	}
+	return (sum0 + sum1) + (sum2 + sum3);
+#endif
+}
+
+static void mpf_resampler_history_reset(mpf_resampler_t *resampler)
+{
+	apr_size_t c;
+	for(c=0; c<resampler->channel_count; c++) {
+		memset(resampler->history[c],0,sizeof(float) * (resampler->bank->taps - 1));
+	}
+}
+
+/** Resample linear frame */
+static void mpf_resampler_frame_convert(mpf_resampler_t *resampler, const mpf_codec_frame_t *frame_in, mpf_codec_frame_t *frame_out)
+{
+	apr_size_t c;
+	apr_size_t i;
+	apr_size_t j;
+	apr_size_t pos;
+	float value;
+	float *history;
+	const mpf_resampler_bank_t *bank = resampler->bank;
+	const apr_int16_t *in = frame_in->buffer;
+	apr_int16_t *out = frame_out->buffer;
+	apr_size_t channel_count = resampler->channel_count;
+	apr_size_t samples_in = resampler->samples_in;
+
+	if(frame_in->size < samples_in * channel_count * sizeof(apr_int16_t)) {
+		samples_in = frame_in->size / (channel_count * sizeof(apr_int16_t));
+	}
+
+	for(c=0; c<channel_count; c++) {
+		history = resampler->history[c];
+		for(i=0; i<samples_in; i++) {
+			history[bank->taps - 1 + i] = in[i * channel_count + c];
+		}
+		for(; i<resampler->samples_in; i++) {
+			history[bank->taps - 1 + i] = 0;
+		}
+
+		for(j=0, pos=0; j<resampler->samples_out; j++, pos+=bank->down) {
+			value = mpf_dot_product(
+						history + pos / bank->up,
+						bank->coeffs + (pos % bank->up) * bank->taps,
+						bank->taps);
+			if(value > 32767.f) {
+				value = 32767.f;
+			}
+			else if(value < -32768.f) {
+				value = -32768.f;
+			}
+			out[j * channel_count + c] = (apr_int16_t)(value < 0 ? value - 0.5f : value + 0.5f);
+		}
+
+		memmove(history,history + resampler->samples_in,sizeof(float) * (bank->taps - 1));
+	}
+}
+
+static apt_bool_t mpf_resampler_destroy(mpf_audio_stream_t *stream)
+{
+	mpf_resampler_t *resampler = stream->obj;
+	if(resampler->source) {
+		return mpf_audio_stream_destroy(resampler->source);
+	}
+	return mpf_audio_stream_destroy(resampler->sink);
+}
+
+static apt_bool_t mpf_resampler_rx_open(mpf_audio_stream_t *stream, mpf_codec_t *codec)
+{
+	mpf_resampler_t *resampler = stream->obj;
+	mpf_resampler_history_reset(resampler);
+	return mpf_audio_stream_rx_open(resampler->source,codec);
+}
+
+static apt_bool_t mpf_resampler_rx_close(mpf_audio_stream_t *stream)
+{
+	mpf_resampler_t *resampler = stream->obj;
+	return mpf_audio_stream_rx_close(resampler->source);
+}
+
+static apt_bool_t mpf_resampler_read(mpf_audio_stream_t *stream, mpf_frame_t *frame)
+{
+	mpf_resampler_t *resampler = stream->obj;
+	resampler->frame.type = MEDIA_FRAME_TYPE_NONE;
+	resampler->frame.marker = MPF_MARKER_NONE;
+	resampler->frame.codec_frame.buffer = resampler->buffer;
+	if(mpf_audio_stream_frame_borrow(resampler->source,&resampler->frame) != TRUE) {
+		return FALSE;
+	}
+
+	frame->type = resampler->frame.type;
+	frame->marker = resampler->frame.marker;
+	if((frame->type & MEDIA_FRAME_TYPE_EVENT) == MEDIA_FRAME_TYPE_EVENT) {
+		frame->event_frame = resampler->frame.event_frame;
+	}
+	if((frame->type & MEDIA_FRAME_TYPE_AUDIO) == MEDIA_FRAME_TYPE_AUDIO) {
+		mpf_resampler_frame_convert(resampler,&resampler->frame.codec_frame,&frame->codec_frame);
+	}
+	else {
+		mpf_resampler_history_reset(resampler);
+	}
+	return TRUE;
+}
+
+static apt_bool_t mpf_resampler_tx_open(mpf_audio_stream_t *stream, mpf_codec_t *codec)
+{
+	mpf_resampler_t *resampler = stream->obj;
+	mpf_resampler_history_reset(resampler);
+	return mpf_audio_stream_tx_open(resampler->sink,codec);
+}
+
+static apt_bool_t mpf_resampler_tx_close(mpf_audio_stream_t *stream)
+{
+	mpf_resampler_t *resampler = stream->obj;
+	return mpf_audio_stream_tx_close(resampler->sink);
+}
+
+static apt_bool_t mpf_resampler_write(mpf_audio_stream_t *stream, const mpf_frame_t *frame)
+{
+	mpf_resampler_t *resampler = stream->obj;
+	resampler->frame.type = frame->type;
+	resampler->frame.marker = frame->marker;
+	if((frame->type & MEDIA_FRAME_TYPE_EVENT) == MEDIA_FRAME_TYPE_EVENT) {
+		resampler->frame.event_frame = frame->event_frame;
+	}
+	if((frame->type & MEDIA_FRAME_TYPE_AUDIO) == MEDIA_FRAME_TYPE_AUDIO) {
+		mpf_resampler_frame_convert(resampler,&frame->codec_frame,&resampler->frame.codec_frame);
+	}
+	else {
+		mpf_resampler_history_reset(resampler);
+	}
+	return mpf_audio_stream_frame_write(resampler->sink,&resampler->frame);
+}
+
+static void mpf_resampler_trace(mpf_audio_stream_t *stream, mpf_stream_direction_e direction, apt_text_stream_t *output)
+{
+	apr_size_t offset;
+	mpf_codec_descriptor_t *descriptor;
+	mpf_resampler_t *resampler = stream->obj;
+
+	if(resampler->source) {
+		mpf_audio_stream_trace(resampler->source,direction,output);
+		descriptor = resampler->base->rx_descriptor;
+		if(descriptor) {
+			offset = output->pos - output->text.buf;
+			output->pos += apr_snprintf(output->pos, output->text.length - offset,
+				"->Resampler->[%s/%d/%d]",
+				descriptor->name.buf,
+				descriptor->sampling_rate,
+				descriptor->channel_count);
+		}
+		return;
+	}
+
+	descriptor = resampler->base->tx_descriptor;
+	if(descriptor) {
+		offset = output->pos - output->text.buf;
+		output->pos += apr_snprintf(output->pos, output->text.length - offset,
+			"[%s/%d/%d]->Resampler->",
+			descriptor->name.buf,
+			descriptor->sampling_rate,
+			descriptor->channel_count);
+	}
+	mpf_audio_stream_trace(resampler->sink,direction,output);
+}
+
+static const mpf_audio_stream_vtable_t rx_vtable = {
+	mpf_resampler_destroy,
+	mpf_resampler_rx_open,
+	mpf_resampler_rx_close,
+	mpf_resampler_read,
+	NULL,
+	NULL,
+	NULL,
+	mpf_resampler_trace
+};
+
+static const mpf_audio_stream_vtable_t tx_vtable = {
+	mpf_resampler_destroy,
+	NULL,
+	NULL,
+	NULL,
+	mpf_resampler_tx_open,
+	mpf_resampler_tx_close,
+	mpf_resampler_write,
+	mpf_resampler_trace
+};
+
+static mpf_resampler_t* mpf_resampler_base_create(
+							const mpf_codec_descriptor_t *descriptor_in,
+							const mpf_codec_descriptor_t *descriptor_out,
+							const mpf_audio_stream_vtable_t *vtable,
+							mpf_stream_direction_e direction,
+							apr_pool_t *pool)
+{
+	apr_size_t c;
+	mpf_resampler_t *resampler;
+	mpf_stream_capabilities_t *capabilities;
+	const mpf_resampler_bank_t *bank;
+
+	if(descriptor_in->channel_count != descriptor_out->channel_count) {
+		apt_log(MPF_LOG_MARK,APT_PRIO_WARNING,"Failed to Create Resampler: channel count mismatch [%d] -> [%d]",
+			descriptor_in->channel_count,
+			descriptor_out->channel_count);
+		return NULL;
+	}
+
+	bank = mpf_resampler_bank_get(descriptor_in->sampling_rate,descriptor_out->sampling_rate);
+	if(!bank) {
+		apt_log(MPF_LOG_MARK,APT_PRIO_WARNING,"Failed to Create Resampler: unsupported sampling rates [%d] -> [%d]",
+			descriptor_in->sampling_rate,
+			descriptor_out->sampling_rate);
+		return NULL;
+	}
+
+	resampler = apr_palloc(pool,sizeof(mpf_resampler_t));
+	capabilities = mpf_stream_capabilities_create(direction,pool);
+	resampler->base = mpf_audio_stream_create(resampler,vtable,capabilities,pool);
+	if(!resampler->base) {
+		return NULL;
+	}
+	resampler->source = NULL;
+	resampler->sink = NULL;
+	resampler->bank = bank;
+	resampler->channel_count = descriptor_in->channel_count;
+	resampler->samples_in = mpf_codec_frame_samples_calculate(
+								descriptor_in->sampling_rate,
+								1,
+								descriptor_in->frame_duration);
+	resampler->samples_out = resampler->samples_in * bank->up / bank->down;
+	resampler->history = apr_palloc(pool,sizeof(float*) * resampler->channel_count);
+	for(c=0; c<resampler->channel_count; c++) {
+		resampler->history[c] = apr_pcalloc(pool,sizeof(float) * (bank->taps - 1 + resampler->samples_in));
+	}
+
+	apt_log(MPF_LOG_MARK,APT_PRIO_DEBUG,"Create Resampler [%d] -> [%d] taps [%"APR_SIZE_T_FMT"x%"APR_SIZE_T_FMT"]",
+		descriptor_in->sampling_rate,
+		descriptor_out->sampling_rate,
+		bank->up,
+		bank->taps);
+	return resampler;
+}
+
 MPF_DECLARE(mpf_audio_stream_t*) mpf_resampler_create(mpf_audio_stream_t *source, mpf_audio_stream_t *sink, apr_pool_t *pool)
 {
-	apt_log(MPF_LOG_MARK,APT_PRIO_WARNING,
-		"Currently resampling is not supported. "
-		"Try to configure and use the same sampling rate on both ends");
-	return NULL;
+	apr_size_t frame_size;
+	mpf_resampler_t *resampler;
+	mpf_codec_descriptor_t *descriptor;
+	if(!source || !sink || !source->rx_descriptor || !sink->tx_descriptor) {
+		return NULL;
+	}
+
+	descriptor = mpf_codec_lpcm_descriptor_create(
+		sink->tx_descriptor->sampling_rate,
+		source->rx_descriptor->channel_count,
+		source->rx_descriptor->frame_duration,
+		pool);
+	resampler = mpf_resampler_base_create(source->rx_descriptor,descriptor,&rx_vtable,STREAM_DIRECTION_RECEIVE,pool);
+	if(!resampler) {
+		return NULL;
+	}
+	resampler->base->rx_descriptor = descriptor;
+	resampler->base->rx_event_descriptor = source->rx_event_descriptor;
+	resampler->source = source;
+
+	frame_size = mpf_codec_linear_frame_size_calculate(
+		source->rx_descriptor->sampling_rate,
+		source->rx_descriptor->channel_count,
+		source->rx_descriptor->frame_duration);
+	resampler->frame.codec_frame.size = frame_size;
+	resampler->buffer = apr_palloc(pool,frame_size);
+	resampler->frame.codec_frame.buffer = resampler->buffer;
+	return resampler->base;
+}
+
+MPF_DECLARE(mpf_audio_stream_t*) mpf_resampler_sink_create(mpf_audio_stream_t *source, mpf_audio_stream_t *sink, apr_pool_t *pool)
+{
+	apr_size_t frame_size;
+	mpf_resampler_t *resampler;
+	mpf_codec_descriptor_t *descriptor;
+	if(!source || !sink || !source->rx_descriptor || !sink->tx_descriptor) {
+		return NULL;
+	}
+
+	descriptor = mpf_codec_lpcm_descriptor_create(
+		source->rx_descriptor->sampling_rate,
+		sink->tx_descriptor->channel_count,
+		sink->tx_descriptor->frame_duration,
+		pool);
+	resampler = mpf_resampler_base_create(descriptor,sink->tx_descriptor,&tx_vtable,STREAM_DIRECTION_SEND,pool);
+	if(!resampler) {
+		return NULL;
+	}
+	resampler->base->tx_descriptor = descriptor;
+	resampler->base->tx_event_descriptor = sink->tx_event_descriptor;
+	resampler->sink = sink;
+
+	frame_size = mpf_codec_linear_frame_size_calculate(
+		sink->tx_descriptor->sampling_rate,
+		sink->tx_descriptor->channel_count,
+		sink->tx_descriptor->frame_duration);
+	resampler->frame.codec_frame.size = frame_size;
+	resampler->frame.codec_frame.buffer = apr_palloc(pool,frame_size);
+	return resampler->base;
 }
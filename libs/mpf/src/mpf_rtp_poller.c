@@ -0,0 +1,191 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+/* required for recvmmsg() */
+#define _GNU_SOURCE
+#endif
+
+#include <apr_poll.h>
+#include "mpf_rtp_poller.h"
+#include "apt_pollset.h"
+#include "apt_log.h"
+
+#ifdef __linux__
+#include <sys/socket.h>
+#include <apr_portable.h>
+#ifdef MSG_WAITFORONE
+/** Use recvmmsg() to receive a batch of packets by a single system call */
+#define MPF_RTP_POLLER_MMSG
+#endif
+#endif
+
+/** Max size of RTP packet */
+#define MAX_RTP_PACKET_SIZE 1500
+/** Max number of packets received from a ready socket per poll */
+#define MAX_RTP_PACKET_BATCH 8
+
+/** RTP poller descriptor */
+struct mpf_rtp_poller_descriptor_t {
+	/** APR poll descriptor */
+	apr_pollfd_t                    pfd;
+	/** Handler to pass received packets to */
+	mpf_rtp_poller_packet_handler_f handler;
+	/** External object */
+	void                           *obj;
+};
+
+/** RTP poller */
+struct mpf_rtp_poller_t {
+	/** Pollset */
+	apt_pollset_t  *pollset;
+	/** Number of sockets in the pollset */
+	apr_size_t      socket_count;
+	/** Packet buffers shared by all the sockets */
+	char            buffers[MAX_RTP_PACKET_BATCH][MAX_RTP_PACKET_SIZE];
+#ifdef MPF_RTP_POLLER_MMSG
+	/** Message headers used by recvmmsg() */
+	struct mmsghdr  messages[MAX_RTP_PACKET_BATCH];
+	/** IO vectors used by recvmmsg() */
+	struct iovec    iovecs[MAX_RTP_PACKET_BATCH];
+#endif
+};
+
+/** Create RTP poller */
+MPF_DECLARE(mpf_rtp_poller_t*) mpf_rtp_poller_create(apr_size_t max_socket_count, apr_pool_t *pool)
+{
+	mpf_rtp_poller_t *poller = apr_palloc(pool,sizeof(mpf_rtp_poller_t));
+	poller->socket_count = 0;
+	poller->pollset = apt_pollset_create((apr_uint32_t)max_socket_count,pool);
+	if(!poller->pollset) {
+		apt_log(MPF_LOG_MARK,APT_PRIO_WARNING,"Failed to Create RTP Pollset");
+		return NULL;
+	}
+#ifdef MPF_RTP_POLLER_MMSG
+	{
+		apr_size_t i;
+		memset(poller->messages,0,sizeof(poller->messages));
+		for(i=0; i<MAX_RTP_PACKET_BATCH; i++) {
+			poller->iovecs[i].iov_base = poller->buffers[i];
+			poller->iovecs[i].iov_len = MAX_RTP_PACKET_SIZE;
+			poller->messages[i].msg_hdr.msg_iov = &poller->iovecs[i];
+			poller->messages[i].msg_hdr.msg_iovlen = 1;
+		}
+	}
+#endif
+	return poller;
+}
+
+/** Destroy RTP poller */
+MPF_DECLARE(void) mpf_rtp_poller_destroy(mpf_rtp_poller_t *poller)
+{
+	if(poller->pollset) {
+		apt_pollset_destroy(poller->pollset);
+		poller->pollset = NULL;
+	}
+}
+
+/** Add socket to RTP poller */
+MPF_DECLARE(mpf_rtp_poller_descriptor_t*) mpf_rtp_poller_socket_add(
+										mpf_rtp_poller_t *poller,
+										apr_socket_t *socket,
+										mpf_rtp_poller_packet_handler_f handler,
+										void *obj,
+										apr_pool_t *pool)
+{
+	mpf_rtp_poller_descriptor_t *descriptor;
+	if(!socket || !handler) {
+		return NULL;
+	}
+
+	descriptor = apr_palloc(pool,sizeof(mpf_rtp_poller_descriptor_t));
+	memset(&descriptor->pfd,0,sizeof(apr_pollfd_t));
+	descriptor->pfd.desc_type = APR_POLL_SOCKET;
+	descriptor->pfd.reqevents = APR_POLLIN;
+	descriptor->pfd.desc.s = socket;
+	descriptor->pfd.client_data = descriptor;
+	descriptor->handler = handler;
+	descriptor->obj = obj;
+	if(apt_pollset_add(poller->pollset,&descriptor->pfd) != TRUE) {
+		apt_log(MPF_LOG_MARK,APT_PRIO_WARNING,"Failed to Add Socket to RTP Pollset");
+		return NULL;
+	}
+	poller->socket_count++;
+	return descriptor;
+}
+
+/** Remove socket from RTP poller */
+MPF_DECLARE(apt_bool_t) mpf_rtp_poller_socket_remove(mpf_rtp_poller_t *poller, mpf_rtp_poller_descriptor_t *descriptor)
+{
+	if(apt_pollset_remove(poller->pollset,&descriptor->pfd) != TRUE) {
+		apt_log(MPF_LOG_MARK,APT_PRIO_WARNING,"Failed to Remove Socket from RTP Pollset");
+		return FALSE;
+	}
+	poller->socket_count--;
+	return TRUE;
+}
+
+/** Receive a batch of pending packets from the ready socket */
+static void mpf_rtp_poller_socket_read(mpf_rtp_poller_t *poller, mpf_rtp_poller_descriptor_t *descriptor)
+{
+#ifdef MPF_RTP_POLLER_MMSG
+	int i;
+	int count;
+	apr_os_sock_t fd;
+	if(apr_os_sock_get(&fd,descriptor->pfd.desc.s) != APR_SUCCESS) {
+		return;
+	}
+
+	count = recvmmsg(fd,poller->messages,MAX_RTP_PACKET_BATCH,MSG_DONTWAIT,NULL);
+	for(i=0; i<count; i++) {
+		descriptor->handler(descriptor->obj,poller->buffers[i],poller->messages[i].msg_len);
+	}
+#else
+	apr_size_t i;
+	apr_size_t size = MAX_RTP_PACKET_SIZE;
+	for(i=0; i<MAX_RTP_PACKET_BATCH; i++) {
+		if(apr_socket_recv(descriptor->pfd.desc.s,poller->buffers[0],&size) != APR_SUCCESS) {
+			break;
+		}
+		descriptor->handler(descriptor->obj,poller->buffers[0],size);
+		size = MAX_RTP_PACKET_SIZE;
+	}
+#endif
+}
+
+/** Receive pending packets from the sockets which are ready for reading */
+MPF_DECLARE(apt_bool_t) mpf_rtp_poller_process(mpf_rtp_poller_t *poller)
+{
+	apr_int32_t i;
+	apr_int32_t count = 0;
+	const apr_pollfd_t *ret_pfd = NULL;
+	if(!poller->socket_count) {
+		return TRUE;
+	}
+
+	if(apt_pollset_poll(poller->pollset,0,&count,&ret_pfd) != APR_SUCCESS) {
+		/* nothing to read */
+		return TRUE;
+	}
+
+	for(i=0; i<count; i++) {
+		if(apt_pollset_is_wakeup(poller->pollset,&ret_pfd[i])) {
+			continue;
+		}
+		mpf_rtp_poller_socket_read(poller,ret_pfd[i].client_data);
+	}
+	return TRUE;
+}
@@ -0,0 +1,214 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+/* required for sendmmsg() */
+#define _GNU_SOURCE
+#endif
+
+#include "mpf_rtp_sender.h"
+#include "apt_log.h"
+
+#ifdef __linux__
+#include <sys/socket.h>
+#include <apr_portable.h>
+#ifdef MSG_WAITFORONE
+/** Use sendmmsg() to send a batch of packets by a single system call */
+#define MPF_RTP_SENDER_MMSG
+#endif
+#endif
+
+/** Queued RTP packet */
+typedef struct mpf_rtp_sender_packet_t mpf_rtp_sender_packet_t;
+struct mpf_rtp_sender_packet_t {
+	/** Address to send packet to */
+	apr_sockaddr_t *sockaddr;
+	/** Size of packet data */
+	apr_size_t      size;
+	/** Packet data */
+	char           *data;
+};
+
+/** RTP sender */
+struct mpf_rtp_sender_t {
+	/** Socket to send the queued packets from */
+	apr_socket_t            *socket;
+	/** Queued packets */
+	mpf_rtp_sender_packet_t *packets;
+	/** Number of queued packets */
+	apr_size_t               packet_count;
+	/** Max number of queued packets */
+	apr_size_t               max_packet_count;
+	/** Max size of queued packet */
+	apr_size_t               max_packet_size;
+	/** Number of ticks the first queued packet is held for */
+	apr_size_t               hold_ticks;
+	/** Max number of ticks the first queued packet is held for */
+	apr_size_t               max_hold_ticks;
+#ifdef MPF_RTP_SENDER_MMSG
+	/** Message headers used by sendmmsg() */
+	struct mmsghdr          *messages;
+	/** IO vectors used by sendmmsg() */
+	struct iovec            *iovecs;
+#endif
+};
+
+/** Check whether packets can be sent by a single system call on this platform */
+MPF_DECLARE(apt_bool_t) mpf_rtp_sender_is_supported(void)
+{
+#ifdef MPF_RTP_SENDER_MMSG
+	return TRUE;
+#else
+	return FALSE;
+#endif
+}
+
+/** Create RTP sender */
+MPF_DECLARE(mpf_rtp_sender_t*) mpf_rtp_sender_create(apr_size_t max_packet_count, apr_size_t max_packet_size, apr_size_t max_hold_ticks, apr_pool_t *pool)
+{
+	apr_size_t i;
+	char *data;
+	mpf_rtp_sender_t *sender = apr_palloc(pool,sizeof(mpf_rtp_sender_t));
+	if(!max_packet_count) {
+		max_packet_count = 1;
+	}
+	if(!max_packet_size) {
+		max_packet_size = MPF_RTP_SENDER_DEFAULT_PACKET_SIZE;
+	}
+	sender->socket = NULL;
+	sender->packets = apr_palloc(pool,sizeof(mpf_rtp_sender_packet_t) * max_packet_count);
+	data = apr_palloc(pool,max_packet_size * max_packet_count);
+	for(i=0; i<max_packet_count; i++) {
+		sender->packets[i].data = data + i * max_packet_size;
+	}
+	sender->packet_count = 0;
+	sender->max_packet_count = max_packet_count;
+	sender->max_packet_size = max_packet_size;
+	sender->hold_ticks = 0;
+	sender->max_hold_ticks = max_hold_ticks;
+#ifdef MPF_RTP_SENDER_MMSG
+	{
+		sender->messages = apr_pcalloc(pool,sizeof(struct mmsghdr) * max_packet_count);
+		sender->iovecs = apr_pcalloc(pool,sizeof(struct iovec) * max_packet_count);
+		for(i=0; i<max_packet_count; i++) {
+			sender->iovecs[i].iov_base = sender->packets[i].data;
+			sender->messages[i].msg_hdr.msg_iov = &sender->iovecs[i];
+			sender->messages[i].msg_hdr.msg_iovlen = 1;
+		}
+	}
+#endif
+	return sender;
+}
+
+/** Queue RTP packet to send */
+MPF_DECLARE(apt_bool_t) mpf_rtp_sender_packet_add(
+							mpf_rtp_sender_t *sender,
+							apr_socket_t *socket,
+							apr_sockaddr_t *sockaddr,
+							const void *data,
+							apr_size_t size)
+{
+	mpf_rtp_sender_packet_t *packet;
+	if(!socket || !sockaddr || size > sender->max_packet_size) {
+		return FALSE;
+	}
+
+	if(sender->packet_count) {
+		if(sender->packet_count == sender->max_packet_count || sender->socket != socket) {
+			/* the sender must be flushed first */
+			return FALSE;
+		}
+	}
+	else {
+		sender->socket = socket;
+		sender->hold_ticks = 0;
+	}
+
+	packet = &sender->packets[sender->packet_count++];
+	packet->sockaddr = sockaddr;
+	packet->size = size;
+	memcpy(packet->data,data,size);
+	return TRUE;
+}
+
+/** Check whether the sender is full and must be flushed */
+MPF_DECLARE(apt_bool_t) mpf_rtp_sender_is_full(const mpf_rtp_sender_t *sender)
+{
+	return (sender->packet_count == sender->max_packet_count) ? TRUE : FALSE;
+}
+
+/** Advance the sender by one media tick */
+MPF_DECLARE(apt_bool_t) mpf_rtp_sender_tick(mpf_rtp_sender_t *sender)
+{
+	if(!sender->packet_count) {
+		return FALSE;
+	}
+	return (++sender->hold_ticks > sender->max_hold_ticks) ? TRUE : FALSE;
+}
+
+/** Send all the queued packets */
+MPF_DECLARE(apt_bool_t) mpf_rtp_sender_flush(mpf_rtp_sender_t *sender, apr_size_t *packet_count, apr_size_t *octet_count)
+{
+	apr_size_t i;
+	apr_size_t queued_packets = sender->packet_count;
+	apr_size_t sent_packets = 0;
+	apr_size_t sent_octets = 0;
+	mpf_rtp_sender_packet_t *packet;
+#ifdef MPF_RTP_SENDER_MMSG
+	int sent;
+	apr_os_sock_t fd;
+	if(queued_packets && apr_os_sock_get(&fd,sender->socket) == APR_SUCCESS) {
+		for(i=0; i<queued_packets; i++) {
+			packet = &sender->packets[i];
+			sender->iovecs[i].iov_len = packet->size;
+			sender->messages[i].msg_hdr.msg_name = &packet->sockaddr->sa;
+			sender->messages[i].msg_hdr.msg_namelen = packet->sockaddr->salen;
+		}
+
+		while(sent_packets < queued_packets) {
+			sent = sendmmsg(fd,&sender->messages[sent_packets],(unsigned int)(queued_packets - sent_packets),0);
+			if(sent <= 0) {
+				/* datagrams which cannot be sent now are dropped */
+				break;
+			}
+			for(i=sent_packets; i<sent_packets+sent; i++) {
+				sent_octets += sender->messages[i].msg_len;
+			}
+			sent_packets += sent;
+		}
+	}
+#else
+	apr_size_t size;
+	for(i=0; i<queued_packets; i++) {
+		packet = &sender->packets[i];
+		size = packet->size;
+		if(apr_socket_sendto(sender->socket,packet->sockaddr,0,packet->data,&size) == APR_SUCCESS) {
+			sent_packets++;
+			sent_octets += size;
+		}
+	}
+#endif
+	if(packet_count) {
+		*packet_count = sent_packets;
+	}
+	if(octet_count) {
+		*octet_count = sent_octets;
+	}
+
+	sender->packet_count = 0;
+	sender->hold_ticks = 0;
+	return (sent_packets == queued_packets) ? TRUE : FALSE;
+}
@@ -18,6 +18,8 @@
 #include "apt_net.h"
 #include "apt_timer_queue.h"
 #include "mpf_rtp_stream.h"
+#include "mpf_rtp_poller.h"
+#include "mpf_rtp_sender.h"
 #include "mpf_termination.h"
 #include "mpf_codec_manager.h"
 #include "mpf_rtp_header.h"
@@ -69,6 +71,11 @@ struct mpf_rtp_stream_t {
 	apr_sockaddr_t             *rtcp_l_sockaddr;
 	apr_sockaddr_t             *rtcp_r_sockaddr;
 
+	mpf_rtp_poller_t           *rtp_poller;
+	mpf_rtp_poller_descriptor_t *rtp_poller_descriptor;
+	mpf_rtp_sender_t           *rtp_sender;
+	apr_size_t                  rtp_batch_size;
+
 	apt_timer_t                *rtcp_tx_timer;
 	apt_timer_t                *rtcp_rx_timer;
 	
@@ -79,6 +86,7 @@ static apt_bool_t mpf_rtp_stream_destroy(mpf_audio_stream_t *stream);
 static apt_bool_t mpf_rtp_rx_stream_open(mpf_audio_stream_t *stream, mpf_codec_t *codec);
 static apt_bool_t mpf_rtp_rx_stream_close(mpf_audio_stream_t *stream);
 static apt_bool_t mpf_rtp_stream_receive(mpf_audio_stream_t *stream, mpf_frame_t *frame);
+static apt_bool_t mpf_rtp_stream_borrow(mpf_audio_stream_t *stream, mpf_frame_t *frame);
 static apt_bool_t mpf_rtp_tx_stream_open(mpf_audio_stream_t *stream, mpf_codec_t *codec);
 static apt_bool_t mpf_rtp_tx_stream_close(mpf_audio_stream_t *stream);
 static apt_bool_t mpf_rtp_stream_transmit(mpf_audio_stream_t *stream, const mpf_frame_t *frame);
@@ -98,6 +106,11 @@ static apt_bool_t mpf_rtp_socket_pair_create(mpf_rtp_stream_t *stream, mpf_rtp_m
 static apt_bool_t mpf_rtp_socket_pair_bind(mpf_rtp_stream_t *stream, mpf_rtp_media_descriptor_t *local_media);
 static void mpf_rtp_socket_pair_close(mpf_rtp_stream_t *stream);
 
+static apt_bool_t mpf_rtp_rx_poller_attach(mpf_rtp_stream_t *stream);
+static void mpf_rtp_rx_poller_detach(mpf_rtp_stream_t *stream);
+
+static void mpf_rtp_batch_flush(mpf_rtp_stream_t *rtp_stream);
+
 static apt_bool_t mpf_rtcp_report_send(mpf_rtp_stream_t *stream);
 static apt_bool_t mpf_rtcp_bye_send(mpf_rtp_stream_t *stream, apt_str_t *reason);
 static void mpf_rtcp_tx_timer_proc(apt_timer_t *timer, void *obj);
@@ -115,6 +128,8 @@ MPF_DECLARE(mpf_audio_stream_t*) mpf_rtp_stream_create(mpf_termination_t *termin
 
 	audio_stream->direction = STREAM_DIRECTION_NONE;
 	audio_stream->termination = termination;
+	/* lend the slots of the jitter buffer to the readers of the stream */
+	audio_stream->borrow_frame = mpf_rtp_stream_borrow;
 
 	rtp_stream->base = audio_stream;
 	rtp_stream->pool = pool;
@@ -128,6 +143,10 @@ MPF_DECLARE(mpf_audio_stream_t*) mpf_rtp_stream_create(mpf_termination_t *termin
 	rtp_stream->rtp_r_sockaddr = NULL;
 	rtp_stream->rtcp_l_sockaddr = NULL;
 	rtp_stream->rtcp_r_sockaddr = NULL;
+	rtp_stream->rtp_poller = termination->rtp_poller;
+	rtp_stream->rtp_poller_descriptor = NULL;
+	rtp_stream->rtp_sender = NULL;
+	rtp_stream->rtp_batch_size = termination->rtp_batch_size;
 	rtp_stream->rtcp_tx_timer = NULL;
 	rtp_stream->rtcp_rx_timer = NULL;
 	rtp_stream->state = MPF_MEDIA_DISABLED;
@@ -246,6 +265,7 @@ static apt_bool_t mpf_rtp_stream_local_media_update(mpf_rtp_stream_t *rtp_stream
 	apt_bool_t status = TRUE;
 	if(apt_string_compare(&rtp_stream->local_media->ip,&media->ip) == FALSE ||
 		rtp_stream->local_media->port != media->port) {
+		apt_bool_t attached = rtp_stream->rtp_poller_descriptor ? TRUE : FALSE;
 
 		mpf_rtp_socket_pair_close(rtp_stream);
 
@@ -253,6 +273,10 @@ static apt_bool_t mpf_rtp_stream_local_media_update(mpf_rtp_stream_t *rtp_stream
 			media->state = MPF_MEDIA_DISABLED;
 			status = FALSE;
 		}
+		else if(attached == TRUE) {
+			/* receiver is open, keep polling the new socket */
+			mpf_rtp_rx_poller_attach(rtp_stream);
+		}
 	}
 	if(mpf_codec_list_is_empty(&media->codec_list) == TRUE) {
 		mpf_codec_manager_codec_list_get(
@@ -502,8 +526,10 @@ static apt_bool_t mpf_rtp_rx_stream_open(mpf_audio_stream_t *stream, mpf_codec_t
 						codec,
 						rtp_stream->pool);
 
+	mpf_rtp_rx_poller_attach(rtp_stream);
+
 	apt_log(MPF_LOG_MARK,APT_PRIO_INFO,
-			"Open RTP Receiver %s:%hu <- %s:%hu playout [%u ms] bounds [%u - %u ms] adaptive [%d] skew detection [%d]",
+			"Open RTP Receiver %s:%hu <- %s:%hu playout [%u ms] bounds [%u - %u ms] adaptive [%d] skew detection [%d] plc [%d]",
 			rtp_stream->rtp_l_sockaddr->hostname,
 			rtp_stream->rtp_l_sockaddr->port,
 			rtp_stream->rtp_r_sockaddr->hostname,
@@ -512,7 +538,8 @@ static apt_bool_t mpf_rtp_rx_stream_open(mpf_audio_stream_t *stream, mpf_codec_t
 			jb_config->min_playout_delay,
 			jb_config->max_playout_delay,
 			jb_config->adaptive,
-			jb_config->time_skew_detection);
+			jb_config->time_skew_detection,
+			jb_config->plc);
 	return TRUE;
 }
 
@@ -521,6 +548,8 @@ static apt_bool_t mpf_rtp_rx_stream_close(mpf_audio_stream_t *stream)
 	mpf_rtp_stream_t *rtp_stream = stream->obj;
 	rtp_receiver_t *receiver = &rtp_stream->receiver;
 
+	mpf_rtp_rx_poller_detach(rtp_stream);
+
 	if(!rtp_stream->rtp_l_sockaddr || !rtp_stream->rtp_r_sockaddr) {
 		return FALSE;
 	}
@@ -872,14 +901,33 @@ static apt_bool_t rtp_rx_process(mpf_rtp_stream_t *rtp_stream)
 	return TRUE;
 }
 
+static void rtp_rx_poller_packet_handler(void *obj, void *buffer, apr_size_t size)
+{
+	rtp_rx_packet_receive(obj,buffer,size);
+}
+
 static apt_bool_t mpf_rtp_stream_receive(mpf_audio_stream_t *stream, mpf_frame_t *frame)
 {
 	mpf_rtp_stream_t *rtp_stream = stream->obj;
-	rtp_rx_process(rtp_stream);
+	if(!rtp_stream->rtp_poller_descriptor) {
+		/* packets are not delivered by the poller, read them now */
+		rtp_rx_process(rtp_stream);
+	}
 
 	return mpf_jitter_buffer_read(rtp_stream->receiver.jb,frame);
 }
 
+static apt_bool_t mpf_rtp_stream_borrow(mpf_audio_stream_t *stream, mpf_frame_t *frame)
+{
+	mpf_rtp_stream_t *rtp_stream = stream->obj;
+	if(!rtp_stream->rtp_poller_descriptor) {
+		/* packets are not delivered by the poller, read them now */
+		rtp_rx_process(rtp_stream);
+	}
+
+	return mpf_jitter_buffer_borrow(rtp_stream->receiver.jb,frame);
+}
+
 
 static apt_bool_t mpf_rtp_tx_stream_open(mpf_audio_stream_t *stream, mpf_codec_t *codec)
 {
@@ -925,6 +973,15 @@ static apt_bool_t mpf_rtp_tx_stream_open(mpf_audio_stream_t *stream, mpf_codec_t
 							rtp_stream->pool,
 							sizeof(mpf_codec_frame_t) * transmitter->packet_frames);
 
+	if(rtp_stream->rtp_batch_size && !rtp_stream->rtp_sender) {
+		/* hold the first packet of a batch until the last one is generated */
+		rtp_stream->rtp_sender = mpf_rtp_sender_create(
+							rtp_stream->rtp_batch_size,
+							sizeof(rtp_header_t) + transmitter->packet_frames * frame_size,
+							(rtp_stream->rtp_batch_size - 1) * transmitter->packet_frames,
+							rtp_stream->pool);
+	}
+
 	transmitter->inactivity = 1;
 	transmitter->codec = codec;
 	apt_log(MPF_LOG_MARK,APT_PRIO_INFO,"Open RTP Transmitter %s:%hu -> %s:%hu",
@@ -941,6 +998,7 @@ static apt_bool_t mpf_rtp_tx_stream_close(mpf_audio_stream_t *stream)
 	if(!rtp_stream->rtp_l_sockaddr || !rtp_stream->rtp_r_sockaddr) {
 		return FALSE;
 	}
+	mpf_rtp_batch_flush(rtp_stream);
 	apt_log(MPF_LOG_MARK,APT_PRIO_INFO,"Close RTP Transmitter %s:%hu -> %s:%hu [s:%u o:%u]",
 			rtp_stream->rtp_l_sockaddr->hostname,
 			rtp_stream->rtp_l_sockaddr->port,
@@ -969,6 +1027,55 @@ static APR_INLINE void rtp_header_prepare(
 	header->ssrc = htonl(transmitter->sr_stat.ssrc);
 }
 
+static void mpf_rtp_batch_flush(mpf_rtp_stream_t *rtp_stream)
+{
+	rtcp_sr_stat_t *sr_stat = &rtp_stream->transmitter.sr_stat;
+	apr_size_t packet_count = 0;
+	apr_size_t octet_count = 0;
+	if(!rtp_stream->rtp_sender) {
+		return;
+	}
+
+	/* account the packets actually sent only */
+	mpf_rtp_sender_flush(rtp_stream->rtp_sender,&packet_count,&octet_count);
+	sr_stat->sent_packets += (apr_uint32_t)packet_count;
+	sr_stat->sent_octets += (apr_uint32_t)(octet_count - packet_count * sizeof(rtp_header_t));
+}
+
+static APR_INLINE apt_bool_t mpf_rtp_packet_send(mpf_rtp_stream_t *rtp_stream, const char *data, apr_size_t size)
+{
+	rtcp_sr_stat_t *sr_stat = &rtp_stream->transmitter.sr_stat;
+	if(rtp_stream->rtp_sender) {
+		/* queue packet to send along with the next ones of the stream */
+		if(mpf_rtp_sender_packet_add(
+					rtp_stream->rtp_sender,
+					rtp_stream->rtp_socket,
+					rtp_stream->rtp_r_sockaddr,
+					data,
+					size) == TRUE) {
+			if(mpf_rtp_sender_is_full(rtp_stream->rtp_sender) == TRUE) {
+				mpf_rtp_batch_flush(rtp_stream);
+			}
+			return TRUE;
+		}
+		/* the packet does not fit the sender (e.g. the stream is reopened with a larger ptime),
+		   send the queued packets first to keep the order, then the packet itself */
+		mpf_rtp_batch_flush(rtp_stream);
+	}
+
+	if(apr_socket_sendto(
+				rtp_stream->rtp_socket,
+				rtp_stream->rtp_r_sockaddr,
+				0,
+				data,
+				&size) != APR_SUCCESS) {
+		return FALSE;
+	}
+	sr_stat->sent_packets++;
+	sr_stat->sent_octets += (apr_uint32_t)(size - sizeof(rtp_header_t));
+	return TRUE;
+}
+
 static APR_INLINE apt_bool_t mpf_rtp_data_send(mpf_rtp_stream_t *rtp_stream, rtp_transmitter_t *transmitter, const mpf_frame_t *frame)
 {
 	apt_bool_t status = TRUE;
@@ -997,16 +1104,7 @@ static APR_INLINE apt_bool_t mpf_rtp_data_send(mpf_rtp_stream_t *rtp_stream, rtp
 			return FALSE;
 		}
 
-		if(apr_socket_sendto(
-					rtp_stream->rtp_socket,
-					rtp_stream->rtp_r_sockaddr,
-					0,
-					transmitter->packet_data,
-					&transmitter->packet_size) == APR_SUCCESS) {
-			transmitter->sr_stat.sent_packets++;
-			transmitter->sr_stat.sent_octets += (apr_uint32_t)transmitter->packet_size - sizeof(rtp_header_t);
-		}
-		else {
+		if(mpf_rtp_packet_send(rtp_stream,transmitter->packet_data,transmitter->packet_size) == FALSE) {
 			status = FALSE;
 		}
 		transmitter->current_frames = 0;
@@ -1040,17 +1138,7 @@ static APR_INLINE apt_bool_t mpf_rtp_event_send(mpf_rtp_stream_t *rtp_stream, rt
 		(named_event->edge == 1) ? '*' : ' ');
 	header->timestamp = htonl(header->timestamp);
 	named_event->duration = htons((apr_uint16_t)named_event->duration);
-	if(apr_socket_sendto(
-				rtp_stream->rtp_socket,
-				rtp_stream->rtp_r_sockaddr,
-				0,
-				packet_data,
-				&packet_size) != APR_SUCCESS) {
-		return FALSE;
-	}
-	transmitter->sr_stat.sent_packets++;
-	transmitter->sr_stat.sent_octets += sizeof(mpf_named_event_frame_t);
-	return TRUE;
+	return mpf_rtp_packet_send(rtp_stream,packet_data,packet_size);
 }
 
 static apt_bool_t mpf_rtp_stream_transmit(mpf_audio_stream_t *stream, const mpf_frame_t *frame)
@@ -1061,6 +1149,11 @@ static apt_bool_t mpf_rtp_stream_transmit(mpf_audio_stream_t *stream, const mpf_
 
 	transmitter->timestamp += transmitter->samples_per_frame;
 
+	if(rtp_stream->rtp_sender && mpf_rtp_sender_tick(rtp_stream->rtp_sender) == TRUE) {
+		/* do not hold the queued packets any longer, even if no more packets follow */
+		mpf_rtp_batch_flush(rtp_stream);
+	}
+
 	if(frame->type == MEDIA_FRAME_TYPE_NONE) {
 		if(!transmitter->inactivity) {
 			if(transmitter->current_frames == 0) {
@@ -1197,6 +1290,9 @@ static apt_bool_t mpf_rtp_socket_pair_bind(mpf_rtp_stream_t *stream, mpf_rtp_med
 /* Close RTP/RTCP sockets */
 static void mpf_rtp_socket_pair_close(mpf_rtp_stream_t *stream)
 {
+	mpf_rtp_rx_poller_detach(stream);
+	/* send the packets queued for the socket before it is closed */
+	mpf_rtp_batch_flush(stream);
 	if(stream->rtp_socket) {
 		apr_socket_close(stream->rtp_socket);
 		stream->rtp_socket = NULL;
@@ -1207,6 +1303,30 @@ static void mpf_rtp_socket_pair_close(mpf_rtp_stream_t *stream)
 	}
 }
 
+/* Start receiving RTP packets by the poller, if one is available */
+static apt_bool_t mpf_rtp_rx_poller_attach(mpf_rtp_stream_t *stream)
+{
+	if(!stream->rtp_poller || !stream->rtp_socket || stream->rtp_poller_descriptor) {
+		return FALSE;
+	}
+	stream->rtp_poller_descriptor = mpf_rtp_poller_socket_add(
+										stream->rtp_poller,
+										stream->rtp_socket,
+										rtp_rx_poller_packet_handler,
+										stream,
+										stream->pool);
+	return stream->rtp_poller_descriptor ? TRUE : FALSE;
+}
+
+/* Stop receiving RTP packets by the poller */
+static void mpf_rtp_rx_poller_detach(mpf_rtp_stream_t *stream)
+{
+	if(stream->rtp_poller_descriptor) {
+		mpf_rtp_poller_socket_remove(stream->rtp_poller,stream->rtp_poller_descriptor);
+		stream->rtp_poller_descriptor = NULL;
+	}
+}
+
 
 
 static APR_INLINE void rtcp_sr_generate(mpf_rtp_stream_t *rtp_stream, rtcp_sr_stat_t *sr_stat)
@@ -15,6 +15,7 @@
  */
 
 #include <apr_tables.h>
+#include <apr_thread_mutex.h>
 #include "mpf_termination.h"
 #include "mpf_rtp_termination_factory.h"
 #include "mpf_rtp_stream.h"
@@ -33,6 +34,7 @@ struct rtp_termination_factory_t {
 
 	mpf_rtp_config_t         *config;
 	apr_array_header_t       *media_engine_slots;
+	apr_thread_mutex_t       *guard;
 	apr_pool_t               *pool;
 };
 
@@ -46,10 +48,14 @@ static apt_bool_t mpf_rtp_termination_add(mpf_termination_t *termination, void *
 	apt_bool_t status = TRUE;
 	mpf_rtp_termination_descriptor_t *rtp_descriptor = descriptor;
 	mpf_audio_stream_t *audio_stream = termination->audio_stream;
+	rtp_termination_factory_t *rtp_termination_factory = (rtp_termination_factory_t*)termination->termination_factory;
+
+	/* terminations may be added concurrently by several media processing workers,
+	while RTP port management is shared per media engine */
+	apr_thread_mutex_lock(rtp_termination_factory->guard);
 	if(!audio_stream) {
 		int i;
 		media_engine_slot_t *slot;
-		rtp_termination_factory_t *rtp_termination_factory = (rtp_termination_factory_t*)termination->termination_factory;
 		mpf_rtp_config_t *rtp_config = rtp_termination_factory->config;
 		for(i=0; i<rtp_termination_factory->media_engine_slots->nelts; i++) {
 			slot = &APR_ARRAY_IDX(rtp_termination_factory->media_engine_slots,i,media_engine_slot_t);
@@ -64,6 +70,7 @@ static apt_bool_t mpf_rtp_termination_add(mpf_termination_t *termination, void *
 							rtp_descriptor->audio.settings,
 							termination->pool);
 		if(!audio_stream) {
+			apr_thread_mutex_unlock(rtp_termination_factory->guard);
 			return FALSE;
 		}
 		termination->audio_stream = audio_stream;
@@ -73,6 +80,7 @@ static apt_bool_t mpf_rtp_termination_add(mpf_termination_t *termination, void *
 	if(rtp_descriptor) {
 		status = mpf_rtp_stream_modify(audio_stream,&rtp_descriptor->audio);
 	}
+	apr_thread_mutex_unlock(rtp_termination_factory->guard);
 	return status;
 }
 
@@ -81,12 +89,15 @@ static apt_bool_t mpf_rtp_termination_modify(mpf_termination_t *termination, voi
 	apt_bool_t status = TRUE;
 	mpf_rtp_termination_descriptor_t *rtp_descriptor = descriptor;
 	mpf_audio_stream_t *audio_stream = termination->audio_stream;
+	rtp_termination_factory_t *rtp_termination_factory = (rtp_termination_factory_t*)termination->termination_factory;
 	if(!audio_stream) {
 		return FALSE;
 	}
 
 	if(rtp_descriptor) {
+		apr_thread_mutex_lock(rtp_termination_factory->guard);
 		status = mpf_rtp_stream_modify(audio_stream,&rtp_descriptor->audio);
+		apr_thread_mutex_unlock(rtp_termination_factory->guard);
 	}
 	return status;
 }
@@ -194,6 +205,7 @@ MPF_DECLARE(mpf_termination_factory_t*) mpf_rtp_termination_factory_create(
 	rtp_termination_factory->pool = pool;
 	rtp_termination_factory->config = rtp_config;
 	rtp_termination_factory->media_engine_slots = apr_array_make(pool,1,sizeof(media_engine_slot_t));
+	apr_thread_mutex_create(&rtp_termination_factory->guard,APR_THREAD_MUTEX_DEFAULT,pool);
 	apt_log(MPF_LOG_MARK,APT_PRIO_NOTICE,"Create RTP Termination Factory %s:[%hu,%hu]",
 									rtp_config->ip.buf,
 									rtp_config->rtp_port_min,
@@ -34,6 +34,8 @@ MPF_DECLARE(mpf_termination_t*) mpf_termination_base_create(
 	termination->event_handler = NULL;
 	termination->codec_manager = NULL;
 	termination->timer_queue = NULL;
+	termination->rtp_poller = NULL;
+	termination->rtp_batch_size = 0;
 	termination->termination_factory = termination_factory;
 	termination->vtable = vtable;
 	termination->slot = 0;
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MRCP_AUDIO_WRITER_H
+#define MRCP_AUDIO_WRITER_H
+
+/**
+ * @file mrcp_audio_writer.h
+ * @brief Asynchronous Writer of Audio Files
+ */ 
+
+#include "mpf_codec_descriptor.h"
+
+APT_BEGIN_EXTERN_C
+
+/** Default size of each of the two buffers of an audio file */
+#define MRCP_AUDIO_WRITER_DEFAULT_BUFFER_SIZE 16000
+
+/**
+ * Opaque audio writer declaration.
+ * The writer owns a background I/O thread, which drains the buffers of audio files,
+ * so that the media thread writing to a file never waits for the disk.
+ */
+typedef struct mrcp_audio_writer_t mrcp_audio_writer_t;
+
+/** Opaque audio file declaration */
+typedef struct mrcp_audio_file_t mrcp_audio_file_t;
+
+/**
+ * Create and start audio writer.
+ * @param buffer_size the size of each of the two buffers per file (0 - default)
+ * @param pool the pool to allocate memory from
+ */
+mrcp_audio_writer_t* mrcp_audio_writer_create(apr_size_t buffer_size, apr_pool_t *pool);
+
+/**
+ * Stop and destroy audio writer, the files closed so far are flushed before.
+ * @param writer the writer to destroy
+ */
+apt_bool_t mrcp_audio_writer_destroy(mrcp_audio_writer_t *writer);
+
+/**
+ * Open audio file for writing.
+ * @param writer the writer to drain the file by
+ * @param file_path the path of the file
+ * @param descriptor the descriptor of linear PCM audio to write WAV header for (NULL - raw audio)
+ * @return the opened file or NULL on failure
+ */
+mrcp_audio_file_t* mrcp_audio_file_open(mrcp_audio_writer_t *writer, const char *file_path, const mpf_codec_descriptor_t *descriptor);
+
+/**
+ * Write audio to file, never blocks on I/O.
+ * @param file the file to write to
+ * @param data the audio to write
+ * @param size the size of the audio
+ * @return FALSE if the audio is dropped as a whole since both buffers are not yet drained
+ */
+apt_bool_t mrcp_audio_file_write(mrcp_audio_file_t *file, const void *data, apr_size_t size);
+
+/**
+ * Close audio file, the remaining audio is flushed and the file is closed by the I/O thread.
+ * @param file the file to close, which may not be accessed afterwards
+ */
+apt_bool_t mrcp_audio_file_close(mrcp_audio_file_t *file);
+
+/**
+ * Close audio file the same way, but keep the handle to learn when the file is complete.
+ * @param file the file to close, which must be released by mrcp_audio_file_release()
+ * @see mrcp_audio_file_is_closed()
+ */
+apt_bool_t mrcp_audio_file_close_begin(mrcp_audio_file_t *file);
+
+/**
+ * Check whether the file is flushed and closed by the I/O thread, never blocks.
+ * @param file the file closed by mrcp_audio_file_close_begin()
+ */
+apt_bool_t mrcp_audio_file_is_closed(mrcp_audio_file_t *file);
+
+/**
+ * Release audio file closed by mrcp_audio_file_close_begin(), closed or not yet.
+ * @param file the file to release, which may not be accessed afterwards
+ */
+apt_bool_t mrcp_audio_file_release(mrcp_audio_file_t *file);
+
+APT_END_EXTERN_C
+
+#endif /* MRCP_AUDIO_WRITER_H */
@@ -53,6 +53,20 @@ const mrcp_engine_config_t* mrcp_engine_config_get(const mrcp_engine_t *engine);
 /** Get engine param by name */
 const char* mrcp_engine_param_get(const mrcp_engine_t *engine, const char *name);
 
+/**
+ * Acquire grammar carried in the body of request (DEFINE-GRAMMAR, RECOGNIZE, ...)
+ * from the server-wide grammar cache. The grammar is shared by all the sessions
+ * defining the same content, so a handle (e.g. compiled grammar) attached to it
+ * by mrcp_grammar_handle_attach() can be reused across sessions.
+ * @param engine the engine to acquire grammar by
+ * @param request the request carrying grammar
+ * @return the grammar or NULL if there is no grammar cache or no grammar in the request
+ */
+mrcp_grammar_t* mrcp_engine_grammar_acquire(mrcp_engine_t *engine, const mrcp_message_t *request);
+
+/** Release grammar acquired by mrcp_engine_grammar_acquire() */
+void mrcp_engine_grammar_release(mrcp_engine_t *engine, mrcp_grammar_t *grammar);
+
 
 /** Create engine channel */
 mrcp_engine_channel_t* mrcp_engine_channel_create(
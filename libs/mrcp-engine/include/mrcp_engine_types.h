@@ -25,6 +25,7 @@
 #include <apr_tables.h>
 #include <apr_hash.h>
 #include "mrcp_state_machine.h"
+#include "mrcp_grammar_cache.h"
 #include "mpf_types.h"
 #include "apt_string.h"
 
@@ -144,6 +145,9 @@ struct mrcp_engine_t {
 
 	/** Create state machine */
 	mrcp_state_machine_t* (*create_state_machine)(void *obj, mrcp_version_e version, apr_pool_t *pool);
+
+	/** Server-wide grammar cache (optional), appended to keep the layout of the fields above */
+	mrcp_grammar_cache_t              *grammar_cache;
 };
 
 /** MRCP engine config */
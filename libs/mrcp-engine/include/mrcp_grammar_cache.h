@@ -0,0 +1,110 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MRCP_GRAMMAR_CACHE_H
+#define MRCP_GRAMMAR_CACHE_H
+
+/**
+ * @file mrcp_grammar_cache.h
+ * @brief Server-wide Content-Addressed Cache of Grammars
+ */
+
+#include "apt_string.h"
+
+APT_BEGIN_EXTERN_C
+
+/** Default max size of the cached grammars */
+#define MRCP_GRAMMAR_CACHE_DEFAULT_MAX_SIZE  (16 * 1024 * 1024)
+/** Default max number of the cached grammars */
+#define MRCP_GRAMMAR_CACHE_DEFAULT_MAX_COUNT 4096
+/** Length of the digest of a grammar in hex */
+#define MRCP_GRAMMAR_DIGEST_LENGTH           16
+
+/** Opaque grammar cache declaration */
+typedef struct mrcp_grammar_cache_t mrcp_grammar_cache_t;
+
+/** Grammar declaration */
+typedef struct mrcp_grammar_t mrcp_grammar_t;
+
+/** Prototype of the function destroying a handle attached to grammar */
+typedef void (*mrcp_grammar_handle_destroy_f)(void *handle);
+
+/** Grammar, shared read-only by all the sessions defining the same content */
+struct mrcp_grammar_t {
+	/** Content type of the grammar */
+	apt_str_t content_type;
+	/** Content of the grammar */
+	apt_str_t content;
+	/** Content-ID the grammar has been first defined with */
+	apt_str_t content_id;
+	/** Digest of the content type and the content (64-bit FNV-1a in hex) */
+	char      digest[MRCP_GRAMMAR_DIGEST_LENGTH + 1];
+};
+
+/**
+ * Create grammar cache.
+ * @param max_size the max size of the cached grammars (0 - default)
+ * @param max_count the max number of the cached grammars (0 - default)
+ * @param pool the pool to allocate memory from
+ */
+mrcp_grammar_cache_t* mrcp_grammar_cache_create(apr_size_t max_size, apr_size_t max_count, apr_pool_t *pool);
+
+/**
+ * Destroy grammar cache and the handles attached to the grammars.
+ * @param cache the cache to destroy
+ */
+void mrcp_grammar_cache_destroy(mrcp_grammar_cache_t *cache);
+
+/**
+ * Acquire grammar by content, the grammar is added unless already cached.
+ * @param cache the cache to acquire grammar from
+ * @param content_type the content type of the grammar
+ * @param content the content of the grammar
+ * @param content_id the Content-ID the grammar is defined with (optional)
+ * @return the grammar or NULL if the content is empty
+ */
+mrcp_grammar_t* mrcp_grammar_cache_acquire(mrcp_grammar_cache_t *cache, const apt_str_t *content_type, const apt_str_t *content, const apt_str_t *content_id);
+
+/**
+ * Release grammar previously acquired, the least recently used grammars
+ * not in use are evicted while the cache exceeds its limits.
+ * @param cache the cache the grammar is acquired from
+ * @param grammar the grammar to release
+ */
+void mrcp_grammar_cache_release(mrcp_grammar_cache_t *cache, mrcp_grammar_t *grammar);
+
+/**
+ * Get handle (e.g. compiled grammar) attached to grammar.
+ * @param grammar the grammar to get handle of
+ * @param owner the owner of the handle (e.g. engine)
+ * @return the handle or NULL if not attached yet
+ */
+void* mrcp_grammar_handle_get(mrcp_grammar_t *grammar, const void *owner);
+
+/**
+ * Attach handle (e.g. compiled grammar) to grammar, the handle is destroyed along with the grammar.
+ * @param grammar the grammar to attach handle to
+ * @param owner the owner of the handle (e.g. engine)
+ * @param handle the handle to attach
+ * @param destroy the function to destroy the handle with (optional)
+ * @return the attached handle, which is another one if attached by the same owner before
+ * @remark If another handle is returned, the given one is not attached and remains owned by the caller.
+ */
+void* mrcp_grammar_handle_attach(mrcp_grammar_t *grammar, const void *owner, void *handle, mrcp_grammar_handle_destroy_f destroy);
+
+APT_END_EXTERN_C
+
+#endif /* MRCP_GRAMMAR_CACHE_H */
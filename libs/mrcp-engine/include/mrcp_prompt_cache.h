@@ -0,0 +1,79 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MRCP_PROMPT_CACHE_H
+#define MRCP_PROMPT_CACHE_H
+
+/**
+ * @file mrcp_prompt_cache.h
+ * @brief Cache of Memory-Mapped Prerecorded Prompts
+ */ 
+
+#include "mpf_codec_descriptor.h"
+
+APT_BEGIN_EXTERN_C
+
+/** Default max size of the prompts kept mapped while not in use */
+#define MRCP_PROMPT_CACHE_DEFAULT_MAX_SIZE (64 * 1024 * 1024)
+
+/** Opaque prompt cache declaration */
+typedef struct mrcp_prompt_cache_t mrcp_prompt_cache_t;
+
+/** Prompt declaration */
+typedef struct mrcp_prompt_t mrcp_prompt_t;
+
+/** Prompt, the audio is shared read-only by all the channels playing the prompt */
+struct mrcp_prompt_t {
+	/** Audio data (the header of WAV file is skipped) */
+	const apr_byte_t *data;
+	/** Size of audio data */
+	apr_size_t        size;
+};
+
+/**
+ * Create prompt cache.
+ * @param max_size the max size of the prompts kept mapped while not in use (0 - default)
+ * @param pool the pool to allocate memory from
+ */
+mrcp_prompt_cache_t* mrcp_prompt_cache_create(apr_size_t max_size, apr_pool_t *pool);
+
+/**
+ * Destroy prompt cache, all the prompts must be released before.
+ * @param cache the cache to destroy
+ */
+void mrcp_prompt_cache_destroy(mrcp_prompt_cache_t *cache);
+
+/**
+ * Acquire prompt, the file is mapped unless already cached and not modified since.
+ * @param cache the cache to acquire prompt from
+ * @param file_path the path of raw PCM or WAV file
+ * @param descriptor the codec descriptor the prompt is recorded in
+ * @return the prompt or NULL if the file cannot be mapped
+ * @remark Must not be called from the media thread.
+ */
+mrcp_prompt_t* mrcp_prompt_cache_acquire(mrcp_prompt_cache_t *cache, const char *file_path, const mpf_codec_descriptor_t *descriptor);
+
+/**
+ * Release prompt previously acquired.
+ * @param cache the cache the prompt is acquired from
+ * @param prompt the prompt to release
+ * @remark Lock-free, may be called from the media thread.
+ */
+void mrcp_prompt_cache_release(mrcp_prompt_cache_t *cache, mrcp_prompt_t *prompt);
+
+APT_END_EXTERN_C
+
+#endif /* MRCP_PROMPT_CACHE_H */
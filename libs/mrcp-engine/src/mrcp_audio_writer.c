@@ -0,0 +1,357 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <apr_thread_proc.h>
+#include <apr_thread_mutex.h>
+#include <apr_thread_cond.h>
+#include <apr_atomic.h>
+#include "mrcp_audio_writer.h"
+#include "apt_log.h"
+
+/** Size of canonical WAV header */
+#define WAV_HEADER_SIZE 44
+
+/** Buffer of audio */
+typedef struct mrcp_audio_buffer_t mrcp_audio_buffer_t;
+struct mrcp_audio_buffer_t {
+	apr_byte_t *data;
+	apr_size_t  size;
+};
+
+/** Audio file */
+struct mrcp_audio_file_t {
+	/** Next file in the list of files to be drained */
+	mrcp_audio_file_t   *next;
+	mrcp_audio_writer_t *writer;
+	FILE                *fp;
+	const char          *file_path;
+
+	/** Double buffer, the active one is filled by the media thread only */
+	mrcp_audio_buffer_t  buffers[2];
+	mrcp_audio_buffer_t *active;
+	/** Full buffer handed over to the I/O thread */
+	mrcp_audio_buffer_t *pending;
+
+	/** Whether the file is in the list of files to be drained */
+	apt_bool_t           queued;
+	/** Whether the file is closed by the user */
+	apt_bool_t           closing;
+	/** Whether WAV header is written */
+	apt_bool_t           wav_header;
+	/** Size of the audio written to the file */
+	apr_size_t           written_size;
+	/** Size of the audio dropped */
+	apr_size_t           dropped_size;
+
+	/** Whether the file is flushed and closed by the I/O thread */
+	volatile apr_uint32_t closed;
+	/** References held by the user and the I/O thread, the last one frees the file */
+	volatile apr_uint32_t ref_count;
+};
+
+/** Audio writer */
+struct mrcp_audio_writer_t {
+	apr_size_t          buffer_size;
+	apr_thread_t       *thread;
+	apr_thread_mutex_t *guard;
+	apr_thread_cond_t  *wait_object;
+	/** List of files to be drained */
+	mrcp_audio_file_t  *files;
+	apt_bool_t          running;
+};
+
+static void* APR_THREAD_FUNC mrcp_audio_writer_run(apr_thread_t *thread, void *data);
+
+mrcp_audio_writer_t* mrcp_audio_writer_create(apr_size_t buffer_size, apr_pool_t *pool)
+{
+	mrcp_audio_writer_t *writer = apr_palloc(pool,sizeof(mrcp_audio_writer_t));
+	writer->buffer_size = buffer_size ? buffer_size : MRCP_AUDIO_WRITER_DEFAULT_BUFFER_SIZE;
+	writer->files = NULL;
+	writer->running = TRUE;
+	writer->thread = NULL;
+	apr_thread_mutex_create(&writer->guard,APR_THREAD_MUTEX_UNNESTED,pool);
+	apr_thread_cond_create(&writer->wait_object,pool);
+
+	if(apr_thread_create(&writer->thread,NULL,mrcp_audio_writer_run,writer,pool) != APR_SUCCESS) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Create Audio Writer Thread");
+		apr_thread_cond_destroy(writer->wait_object);
+		apr_thread_mutex_destroy(writer->guard);
+		return NULL;
+	}
+	return writer;
+}
+
+apt_bool_t mrcp_audio_writer_destroy(mrcp_audio_writer_t *writer)
+{
+	apr_status_t retval;
+
+	apr_thread_mutex_lock(writer->guard);
+	writer->running = FALSE;
+	apr_thread_cond_signal(writer->wait_object);
+	apr_thread_mutex_unlock(writer->guard);
+
+	apr_thread_join(&retval,writer->thread);
+	writer->thread = NULL;
+
+	apr_thread_cond_destroy(writer->wait_object);
+	apr_thread_mutex_destroy(writer->guard);
+	return TRUE;
+}
+
+static void mrcp_audio_wav_header_write(mrcp_audio_file_t *file, const mpf_codec_descriptor_t *descriptor)
+{
+	apr_byte_t header[WAV_HEADER_SIZE];
+	apr_uint32_t data_size = (apr_uint32_t)file->written_size;
+	apr_uint32_t channel_count = descriptor ? descriptor->channel_count : 1;
+	apr_uint32_t sampling_rate = descriptor ? descriptor->sampling_rate : 8000;
+	apr_uint32_t value;
+	apr_size_t i;
+	const apr_uint32_t fields[] = {
+		36 + data_size,                    /* RIFF chunk size */
+		16,                                /* fmt chunk size */
+		1 | (channel_count << 16),         /* PCM format and channel count */
+		sampling_rate,                     /* sampling rate */
+		sampling_rate * channel_count * 2, /* byte rate */
+		(channel_count * 2) | (16 << 16),  /* block align and bits per sample */
+		data_size                          /* data chunk size */
+	};
+	const apr_size_t offsets[] = {4, 16, 20, 24, 28, 32, 40};
+
+	memcpy(header,"RIFF....WAVEfmt ",16);
+	memcpy(header+36,"data",4);
+	/* the fields are little-endian regardless of the host */
+	for(i=0; i<sizeof(offsets)/sizeof(offsets[0]); i++) {
+		value = fields[i];
+		header[offsets[i]]   = (apr_byte_t)value;
+		header[offsets[i]+1] = (apr_byte_t)(value >> 8);
+		header[offsets[i]+2] = (apr_byte_t)(value >> 16);
+		header[offsets[i]+3] = (apr_byte_t)(value >> 24);
+	}
+	fwrite(header,1,WAV_HEADER_SIZE,file->fp);
+}
+
+mrcp_audio_file_t* mrcp_audio_file_open(mrcp_audio_writer_t *writer, const char *file_path, const mpf_codec_descriptor_t *descriptor)
+{
+	mrcp_audio_file_t *file;
+	FILE *fp = fopen(file_path,"wb");
+	if(!fp) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Open Audio File [%s] for Writing",file_path);
+		return NULL;
+	}
+
+	/* the file outlives the channel until flushed by the I/O thread, thus it is not allocated from the channel pool */
+	file = malloc(sizeof(mrcp_audio_file_t) + 2 * writer->buffer_size + strlen(file_path) + 1);
+	if(!file) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Allocate Buffers of Audio File [%s]",file_path);
+		fclose(fp);
+		return NULL;
+	}
+	file->next = NULL;
+	file->writer = writer;
+	file->fp = fp;
+	file->buffers[0].data = (apr_byte_t*)(file + 1);
+	file->buffers[0].size = 0;
+	file->buffers[1].data = file->buffers[0].data + writer->buffer_size;
+	file->buffers[1].size = 0;
+	file->file_path = strcpy((char*)file->buffers[1].data + writer->buffer_size,file_path);
+	file->active = &file->buffers[0];
+	file->pending = NULL;
+	file->queued = FALSE;
+	file->closing = FALSE;
+	file->wav_header = descriptor ? TRUE : FALSE;
+	file->written_size = 0;
+	file->dropped_size = 0;
+	file->closed = FALSE;
+	file->ref_count = 2;
+
+	if(file->wav_header == TRUE) {
+		/* the sizes are updated on close */
+		mrcp_audio_wav_header_write(file,descriptor);
+	}
+	return file;
+}
+
+/** Queue the file to be drained by the I/O thread, the writer guard must be locked */
+static void mrcp_audio_file_queue(mrcp_audio_file_t *file)
+{
+	mrcp_audio_writer_t *writer = file->writer;
+	if(file->queued == FALSE) {
+		file->queued = TRUE;
+		file->next = writer->files;
+		writer->files = file;
+		apr_thread_cond_signal(writer->wait_object);
+	}
+}
+
+apt_bool_t mrcp_audio_file_write(mrcp_audio_file_t *file, const void *data, apr_size_t size)
+{
+	mrcp_audio_writer_t *writer = file->writer;
+	mrcp_audio_buffer_t *active = file->active;
+	apr_size_t chunk_size = writer->buffer_size - active->size;
+
+	if(size > chunk_size) {
+		/* the audio is written as a whole or dropped, the rest must fit the other buffer, which must be drained */
+		apr_thread_mutex_lock(writer->guard);
+		if(file->pending || size - chunk_size > writer->buffer_size) {
+			apr_thread_mutex_unlock(writer->guard);
+			file->dropped_size += size;
+			return FALSE;
+		}
+		/* fill the active buffer up and hand it over to the I/O thread */
+		memcpy(active->data + active->size,data,chunk_size);
+		active->size += chunk_size;
+		file->pending = active;
+		mrcp_audio_file_queue(file);
+		apr_thread_mutex_unlock(writer->guard);
+
+		data = (const apr_byte_t*)data + chunk_size;
+		size -= chunk_size;
+		active = (active == &file->buffers[0]) ? &file->buffers[1] : &file->buffers[0];
+		file->active = active;
+	}
+
+	memcpy(active->data + active->size,data,size);
+	active->size += size;
+	return TRUE;
+}
+
+apt_bool_t mrcp_audio_file_close_begin(mrcp_audio_file_t *file)
+{
+	mrcp_audio_writer_t *writer = file->writer;
+	apr_thread_mutex_lock(writer->guard);
+	file->closing = TRUE;
+	mrcp_audio_file_queue(file);
+	apr_thread_mutex_unlock(writer->guard);
+	return TRUE;
+}
+
+apt_bool_t mrcp_audio_file_is_closed(mrcp_audio_file_t *file)
+{
+	return apr_atomic_read32(&file->closed) ? TRUE : FALSE;
+}
+
+apt_bool_t mrcp_audio_file_release(mrcp_audio_file_t *file)
+{
+	/* the writer may be destroyed by now, thus the file is not guarded by its lock */
+	if(!apr_atomic_dec32(&file->ref_count)) {
+		free(file);
+	}
+	return TRUE;
+}
+
+apt_bool_t mrcp_audio_file_close(mrcp_audio_file_t *file)
+{
+	mrcp_audio_file_close_begin(file);
+	return mrcp_audio_file_release(file);
+}
+
+/** Write the buffer to the file, called from the I/O thread */
+static void mrcp_audio_buffer_flush(mrcp_audio_file_t *file, mrcp_audio_buffer_t *buffer)
+{
+	if(buffer->size) {
+		file->written_size += fwrite(buffer->data,1,buffer->size,file->fp);
+	}
+}
+
+/** Finalize and close the file, called from the I/O thread */
+static void mrcp_audio_file_finalize(mrcp_audio_file_t *file)
+{
+	mrcp_audio_buffer_flush(file,file->active);
+	if(file->wav_header == TRUE) {
+		/* rewrite the header with the actual sizes */
+		apr_byte_t sizes[4];
+		apr_uint32_t data_size = (apr_uint32_t)file->written_size;
+		apr_uint32_t riff_size = data_size + 36;
+		sizes[0] = (apr_byte_t)riff_size;
+		sizes[1] = (apr_byte_t)(riff_size >> 8);
+		sizes[2] = (apr_byte_t)(riff_size >> 16);
+		sizes[3] = (apr_byte_t)(riff_size >> 24);
+		fseek(file->fp,4,SEEK_SET);
+		fwrite(sizes,1,4,file->fp);
+		sizes[0] = (apr_byte_t)data_size;
+		sizes[1] = (apr_byte_t)(data_size >> 8);
+		sizes[2] = (apr_byte_t)(data_size >> 16);
+		sizes[3] = (apr_byte_t)(data_size >> 24);
+		fseek(file->fp,40,SEEK_SET);
+		fwrite(sizes,1,4,file->fp);
+	}
+	fclose(file->fp);
+
+	if(file->dropped_size) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Dropped Audio [%"APR_SIZE_T_FMT" bytes] of File [%s]",
+			file->dropped_size,file->file_path);
+	}
+
+	apr_atomic_set32(&file->closed,TRUE);
+	mrcp_audio_file_release(file);
+}
+
+/** Drain the list of files, called from the I/O thread */
+static void mrcp_audio_files_process(mrcp_audio_writer_t *writer, mrcp_audio_file_t *file)
+{
+	mrcp_audio_file_t *next;
+	mrcp_audio_buffer_t *pending;
+	apt_bool_t closing;
+
+	while(file) {
+		apr_thread_mutex_lock(writer->guard);
+		next = file->next;
+		pending = file->pending;
+		closing = file->closing;
+		file->queued = FALSE;
+		apr_thread_mutex_unlock(writer->guard);
+
+		if(pending) {
+			/* write outside the lock, the media thread keeps filling the other buffer meanwhile */
+			mrcp_audio_buffer_flush(file,pending);
+			apr_thread_mutex_lock(writer->guard);
+			pending->size = 0;
+			file->pending = NULL;
+			apr_thread_mutex_unlock(writer->guard);
+		}
+		if(closing == TRUE) {
+			/* no more writes from the media thread */
+			mrcp_audio_file_finalize(file);
+		}
+		file = next;
+	}
+}
+
+static void* APR_THREAD_FUNC mrcp_audio_writer_run(apr_thread_t *thread, void *data)
+{
+	mrcp_audio_writer_t *writer = data;
+	mrcp_audio_file_t *files;
+	apt_bool_t running = TRUE;
+
+	while(running == TRUE) {
+		apr_thread_mutex_lock(writer->guard);
+		while(!writer->files && writer->running == TRUE) {
+			apr_thread_cond_wait(writer->wait_object,writer->guard);
+		}
+		files = writer->files;
+		writer->files = NULL;
+		/* keep running until the files closed so far are flushed */
+		running = (writer->running == TRUE || files) ? TRUE : FALSE;
+		apr_thread_mutex_unlock(writer->guard);
+
+		mrcp_audio_files_process(writer,files);
+	}
+
+	apr_thread_exit(thread,APR_SUCCESS);
+	return NULL;
+}
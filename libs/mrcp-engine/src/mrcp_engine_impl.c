@@ -16,6 +16,7 @@
 
 #include "mrcp_engine_impl.h"
 #include "mpf_termination_factory.h"
+#include "mrcp_message.h"
 
 /** Create engine */
 mrcp_engine_t* mrcp_engine_create(
@@ -34,6 +35,7 @@ mrcp_engine_t* mrcp_engine_create(
 	engine->config = NULL;
 	engine->codec_manager = NULL;
 	engine->dir_layout = NULL;
+	engine->grammar_cache = NULL;
 	engine->cur_channel_count = 0;
 	engine->is_open = FALSE;
 	engine->pool = pool;
@@ -56,6 +58,33 @@ const char* mrcp_engine_param_get(const mrcp_engine_t *engine, const char *name)
 	return apr_table_get(engine->config->params,name);
 }
 
+/** Acquire grammar carried in the body of request from the grammar cache */
+mrcp_grammar_t* mrcp_engine_grammar_acquire(mrcp_engine_t *engine, const mrcp_message_t *request)
+{
+	mrcp_generic_header_t *generic_header;
+	const apt_str_t *content_id = NULL;
+	if(!engine->grammar_cache || !request->body.length) {
+		return NULL;
+	}
+
+	generic_header = mrcp_generic_header_get(request);
+	if(!generic_header || mrcp_generic_header_property_check(request,GENERIC_HEADER_CONTENT_TYPE) != TRUE) {
+		return NULL;
+	}
+	if(mrcp_generic_header_property_check(request,GENERIC_HEADER_CONTENT_ID) == TRUE) {
+		content_id = &generic_header->content_id;
+	}
+	return mrcp_grammar_cache_acquire(engine->grammar_cache,&generic_header->content_type,&request->body,content_id);
+}
+
+/** Release grammar acquired from the grammar cache */
+void mrcp_engine_grammar_release(mrcp_engine_t *engine, mrcp_grammar_t *grammar)
+{
+	if(engine->grammar_cache && grammar) {
+		mrcp_grammar_cache_release(engine->grammar_cache,grammar);
+	}
+}
+
 /** Create engine channel */
 mrcp_engine_channel_t* mrcp_engine_channel_create(
 							mrcp_engine_t *engine, 
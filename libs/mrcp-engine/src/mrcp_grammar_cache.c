@@ -0,0 +1,353 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <apr_hash.h>
+#include <apr_thread_mutex.h>
+#include "mrcp_grammar_cache.h"
+#include "apt_log.h"
+
+/** FNV-1a 64-bit offset basis and prime */
+#define FNV64_OFFSET_BASIS APR_UINT64_C(0xcbf29ce484222325)
+#define FNV64_PRIME        APR_UINT64_C(0x100000001b3)
+
+typedef struct mrcp_grammar_entry_t mrcp_grammar_entry_t;
+typedef struct mrcp_grammar_handle_t mrcp_grammar_handle_t;
+
+/** Handle attached to grammar */
+struct mrcp_grammar_handle_t {
+	const void                   *owner;
+	void                         *handle;
+	mrcp_grammar_handle_destroy_f destroy;
+	mrcp_grammar_handle_t        *next;
+};
+
+/** Entry of the cache, the grammar is the first member to get the entry back from the grammar */
+struct mrcp_grammar_entry_t {
+	mrcp_grammar_t         grammar;
+	/** Hash of the content type and the content */
+	apr_uint64_t           hash;
+	/** Next entry with the same hash */
+	mrcp_grammar_entry_t  *next_same;
+	/** Neighbours in the list of entries, the most recently used first */
+	mrcp_grammar_entry_t  *lru_prev;
+	mrcp_grammar_entry_t  *lru_next;
+	/** Number of sessions using the grammar */
+	apr_size_t             ref_count;
+	/** Size accounted for the entry */
+	apr_size_t             size;
+	/** Handles attached to the grammar */
+	mrcp_grammar_handle_t *handles;
+	mrcp_grammar_cache_t  *cache;
+	apr_pool_t            *pool;
+};
+
+/** Grammar cache */
+struct mrcp_grammar_cache_t {
+	/** Table of entries by hash */
+	apr_hash_t           *entries;
+	/** List of entries, the most and the least recently used */
+	mrcp_grammar_entry_t *lru_head;
+	mrcp_grammar_entry_t *lru_tail;
+	/** Total size and number of the entries */
+	apr_size_t            size;
+	apr_size_t            count;
+	apr_size_t            max_size;
+	apr_size_t            max_count;
+	/** Statistics of the lookups */
+	apr_size_t            hit_count;
+	apr_size_t            miss_count;
+	apr_thread_mutex_t   *guard;
+	apr_pool_t           *pool;
+};
+
+mrcp_grammar_cache_t* mrcp_grammar_cache_create(apr_size_t max_size, apr_size_t max_count, apr_pool_t *pool)
+{
+	mrcp_grammar_cache_t *cache = apr_palloc(pool,sizeof(mrcp_grammar_cache_t));
+	cache->entries = apr_hash_make(pool);
+	cache->lru_head = NULL;
+	cache->lru_tail = NULL;
+	cache->size = 0;
+	cache->count = 0;
+	cache->max_size = max_size ? max_size : MRCP_GRAMMAR_CACHE_DEFAULT_MAX_SIZE;
+	cache->max_count = max_count ? max_count : MRCP_GRAMMAR_CACHE_DEFAULT_MAX_COUNT;
+	cache->hit_count = 0;
+	cache->miss_count = 0;
+	cache->pool = pool;
+	apr_thread_mutex_create(&cache->guard,APR_THREAD_MUTEX_UNNESTED,pool);
+	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Create Grammar Cache max size [%"APR_SIZE_T_FMT"] max count [%"APR_SIZE_T_FMT"]",
+		cache->max_size,
+		cache->max_count);
+	return cache;
+}
+
+static APR_INLINE apr_uint64_t mrcp_grammar_hash_update(apr_uint64_t hash, const char *buf, apr_size_t length)
+{
+	const unsigned char *pos = (const unsigned char*)buf;
+	const unsigned char *end = pos + length;
+	for(; pos < end; pos++) {
+		hash ^= *pos;
+		hash *= FNV64_PRIME;
+	}
+	return hash;
+}
+
+static apr_uint64_t mrcp_grammar_hash_calculate(const apt_str_t *content_type, const apt_str_t *content)
+{
+	apr_uint64_t hash = FNV64_OFFSET_BASIS;
+	hash = mrcp_grammar_hash_update(hash,content_type->buf,content_type->length);
+	/* separate the content type from the content */
+	hash = mrcp_grammar_hash_update(hash,"\n",1);
+	return mrcp_grammar_hash_update(hash,content->buf,content->length);
+}
+
+static void mrcp_grammar_digest_format(char *digest, apr_uint64_t hash)
+{
+	static const char hex_digits[] = "0123456789abcdef";
+	int i;
+	for(i = MRCP_GRAMMAR_DIGEST_LENGTH - 1; i >= 0; i--) {
+		digest[i] = hex_digits[hash & 0x0F];
+		hash >>= 4;
+	}
+	digest[MRCP_GRAMMAR_DIGEST_LENGTH] = '\0';
+}
+
+static APR_INLINE void mrcp_grammar_lru_remove(mrcp_grammar_cache_t *cache, mrcp_grammar_entry_t *entry)
+{
+	if(entry->lru_prev)
+		entry->lru_prev->lru_next = entry->lru_next;
+	else
+		cache->lru_head = entry->lru_next;
+	if(entry->lru_next)
+		entry->lru_next->lru_prev = entry->lru_prev;
+	else
+		cache->lru_tail = entry->lru_prev;
+	entry->lru_prev = entry->lru_next = NULL;
+}
+
+static APR_INLINE void mrcp_grammar_lru_push_front(mrcp_grammar_cache_t *cache, mrcp_grammar_entry_t *entry)
+{
+	entry->lru_prev = NULL;
+	entry->lru_next = cache->lru_head;
+	if(cache->lru_head)
+		cache->lru_head->lru_prev = entry;
+	else
+		cache->lru_tail = entry;
+	cache->lru_head = entry;
+}
+
+static void mrcp_grammar_entry_destroy(mrcp_grammar_cache_t *cache, mrcp_grammar_entry_t *entry)
+{
+	mrcp_grammar_handle_t *handle;
+	apt_log(APT_LOG_MARK,APT_PRIO_DEBUG,"Evict Grammar [%s] size [%"APR_SIZE_T_FMT"]",entry->grammar.digest,entry->size);
+	for(handle = entry->handles; handle; handle = handle->next) {
+		if(handle->destroy) {
+			handle->destroy(handle->handle);
+		}
+	}
+	cache->size -= entry->size;
+	cache->count--;
+	apr_pool_destroy(entry->pool);
+}
+
+/** Remove the entry from the chain of entries with the same hash */
+static void mrcp_grammar_entry_unlink(mrcp_grammar_cache_t *cache, mrcp_grammar_entry_t *entry)
+{
+	mrcp_grammar_entry_t *first = apr_hash_get(cache->entries,&entry->hash,sizeof(entry->hash));
+	mrcp_grammar_entry_t **link;
+	if(first == entry) {
+		/* the key is kept by the entry, set it again by the next one */
+		apr_hash_set(cache->entries,&entry->hash,sizeof(entry->hash),NULL);
+		if(entry->next_same) {
+			apr_hash_set(cache->entries,&entry->next_same->hash,sizeof(entry->hash),entry->next_same);
+		}
+		return;
+	}
+	for(link = &first->next_same; *link; link = &(*link)->next_same) {
+		if(*link == entry) {
+			*link = entry->next_same;
+			return;
+		}
+	}
+}
+
+/** Evict the least recently used entries not in use, while the cache exceeds its limits */
+static void mrcp_grammar_cache_evict(mrcp_grammar_cache_t *cache)
+{
+	mrcp_grammar_entry_t *entry = cache->lru_tail;
+	mrcp_grammar_entry_t *prev;
+	while(entry && (cache->size > cache->max_size || cache->count > cache->max_count)) {
+		prev = entry->lru_prev;
+		if(!entry->ref_count) {
+			mrcp_grammar_lru_remove(cache,entry);
+			mrcp_grammar_entry_unlink(cache,entry);
+			mrcp_grammar_entry_destroy(cache,entry);
+		}
+		entry = prev;
+	}
+}
+
+void mrcp_grammar_cache_destroy(mrcp_grammar_cache_t *cache)
+{
+	mrcp_grammar_entry_t *entry = cache->lru_head;
+	mrcp_grammar_entry_t *next;
+	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Destroy Grammar Cache hits [%"APR_SIZE_T_FMT"] misses [%"APR_SIZE_T_FMT"]",
+		cache->hit_count,
+		cache->miss_count);
+	while(entry) {
+		next = entry->lru_next;
+		if(entry->ref_count) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Grammar [%s] Still in Use",entry->grammar.digest);
+		}
+		mrcp_grammar_entry_destroy(cache,entry);
+		entry = next;
+	}
+	cache->lru_head = cache->lru_tail = NULL;
+	apr_hash_clear(cache->entries);
+	apr_thread_mutex_destroy(cache->guard);
+}
+
+static mrcp_grammar_entry_t* mrcp_grammar_entry_create(mrcp_grammar_cache_t *cache, apr_uint64_t hash, const apt_str_t *content_type, const apt_str_t *content, const apt_str_t *content_id)
+{
+	apr_pool_t *pool;
+	mrcp_grammar_entry_t *entry;
+
+	if(apr_pool_create(&pool,cache->pool) != APR_SUCCESS) {
+		return NULL;
+	}
+	entry = apr_palloc(pool,sizeof(mrcp_grammar_entry_t));
+	apt_string_copy(&entry->grammar.content_type,content_type,pool);
+	apt_string_copy(&entry->grammar.content,content,pool);
+	apt_string_reset(&entry->grammar.content_id);
+	if(content_id) {
+		apt_string_copy(&entry->grammar.content_id,content_id,pool);
+	}
+	mrcp_grammar_digest_format(entry->grammar.digest,hash);
+	entry->hash = hash;
+	entry->next_same = NULL;
+	entry->lru_prev = entry->lru_next = NULL;
+	entry->ref_count = 0;
+	entry->size = sizeof(mrcp_grammar_entry_t) + content_type->length + content->length;
+	entry->handles = NULL;
+	entry->cache = cache;
+	entry->pool = pool;
+	return entry;
+}
+
+mrcp_grammar_t* mrcp_grammar_cache_acquire(mrcp_grammar_cache_t *cache, const apt_str_t *content_type, const apt_str_t *content, const apt_str_t *content_id)
+{
+	apr_uint64_t hash;
+	mrcp_grammar_entry_t *first;
+	mrcp_grammar_entry_t *entry;
+
+	if(!content || !content->length) {
+		return NULL;
+	}
+	/* hash the content outside of the guard */
+	hash = mrcp_grammar_hash_calculate(content_type,content);
+
+	apr_thread_mutex_lock(cache->guard);
+	first = apr_hash_get(cache->entries,&hash,sizeof(hash));
+	for(entry = first; entry; entry = entry->next_same) {
+		if(apt_string_compare(&entry->grammar.content,content) == TRUE &&
+			apt_string_compare(&entry->grammar.content_type,content_type) == TRUE) {
+			break;
+		}
+	}
+
+	if(entry) {
+		cache->hit_count++;
+		mrcp_grammar_lru_remove(cache,entry);
+	}
+	else {
+		cache->miss_count++;
+		entry = mrcp_grammar_entry_create(cache,hash,content_type,content,content_id);
+		if(entry) {
+			entry->next_same = first;
+			if(first) {
+				/* the key is kept by the first entry, set it again by the new one */
+				apr_hash_set(cache->entries,&first->hash,sizeof(first->hash),NULL);
+			}
+			apr_hash_set(cache->entries,&entry->hash,sizeof(entry->hash),entry);
+			cache->size += entry->size;
+			cache->count++;
+			apt_log(APT_LOG_MARK,APT_PRIO_DEBUG,"Add Grammar [%s] <%s> size [%"APR_SIZE_T_FMT"]",
+				entry->grammar.digest,
+				entry->grammar.content_id.buf ? entry->grammar.content_id.buf : "",
+				entry->size);
+		}
+	}
+
+	if(entry) {
+		entry->ref_count++;
+		mrcp_grammar_lru_push_front(cache,entry);
+	}
+	mrcp_grammar_cache_evict(cache);
+	apr_thread_mutex_unlock(cache->guard);
+	return entry ? &entry->grammar : NULL;
+}
+
+void mrcp_grammar_cache_release(mrcp_grammar_cache_t *cache, mrcp_grammar_t *grammar)
+{
+	mrcp_grammar_entry_t *entry = (mrcp_grammar_entry_t*)grammar;
+	apr_thread_mutex_lock(cache->guard);
+	if(entry->ref_count) {
+		entry->ref_count--;
+	}
+	mrcp_grammar_cache_evict(cache);
+	apr_thread_mutex_unlock(cache->guard);
+}
+
+void* mrcp_grammar_handle_get(mrcp_grammar_t *grammar, const void *owner)
+{
+	mrcp_grammar_entry_t *entry = (mrcp_grammar_entry_t*)grammar;
+	mrcp_grammar_handle_t *handle;
+	void *obj = NULL;
+
+	apr_thread_mutex_lock(entry->cache->guard);
+	for(handle = entry->handles; handle; handle = handle->next) {
+		if(handle->owner == owner) {
+			obj = handle->handle;
+			break;
+		}
+	}
+	apr_thread_mutex_unlock(entry->cache->guard);
+	return obj;
+}
+
+void* mrcp_grammar_handle_attach(mrcp_grammar_t *grammar, const void *owner, void *obj, mrcp_grammar_handle_destroy_f destroy)
+{
+	mrcp_grammar_entry_t *entry = (mrcp_grammar_entry_t*)grammar;
+	mrcp_grammar_handle_t *handle;
+
+	apr_thread_mutex_lock(entry->cache->guard);
+	for(handle = entry->handles; handle; handle = handle->next) {
+		if(handle->owner == owner) {
+			/* attached by another session in the meantime */
+			obj = handle->handle;
+			break;
+		}
+	}
+	if(!handle) {
+		handle = apr_palloc(entry->pool,sizeof(mrcp_grammar_handle_t));
+		handle->owner = owner;
+		handle->handle = obj;
+		handle->destroy = destroy;
+		handle->next = entry->handles;
+		entry->handles = handle;
+	}
+	apr_thread_mutex_unlock(entry->cache->guard);
+	return obj;
+}
@@ -0,0 +1,237 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <apr_hash.h>
+#include <apr_file_io.h>
+#include <apr_mmap.h>
+#include <apr_atomic.h>
+#include <apr_thread_mutex.h>
+#include "mrcp_prompt_cache.h"
+#include "apt_log.h"
+
+/** Size of RIFF header and of chunk header of WAV file */
+#define WAV_RIFF_HEADER_SIZE  12
+#define WAV_CHUNK_HEADER_SIZE 8
+
+typedef struct mrcp_prompt_entry_t mrcp_prompt_entry_t;
+
+/** Entry of the cache, the prompt is the first member to get the entry back from the prompt */
+struct mrcp_prompt_entry_t {
+	mrcp_prompt_t         prompt;
+	/** Next entry in the list of all the entries */
+	mrcp_prompt_entry_t  *next;
+	/** Key of the entry (path and codec) */
+	const char           *key;
+	/** Number of channels playing the prompt */
+	volatile apr_uint32_t ref_count;
+	/** Whether the entry is replaced by a more recent version of the file */
+	apt_bool_t            stale;
+	/** Modification time and size of the file, the entry is mapped from */
+	apr_time_t            mtime;
+	apr_off_t             file_size;
+	apr_mmap_t           *mmap;
+	apr_pool_t           *pool;
+};
+
+/** Prompt cache */
+struct mrcp_prompt_cache_t {
+	/** Table of entries by key */
+	apr_hash_t          *entries;
+	/** List of all the entries including stale ones */
+	mrcp_prompt_entry_t *entry_list;
+	/** Total size of the mapped entries */
+	apr_size_t           mapped_size;
+	apr_size_t           max_size;
+	apr_thread_mutex_t  *guard;
+	apr_pool_t          *pool;
+};
+
+mrcp_prompt_cache_t* mrcp_prompt_cache_create(apr_size_t max_size, apr_pool_t *pool)
+{
+	mrcp_prompt_cache_t *cache = apr_palloc(pool,sizeof(mrcp_prompt_cache_t));
+	cache->entries = apr_hash_make(pool);
+	cache->entry_list = NULL;
+	cache->mapped_size = 0;
+	cache->max_size = max_size ? max_size : MRCP_PROMPT_CACHE_DEFAULT_MAX_SIZE;
+	cache->pool = pool;
+	apr_thread_mutex_create(&cache->guard,APR_THREAD_MUTEX_UNNESTED,pool);
+	return cache;
+}
+
+static void mrcp_prompt_entry_destroy(mrcp_prompt_cache_t *cache, mrcp_prompt_entry_t *entry)
+{
+	apt_log(APT_LOG_MARK,APT_PRIO_DEBUG,"Unmap Prompt [%s]",entry->key);
+	cache->mapped_size -= entry->mmap->size;
+	apr_mmap_delete(entry->mmap);
+	apr_pool_destroy(entry->pool);
+}
+
+void mrcp_prompt_cache_destroy(mrcp_prompt_cache_t *cache)
+{
+	mrcp_prompt_entry_t *entry = cache->entry_list;
+	mrcp_prompt_entry_t *next;
+	while(entry) {
+		next = entry->next;
+		if(apr_atomic_read32(&entry->ref_count)) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Prompt [%s] Still in Use",entry->key);
+		}
+		mrcp_prompt_entry_destroy(cache,entry);
+		entry = next;
+	}
+	cache->entry_list = NULL;
+	apr_hash_clear(cache->entries);
+	apr_thread_mutex_destroy(cache->guard);
+}
+
+/** Unmap the entries not in use, stale ones first, while the cache exceeds its max size */
+static void mrcp_prompt_cache_evict(mrcp_prompt_cache_t *cache)
+{
+	mrcp_prompt_entry_t **link = &cache->entry_list;
+	mrcp_prompt_entry_t *entry;
+	while((entry = *link) != NULL) {
+		/* the count only drops to zero without the guard, and is raised under the guard */
+		if(apr_atomic_read32(&entry->ref_count) == 0 &&
+			(entry->stale == TRUE || cache->mapped_size > cache->max_size)) {
+			*link = entry->next;
+			if(entry->stale == FALSE) {
+				apr_hash_set(cache->entries,entry->key,APR_HASH_KEY_STRING,NULL);
+			}
+			mrcp_prompt_entry_destroy(cache,entry);
+			continue;
+		}
+		link = &entry->next;
+	}
+}
+
+/** Locate audio data of WAV file, the whole file is audio otherwise */
+static void mrcp_prompt_audio_locate(mrcp_prompt_t *prompt, const apr_byte_t *data, apr_size_t size)
+{
+	apr_size_t offset;
+	apr_size_t chunk_size;
+
+	prompt->data = data;
+	prompt->size = size;
+	if(size < WAV_RIFF_HEADER_SIZE || memcmp(data,"RIFF",4) != 0 || memcmp(data+8,"WAVE",4) != 0) {
+		return;
+	}
+
+	offset = WAV_RIFF_HEADER_SIZE;
+	while(offset + WAV_CHUNK_HEADER_SIZE <= size) {
+		chunk_size = data[offset+4] | (data[offset+5] << 8) | (data[offset+6] << 16) | ((apr_size_t)data[offset+7] << 24);
+		offset += WAV_CHUNK_HEADER_SIZE;
+		if(memcmp(data + offset - WAV_CHUNK_HEADER_SIZE,"data",4) == 0) {
+			prompt->data = data + offset;
+			prompt->size = (chunk_size <= size - offset) ? chunk_size : size - offset;
+			return;
+		}
+		/* chunks are word aligned */
+		offset += chunk_size + (chunk_size & 1);
+	}
+	/* no audio found */
+	prompt->size = 0;
+}
+
+static mrcp_prompt_entry_t* mrcp_prompt_entry_create(mrcp_prompt_cache_t *cache, const char *key, const char *file_path)
+{
+	apr_pool_t *pool;
+	apr_file_t *file;
+	apr_finfo_t finfo;
+	mrcp_prompt_entry_t *entry;
+
+	if(apr_pool_create(&pool,cache->pool) != APR_SUCCESS) {
+		return NULL;
+	}
+	if(apr_file_open(&file,file_path,APR_FOPEN_READ | APR_FOPEN_BINARY,APR_OS_DEFAULT,pool) != APR_SUCCESS) {
+		apr_pool_destroy(pool);
+		return NULL;
+	}
+
+	entry = apr_palloc(pool,sizeof(mrcp_prompt_entry_t));
+	entry->pool = pool;
+	entry->mmap = NULL;
+	if(apr_file_info_get(&finfo,APR_FINFO_SIZE | APR_FINFO_MTIME,file) != APR_SUCCESS || finfo.size <= 0 ||
+		apr_mmap_create(&entry->mmap,file,0,(apr_size_t)finfo.size,APR_MMAP_READ,pool) != APR_SUCCESS) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Map Prompt [%s]",file_path);
+		apr_file_close(file);
+		apr_pool_destroy(pool);
+		return NULL;
+	}
+	/* the mapping remains valid after the file is closed */
+	apr_file_close(file);
+
+	entry->key = apr_pstrdup(pool,key);
+	entry->ref_count = 0;
+	entry->stale = FALSE;
+	entry->mtime = finfo.mtime;
+	entry->file_size = finfo.size;
+	mrcp_prompt_audio_locate(&entry->prompt,entry->mmap->mm,entry->mmap->size);
+	/* account the whole mapping, not only the audio */
+	cache->mapped_size += entry->mmap->size;
+
+	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Map Prompt [%s] size [%"APR_SIZE_T_FMT"]",key,entry->prompt.size);
+	return entry;
+}
+
+mrcp_prompt_t* mrcp_prompt_cache_acquire(mrcp_prompt_cache_t *cache, const char *file_path, const mpf_codec_descriptor_t *descriptor)
+{
+	char key[1024];
+	apr_finfo_t finfo;
+	mrcp_prompt_entry_t *entry;
+
+	if(apr_snprintf(key,sizeof(key),"%s;%.*s/%d/%d",
+			file_path,
+			(int)descriptor->name.length,descriptor->name.buf,
+			descriptor->sampling_rate,
+			descriptor->channel_count) >= (int)sizeof(key)) {
+		return NULL;
+	}
+
+	apr_thread_mutex_lock(cache->guard);
+	entry = apr_hash_get(cache->entries,key,APR_HASH_KEY_STRING);
+	if(entry) {
+		/* check the file is not modified since mapped */
+		if(apr_stat(&finfo,file_path,APR_FINFO_SIZE | APR_FINFO_MTIME,cache->pool) != APR_SUCCESS ||
+			finfo.mtime != entry->mtime || finfo.size != entry->file_size) {
+			/* the channels playing the stale entry keep playing it till released */
+			apr_hash_set(cache->entries,entry->key,APR_HASH_KEY_STRING,NULL);
+			entry->stale = TRUE;
+			entry = NULL;
+		}
+	}
+
+	if(!entry) {
+		entry = mrcp_prompt_entry_create(cache,key,file_path);
+		if(entry) {
+			entry->next = cache->entry_list;
+			cache->entry_list = entry;
+			apr_hash_set(cache->entries,entry->key,APR_HASH_KEY_STRING,entry);
+		}
+	}
+
+	if(entry) {
+		apr_atomic_inc32(&entry->ref_count);
+	}
+	mrcp_prompt_cache_evict(cache);
+	apr_thread_mutex_unlock(cache->guard);
+	return entry ? &entry->prompt : NULL;
+}
+
+void mrcp_prompt_cache_release(mrcp_prompt_cache_t *cache, mrcp_prompt_t *prompt)
+{
+	mrcp_prompt_entry_t *entry = (mrcp_prompt_entry_t*)prompt;
+	/* the entry is unmapped, if needed, on a subsequent acquire */
+	apr_atomic_dec32(&entry->ref_count);
+}
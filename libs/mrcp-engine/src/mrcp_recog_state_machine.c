@@ -85,10 +85,12 @@ static APR_INLINE apt_bool_t recog_event_dispatch(mrcp_recog_state_machine_t *st
 
 static APR_INLINE void recog_state_change(mrcp_recog_state_machine_t *state_machine, mrcp_recog_state_e state, mrcp_message_t *message)
 {
-	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"State Transition %s -> %s " APT_SIDRES_FMT,
-		state_names[state_machine->state],
-		state_names[state],
-		MRCP_MESSAGE_SIDRES(message));
+	if(APT_LOG_ENABLED(APT_PRIO_INFO)) {
+		apt_log(APT_LOG_MARK,APT_PRIO_INFO,"State Transition %s -> %s " APT_SIDRES_FMT,
+			state_names[state_machine->state],
+			state_names[state],
+			MRCP_MESSAGE_SIDRES(message));
+	}
 	state_machine->state = state;
 	if(state == RECOGNIZER_STATE_IDLE) {
 		state_machine->recog = NULL;
@@ -420,10 +422,12 @@ static apt_bool_t recog_request_state_update(mrcp_recog_state_machine_t *state_m
 		return FALSE;
 	}
 	
-	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Process %s Request " APT_SIDRES_FMT " [%" MRCP_REQUEST_ID_FMT "]",
-		message->start_line.method_name.buf,
-		MRCP_MESSAGE_SIDRES(message),
-		message->start_line.request_id);
+	if(APT_LOG_ENABLED(APT_PRIO_INFO)) {
+		apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Process %s Request " APT_SIDRES_FMT " [%" MRCP_REQUEST_ID_FMT "]",
+			message->start_line.method_name.buf,
+			MRCP_MESSAGE_SIDRES(message),
+			message->start_line.request_id);
+	}
 	method = recog_request_method_array[message->start_line.method_id];
 	if(method) {
 		return method(state_machine,message);
@@ -448,10 +452,12 @@ static apt_bool_t recog_response_state_update(mrcp_recog_state_machine_t *state_
 		return FALSE;
 	}
 	
-	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Process %s Response " APT_SIDRES_FMT " [%" MRCP_REQUEST_ID_FMT "]",
-		message->start_line.method_name.buf,
-		MRCP_MESSAGE_SIDRES(message),
-		message->start_line.request_id);
+	if(APT_LOG_ENABLED(APT_PRIO_INFO)) {
+		apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Process %s Response " APT_SIDRES_FMT " [%" MRCP_REQUEST_ID_FMT "]",
+			message->start_line.method_name.buf,
+			MRCP_MESSAGE_SIDRES(message),
+			message->start_line.request_id);
+	}
 	method = recog_response_method_array[message->start_line.method_id];
 	if(method) {
 		return method(state_machine,message);
@@ -467,10 +473,12 @@ static apt_bool_t recog_event_state_update(mrcp_recog_state_machine_t *state_mac
 		return FALSE;
 	}
 	
-	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Process %s Event " APT_SIDRES_FMT " [%" MRCP_REQUEST_ID_FMT "]",
-		message->start_line.method_name.buf,
-		MRCP_MESSAGE_SIDRES(message),
-		message->start_line.request_id);
+	if(APT_LOG_ENABLED(APT_PRIO_INFO)) {
+		apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Process %s Event " APT_SIDRES_FMT " [%" MRCP_REQUEST_ID_FMT "]",
+			message->start_line.method_name.buf,
+			MRCP_MESSAGE_SIDRES(message),
+			message->start_line.request_id);
+	}
 	method = recog_event_method_array[message->start_line.method_id];
 	if(method) {
 		return method(state_machine,message);
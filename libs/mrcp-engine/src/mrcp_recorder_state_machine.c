@@ -79,10 +79,12 @@ static APR_INLINE apt_bool_t recorder_event_dispatch(mrcp_recorder_state_machine
 
 static APR_INLINE void recorder_state_change(mrcp_recorder_state_machine_t *state_machine, mrcp_recorder_state_e state, mrcp_message_t *message)
 {
-	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"State Transition %s -> %s " APT_SIDRES_FMT,
-		state_names[state_machine->state],
-		state_names[state],
-		MRCP_MESSAGE_SIDRES(message));
+	if(APT_LOG_ENABLED(APT_PRIO_INFO)) {
+		apt_log(APT_LOG_MARK,APT_PRIO_INFO,"State Transition %s -> %s " APT_SIDRES_FMT,
+			state_names[state_machine->state],
+			state_names[state],
+			MRCP_MESSAGE_SIDRES(message));
+	}
 	state_machine->state = state;
 	if(state == RECORDER_STATE_IDLE) {
 		state_machine->record = NULL;
@@ -258,10 +260,12 @@ static apt_bool_t recorder_request_state_update(mrcp_recorder_state_machine_t *s
 		return FALSE;
 	}
 	
-	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Process %s Request " APT_SIDRES_FMT " [%" MRCP_REQUEST_ID_FMT "]",
-		message->start_line.method_name.buf,
-		MRCP_MESSAGE_SIDRES(message),
-		message->start_line.request_id);
+	if(APT_LOG_ENABLED(APT_PRIO_INFO)) {
+		apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Process %s Request " APT_SIDRES_FMT " [%" MRCP_REQUEST_ID_FMT "]",
+			message->start_line.method_name.buf,
+			MRCP_MESSAGE_SIDRES(message),
+			message->start_line.request_id);
+	}
 	method = recorder_request_method_array[message->start_line.method_id];
 	if(method) {
 		return method(state_machine,message);
@@ -286,10 +290,12 @@ static apt_bool_t recorder_response_state_update(mrcp_recorder_state_machine_t *
 		return FALSE;
 	}
 	
-	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Process %s Response " APT_SIDRES_FMT " [%" MRCP_REQUEST_ID_FMT "]",
-		message->start_line.method_name.buf,
-		MRCP_MESSAGE_SIDRES(message),
-		message->start_line.request_id);
+	if(APT_LOG_ENABLED(APT_PRIO_INFO)) {
+		apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Process %s Response " APT_SIDRES_FMT " [%" MRCP_REQUEST_ID_FMT "]",
+			message->start_line.method_name.buf,
+			MRCP_MESSAGE_SIDRES(message),
+			message->start_line.request_id);
+	}
 	method = recorder_response_method_array[message->start_line.method_id];
 	if(method) {
 		return method(state_machine,message);
@@ -305,10 +311,12 @@ static apt_bool_t recorder_event_state_update(mrcp_recorder_state_machine_t *sta
 		return FALSE;
 	}
 	
-	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Process %s Event " APT_SIDRES_FMT " [%" MRCP_REQUEST_ID_FMT "]",
-		message->start_line.method_name.buf,
-		MRCP_MESSAGE_SIDRES(message),
-		message->start_line.request_id);
+	if(APT_LOG_ENABLED(APT_PRIO_INFO)) {
+		apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Process %s Event " APT_SIDRES_FMT " [%" MRCP_REQUEST_ID_FMT "]",
+			message->start_line.method_name.buf,
+			MRCP_MESSAGE_SIDRES(message),
+			message->start_line.request_id);
+	}
 	method = recorder_event_method_array[message->start_line.method_id];
 	if(method) {
 		return method(state_machine,message);
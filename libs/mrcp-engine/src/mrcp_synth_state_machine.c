@@ -85,10 +85,12 @@ static APR_INLINE apt_bool_t synth_event_dispatch(mrcp_synth_state_machine_t *st
 
 static APR_INLINE void synth_state_change(mrcp_synth_state_machine_t *state_machine, mrcp_synth_state_e state, mrcp_message_t *message)
 {
-	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"State Transition %s -> %s " APT_SIDRES_FMT,
-		state_names[state_machine->state],
-		state_names[state],
-		MRCP_MESSAGE_SIDRES(message));
+	if(APT_LOG_ENABLED(APT_PRIO_NOTICE)) {
+		apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"State Transition %s -> %s " APT_SIDRES_FMT,
+			state_names[state_machine->state],
+			state_names[state],
+			MRCP_MESSAGE_SIDRES(message));
+	}
 	state_machine->state = state;
 	if(state == SYNTHESIZER_STATE_IDLE) {
 		state_machine->speaker = NULL;
@@ -490,10 +492,12 @@ static apt_bool_t synth_request_state_update(mrcp_synth_state_machine_t *state_m
 		return FALSE;
 	}
 	
-	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Process %s Request " APT_SIDRES_FMT " [%" MRCP_REQUEST_ID_FMT "]",
-		message->start_line.method_name.buf,
-		MRCP_MESSAGE_SIDRES(message),
-		message->start_line.request_id);
+	if(APT_LOG_ENABLED(APT_PRIO_INFO)) {
+		apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Process %s Request " APT_SIDRES_FMT " [%" MRCP_REQUEST_ID_FMT "]",
+			message->start_line.method_name.buf,
+			MRCP_MESSAGE_SIDRES(message),
+			message->start_line.request_id);
+	}
 	method = synth_request_method_array[message->start_line.method_id];
 	if(method) {
 		return method(state_machine,message);
@@ -518,10 +522,12 @@ static apt_bool_t synth_response_state_update(mrcp_synth_state_machine_t *state_
 		return FALSE;
 	}
 	
-	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Process %s Response " APT_SIDRES_FMT " [%" MRCP_REQUEST_ID_FMT "]",
-		message->start_line.method_name.buf,
-		MRCP_MESSAGE_SIDRES(message),
-		message->start_line.request_id);
+	if(APT_LOG_ENABLED(APT_PRIO_INFO)) {
+		apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Process %s Response " APT_SIDRES_FMT " [%" MRCP_REQUEST_ID_FMT "]",
+			message->start_line.method_name.buf,
+			MRCP_MESSAGE_SIDRES(message),
+			message->start_line.request_id);
+	}
 	method = synth_response_method_array[message->start_line.method_id];
 	if(method) {
 		return method(state_machine,message);
@@ -537,10 +543,12 @@ static apt_bool_t synth_event_state_update(mrcp_synth_state_machine_t *state_mac
 		return FALSE;
 	}
 	
-	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Process %s Event " APT_SIDRES_FMT " [%" MRCP_REQUEST_ID_FMT "]",
-		message->start_line.method_name.buf,
-		MRCP_MESSAGE_SIDRES(message),
-		message->start_line.request_id);
+	if(APT_LOG_ENABLED(APT_PRIO_INFO)) {
+		apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Process %s Event " APT_SIDRES_FMT " [%" MRCP_REQUEST_ID_FMT "]",
+			message->start_line.method_name.buf,
+			MRCP_MESSAGE_SIDRES(message),
+			message->start_line.request_id);
+	}
 	method = synth_event_method_array[message->start_line.method_id];
 	if(method) {
 		return method(state_machine,message);
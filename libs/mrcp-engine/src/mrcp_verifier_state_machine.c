@@ -81,10 +81,12 @@ static APR_INLINE apt_bool_t verifier_event_dispatch(mrcp_verifier_state_machine
 
 static APR_INLINE void verifier_state_change(mrcp_verifier_state_machine_t *state_machine, mrcp_verifier_state_e state, mrcp_message_t *message)
 {
-	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"State Transition %s -> %s " APT_SIDRES_FMT,
-		state_names[state_machine->state],
-		state_names[state],
-		MRCP_MESSAGE_SIDRES(message));
+	if(APT_LOG_ENABLED(APT_PRIO_INFO)) {
+		apt_log(APT_LOG_MARK,APT_PRIO_INFO,"State Transition %s -> %s " APT_SIDRES_FMT,
+			state_names[state_machine->state],
+			state_names[state],
+			MRCP_MESSAGE_SIDRES(message));
+	}
 	state_machine->state = state;
 	if(state == VERIFIER_STATE_IDLE) {
 		state_machine->verify = NULL;
@@ -396,10 +398,12 @@ static apt_bool_t verifier_request_state_update(mrcp_verifier_state_machine_t *s
 		return FALSE;
 	}
 	
-	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Process %s Request " APT_SIDRES_FMT " [%" MRCP_REQUEST_ID_FMT "]",
-		message->start_line.method_name.buf,
-		MRCP_MESSAGE_SIDRES(message),
-		message->start_line.request_id);
+	if(APT_LOG_ENABLED(APT_PRIO_INFO)) {
+		apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Process %s Request " APT_SIDRES_FMT " [%" MRCP_REQUEST_ID_FMT "]",
+			message->start_line.method_name.buf,
+			MRCP_MESSAGE_SIDRES(message),
+			message->start_line.request_id);
+	}
 	method = verifier_request_method_array[message->start_line.method_id];
 	if(method) {
 		return method(state_machine,message);
@@ -424,10 +428,12 @@ static apt_bool_t verifier_response_state_update(mrcp_verifier_state_machine_t *
 		return FALSE;
 	}
 	
-	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Process %s Response " APT_SIDRES_FMT " [%" MRCP_REQUEST_ID_FMT "]",
-		message->start_line.method_name.buf,
-		MRCP_MESSAGE_SIDRES(message),
-		message->start_line.request_id);
+	if(APT_LOG_ENABLED(APT_PRIO_INFO)) {
+		apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Process %s Response " APT_SIDRES_FMT " [%" MRCP_REQUEST_ID_FMT "]",
+			message->start_line.method_name.buf,
+			MRCP_MESSAGE_SIDRES(message),
+			message->start_line.request_id);
+	}
 	method = verifier_response_method_array[message->start_line.method_id];
 	if(method) {
 		return method(state_machine,message);
@@ -443,10 +449,12 @@ static apt_bool_t verifier_event_state_update(mrcp_verifier_state_machine_t *sta
 		return FALSE;
 	}
 	
-	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Process %s Event " APT_SIDRES_FMT " [%" MRCP_REQUEST_ID_FMT "]",
-		message->start_line.method_name.buf,
-		MRCP_MESSAGE_SIDRES(message),
-		message->start_line.request_id);
+	if(APT_LOG_ENABLED(APT_PRIO_INFO)) {
+		apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Process %s Event " APT_SIDRES_FMT " [%" MRCP_REQUEST_ID_FMT "]",
+			message->start_line.method_name.buf,
+			MRCP_MESSAGE_SIDRES(message),
+			message->start_line.request_id);
+	}
 	method = verifier_event_method_array[message->start_line.method_id];
 	if(method) {
 		return method(state_machine,message);
@@ -35,6 +35,15 @@ APT_BEGIN_EXTERN_C
  */
 MRCP_DECLARE(mrcp_server_t*) mrcp_server_create(apt_dir_layout_t *dir_layout);
 
+/**
+ * Set the number of workers (threads) to process sessions by.
+ * @param server the MRCP server to set the number of workers for
+ * @param worker_count the number of workers
+ * @remark Sessions are distributed among the workers by their identifiers.
+ *         The number of workers can be set only once, before the server is started.
+ */
+MRCP_DECLARE(apt_bool_t) mrcp_server_worker_count_set(mrcp_server_t *server, apr_size_t worker_count);
+
 /**
  * Start message processing loop.
  * @param server the MRCP server to start
@@ -85,6 +94,14 @@ MRCP_DECLARE(apt_bool_t) mrcp_server_engine_register(
 								mrcp_server_t *server, 
 								mrcp_engine_t *engine);
 
+/**
+ * Register grammar cache shared by the engines.
+ * @param server the MRCP server to set grammar cache for
+ * @param grammar_cache the grammar cache to set
+ * @remark The grammar cache must be registered prior to the engines.
+ */
+MRCP_DECLARE(apt_bool_t) mrcp_server_grammar_cache_register(mrcp_server_t *server, mrcp_grammar_cache_t *grammar_cache);
+
 /**
  * Register codec manager.
  * @param server the MRCP server to set codec manager for
@@ -31,12 +31,17 @@
 
 APT_BEGIN_EXTERN_C
 
+/** Length of generated session identifier */
+#define MRCP_SESSION_ID_HEX_STRING_LENGTH 16
+
 /** Opaque MRCP channel declaration */
 typedef struct mrcp_channel_t mrcp_channel_t;
 /** MRCP server session declaration */
 typedef struct mrcp_server_session_t mrcp_server_session_t;
 /** MRCP signaling message declaration */
 typedef struct mrcp_signaling_message_t mrcp_signaling_message_t;
+/** Opaque MRCP server worker declaration */
+typedef struct mrcp_server_worker_t mrcp_server_worker_t;
 
 /** Enumeration of signaling task messages */
 typedef enum {
@@ -77,6 +82,8 @@ struct mrcp_server_session_t {
 	mrcp_session_t              base;
 	/** MRCP server */
 	mrcp_server_t              *server;
+	/** Server worker the session is processed by */
+	mrcp_server_worker_t       *worker;
 	/** MRCP profile */
 	mrcp_server_profile_t      *profile;
 
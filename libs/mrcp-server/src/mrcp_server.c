@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 
+#include <apr_atomic.h>
+#include <apr_thread_mutex.h>
 #include "mrcp_server.h"
 #include "mrcp_server_session.h"
 #include "mrcp_message.h"
@@ -31,10 +33,28 @@
 
 #define SERVER_TASK_NAME "MRCP Server"
 
+/** MRCP server worker processing a share of sessions */
+struct mrcp_server_worker_t {
+	/** Back pointer to server */
+	mrcp_server_t           *server;
+	/** Message processing task (the main task of the server for the first worker) */
+	apt_consumer_task_t     *task;
+	/** Table of sessions processed by the worker */
+	apr_hash_t              *session_table;
+};
+
 /** MRCP server */
 struct mrcp_server_t {
 	/** Main message processing task */
 	apt_consumer_task_t     *task;
+	/** Array of workers, sessions are distributed among by their identifiers */
+	mrcp_server_worker_t    *workers;
+	/** Number of workers */
+	apr_size_t               worker_count;
+	/** Total number of sessions of all the workers */
+	apr_uint32_t             session_count;
+	/** Guard of engine channel creation and destruction (used by multiple workers only) */
+	apr_thread_mutex_t      *engine_guard;
 
 	/** MRCP resource factory */
 	mrcp_resource_factory_t *resource_factory;
@@ -42,6 +62,8 @@ struct mrcp_server_t {
 	mrcp_engine_factory_t   *engine_factory;
 	/** Loader of plugins for MRCP engines */
 	mrcp_engine_loader_t    *engine_loader;
+	/** Grammar cache shared by the engines (optional) */
+	mrcp_grammar_cache_t    *grammar_cache;
 
 	/** Codec manager */
 	mpf_codec_manager_t     *codec_manager;
@@ -58,13 +80,12 @@ struct mrcp_server_t {
 	/** Table of profiles (mrcp_server_profile_t*) */
 	apr_hash_t              *profile_table;
 
-	/** Table of sessions */
-	apr_hash_t              *session_table;
-
 	/** Connection task message pool */
 	apt_task_msg_pool_t     *connection_msg_pool;
 	/** Engine task message pool */
 	apt_task_msg_pool_t     *engine_msg_pool;
+	/** Worker task message pool */
+	apt_task_msg_pool_t     *worker_msg_pool;
 
 	/** Dir layout structure */
 	apt_dir_layout_t        *dir_layout;
@@ -81,9 +102,17 @@ typedef enum {
 	MRCP_SERVER_SIGNALING_TASK_MSG = TASK_MSG_USER,
 	MRCP_SERVER_CONNECTION_TASK_MSG,
 	MRCP_SERVER_ENGINE_TASK_MSG,
-	MRCP_SERVER_MEDIA_TASK_MSG
+	MRCP_SERVER_MEDIA_TASK_MSG,
+	MRCP_SERVER_WORKER_TASK_MSG
 } mrcp_server_task_msg_type_e;
 
+/* Worker interface */
+typedef enum {
+	WORKER_TASK_MSG_MEDIA_MESSAGE,
+	WORKER_TASK_MSG_RELEASE_SESSIONS,
+	WORKER_TASK_MSG_IDLE
+} worker_task_msg_type_e;
+
 
 static apt_bool_t mrcp_server_offer_signal(mrcp_session_t *session, mrcp_session_descriptor_t *descriptor);
 static apt_bool_t mrcp_server_terminate_signal(mrcp_session_t *session);
@@ -166,6 +195,7 @@ const mrcp_engine_channel_event_vtable_t engine_channel_vtable = {
 
 /* Task interface */
 static apt_bool_t mrcp_server_msg_process(apt_task_t *task, apt_task_msg_t *msg);
+static apt_bool_t mrcp_server_worker_msg_process(apt_task_t *task, apt_task_msg_t *msg);
 static apt_bool_t mrcp_server_start_request_process(apt_task_t *task);
 static apt_bool_t mrcp_server_terminate_request_process(apt_task_t *task);
 static void mrcp_server_on_start_complete(apt_task_t *task);
@@ -175,7 +205,7 @@ static void mrcp_server_on_online_complete(apt_task_t *task);
 
 static mrcp_session_t* mrcp_server_sig_agent_session_create(mrcp_sig_agent_t *signaling_agent);
 static apt_bool_t mrcp_server_do_terminate(mrcp_server_t *server);
-static void mrcp_server_sessions_release(mrcp_server_t *server);
+static void mrcp_server_sessions_release(mrcp_server_worker_t *worker);
 
 
 /** Create MRCP server instance */
@@ -199,15 +229,18 @@ MRCP_DECLARE(mrcp_server_t*) mrcp_server_create(apt_dir_layout_t *dir_layout)
 	server->resource_factory = NULL;
 	server->engine_factory = NULL;
 	server->engine_loader = NULL;
+	server->grammar_cache = NULL;
 	server->media_engine_table = NULL;
 	server->rtp_factory_table = NULL;
 	server->sig_agent_table = NULL;
 	server->cnt_agent_table = NULL;
 	server->rtp_settings_table = NULL;
 	server->profile_table = NULL;
-	server->session_table = NULL;
 	server->connection_msg_pool = NULL;
 	server->engine_msg_pool = NULL;
+	server->worker_msg_pool = NULL;
+	server->engine_guard = NULL;
+	server->session_count = 0;
 	server->shutdown_requested = FALSE;
 
 	msg_pool = apt_task_msg_pool_create_dynamic(0,pool);
@@ -240,11 +273,69 @@ MRCP_DECLARE(mrcp_server_t*) mrcp_server_create(apt_dir_layout_t *dir_layout)
 	server->cnt_agent_table = apr_hash_make(server->pool);
 
 	server->profile_table = apr_hash_make(server->pool);
-	
-	server->session_table = apr_hash_make(server->pool);
+
+	server->worker_count = 1;
+	server->workers = apr_palloc(server->pool,sizeof(mrcp_server_worker_t));
+	server->workers[0].server = server;
+	server->workers[0].task = server->task;
+	server->workers[0].session_table = apr_hash_make(server->pool);
 	return server;
 }
 
+/** Set the number of workers to process sessions by */
+MRCP_DECLARE(apt_bool_t) mrcp_server_worker_count_set(mrcp_server_t *server, apr_size_t worker_count)
+{
+	apr_size_t i;
+	apt_task_t *task;
+	apt_task_vtable_t *vtable;
+	mrcp_server_worker_t *worker;
+	mrcp_server_worker_t *workers;
+	if(!server || !server->task) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Invalid Server Instance");
+		return FALSE;
+	}
+	if(server->worker_count > 1) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Workers Already Created [%"APR_SIZE_T_FMT"]",server->worker_count);
+		return FALSE;
+	}
+	if(worker_count <= 1) {
+		return TRUE;
+	}
+
+	if(apr_thread_mutex_create(&server->engine_guard,APR_THREAD_MUTEX_DEFAULT,server->pool) != APR_SUCCESS) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Create Engine Guard");
+		return FALSE;
+	}
+	server->worker_msg_pool = apt_task_msg_pool_create_dynamic(sizeof(mpf_message_container_t),server->pool);
+
+	workers = apr_palloc(server->pool,sizeof(mrcp_server_worker_t) * worker_count);
+	/* the first worker is the main task itself */
+	workers[0] = server->workers[0];
+	task = apt_consumer_task_base_get(server->task);
+	for(i=1; i<worker_count; i++) {
+		worker = &workers[i];
+		worker->server = server;
+		worker->session_table = apr_hash_make(server->pool);
+		worker->task = apt_consumer_task_create(worker,apt_task_msg_pool_create_dynamic(0,server->pool),server->pool);
+		if(!worker->task) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Create Server Worker Task");
+			return FALSE;
+		}
+		apt_task_name_set(apt_consumer_task_base_get(worker->task),
+			apr_psprintf(server->pool,SERVER_TASK_NAME"-%"APR_SIZE_T_FMT,i));
+		vtable = apt_task_vtable_get(apt_consumer_task_base_get(worker->task));
+		if(vtable) {
+			vtable->process_msg = mrcp_server_worker_msg_process;
+		}
+		apt_task_add(task,apt_consumer_task_base_get(worker->task));
+	}
+
+	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Create Server Workers [%"APR_SIZE_T_FMT"]",worker_count);
+	server->workers = workers;
+	server->worker_count = worker_count;
+	return TRUE;
+}
+
 /** Start message processing loop */
 MRCP_DECLARE(apt_bool_t) mrcp_server_start(mrcp_server_t *server)
 {
@@ -302,7 +393,6 @@ MRCP_DECLARE(apt_bool_t) mrcp_server_shutdown(mrcp_server_t *server)
 		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Shutdown Server Task");
 		return FALSE;
 	}
-	server->session_table = NULL;
 	uptime = apr_time_now() - server->start_time;
 	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"Server Uptime [%"APR_TIME_T_FMT" sec]", apr_time_sec(uptime));
 	return TRUE;
@@ -317,6 +407,11 @@ MRCP_DECLARE(apt_bool_t) mrcp_server_destroy(mrcp_server_t *server)
 		return FALSE;
 	}
 
+	if(server->grammar_cache) {
+		/* handles attached to the grammars are destroyed prior to the engines */
+		mrcp_grammar_cache_destroy(server->grammar_cache);
+		server->grammar_cache = NULL;
+	}
 	mrcp_engine_factory_destroy(server->engine_factory);
 	mrcp_engine_loader_destroy(server->engine_loader);
 
@@ -350,12 +445,24 @@ MRCP_DECLARE(apt_bool_t) mrcp_server_engine_register(mrcp_server_t *server, mrcp
 	}
 	engine->codec_manager = server->codec_manager;
 	engine->dir_layout = server->dir_layout;
+	engine->grammar_cache = server->grammar_cache;
 	engine->event_vtable = &engine_vtable;
 	engine->event_obj = server;
 	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Register MRCP Engine [%s]",engine->id);
 	return mrcp_engine_factory_engine_register(server->engine_factory,engine);
 }
 
+/** Register grammar cache */
+MRCP_DECLARE(apt_bool_t) mrcp_server_grammar_cache_register(mrcp_server_t *server, mrcp_grammar_cache_t *grammar_cache)
+{
+	if(!grammar_cache) {
+		return FALSE;
+	}
+	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Register Grammar Cache");
+	server->grammar_cache = grammar_cache;
+	return TRUE;
+}
+
 /** Get MRCP engine by name */
 MRCP_DECLARE(mrcp_engine_t*) mrcp_server_engine_get(const mrcp_server_t *server, const char *name)
 {
@@ -647,36 +754,86 @@ MRCP_DECLARE(apr_pool_t*) mrcp_server_memory_pool_get(const mrcp_server_t *serve
 
 void mrcp_server_session_add(mrcp_server_t *server, mrcp_server_session_t *session)
 {
-	if(!session->base.id.buf) 
+	if(!session->base.id.buf || !session->worker) 
 		return;
 
 	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"Add Session " APT_SID_FMT,MRCP_SESSION_SID(&session->base));
-	apr_hash_set(server->session_table,session->base.id.buf,session->base.id.length,session);
+	if(!apr_hash_get(session->worker->session_table,session->base.id.buf,session->base.id.length)) {
+		apr_atomic_inc32(&server->session_count);
+	}
+	apr_hash_set(session->worker->session_table,session->base.id.buf,session->base.id.length,session);
 }
 
 void mrcp_server_session_remove(mrcp_server_t *server, mrcp_server_session_t *session)
 {
-	if(!session->base.id.buf) 
+	if(!session->base.id.buf || !session->worker) 
 		return;
 
 	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"Remove Session " APT_SID_FMT,MRCP_SESSION_SID(&session->base));
-	apr_hash_set(server->session_table,session->base.id.buf,session->base.id.length,NULL);
+	if(apr_hash_get(session->worker->session_table,session->base.id.buf,session->base.id.length)) {
+		apr_atomic_dec32(&server->session_count);
+	}
+	apr_hash_set(session->worker->session_table,session->base.id.buf,session->base.id.length,NULL);
 }
 
 void mrcp_server_session_idle_test(mrcp_server_t *server)
 {
 	if(server->shutdown_requested == TRUE) {
-		unsigned int count = apr_hash_count(server->session_table);
+		apr_uint32_t count = apr_atomic_read32(&server->session_count);
 		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Shutdown Pending: remaining sessions [%d]", count);
 		if(!count) {
-			mrcp_server_do_terminate(server);
+			if(server->worker_count > 1) {
+				/* termination is always completed by the main task */
+				apt_task_msg_t *task_msg = apt_task_msg_acquire(server->worker_msg_pool);
+				task_msg->type = MRCP_SERVER_WORKER_TASK_MSG;
+				task_msg->sub_type = WORKER_TASK_MSG_IDLE;
+				apt_task_msg_signal(apt_consumer_task_base_get(server->task),task_msg);
+			}
+			else {
+				mrcp_server_do_terminate(server);
+			}
 		}
 	}
 }
 
-static APR_INLINE mrcp_server_session_t* mrcp_server_session_find(mrcp_server_t *server, const apt_str_t *session_id)
+void mrcp_server_engine_lock(mrcp_server_t *server)
+{
+	if(server->engine_guard) {
+		apr_thread_mutex_lock(server->engine_guard);
+	}
+}
+
+void mrcp_server_engine_unlock(mrcp_server_t *server)
+{
+	if(server->engine_guard) {
+		apr_thread_mutex_unlock(server->engine_guard);
+	}
+}
+
+/** Assign the session to a worker by its identifier */
+static mrcp_server_worker_t* mrcp_server_worker_assign(mrcp_server_t *server, mrcp_server_session_t *session)
+{
+	apr_ssize_t length;
+	if(server->worker_count == 1) {
+		return &server->workers[0];
+	}
+
+	if(!session->base.id.length) {
+		/* the identifier is generated here rather than on the initial offer to route every message of the session */
+		apt_unique_id_generate(&session->base.id,MRCP_SESSION_ID_HEX_STRING_LENGTH,session->base.pool);
+	}
+	length = session->base.id.length;
+	return &server->workers[apr_hashfunc_default(session->base.id.buf,&length) % server->worker_count];
+}
+
+/** Get the task of the worker processing the session */
+static APR_INLINE apt_task_t* mrcp_server_session_task_get(mrcp_server_t *server, mrcp_session_t *session)
 {
-	return apr_hash_get(server->session_table,session_id->buf,session_id->length);
+	mrcp_server_session_t *server_session = (mrcp_server_session_t*)session;
+	if(!server_session || !server_session->worker) {
+		return apt_consumer_task_base_get(server->task);
+	}
+	return apt_consumer_task_base_get(server_session->worker->task);
 }
 
 static apt_bool_t mrcp_server_start_request_process(apt_task_t *task)
@@ -722,12 +879,12 @@ static apt_bool_t mrcp_server_do_terminate(mrcp_server_t *server)
 	return apt_task_terminate_request_process(task);
 }
 
-static void mrcp_server_sessions_release(mrcp_server_t *server)
+static void mrcp_server_sessions_release(mrcp_server_worker_t *worker)
 {
 	mrcp_server_session_t *session;
 	apr_hash_index_t *it;
 	void *val;
-	it = apr_hash_first(NULL,server->session_table);
+	it = apr_hash_first(NULL,worker->session_table);
 	for(; it; it = apr_hash_next(it)) {
 		apr_hash_this(it,NULL,NULL,&val);
 		session = val;
@@ -767,10 +924,18 @@ static void mrcp_server_on_offline_complete(apt_task_t *task)
 	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,SERVER_TASK_NAME" Taken Offline");
 	
 	if(server->shutdown_requested == TRUE) {
-		unsigned int count = apr_hash_count(server->session_table);
+		apr_uint32_t count = apr_atomic_read32(&server->session_count);
 		if(count) {
+			apr_size_t i;
 			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Shutdown Pending: release open sessions [%d]", count);
-			mrcp_server_sessions_release(server);
+			mrcp_server_sessions_release(&server->workers[0]);
+			for(i=1; i<server->worker_count; i++) {
+				/* the sessions of other workers are released by their own tasks */
+				apt_task_msg_t *task_msg = apt_task_msg_acquire(server->worker_msg_pool);
+				task_msg->type = MRCP_SERVER_WORKER_TASK_MSG;
+				task_msg->sub_type = WORKER_TASK_MSG_RELEASE_SESSIONS;
+				apt_task_msg_signal(apt_consumer_task_base_get(server->workers[i].task),task_msg);
+			}
 		}
 		else {
 			mrcp_server_do_terminate(server);
@@ -783,7 +948,30 @@ static void mrcp_server_on_online_complete(apt_task_t *task)
 	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,SERVER_TASK_NAME" Brought Online");
 }
 
-static apt_bool_t mrcp_server_msg_process(apt_task_t *task, apt_task_msg_t *msg)
+/** Forward MPF message to the worker processing the session, if it's not the current one */
+static apt_bool_t mrcp_server_mpf_message_forward(mrcp_server_worker_t *worker, const mpf_message_container_t *mpf_message_container)
+{
+	apr_size_t i;
+	apt_task_msg_t *task_msg;
+	mrcp_server_session_t *session = NULL;
+	for(i=0; i<mpf_message_container->count && !session; i++) {
+		if(mpf_message_container->messages[i].context) {
+			session = mpf_engine_context_object_get(mpf_message_container->messages[i].context);
+		}
+	}
+	if(!session || !session->worker || session->worker == worker) {
+		return FALSE;
+	}
+
+	/* messages of the container are all of the same media context */
+	task_msg = apt_task_msg_acquire(worker->server->worker_msg_pool);
+	task_msg->type = MRCP_SERVER_WORKER_TASK_MSG;
+	task_msg->sub_type = WORKER_TASK_MSG_MEDIA_MESSAGE;
+	memcpy(task_msg->data,mpf_message_container,sizeof(mpf_message_container_t));
+	return apt_task_msg_signal(apt_consumer_task_base_get(session->worker->task),task_msg);
+}
+
+static apt_bool_t mrcp_server_task_msg_process(mrcp_server_worker_t *worker, apt_task_t *task, apt_task_msg_t *msg)
 {
 	switch(msg->type) {
 		case MRCP_SERVER_SIGNALING_TASK_MSG:
@@ -855,9 +1043,31 @@ static apt_bool_t mrcp_server_msg_process(apt_task_t *task, apt_task_msg_t *msg)
 		case MRCP_SERVER_MEDIA_TASK_MSG:
 		{
 			mpf_message_container_t *mpf_message_container = (mpf_message_container_t*) msg->data;
+			if(worker->server->worker_count > 1 && mrcp_server_mpf_message_forward(worker,mpf_message_container) == TRUE) {
+				break;
+			}
 			mrcp_server_mpf_message_process(mpf_message_container);
 			break;
 		}
+		case MRCP_SERVER_WORKER_TASK_MSG:
+		{
+			switch(msg->sub_type) {
+				case WORKER_TASK_MSG_MEDIA_MESSAGE:
+					mrcp_server_mpf_message_process((mpf_message_container_t*) msg->data);
+					break;
+				case WORKER_TASK_MSG_RELEASE_SESSIONS:
+					mrcp_server_sessions_release(worker);
+					break;
+				case WORKER_TASK_MSG_IDLE:
+					if(worker->server->shutdown_requested == TRUE && !apr_atomic_read32(&worker->server->session_count)) {
+						mrcp_server_do_terminate(worker->server);
+					}
+					break;
+				default:
+					break;
+			}
+			break;
+		}
 		default:
 		{
 			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unknown Task Message Received [%d;%d]", msg->type,msg->sub_type);
@@ -867,9 +1077,24 @@ static apt_bool_t mrcp_server_msg_process(apt_task_t *task, apt_task_msg_t *msg)
 	return TRUE;
 }
 
+static apt_bool_t mrcp_server_msg_process(apt_task_t *task, apt_task_msg_t *msg)
+{
+	apt_consumer_task_t *consumer_task = apt_task_object_get(task);
+	mrcp_server_t *server = apt_consumer_task_object_get(consumer_task);
+	return mrcp_server_task_msg_process(&server->workers[0],task,msg);
+}
+
+static apt_bool_t mrcp_server_worker_msg_process(apt_task_t *task, apt_task_msg_t *msg)
+{
+	apt_consumer_task_t *consumer_task = apt_task_object_get(task);
+	mrcp_server_worker_t *worker = apt_consumer_task_object_get(consumer_task);
+	return mrcp_server_task_msg_process(worker,task,msg);
+}
+
 static apt_bool_t mrcp_server_signaling_task_msg_signal(mrcp_signaling_message_type_e type, mrcp_session_t *session, mrcp_session_descriptor_t *descriptor, mrcp_message_t *message)
 {
 	mrcp_signaling_message_t *signaling_message;
+	mrcp_server_session_t *server_session = (mrcp_server_session_t*)session;
 	apt_task_msg_t *task_msg = apt_task_msg_acquire(session->signaling_agent->msg_pool);
 	mrcp_signaling_message_t **slot = ((mrcp_signaling_message_t**)task_msg->data);
 	task_msg->type = MRCP_SERVER_SIGNALING_TASK_MSG;
@@ -882,8 +1107,12 @@ static apt_bool_t mrcp_server_signaling_task_msg_signal(mrcp_signaling_message_t
 	signaling_message->channel = NULL;
 	signaling_message->message = message;
 	*slot = signaling_message;
-	
-	return apt_task_msg_parent_signal(session->signaling_agent->task,task_msg);
+
+	if(!server_session->worker) {
+		/* the first signaling message of the session, choose the worker to process it */
+		server_session->worker = mrcp_server_worker_assign(server_session->server,server_session);
+	}
+	return apt_task_msg_signal(apt_consumer_task_base_get(server_session->worker->task),task_msg);
 }
 
 static apt_bool_t mrcp_server_connection_task_msg_signal(
@@ -895,7 +1124,7 @@ static apt_bool_t mrcp_server_connection_task_msg_signal(
 							apt_bool_t                       status)
 {
 	mrcp_server_t *server = mrcp_server_connection_agent_object_get(agent);
-	apt_task_t *task = apt_consumer_task_base_get(server->task);
+	apt_task_t *task = mrcp_server_session_task_get(server,(channel && channel->obj) ? mrcp_server_channel_session_get(channel->obj) : NULL);
 	connection_agent_task_msg_data_t *data;
 	apt_task_msg_t *task_msg = apt_task_msg_acquire(server->connection_msg_pool);
 	task_msg->type = MRCP_SERVER_CONNECTION_TASK_MSG;
@@ -938,7 +1167,7 @@ static apt_bool_t mrcp_server_channel_task_msg_signal(
 	mrcp_channel_t *channel = engine_channel->event_obj;
 	mrcp_session_t *session = mrcp_server_channel_session_get(channel);
 	mrcp_server_t *server = session->signaling_agent->parent;
-	apt_task_t *task = apt_consumer_task_base_get(server->task);
+	apt_task_t *task = mrcp_server_session_task_get(server,session);
 	engine_task_msg_data_t *data;
 	apt_task_msg_t *task_msg = apt_task_msg_acquire(server->engine_msg_pool);
 	task_msg->type = MRCP_SERVER_ENGINE_TASK_MSG;
@@ -34,8 +34,6 @@
 #define MRCP_SESSION_NAMESID(session) \
 	session->base.name, MRCP_SESSION_SID(&session->base)
 
-#define MRCP_SESSION_ID_HEX_STRING_LENGTH 16
-
 struct mrcp_channel_t {
 	/** Memory pool */
 	apr_pool_t             *pool;
@@ -80,6 +78,8 @@ extern const mrcp_engine_channel_event_vtable_t engine_channel_vtable;
 void mrcp_server_session_add(mrcp_server_t *server, mrcp_server_session_t *session);
 void mrcp_server_session_remove(mrcp_server_t *server, mrcp_server_session_t *session);
 void mrcp_server_session_idle_test(mrcp_server_t *server);
+void mrcp_server_engine_lock(mrcp_server_t *server);
+void mrcp_server_engine_unlock(mrcp_server_t *server);
 
 static apt_bool_t mrcp_server_signaling_message_dispatch(mrcp_server_session_t *session, mrcp_signaling_message_t *signaling_message);
 
@@ -102,6 +102,7 @@ static apt_bool_t mrcp_session_offers_compare(const mrcp_session_descriptor_t *o
 mrcp_server_session_t* mrcp_server_session_create()
 {
 	mrcp_server_session_t *session = (mrcp_server_session_t*) mrcp_session_create(sizeof(mrcp_server_session_t)-sizeof(mrcp_session_t));
+	session->worker = NULL;
 	session->context = NULL;
 	session->terminations = apr_array_make(session->base.pool,2,sizeof(mrcp_termination_slot_t));
 	session->channels = apr_array_make(session->base.pool,2,sizeof(mrcp_channel_t*));
@@ -126,6 +127,7 @@ static APR_INLINE mrcp_version_e mrcp_session_version_get(mrcp_server_session_t
 static mrcp_engine_channel_t* mrcp_server_engine_channel_create(mrcp_server_session_t *session, mrcp_channel_t *channel, const apt_str_t *resource_name, mrcp_session_attribs_t *session_attribs)
 {
 	mrcp_engine_t *engine = NULL;
+	mrcp_engine_channel_t *engine_channel;
 	apr_table_t *attribs = NULL;
 
 	/* get engine settings per profile */
@@ -210,7 +212,11 @@ static mrcp_engine_channel_t* mrcp_server_engine_channel_create(mrcp_server_sess
 		channel->state_machine->on_deactivate = state_machine_on_deactivate;
 	}
 
-	return mrcp_engine_channel_virtual_create(engine,attribs,mrcp_session_version_get(session),session->base.pool);
+	/* engines are shared by the workers of the server */
+	mrcp_server_engine_lock(session->server);
+	engine_channel = mrcp_engine_channel_virtual_create(engine,attribs,mrcp_session_version_get(session),session->base.pool);
+	mrcp_server_engine_unlock(session->server);
+	return engine_channel;
 }
 
 static mrcp_channel_t* mrcp_server_channel_create(mrcp_server_session_t *session, const apt_str_t *resource_name, apr_size_t id, apr_array_header_t *cmid_arr, mrcp_session_attribs_t *session_attribs)
@@ -323,8 +329,10 @@ apt_bool_t mrcp_server_signaling_message_process(mrcp_signaling_message_t *signa
 {
 	mrcp_server_session_t *session = signaling_message->session;
 	if(session->active_request) {
-		apt_log(APT_LOG_MARK,APT_PRIO_DEBUG,"Push Request to Queue " APT_NAMESID_FMT, 
-			MRCP_SESSION_NAMESID(session));
+		if(APT_LOG_ENABLED(APT_PRIO_DEBUG)) {
+			apt_log(APT_LOG_MARK,APT_PRIO_DEBUG,"Push Request to Queue " APT_NAMESID_FMT, 
+				MRCP_SESSION_NAMESID(session));
+		}
 		apt_list_push_back(session->request_queue,signaling_message,session->base.pool);
 	}
 	else {
@@ -630,7 +638,9 @@ static apt_bool_t mrcp_server_on_message_receive(mrcp_server_session_t *session,
 
 static apt_bool_t mrcp_server_signaling_message_dispatch(mrcp_server_session_t *session, mrcp_signaling_message_t *signaling_message)
 {
-	apt_log(APT_LOG_MARK,APT_PRIO_DEBUG,"Dispatch Signaling Message [%d]",signaling_message->type);
+	if(APT_LOG_ENABLED(APT_PRIO_DEBUG)) {
+		apt_log(APT_LOG_MARK,APT_PRIO_DEBUG,"Dispatch Signaling Message [%d]",signaling_message->type);
+	}
 	switch(signaling_message->type) {
 		case SIGNALING_MESSAGE_OFFER:
 			mrcp_server_session_offer_process(signaling_message->session,signaling_message->descriptor);
@@ -1037,7 +1047,9 @@ static apt_bool_t mrcp_server_session_terminate_send(mrcp_server_session_t *sess
 			channel->control_channel = NULL;
 		}
 		if(channel->engine_channel) {
+			mrcp_server_engine_lock(server);
 			mrcp_engine_channel_virtual_destroy(channel->engine_channel);
+			mrcp_server_engine_unlock(server);
 			channel->engine_channel = NULL;
 		}
 	}
@@ -1194,7 +1206,9 @@ apt_bool_t mrcp_server_mpf_message_process(mpf_message_container_t *mpf_message_
 			}
 		}
 		else if(mpf_message->message_type == MPF_MESSAGE_TYPE_EVENT) {
-			apt_log(APT_LOG_MARK,APT_PRIO_DEBUG,"Process MPF Event");
+			if(APT_LOG_ENABLED(APT_PRIO_DEBUG)) {
+				apt_log(APT_LOG_MARK,APT_PRIO_DEBUG,"Process MPF Event");
+			}
 		}
 	}
 	return TRUE;
@@ -96,7 +96,7 @@ MRCP_DECLARE(mrcp_sig_settings_t*) mrcp_signaling_settings_alloc(apr_pool_t *poo
 
 MRCP_DECLARE(mrcp_session_t*) mrcp_session_create(apr_size_t padding)
 {
-	apr_pool_t *pool = apt_pool_create();
+	apr_pool_t *pool = apt_pool_acquire();
 	if(!pool) {
 		return NULL;
 	}
@@ -128,6 +128,6 @@ MRCP_DECLARE(mrcp_session_t*) mrcp_session_create_ex(apr_pool_t *pool, apt_bool_
 MRCP_DECLARE(void) mrcp_session_destroy(mrcp_session_t *session)
 {
 	if(session->pool && session->self_owned == TRUE) {
-		apr_pool_destroy(session->pool);
+		apt_pool_release(session->pool);
 	}
 }
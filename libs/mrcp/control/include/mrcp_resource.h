@@ -47,6 +47,11 @@ struct mrcp_resource_t {
 
 	/** Get vtable of resource header */
 	const mrcp_header_vtable_t* (*get_resource_header_vtable)(mrcp_version_e version);
+
+	/** Get perfect hash of the string table of methods (optional) */
+	const apt_str_table_hash_t* (*get_method_str_hash)(mrcp_version_e version);
+	/** Get perfect hash of the string table of events (optional) */
+	const apt_str_table_hash_t* (*get_event_str_hash)(mrcp_version_e version);
 };
 
 /** Initialize MRCP resource */
@@ -60,6 +65,8 @@ static APR_INLINE mrcp_resource_t* mrcp_resource_create(apr_pool_t *pool)
 	resource->get_method_str_table = NULL;
 	resource->get_event_str_table = NULL;
 	resource->get_resource_header_vtable = NULL;
+	resource->get_method_str_hash = NULL;
+	resource->get_event_str_hash = NULL;
 	return resource;
 }
 
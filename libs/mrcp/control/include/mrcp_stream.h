@@ -57,6 +57,9 @@ MRCP_DECLARE(void) mrcp_generator_verbose_set(mrcp_generator_t *generator, apt_b
 /** Generate MRCP stream */
 MRCP_DECLARE(apt_message_status_e) mrcp_generator_run(mrcp_generator_t *generator, mrcp_message_t *message, apt_text_stream_t *stream);
 
+/** Generate MRCP stream header (start-line and header section), the body is referenced in place */
+MRCP_DECLARE(apt_message_status_e) mrcp_generator_header_run(mrcp_generator_t *generator, mrcp_message_t *message, apt_text_stream_t *stream, apt_str_t *body);
+
 
 /** Generate MRCP message (excluding message body) */
 MRCP_DECLARE(apt_bool_t) mrcp_message_generate(const mrcp_resource_factory_t *resource_factory, mrcp_message_t *message, apt_text_stream_t *stream);
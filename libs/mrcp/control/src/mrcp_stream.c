@@ -182,6 +182,12 @@ MRCP_DECLARE(apt_message_status_e) mrcp_generator_run(mrcp_generator_t *generato
 	return apt_message_generator_run(generator->base,message,stream);
 }
 
+/** Generate MRCP stream header, the body is referenced in place */
+MRCP_DECLARE(apt_message_status_e) mrcp_generator_header_run(mrcp_generator_t *generator, mrcp_message_t *message, apt_text_stream_t *stream, apt_str_t *body)
+{
+	return apt_message_generator_header_run(generator->base,message,stream,body);
+}
+
 /** Initialize by generating message start line and return header section and body */
 apt_bool_t mrcp_generator_on_start(apt_message_generator_t *generator, apt_message_context_t *context, apt_text_stream_t *stream)
 {
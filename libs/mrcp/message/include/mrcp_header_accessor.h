@@ -51,6 +51,8 @@ struct mrcp_header_vtable_t {
 	const apt_str_table_item_t *field_table;
 	/** Number of fields  */
 	apr_size_t                  field_count;
+	/** Perfect hash of the table of fields (optional) */
+	const apt_str_table_hash_t *field_hash;
 };
 
 /** MRCP header accessor */
@@ -73,6 +75,7 @@ static APR_INLINE void mrcp_header_vtable_init(mrcp_header_vtable_t *vtable)
 	vtable->duplicate_field = NULL;
 	vtable->field_table = NULL;
 	vtable->field_count = 0;
+	vtable->field_hash = NULL;
 }
 
 /** Validate header vtable */
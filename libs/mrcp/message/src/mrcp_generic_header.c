@@ -37,6 +37,11 @@ static const apt_str_table_item_t generic_header_string_table[] = {
 	{{"Set-Cookie2",               11},10}
 };
 
+/** Perfect hash of generic_header_string_table (generated by strtablegen) */
+static const apr_uint16_t generic_header_string_table_hash_seeds[] = {6,0,0,6,9,13,0,0,5};
+static const apr_byte_t generic_header_string_table_hash_ids[] = {8,15,14,1,5,10,7,2,4,6,3,13,11,12,0,9};
+static const apt_str_table_hash_t generic_header_string_table_hash = {9,generic_header_string_table_hash_seeds,generic_header_string_table_hash_ids};
+
 /** Parse mrcp request-id list */
 static apt_bool_t mrcp_request_id_list_parse(mrcp_request_id_list_t *request_id_list, const apt_str_t *value)
 {
@@ -315,7 +320,8 @@ static const mrcp_header_vtable_t vtable = {
 	mrcp_generic_header_generate,
 	mrcp_generic_header_duplicate,
 	generic_header_string_table,
-	GENERIC_HEADER_COUNT
+	GENERIC_HEADER_COUNT,
+	&generic_header_string_table_hash
 };
 
 
@@ -74,18 +74,20 @@ MRCP_DECLARE(apt_bool_t) mrcp_message_resource_set(mrcp_message_t *message, cons
 	
 	/* associate method_name and method_id */
 	if(message->start_line.message_type == MRCP_MESSAGE_TYPE_REQUEST) {
-		message->start_line.method_id = apt_string_table_id_find(
+		message->start_line.method_id = apt_string_table_hash_id_find(
 			resource->get_method_str_table(message->start_line.version),
 			resource->method_count,
+			resource->get_method_str_hash ? resource->get_method_str_hash(message->start_line.version) : NULL,
 			&message->start_line.method_name);
 		if(message->start_line.method_id >= resource->method_count) {
 			return FALSE;
 		}
 	}
 	else if(message->start_line.message_type == MRCP_MESSAGE_TYPE_EVENT) {
-		message->start_line.method_id = apt_string_table_id_find(
+		message->start_line.method_id = apt_string_table_hash_id_find(
 			resource->get_event_str_table(message->start_line.version),
 			resource->event_count,
+			resource->get_event_str_hash ? resource->get_event_str_hash(message->start_line.version) : NULL,
 			&message->start_line.method_name);
 		if(message->start_line.method_id >= resource->event_count) {
 			return FALSE;
@@ -65,6 +65,11 @@ static const apt_str_table_item_t v1_recog_header_string_table[] = {
 	{{"Abort-Phrase-Enrollment",          23},0}
 };
 
+/** Perfect hash of v1_recog_header_string_table (generated by strtablegen) */
+static const apr_uint16_t v1_recog_header_string_table_hash_seeds[] = {4,3,8,2,0,0,0,7,26,1,5,5,0,1,14,1,0,5,0,0,0,2,11};
+static const apr_byte_t v1_recog_header_string_table_hash_ids[] = {23,32,9,38,27,21,36,3,13,5,26,43,10,40,16,28,34,44,22,4,19,2,18,31,0,1,20,29,7,12,15,37,35,24,8,33,30,25,41,42,17,14,11,6,39};
+static const apt_str_table_hash_t v1_recog_header_string_table_hash = {23,v1_recog_header_string_table_hash_seeds,v1_recog_header_string_table_hash_ids};
+
 /** String table of MRCPv2 recognizer header fields (mrcp_recog_header_id) */
 static const apt_str_table_item_t v2_recog_header_string_table[] = {
 	{{"Confidence-Threshold",             20},16},
@@ -114,6 +119,11 @@ static const apt_str_table_item_t v2_recog_header_string_table[] = {
 	{{"Abort-Phrase-Enrollment",          23},0}
 };
 
+/** Perfect hash of v2_recog_header_string_table (generated by strtablegen) */
+static const apr_uint16_t v2_recog_header_string_table_hash_seeds[] = {3,0,8,0,1,0,1,0,35,3,7,5,6,1,36,7,13,5,1,0,14,4,29};
+static const apr_byte_t v2_recog_header_string_table_hash_ids[] = {23,32,21,6,41,34,36,3,27,5,25,43,22,7,40,10,44,17,14,20,19,2,26,31,11,1,13,29,39,12,15,37,38,24,18,33,9,8,42,30,4,28,35,16,0};
+static const apt_str_table_hash_t v2_recog_header_string_table_hash = {23,v2_recog_header_string_table_hash_seeds,v2_recog_header_string_table_hash_ids};
+
 /** String table of MRCPv1 recognizer completion-cause fields (mrcp_recog_completion_cause_e) */
 static const apt_str_table_item_t v1_completion_cause_string_table[] = {
 	{{"success",                     7},1},
@@ -747,7 +757,8 @@ static const mrcp_header_vtable_t v1_vtable = {
 	mrcp_v1_recog_header_generate,
 	mrcp_recog_header_duplicate,
 	v1_recog_header_string_table,
-	RECOGNIZER_HEADER_COUNT
+	RECOGNIZER_HEADER_COUNT,
+	&v1_recog_header_string_table_hash
 };
 
 static const mrcp_header_vtable_t v2_vtable = {
@@ -757,7 +768,8 @@ static const mrcp_header_vtable_t v2_vtable = {
 	mrcp_v2_recog_header_generate,
 	mrcp_recog_header_duplicate,
 	v2_recog_header_string_table,
-	RECOGNIZER_HEADER_COUNT
+	RECOGNIZER_HEADER_COUNT,
+	&v2_recog_header_string_table_hash
 };
 
 const mrcp_header_vtable_t* mrcp_recog_header_vtable_get(mrcp_version_e version)
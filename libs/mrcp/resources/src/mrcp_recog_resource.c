@@ -35,6 +35,11 @@ static const apt_str_table_item_t v1_recog_method_string_table[] = {
 	{{"DELETE-PHRASE",            13},2}
 };
 
+/** Perfect hash of v1_recog_method_string_table (generated by strtablegen) */
+static const apr_uint16_t v1_recog_method_string_table_hash_seeds[] = {0,4,28,0,2,7,33};
+static const apr_byte_t v1_recog_method_string_table_hash_ids[] = {10,7,0,4,8,2,5,6,9,3,11,12,1};
+static const apt_str_table_hash_t v1_recog_method_string_table_hash = {7,v1_recog_method_string_table_hash_seeds,v1_recog_method_string_table_hash_ids};
+
 /** String table of MRCPv2 recognizer methods (mrcp_recognizer_method_id) */
 static const apt_str_table_item_t v2_recog_method_string_table[] = {
 	{{"SET-PARAMS",               10},10},
@@ -52,6 +57,11 @@ static const apt_str_table_item_t v2_recog_method_string_table[] = {
 	{{"DELETE-PHRASE",            13},2}
 };
 
+/** Perfect hash of v2_recog_method_string_table (generated by strtablegen) */
+static const apr_uint16_t v2_recog_method_string_table_hash_seeds[] = {0,4,17,0,2,6,37};
+static const apr_byte_t v2_recog_method_string_table_hash_ids[] = {1,7,6,4,8,2,5,0,9,3,11,12,10};
+static const apt_str_table_hash_t v2_recog_method_string_table_hash = {7,v2_recog_method_string_table_hash_seeds,v2_recog_method_string_table_hash_ids};
+
 /** String table of MRCP recognizer events (mrcp_recognizer_event_id) */
 static const apt_str_table_item_t v1_recog_event_string_table[] = {
 	{{"START-OF-SPEECH",          15},0},
@@ -59,6 +69,11 @@ static const apt_str_table_item_t v1_recog_event_string_table[] = {
 	{{"INTERPRETATION-COMPLETE",  23},0}
 };
 
+/** Perfect hash of v1_recog_event_string_table (generated by strtablegen) */
+static const apr_uint16_t v1_recog_event_string_table_hash_seeds[] = {7,0};
+static const apr_byte_t v1_recog_event_string_table_hash_ids[] = {2,0,1};
+static const apt_str_table_hash_t v1_recog_event_string_table_hash = {2,v1_recog_event_string_table_hash_seeds,v1_recog_event_string_table_hash_ids};
+
 /** String table of MRCPv2 recognizer events (mrcp_recognizer_event_id) */
 static const apt_str_table_item_t v2_recog_event_string_table[] = {
 	{{"START-OF-INPUT",           14},0},
@@ -66,6 +81,11 @@ static const apt_str_table_item_t v2_recog_event_string_table[] = {
 	{{"INTERPRETATION-COMPLETE",  23},0}
 };
 
+/** Perfect hash of v2_recog_event_string_table (generated by strtablegen) */
+static const apr_uint16_t v2_recog_event_string_table_hash_seeds[] = {0,1};
+static const apr_byte_t v2_recog_event_string_table_hash_ids[] = {0,1,2};
+static const apt_str_table_hash_t v2_recog_event_string_table_hash = {2,v2_recog_event_string_table_hash_seeds,v2_recog_event_string_table_hash_ids};
+
 
 static APR_INLINE const apt_str_table_item_t* recog_method_string_table_get(mrcp_version_e version)
 {
@@ -83,6 +103,22 @@ static APR_INLINE const apt_str_table_item_t* recog_event_string_table_get(mrcp_
 	return v2_recog_event_string_table;
 }
 
+static APR_INLINE const apt_str_table_hash_t* recog_method_string_hash_get(mrcp_version_e version)
+{
+	if(version == MRCP_VERSION_1) {
+		return &v1_recog_method_string_table_hash;
+	}
+	return &v2_recog_method_string_table_hash;
+}
+
+static APR_INLINE const apt_str_table_hash_t* recog_event_string_hash_get(mrcp_version_e version)
+{
+	if(version == MRCP_VERSION_1) {
+		return &v1_recog_event_string_table_hash;
+	}
+	return &v2_recog_event_string_table_hash;
+}
+
 /** Create MRCP recognizer resource */
 MRCP_DECLARE(mrcp_resource_t*) mrcp_recog_resource_create(apr_pool_t *pool)
 {
@@ -92,6 +128,8 @@ MRCP_DECLARE(mrcp_resource_t*) mrcp_recog_resource_create(apr_pool_t *pool)
 	resource->event_count = RECOGNIZER_EVENT_COUNT;
 	resource->get_method_str_table = recog_method_string_table_get;
 	resource->get_event_str_table = recog_event_string_table_get;
+	resource->get_method_str_hash = recog_method_string_hash_get;
+	resource->get_event_str_hash = recog_event_string_hash_get;
 	resource->get_resource_header_vtable = mrcp_recog_header_vtable_get;
 	return resource;
 }
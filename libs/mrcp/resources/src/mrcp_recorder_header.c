@@ -35,6 +35,11 @@ static const apt_str_table_item_t recorder_header_string_table[] = {
 	{{"New-Audio-Channel",    17},2}
 };
 
+/** Perfect hash of recorder_header_string_table (generated by strtablegen) */
+static const apr_uint16_t recorder_header_string_table_hash_seeds[] = {0,2,14,3,31,1,3,0};
+static const apr_byte_t recorder_header_string_table_hash_ids[] = {0,10,7,12,11,6,3,8,13,2,9,4,1,14,5};
+static const apt_str_table_hash_t recorder_header_string_table_hash = {8,recorder_header_string_table_hash_seeds,recorder_header_string_table_hash_ids};
+
 /** String table of recorder completion-cause fields (mrcp_recorder_completion_cause_e) */
 static const apt_str_table_item_t completion_cause_string_table[] = {
 	{{"success-silence",  15},8},
@@ -264,7 +269,8 @@ static const mrcp_header_vtable_t vtable = {
 	mrcp_recorder_header_generate,
 	mrcp_recorder_header_duplicate,
 	recorder_header_string_table,
-	RECORDER_HEADER_COUNT
+	RECORDER_HEADER_COUNT,
+	&recorder_header_string_table_hash
 };
 
 const mrcp_header_vtable_t* mrcp_recorder_header_vtable_get(mrcp_version_e version)
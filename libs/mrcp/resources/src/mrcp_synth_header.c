@@ -41,6 +41,11 @@ static const apt_str_table_item_t synth_header_string_table[] = {
 	{{"Lexicon-Search-Order",20},2}
 };
 
+/** Perfect hash of synth_header_string_table (generated by strtablegen) */
+static const apr_uint16_t synth_header_string_table_hash_seeds[] = {0,0,10,0,6,2,0,7,22,30,53};
+static const apr_byte_t synth_header_string_table_hash_ids[] = {13,16,6,14,9,4,3,18,10,2,5,8,12,1,0,17,15,20,11,19,7};
+static const apt_str_table_hash_t synth_header_string_table_hash = {11,synth_header_string_table_hash_seeds,synth_header_string_table_hash_ids};
+
 /** String table of MRCP speech-unit fields (mrcp_speech_unit_t) */
 static const apt_str_table_item_t speech_unit_string_table[] = {
 	{{"Second",   6},2},
@@ -547,7 +552,8 @@ static const mrcp_header_vtable_t vtable = {
 	mrcp_synth_header_generate,
 	mrcp_synth_header_duplicate,
 	synth_header_string_table,
-	SYNTHESIZER_HEADER_COUNT
+	SYNTHESIZER_HEADER_COUNT,
+	&synth_header_string_table_hash
 };
 
 const mrcp_header_vtable_t* mrcp_synth_header_vtable_get(mrcp_version_e version)
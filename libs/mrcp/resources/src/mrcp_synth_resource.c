@@ -31,12 +31,22 @@ static const apt_str_table_item_t synth_method_string_table[] = {
 	{{"DEFINE-LEXICON",   14},0}
 };
 
+/** Perfect hash of synth_method_string_table (generated by strtablegen) */
+static const apr_uint16_t synth_method_string_table_hash_seeds[] = {0,0,1,58,0};
+static const apr_byte_t synth_method_string_table_hash_ids[] = {8,5,7,1,4,6,3,2,0};
+static const apt_str_table_hash_t synth_method_string_table_hash = {5,synth_method_string_table_hash_seeds,synth_method_string_table_hash_ids};
+
 /** String table of MRCP synthesizer events (mrcp_synthesizer_event_id) */
 static const apt_str_table_item_t synth_event_string_table[] = {
 	{{"SPEECH-MARKER", 13},3},
 	{{"SPEAK-COMPLETE",14},3}
 };
 
+/** Perfect hash of synth_event_string_table (generated by strtablegen) */
+static const apr_uint16_t synth_event_string_table_hash_seeds[] = {0,0};
+static const apr_byte_t synth_event_string_table_hash_ids[] = {1,0};
+static const apt_str_table_hash_t synth_event_string_table_hash = {2,synth_event_string_table_hash_seeds,synth_event_string_table_hash_ids};
+
 static APR_INLINE const apt_str_table_item_t* synth_method_string_table_get(mrcp_version_e version)
 {
 	return synth_method_string_table;
@@ -47,6 +57,16 @@ static APR_INLINE const apt_str_table_item_t* synth_event_string_table_get(mrcp_
 	return synth_event_string_table;
 }
 
+static APR_INLINE const apt_str_table_hash_t* synth_method_string_hash_get(mrcp_version_e version)
+{
+	return &synth_method_string_table_hash;
+}
+
+static APR_INLINE const apt_str_table_hash_t* synth_event_string_hash_get(mrcp_version_e version)
+{
+	return &synth_event_string_table_hash;
+}
+
 /** Create MRCP synthesizer resource */
 MRCP_DECLARE(mrcp_resource_t*) mrcp_synth_resource_create(apr_pool_t *pool)
 {
@@ -56,6 +76,8 @@ MRCP_DECLARE(mrcp_resource_t*) mrcp_synth_resource_create(apr_pool_t *pool)
 	resource->event_count = SYNTHESIZER_EVENT_COUNT;
 	resource->get_method_str_table = synth_method_string_table_get;
 	resource->get_event_str_table = synth_event_string_table_get;
+	resource->get_method_str_hash = synth_method_string_hash_get;
+	resource->get_event_str_hash = synth_event_string_hash_get;
 	resource->get_resource_header_vtable = mrcp_synth_header_vtable_get;
 	return resource;
 }
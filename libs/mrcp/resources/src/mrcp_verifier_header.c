@@ -41,6 +41,11 @@ static const apt_str_table_item_t verifier_header_string_table[] = {
 	{{"Start-Input-Timers",          18},1}
 };
 
+/** Perfect hash of verifier_header_string_table (generated by strtablegen) */
+static const apr_uint16_t verifier_header_string_table_hash_seeds[] = {4,0,19,1,0,0,0,1,3,7,53};
+static const apr_byte_t verifier_header_string_table_hash_ids[] = {5,3,0,10,20,16,17,7,1,4,9,11,14,15,13,6,12,8,2,18,19};
+static const apt_str_table_hash_t verifier_header_string_table_hash = {11,verifier_header_string_table_hash_seeds,verifier_header_string_table_hash_ids};
+
 /** String table of MRCP verifier completion-cause fields (mrcp_verifier_completion_cause_e) */
 static const apt_str_table_item_t completion_cause_string_table[] = {
 	{{"success",                 7},2},
@@ -335,7 +340,8 @@ static const mrcp_header_vtable_t header_vtable = {
 	mrcp_verifier_header_generate,
 	mrcp_verifier_header_duplicate,
 	verifier_header_string_table,
-	VERIFIER_HEADER_COUNT
+	VERIFIER_HEADER_COUNT,
+	&verifier_header_string_table_hash
 };
 
 const mrcp_header_vtable_t* mrcp_verifier_header_vtable_get(mrcp_version_e version)
@@ -35,12 +35,22 @@ static const apt_str_table_item_t verifier_method_string_table[] = {
 	{{"GET-INTERMEDIATE-RESULT",23},4},
 };
 
+/** Perfect hash of verifier_method_string_table (generated by strtablegen) */
+static const apr_uint16_t verifier_method_string_table_hash_seeds[] = {0,1,14,42,1,0,75};
+static const apr_byte_t verifier_method_string_table_hash_ids[] = {12,10,6,0,2,5,7,8,3,4,11,1,9};
+static const apt_str_table_hash_t verifier_method_string_table_hash = {7,verifier_method_string_table_hash_seeds,verifier_method_string_table_hash_ids};
+
 /** String table of MRCP verifier events (mrcp_verifier_event_id) */
 static const apt_str_table_item_t verifier_event_string_table[] = {
 	{{"START-OF-INPUT",       14},0},
 	{{"VERIFICATION-COMPLETE",21},0},
 };
 
+/** Perfect hash of verifier_event_string_table (generated by strtablegen) */
+static const apr_uint16_t verifier_event_string_table_hash_seeds[] = {1,0};
+static const apr_byte_t verifier_event_string_table_hash_ids[] = {0,1};
+static const apt_str_table_hash_t verifier_event_string_table_hash = {2,verifier_event_string_table_hash_seeds,verifier_event_string_table_hash_ids};
+
 static APR_INLINE const apt_str_table_item_t* verifier_method_string_table_get(mrcp_version_e version)
 {
 	return verifier_method_string_table;
@@ -51,6 +61,16 @@ static APR_INLINE const apt_str_table_item_t* verifier_event_string_table_get(mr
 	return verifier_event_string_table;
 }
 
+static APR_INLINE const apt_str_table_hash_t* verifier_method_string_hash_get(mrcp_version_e version)
+{
+	return &verifier_method_string_table_hash;
+}
+
+static APR_INLINE const apt_str_table_hash_t* verifier_event_string_hash_get(mrcp_version_e version)
+{
+	return &verifier_event_string_table_hash;
+}
+
 
 /** Create MRCP verifier resource */
 MRCP_DECLARE(mrcp_resource_t*) mrcp_verifier_resource_create(apr_pool_t *pool)
@@ -61,6 +81,8 @@ MRCP_DECLARE(mrcp_resource_t*) mrcp_verifier_resource_create(apr_pool_t *pool)
 	resource->event_count = VERIFIER_EVENT_COUNT;
 	resource->get_method_str_table = verifier_method_string_table_get;
 	resource->get_event_str_table = verifier_event_string_table_get;
+	resource->get_method_str_hash = verifier_method_string_hash_get;
+	resource->get_event_str_hash = verifier_event_string_hash_get;
 	resource->get_resource_header_vtable = mrcp_verifier_header_vtable_get;
 	return resource;
 }
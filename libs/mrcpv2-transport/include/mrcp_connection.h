@@ -110,6 +110,9 @@ apt_bool_t mrcp_connection_channel_remove(mrcp_connection_t *connection, mrcp_co
 /** Raise disconnect event for each channel from the specified connection. */
 apt_bool_t mrcp_connection_disconnect_raise(mrcp_connection_t *connection, const mrcp_connection_event_vtable_t *vtable);
 
+/** Send the generated header and the body referenced in place by a single gather write. */
+apt_bool_t mrcp_connection_message_send(mrcp_connection_t *connection, const apt_str_t *header, const apt_str_t *body);
+
 APT_END_EXTERN_C
 
 #endif /* MRCP_CONNECTION_H */
@@ -44,6 +44,27 @@ MRCP_DECLARE(mrcp_connection_agent_t*) mrcp_server_connection_agent_create(
 										apt_bool_t force_new_connection,
 										apr_pool_t *pool);
 
+/**
+ * Create connection agent with the specified number of workers.
+ * @param id the identifier of the engine
+ * @param listen_ip the IP address to listen on
+ * @param listen_port the port to listen on
+ * @param max_connection_count the number of max MRCPv2 connections per worker
+ * @param force_new_connection the policy used in o/a for connection establishment
+ * @param worker_count the number of workers (threads) to process connections by
+ * @param pool the pool to allocate memory from
+ * @remark Each worker runs its own poller, listens on its own socket bound to the
+ *         same address (SO_REUSEPORT) and processes the connections it accepts.
+ */
+MRCP_DECLARE(mrcp_connection_agent_t*) mrcp_server_connection_agent_create_ex(
+										const char *id,
+										const char *listen_ip, 
+										apr_port_t listen_port, 
+										apr_size_t max_connection_count,
+										apt_bool_t force_new_connection,
+										apr_size_t worker_count,
+										apr_pool_t *pool);
+
 /**
  * Destroy connection agent.
  * @param agent the agent to destroy
@@ -533,7 +533,7 @@ static apt_bool_t mrcp_client_agent_messsage_send(mrcp_connection_agent_t *agent
 	apt_bool_t status = FALSE;
 	mrcp_connection_t *connection = channel->connection;
 	apt_text_stream_t stream;
-	apt_message_status_e result;
+	apt_str_t body;
 
 	if(!connection || !connection->sock) {
 		apt_obj_log(APT_LOG_MARK,APT_PRIO_WARNING,channel->log_obj,"Null MRCPv2 Connection " APT_SIDRES_FMT,MRCP_MESSAGE_SIDRES(message));
@@ -541,33 +541,38 @@ static apt_bool_t mrcp_client_agent_messsage_send(mrcp_connection_agent_t *agent
 		return FALSE;
 	}
 
-	do {
-		apt_text_stream_init(&stream,connection->tx_buffer,connection->tx_buffer_size);
-		result = mrcp_generator_run(connection->generator,message,&stream);
-		if(result != APT_MESSAGE_STATUS_INVALID) {
-			stream.text.length = stream.pos - stream.text.buf;
-			*stream.pos = '\0';
+	/* generate start-line and header section only, the body is sent from where it is */
+	apt_text_stream_init(&stream,connection->tx_buffer,connection->tx_buffer_size);
+	if(mrcp_generator_header_run(connection->generator,message,&stream,&body) == APT_MESSAGE_STATUS_COMPLETE) {
+		stream.text.length = stream.pos - stream.text.buf;
+		*stream.pos = '\0';
 
-			apt_obj_log(APT_LOG_MARK,APT_PRIO_INFO,channel->log_obj,"Send MRCPv2 Data %s [%"APR_SIZE_T_FMT" bytes]\n%.*s",
+		if(APT_LOG_ENABLED(APT_PRIO_INFO)) {
+			apt_obj_log(APT_LOG_MARK,APT_PRIO_INFO,channel->log_obj,"Send MRCPv2 Data %s [%"APR_SIZE_T_FMT" bytes]\n%.*s%.*s",
 				connection->id,
-				stream.text.length,
+				stream.text.length + body.length,
 				connection->verbose == TRUE ? stream.text.length : 0,
-				stream.text.buf);
+				stream.text.buf,
+				connection->verbose == TRUE ? body.length : 0,
+				body.buf);
+		}
+		apt_log_trace(connection->id,APT_LOG_TRACE_SEND,stream.text.buf,stream.text.length);
+		if(body.length) {
+			apt_log_trace(connection->id,APT_LOG_TRACE_SEND,body.buf,body.length);
+		}
 
-			if(apr_socket_send(connection->sock,stream.text.buf,&stream.text.length) == APR_SUCCESS) {
-				status = TRUE;
-			}
-			else {
-				apt_obj_log(APT_LOG_MARK,APT_PRIO_WARNING,channel->log_obj,"Failed to Send MRCPv2 Data %s",
-					connection->id);
-			}
+		if(mrcp_connection_message_send(connection,&stream.text,&body) == TRUE) {
+			status = TRUE;
 		}
 		else {
-			apt_obj_log(APT_LOG_MARK,APT_PRIO_WARNING,channel->log_obj,"Failed to Generate MRCPv2 Data %s",
+			apt_obj_log(APT_LOG_MARK,APT_PRIO_WARNING,channel->log_obj,"Failed to Send MRCPv2 Data %s",
 				connection->id);
 		}
 	}
-	while(result == APT_MESSAGE_STATUS_INCOMPLETE);
+	else {
+		apt_obj_log(APT_LOG_MARK,APT_PRIO_WARNING,channel->log_obj,"Failed to Generate MRCPv2 Data %s",
+			connection->id);
+	}
 
 	if(status == TRUE) {
 		channel->active_request = message;
@@ -653,11 +658,14 @@ static apt_bool_t mrcp_client_poller_signal_process(void *obj, const apr_pollfd_
 	/* calculate actual length of the stream */
 	stream->text.length = offset + length;
 	stream->pos[length] = '\0';
-	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Receive MRCPv2 Data %s [%"APR_SIZE_T_FMT" bytes]\n%.*s",
-			connection->id,
-			length,
-			connection->verbose == TRUE ? length : 0,
-			stream->pos);
+	if(APT_LOG_ENABLED(APT_PRIO_INFO)) {
+		apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Receive MRCPv2 Data %s [%"APR_SIZE_T_FMT" bytes]\n%.*s",
+				connection->id,
+				length,
+				connection->verbose == TRUE ? length : 0,
+				stream->pos);
+	}
+	apt_log_trace(connection->id,APT_LOG_TRACE_RECEIVE,stream->pos,length);
 
 	/* reset pos */
 	apt_text_stream_reset(stream);
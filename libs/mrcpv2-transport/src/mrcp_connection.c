@@ -17,10 +17,13 @@
 #include "mrcp_connection.h"
 #include "apt_pool.h"
 
+/** Number of the buffers sent by a gather write: header and body */
+#define MRCP_CONNECTION_IOVEC_COUNT 2
+
 mrcp_connection_t* mrcp_connection_create(void)
 {
 	mrcp_connection_t *connection;
-	apr_pool_t *pool = apt_pool_create();
+	apr_pool_t *pool = apt_pool_acquire();
 	if(!pool) {
 		return NULL;
 	}
@@ -52,7 +55,7 @@ mrcp_connection_t* mrcp_connection_create(void)
 void mrcp_connection_destroy(mrcp_connection_t *connection)
 {
 	if(connection && connection->pool) {
-		apr_pool_destroy(connection->pool);
+		apt_pool_release(connection->pool);
 	}
 }
 
@@ -104,3 +107,44 @@ apt_bool_t mrcp_connection_disconnect_raise(mrcp_connection_t *connection, const
 	}
 	return TRUE;
 }
+
+apt_bool_t mrcp_connection_message_send(mrcp_connection_t *connection, const apt_str_t *header, const apt_str_t *body)
+{
+	struct iovec vec[MRCP_CONNECTION_IOVEC_COUNT];
+	struct iovec *cur = vec;
+	apr_int32_t count = 0;
+	apr_size_t length;
+
+	if(!connection || !connection->sock) {
+		return FALSE;
+	}
+
+	if(header && header->length) {
+		vec[count].iov_base = header->buf;
+		vec[count].iov_len = header->length;
+		count++;
+	}
+	if(body && body->length) {
+		vec[count].iov_base = body->buf;
+		vec[count].iov_len = body->length;
+		count++;
+	}
+
+	while(count > 0) {
+		length = 0;
+		if(apr_socket_sendv(connection->sock,cur,count,&length) != APR_SUCCESS) {
+			return FALSE;
+		}
+		/* skip the sent buffers and resume from the rest after a partial write */
+		while(count > 0 && length >= cur->iov_len) {
+			length -= cur->iov_len;
+			cur++;
+			count--;
+		}
+		if(count > 0) {
+			cur->iov_base = (char*)cur->iov_base + length;
+			cur->iov_len -= length;
+		}
+	}
+	return TRUE;
+}
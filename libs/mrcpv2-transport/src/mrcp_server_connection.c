@@ -23,15 +23,36 @@
 #include "apt_poller_task.h"
 #include "apt_pool.h"
 #include "apt_log.h"
+#include <apr_portable.h>
+#include <apr_thread_mutex.h>
 
+/** MRCPv2 connection worker (poller thread), which owns its listening socket and connections */
+typedef struct mrcp_connection_worker_t mrcp_connection_worker_t;
 
-struct mrcp_connection_agent_t {
-	apr_pool_t                           *pool;
+struct mrcp_connection_worker_t {
+	/** Connection agent the worker belongs to */
+	mrcp_connection_agent_t              *agent;
+	/** Poller task of the worker */
 	apt_poller_task_t                    *task;
-	const mrcp_resource_factory_t        *resource_factory;
 
 	/** List (ring) of MRCP connections */
 	APR_RING_HEAD(mrcp_connection_head_t, mrcp_connection_t) connection_list;
+
+	/* Listening socket */
+	apr_socket_t                         *listen_sock;
+	apr_pollfd_t                          listen_sock_pfd;
+};
+
+struct mrcp_connection_agent_t {
+	apr_pool_t                           *pool;
+	/** Array of workers, the task of the first one is the task of the agent */
+	mrcp_connection_worker_t             *workers;
+	/** Number of workers */
+	apr_size_t                            worker_count;
+	/** Guard of the pending channels and connection lists shared by multiple workers */
+	apr_thread_mutex_t                   *guard;
+	const mrcp_resource_factory_t        *resource_factory;
+
 	/** Table of pending control channels */
 	apr_hash_t                           *pending_channel_table;
 
@@ -42,10 +63,8 @@ struct mrcp_connection_agent_t {
 	apr_uint32_t                          inactivity_timeout;
 	apr_uint32_t                          termination_timeout;
 
-	/* Listening socket */
+	/* Listening address */
 	apr_sockaddr_t                       *sockaddr;
-	apr_socket_t                         *listen_sock;
-	apr_pollfd_t                          listen_sock_pfd;
 
 	void                                 *obj;
 	const mrcp_connection_event_vtable_t *vtable;
@@ -71,8 +90,15 @@ static apt_bool_t mrcp_server_agent_on_destroy(apt_task_t *task);
 static apt_bool_t mrcp_server_agent_msg_process(apt_task_t *task, apt_task_msg_t *task_msg);
 static apt_bool_t mrcp_server_poller_signal_process(void *obj, const apr_pollfd_t *descriptor);
 
-static apt_bool_t mrcp_server_agent_listening_socket_create(mrcp_connection_agent_t *agent);
-static void mrcp_server_agent_listening_socket_destroy(mrcp_connection_agent_t *agent);
+static apt_bool_t mrcp_server_agent_listening_socket_create(mrcp_connection_worker_t *worker);
+static void mrcp_server_agent_listening_socket_destroy(mrcp_connection_worker_t *worker);
+
+static apt_bool_t mrcp_server_control_message_signal(
+								connection_task_msg_type_e type,
+								mrcp_connection_worker_t *worker,
+								mrcp_control_channel_t *channel,
+								mrcp_control_descriptor_t *descriptor,
+								mrcp_message_t *message);
 
 static void mrcp_server_inactivity_timer_proc(apt_timer_t *timer, void *obj);
 static void mrcp_server_termination_timer_proc(apt_timer_t *timer, void *obj);
@@ -86,21 +112,42 @@ MRCP_DECLARE(mrcp_connection_agent_t*) mrcp_server_connection_agent_create(
 										apt_bool_t force_new_connection,
 										apr_pool_t *pool)
 {
+	return mrcp_server_connection_agent_create_ex(id,listen_ip,listen_port,max_connection_count,force_new_connection,1,pool);
+}
+
+/** Create connection agent with the specified number of workers */
+MRCP_DECLARE(mrcp_connection_agent_t*) mrcp_server_connection_agent_create_ex(
+										const char *id,
+										const char *listen_ip,
+										apr_port_t listen_port,
+										apr_size_t max_connection_count,
+										apt_bool_t force_new_connection,
+										apr_size_t worker_count,
+										apr_pool_t *pool)
+{
+	apr_size_t i;
 	apt_task_t *task;
+	apt_task_t *agent_task = NULL;
 	apt_task_vtable_t *vtable;
 	apt_task_msg_pool_t *msg_pool;
+	mrcp_connection_worker_t *worker;
 	mrcp_connection_agent_t *agent;
 
 	if(!listen_ip) {
 		return NULL;
 	}
+	if(!worker_count) {
+		worker_count = 1;
+	}
 	
-	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"Create MRCPv2 Agent [%s] %s:%hu [%"APR_SIZE_T_FMT"]",
-		id,listen_ip,listen_port,max_connection_count);
+	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"Create MRCPv2 Agent [%s] %s:%hu [%"APR_SIZE_T_FMT"] workers [%"APR_SIZE_T_FMT"]",
+		id,listen_ip,listen_port,max_connection_count,worker_count);
 	agent = apr_palloc(pool,sizeof(mrcp_connection_agent_t));
 	agent->pool = pool;
 	agent->sockaddr = NULL;
-	agent->listen_sock = NULL;
+	agent->guard = NULL;
+	agent->worker_count = worker_count;
+	agent->workers = apr_palloc(pool,sizeof(mrcp_connection_worker_t) * worker_count);
 	agent->force_new_connection = force_new_connection;
 	agent->max_shared_use_count = 100;
 	agent->rx_buffer_size = MRCP_STREAM_BUFFER_SIZE;
@@ -113,37 +160,56 @@ MRCP_DECLARE(mrcp_connection_agent_t*) mrcp_server_connection_agent_create(
 		return NULL;
 	}
 
-	msg_pool = apt_task_msg_pool_create_dynamic(sizeof(connection_task_msg_t),pool);
-	
-	agent->task = apt_poller_task_create(
-					max_connection_count + 1,
-					mrcp_server_poller_signal_process,
-					agent,
-					msg_pool,
-					pool);
-	if(!agent->task) {
-		return NULL;
+	agent->pending_channel_table = apr_hash_make(pool);
+	if(worker_count > 1) {
+		/* the pending channels and connection lists are accessed by all the workers */
+		if(apr_thread_mutex_create(&agent->guard,APR_THREAD_MUTEX_UNNESTED,pool) != APR_SUCCESS) {
+			return NULL;
+		}
 	}
 
-	task = apt_poller_task_base_get(agent->task);
-	if(task) {
-		apt_task_name_set(task,id);
-	}
+	for(i=0; i<worker_count; i++) {
+		worker = &agent->workers[i];
+		worker->agent = agent;
+		worker->listen_sock = NULL;
+		APR_RING_INIT(&worker->connection_list, mrcp_connection_t, link);
+
+		msg_pool = apt_task_msg_pool_create_dynamic(sizeof(connection_task_msg_t),pool);
+		worker->task = apt_poller_task_create(
+						max_connection_count + 1,
+						mrcp_server_poller_signal_process,
+						worker,
+						msg_pool,
+						pool);
+		if(!worker->task) {
+			return NULL;
+		}
 
-	vtable = apt_poller_task_vtable_get(agent->task);
-	if(vtable) {
-		vtable->destroy = mrcp_server_agent_on_destroy;
-		vtable->process_msg = mrcp_server_agent_msg_process;
-	}
+		task = apt_poller_task_base_get(worker->task);
+		if(task) {
+			if(i == 0) {
+				apt_task_name_set(task,id);
+				agent_task = task;
+			}
+			else {
+				/* the other workers are started and terminated along with the first one */
+				apt_task_name_set(task,apr_psprintf(pool,"%s-%"APR_SIZE_T_FMT,id,i));
+				apt_task_add(agent_task,task);
+			}
+		}
 
-	APR_RING_INIT(&agent->connection_list, mrcp_connection_t, link);
-	agent->pending_channel_table = apr_hash_make(pool);
+		vtable = apt_poller_task_vtable_get(worker->task);
+		if(vtable) {
+			vtable->destroy = mrcp_server_agent_on_destroy;
+			vtable->process_msg = mrcp_server_agent_msg_process;
+		}
 
-	if(mrcp_server_agent_listening_socket_create(agent) != TRUE) {
-		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Create Listening Socket [%s] %s:%hu", 
-				id,
-				listen_ip,
-				listen_port);
+		if(mrcp_server_agent_listening_socket_create(worker) != TRUE) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Create Listening Socket [%s] %s:%hu", 
+					apt_task_name_get(task),
+					listen_ip,
+					listen_port);
+		}
 	}
 	return agent;
 }
@@ -151,10 +217,14 @@ MRCP_DECLARE(mrcp_connection_agent_t*) mrcp_server_connection_agent_create(
 static apt_bool_t mrcp_server_agent_on_destroy(apt_task_t *task)
 {
 	apt_poller_task_t *poller_task = apt_task_object_get(task);
-	mrcp_connection_agent_t *agent = apt_poller_task_object_get(poller_task);
+	mrcp_connection_worker_t *worker = apt_poller_task_object_get(poller_task);
 
-	mrcp_server_agent_listening_socket_destroy(agent);
+	mrcp_server_agent_listening_socket_destroy(worker);
 	apt_poller_task_cleanup(poller_task);
+	if(worker == &worker->agent->workers[0] && worker->agent->guard) {
+		apr_thread_mutex_destroy(worker->agent->guard);
+		worker->agent->guard = NULL;
+	}
 	return TRUE;
 }
 
@@ -163,19 +233,19 @@ MRCP_DECLARE(apt_bool_t) mrcp_server_connection_agent_destroy(mrcp_connection_ag
 {
 	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"Destroy MRCPv2 Agent [%s]",
 		mrcp_server_connection_agent_id_get(agent));
-	return apt_poller_task_destroy(agent->task);
+	return apt_poller_task_destroy(agent->workers[0].task);
 }
 
 /** Start connection agent. */
 MRCP_DECLARE(apt_bool_t) mrcp_server_connection_agent_start(mrcp_connection_agent_t *agent)
 {
-	return apt_poller_task_start(agent->task);
+	return apt_poller_task_start(agent->workers[0].task);
 }
 
 /** Terminate connection agent. */
 MRCP_DECLARE(apt_bool_t) mrcp_server_connection_agent_terminate(mrcp_connection_agent_t *agent)
 {
-	return apt_poller_task_terminate(agent->task);
+	return apt_poller_task_terminate(agent->workers[0].task);
 }
 
 /** Set connection event handler. */
@@ -246,7 +316,7 @@ MRCP_DECLARE(void) mrcp_server_connection_term_timeout_set(
 /** Get task */
 MRCP_DECLARE(apt_task_t*) mrcp_server_connection_agent_task_get(const mrcp_connection_agent_t *agent)
 {
-	return apt_poller_task_base_get(agent->task);
+	return apt_poller_task_base_get(agent->workers[0].task);
 }
 
 /** Get external object */
@@ -258,10 +328,32 @@ MRCP_DECLARE(void*) mrcp_server_connection_agent_object_get(const mrcp_connectio
 /** Get string identifier */
 MRCP_DECLARE(const char*) mrcp_server_connection_agent_id_get(const mrcp_connection_agent_t *agent)
 {
-	apt_task_t *task = apt_poller_task_base_get(agent->task);
+	apt_task_t *task = apt_poller_task_base_get(agent->workers[0].task);
 	return apt_task_name_get(task);
 }
 
+/** Get the number of workers */
+MRCP_DECLARE(apr_size_t) mrcp_server_connection_agent_worker_count_get(const mrcp_connection_agent_t *agent)
+{
+	return agent->worker_count;
+}
+
+/** Lock the data shared by the workers */
+static APR_INLINE void mrcp_server_agent_lock(mrcp_connection_agent_t *agent)
+{
+	if(agent->guard) {
+		apr_thread_mutex_lock(agent->guard);
+	}
+}
+
+/** Unlock the data shared by the workers */
+static APR_INLINE void mrcp_server_agent_unlock(mrcp_connection_agent_t *agent)
+{
+	if(agent->guard) {
+		apr_thread_mutex_unlock(agent->guard);
+	}
+}
+
 
 /** Create MRCPv2 control channel */
 MRCP_DECLARE(mrcp_control_channel_t*) mrcp_server_control_channel_create(mrcp_connection_agent_t *agent, void *obj, apr_pool_t *pool)
@@ -290,20 +382,20 @@ MRCP_DECLARE(apt_bool_t) mrcp_server_control_channel_destroy(mrcp_control_channe
 	return TRUE;
 }
 
-/** Signal task message */
+/** Signal task message to the worker */
 static apt_bool_t mrcp_server_control_message_signal(
 								connection_task_msg_type_e type,
-								mrcp_connection_agent_t *agent,
+								mrcp_connection_worker_t *worker,
 								mrcp_control_channel_t *channel,
 								mrcp_control_descriptor_t *descriptor,
 								mrcp_message_t *message)
 {
-	apt_task_t *task = apt_poller_task_base_get(agent->task);
+	apt_task_t *task = apt_poller_task_base_get(worker->task);
 	apt_task_msg_t *task_msg = apt_task_msg_get(task);
 	if(task_msg) {
 		connection_task_msg_t *msg = (connection_task_msg_t*)task_msg->data;
 		msg->type = type;
-		msg->agent = agent;
+		msg->agent = worker->agent;
 		msg->channel = channel;
 		msg->descriptor = descriptor;
 		msg->message = message;
@@ -315,69 +407,113 @@ static apt_bool_t mrcp_server_control_message_signal(
 /** Add MRCPv2 control channel */
 MRCP_DECLARE(apt_bool_t) mrcp_server_control_channel_add(mrcp_control_channel_t *channel, mrcp_control_descriptor_t *descriptor)
 {
-	return mrcp_server_control_message_signal(CONNECTION_TASK_MSG_ADD_CHANNEL,channel->agent,channel,descriptor,NULL);
+	return mrcp_server_control_message_signal(CONNECTION_TASK_MSG_ADD_CHANNEL,&channel->agent->workers[0],channel,descriptor,NULL);
 }
 
 /** Modify MRCPv2 control channel */
 MRCP_DECLARE(apt_bool_t) mrcp_server_control_channel_modify(mrcp_control_channel_t *channel, mrcp_control_descriptor_t *descriptor)
 {
-	return mrcp_server_control_message_signal(CONNECTION_TASK_MSG_MODIFY_CHANNEL,channel->agent,channel,descriptor,NULL);
+	return mrcp_server_control_message_signal(CONNECTION_TASK_MSG_MODIFY_CHANNEL,&channel->agent->workers[0],channel,descriptor,NULL);
 }
 
 /** Remove MRCPv2 control channel */
 MRCP_DECLARE(apt_bool_t) mrcp_server_control_channel_remove(mrcp_control_channel_t *channel)
 {
-	return mrcp_server_control_message_signal(CONNECTION_TASK_MSG_REMOVE_CHANNEL,channel->agent,channel,NULL,NULL);
+	/* the first worker either removes the pending channel or passes the request to the worker of the connection */
+	return mrcp_server_control_message_signal(CONNECTION_TASK_MSG_REMOVE_CHANNEL,&channel->agent->workers[0],channel,NULL,NULL);
 }
 
 /** Send MRCPv2 message */
 MRCP_DECLARE(apt_bool_t) mrcp_server_control_message_send(mrcp_control_channel_t *channel, mrcp_message_t *message)
 {
-	return mrcp_server_control_message_signal(CONNECTION_TASK_MSG_SEND_MESSAGE,channel->agent,channel,NULL,message);
+	/* messages are sent in response to the requests received through the connection,
+	so the channel is already assigned to the connection and its worker */
+	mrcp_connection_worker_t *worker = &channel->agent->workers[0];
+	if(channel->connection && channel->connection->agent) {
+		worker = channel->connection->agent;
+	}
+	return mrcp_server_control_message_signal(CONNECTION_TASK_MSG_SEND_MESSAGE,worker,channel,NULL,message);
+}
+
+/** Let the listening sockets of all the workers bind to the same address, the kernel balances connections */
+static apt_bool_t mrcp_server_agent_listening_socket_share(mrcp_connection_worker_t *worker)
+{
+#ifdef SO_REUSEPORT
+	apr_os_sock_t os_sock;
+	int on = 1;
+	if(apr_os_sock_get(&os_sock,worker->listen_sock) != APR_SUCCESS) {
+		return FALSE;
+	}
+	if(setsockopt(os_sock,SOL_SOCKET,SO_REUSEPORT,(void*)&on,sizeof(on)) != 0) {
+		return FALSE;
+	}
+	return TRUE;
+#else
+	return FALSE;
+#endif
 }
 
 /** Create listening socket and add it to pollset */
-static apt_bool_t mrcp_server_agent_listening_socket_create(mrcp_connection_agent_t *agent)
+static apt_bool_t mrcp_server_agent_listening_socket_create(mrcp_connection_worker_t *worker)
 {
 	apr_status_t status;
+	mrcp_connection_agent_t *agent = worker->agent;
 	if(!agent->sockaddr) {
 		return FALSE;
 	}
 
+	if(worker != &agent->workers[0] && !agent->workers[0].listen_sock) {
+		/* the port is not shared */
+		return FALSE;
+	}
+
 	/* create listening socket */
-	status = apr_socket_create(&agent->listen_sock, agent->sockaddr->family, SOCK_STREAM, APR_PROTO_TCP, agent->pool);
+	status = apr_socket_create(&worker->listen_sock, agent->sockaddr->family, SOCK_STREAM, APR_PROTO_TCP, agent->pool);
 	if(status != APR_SUCCESS) {
 		return FALSE;
 	}
 
-	apr_socket_opt_set(agent->listen_sock, APR_SO_NONBLOCK, 0);
-	apr_socket_timeout_set(agent->listen_sock, -1);
-	apr_socket_opt_set(agent->listen_sock, APR_SO_REUSEADDR, 1);
+	apr_socket_opt_set(worker->listen_sock, APR_SO_NONBLOCK, 0);
+	apr_socket_timeout_set(worker->listen_sock, -1);
+	apr_socket_opt_set(worker->listen_sock, APR_SO_REUSEADDR, 1);
+	if(agent->worker_count > 1) {
+		if(mrcp_server_agent_listening_socket_share(worker) != TRUE) {
+			if(worker == &agent->workers[0]) {
+				apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Share Listening Port [%s], Connections are Accepted by the First Worker only",
+					apt_task_name_get(apt_poller_task_base_get(worker->task)));
+			}
+			else {
+				apr_socket_close(worker->listen_sock);
+				worker->listen_sock = NULL;
+				return TRUE;
+			}
+		}
+	}
 
-	status = apr_socket_bind(agent->listen_sock, agent->sockaddr);
+	status = apr_socket_bind(worker->listen_sock, agent->sockaddr);
 	if(status != APR_SUCCESS) {
-		apr_socket_close(agent->listen_sock);
-		agent->listen_sock = NULL;
+		apr_socket_close(worker->listen_sock);
+		worker->listen_sock = NULL;
 		return FALSE;
 	}
-	status = apr_socket_listen(agent->listen_sock, SOMAXCONN);
+	status = apr_socket_listen(worker->listen_sock, SOMAXCONN);
 	if(status != APR_SUCCESS) {
-		apr_socket_close(agent->listen_sock);
-		agent->listen_sock = NULL;
+		apr_socket_close(worker->listen_sock);
+		worker->listen_sock = NULL;
 		return FALSE;
 	}
 
 	/* add listening socket to pollset */
-	memset(&agent->listen_sock_pfd,0,sizeof(apr_pollfd_t));
-	agent->listen_sock_pfd.desc_type = APR_POLL_SOCKET;
-	agent->listen_sock_pfd.reqevents = APR_POLLIN;
-	agent->listen_sock_pfd.desc.s = agent->listen_sock;
-	agent->listen_sock_pfd.client_data = agent->listen_sock;
-	if(apt_poller_task_descriptor_add(agent->task, &agent->listen_sock_pfd) != TRUE) {
+	memset(&worker->listen_sock_pfd,0,sizeof(apr_pollfd_t));
+	worker->listen_sock_pfd.desc_type = APR_POLL_SOCKET;
+	worker->listen_sock_pfd.reqevents = APR_POLLIN;
+	worker->listen_sock_pfd.desc.s = worker->listen_sock;
+	worker->listen_sock_pfd.client_data = worker->listen_sock;
+	if(apt_poller_task_descriptor_add(worker->task, &worker->listen_sock_pfd) != TRUE) {
 		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Add Listening Socket to Pollset [%s]",
-			apt_task_name_get(apt_poller_task_base_get(agent->task)));
-		apr_socket_close(agent->listen_sock);
-		agent->listen_sock = NULL;
+			apt_task_name_get(apt_poller_task_base_get(worker->task)));
+		apr_socket_close(worker->listen_sock);
+		worker->listen_sock = NULL;
 		return FALSE;
 	}
 
@@ -385,12 +521,12 @@ static apt_bool_t mrcp_server_agent_listening_socket_create(mrcp_connection_agen
 }
 
 /** Remove from pollset and destroy listening socket */
-static void mrcp_server_agent_listening_socket_destroy(mrcp_connection_agent_t *agent)
+static void mrcp_server_agent_listening_socket_destroy(mrcp_connection_worker_t *worker)
 {
-	if(agent->listen_sock) {
-		apt_poller_task_descriptor_remove(agent->task,&agent->listen_sock_pfd);
-		apr_socket_close(agent->listen_sock);
-		agent->listen_sock = NULL;
+	if(worker->listen_sock) {
+		apt_poller_task_descriptor_remove(worker->task,&worker->listen_sock_pfd);
+		apr_socket_close(worker->listen_sock);
+		worker->listen_sock = NULL;
 	}
 }
 
@@ -405,6 +541,7 @@ static mrcp_control_channel_t* mrcp_connection_channel_associate(mrcp_connection
 	apt_id_resource_generate(&message->channel_id.session_id,&message->channel_id.resource_name,'@',&identifier,connection->pool);
 	channel = mrcp_connection_channel_find(connection,&identifier);
 	if(!channel) {
+		mrcp_server_agent_lock(agent);
 		channel = apr_hash_get(agent->pending_channel_table,identifier.buf,identifier.length);
 		if(channel) {
 			apr_hash_set(agent->pending_channel_table,identifier.buf,identifier.length,NULL);
@@ -415,54 +552,66 @@ static mrcp_control_channel_t* mrcp_connection_channel_associate(mrcp_connection
 				apr_hash_count(agent->pending_channel_table),
 				apr_hash_count(connection->channel_table));
 		}
+		mrcp_server_agent_unlock(agent);
 	}
 	return channel;
 }
 
 static mrcp_connection_t* mrcp_connection_find(mrcp_connection_agent_t *agent, const apt_str_t *remote_ip)
 {
+	apr_size_t i;
+	mrcp_connection_worker_t *worker;
 	mrcp_connection_t *connection;
 	if(!agent || !remote_ip) {
 		return NULL;
 	}
 
-	for(connection = APR_RING_FIRST(&agent->connection_list);
-			connection != APR_RING_SENTINEL(&agent->connection_list, mrcp_connection_t, link);
-				connection = APR_RING_NEXT(connection, link)) {
-		if(apt_string_compare(&connection->remote_ip,remote_ip) == TRUE) {
-			return connection;
+	for(i=0; i<agent->worker_count; i++) {
+		worker = &agent->workers[i];
+		for(connection = APR_RING_FIRST(&worker->connection_list);
+				connection != APR_RING_SENTINEL(&worker->connection_list, mrcp_connection_t, link);
+					connection = APR_RING_NEXT(connection, link)) {
+			if(apt_string_compare(&connection->remote_ip,remote_ip) == TRUE) {
+				return connection;
+			}
 		}
 	}
 
 	return NULL;
 }
 
-static apt_bool_t mrcp_connection_add(mrcp_connection_agent_t *agent, mrcp_connection_t *connection)
+static apt_bool_t mrcp_connection_add(mrcp_connection_worker_t *worker, mrcp_connection_t *connection)
 {
-	APR_RING_INSERT_TAIL(&agent->connection_list,connection,mrcp_connection_t,link);
+	mrcp_server_agent_lock(worker->agent);
+	APR_RING_INSERT_TAIL(&worker->connection_list,connection,mrcp_connection_t,link);
+	mrcp_server_agent_unlock(worker->agent);
 	if(connection->inactivity_timer) {
-		apt_timer_set(connection->inactivity_timer,agent->inactivity_timeout);
+		apt_timer_set(connection->inactivity_timer,worker->agent->inactivity_timeout);
 	}
 	return TRUE;
 }
 
-static apt_bool_t mrcp_connection_remove(mrcp_connection_agent_t *agent, mrcp_connection_t *connection)
+static apt_bool_t mrcp_connection_remove(mrcp_connection_worker_t *worker, mrcp_connection_t *connection)
 {
 	if(connection->inactivity_timer) {
 		apt_timer_kill(connection->inactivity_timer);
 	}
+	mrcp_server_agent_lock(worker->agent);
 	APR_RING_REMOVE(connection,link);
+	mrcp_server_agent_unlock(worker->agent);
 	return TRUE;
 }
 
-static apt_bool_t mrcp_server_agent_connection_accept(mrcp_connection_agent_t *agent)
+static apt_bool_t mrcp_server_agent_connection_accept(mrcp_connection_worker_t *worker)
 {
 	char *local_ip = NULL;
 	char *remote_ip = NULL;
+	apr_size_t pending_count;
+	mrcp_connection_agent_t *agent = worker->agent;
 	
 	mrcp_connection_t *connection = mrcp_connection_create();
 
-	if(apr_socket_accept(&connection->sock,agent->listen_sock,connection->pool) != APR_SUCCESS) {
+	if(apr_socket_accept(&connection->sock,worker->listen_sock,connection->pool) != APR_SUCCESS) {
 		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Accept Connection");
 		mrcp_connection_destroy(connection);
 		return FALSE;
@@ -483,7 +632,10 @@ static apt_bool_t mrcp_server_agent_connection_accept(mrcp_connection_agent_t *a
 		local_ip,connection->l_sockaddr->port,
 		remote_ip,connection->r_sockaddr->port);
 
-	if(apr_hash_count(agent->pending_channel_table) == 0) {
+	mrcp_server_agent_lock(agent);
+	pending_count = apr_hash_count(agent->pending_channel_table);
+	mrcp_server_agent_unlock(agent);
+	if(pending_count == 0) {
 		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Reject Unexpected TCP/MRCPv2 Connection %s",connection->id);
 		apr_socket_close(connection->sock);
 		mrcp_connection_destroy(connection);
@@ -495,15 +647,18 @@ static apt_bool_t mrcp_server_agent_connection_accept(mrcp_connection_agent_t *a
 	connection->sock_pfd.reqevents = APR_POLLIN;
 	connection->sock_pfd.desc.s = connection->sock;
 	connection->sock_pfd.client_data = connection;
-	if(apt_poller_task_descriptor_add(agent->task, &connection->sock_pfd) != TRUE) {
+	if(apt_poller_task_descriptor_add(worker->task, &connection->sock_pfd) != TRUE) {
 		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Add to Pollset %s",connection->id);
 		apr_socket_close(connection->sock);
 		mrcp_connection_destroy(connection);
 		return FALSE;
 	}
 
-	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"Accepted TCP/MRCPv2 Connection %s",connection->id);
-	connection->agent = agent;
+	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"Accepted TCP/MRCPv2 Connection %s [%s]",
+		connection->id,
+		apt_task_name_get(apt_poller_task_base_get(worker->task)));
+	/* the opaque agent of the connection is the worker it is processed by */
+	connection->agent = worker;
 
 	connection->parser = mrcp_parser_create(agent->resource_factory,connection->pool);
 	connection->generator = mrcp_generator_create(agent->resource_factory,connection->pool);
@@ -523,24 +678,25 @@ static apt_bool_t mrcp_server_agent_connection_accept(mrcp_connection_agent_t *a
 
 	if(agent->inactivity_timeout) {
 		connection->inactivity_timer = apt_poller_task_timer_create(
-										agent->task,
+										worker->task,
 										mrcp_server_inactivity_timer_proc,
 										connection,
 										connection->pool);
 	}
 
-	mrcp_connection_add(agent,connection);
+	mrcp_connection_add(worker,connection);
 	return TRUE;
 }
 
-static apt_bool_t mrcp_server_agent_connection_close(mrcp_connection_agent_t *agent, mrcp_connection_t *connection, apt_bool_t timedout)
+static apt_bool_t mrcp_server_agent_connection_close(mrcp_connection_worker_t *worker, mrcp_connection_t *connection, apt_bool_t timedout)
 {
+	mrcp_connection_agent_t *agent = worker->agent;
 	if(connection->sock) {
-		apt_poller_task_descriptor_remove(agent->task,&connection->sock_pfd);
+		apt_poller_task_descriptor_remove(worker->task,&connection->sock_pfd);
 		apr_socket_close(connection->sock);
 		connection->sock = NULL;
 	}
-	mrcp_connection_remove(agent,connection);
+	mrcp_connection_remove(worker,connection);
 	if(connection->access_count) {
 		if(timedout == TRUE) {
 			mrcp_connection_disconnect_raise(connection,agent->vtable);
@@ -548,7 +704,7 @@ static apt_bool_t mrcp_server_agent_connection_close(mrcp_connection_agent_t *ag
 		else {
 			if(agent->termination_timeout) {
 				connection->termination_timer = apt_poller_task_timer_create(
-												agent->task,
+												worker->task,
 												mrcp_server_termination_timer_proc,
 												connection,
 												connection->pool);
@@ -574,7 +730,7 @@ static void mrcp_server_inactivity_timer_proc(apt_timer_t *timer, void *obj)
 
 	if(connection->inactivity_timer == timer) {
 		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"TCP/MRCPv2 Connection Timed Out %s",connection->id);
-		mrcp_server_agent_connection_close(connection->agent, connection, TRUE);
+		mrcp_server_agent_connection_close(connection->agent,connection,TRUE);
 	}
 }
 
@@ -585,7 +741,8 @@ static void mrcp_server_termination_timer_proc(apt_timer_t *timer, void *obj)
 	if(!connection) return;
 
 	if(connection->termination_timer == timer) {
-		mrcp_connection_agent_t *agent = connection->agent;
+		mrcp_connection_worker_t *worker = connection->agent;
+		mrcp_connection_agent_t *agent = worker->agent;
 		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Termination Timeout Elapsed %s",connection->id);
 		mrcp_connection_disconnect_raise(connection,agent->vtable);
 	}
@@ -606,6 +763,7 @@ static apt_bool_t mrcp_server_agent_channel_add(mrcp_connection_agent_t *agent,
 		else {
 			mrcp_connection_t *connection = NULL;
 			/* try to find any existing connection */
+			mrcp_server_agent_lock(agent);
 			connection = mrcp_connection_find(agent,&offer->ip);
 			if(connection) {
 				if(agent->max_shared_use_count && connection->use_count >= agent->max_shared_use_count) {
@@ -620,13 +778,16 @@ static apt_bool_t mrcp_server_agent_channel_add(mrcp_connection_agent_t *agent,
 				/* no existing conection found, force a new one */
 				answer->connection_type = MRCP_CONNECTION_TYPE_NEW;
 			}
+			mrcp_server_agent_unlock(agent);
 		}
 	}
 
+	mrcp_server_agent_lock(agent);
 	apr_hash_set(agent->pending_channel_table,channel->identifier.buf,channel->identifier.length,channel);
 	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Add Pending Control Channel <%s> [%d]",
 			channel->identifier.buf,
 			apr_hash_count(agent->pending_channel_table));
+	mrcp_server_agent_unlock(agent);
 	/* send response */
 	return mrcp_control_channel_add_respond(agent->vtable,channel,answer,TRUE);
 }
@@ -642,9 +803,26 @@ static apt_bool_t mrcp_server_agent_channel_modify(mrcp_connection_agent_t *agen
 	return mrcp_control_channel_modify_respond(agent->vtable,channel,answer,TRUE);
 }
 
-static apt_bool_t mrcp_server_agent_channel_remove(mrcp_connection_agent_t *agent, mrcp_control_channel_t *channel)
+static apt_bool_t mrcp_server_agent_channel_remove(mrcp_connection_worker_t *worker, mrcp_control_channel_t *channel)
 {
-	mrcp_connection_t *connection = channel->connection;
+	mrcp_connection_agent_t *agent = worker->agent;
+	mrcp_connection_t *connection;
+
+	mrcp_server_agent_lock(agent);
+	connection = channel->connection;
+	if(connection && connection->agent != worker) {
+		/* the channel has been assigned to a connection of another worker */
+		mrcp_server_agent_unlock(agent);
+		return mrcp_server_control_message_signal(CONNECTION_TASK_MSG_REMOVE_CHANNEL,connection->agent,channel,NULL,NULL);
+	}
+	if(!connection) {
+		apr_hash_set(agent->pending_channel_table,channel->identifier.buf,channel->identifier.length,NULL);
+		apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Remove Pending Control Channel <%s> [%d]",
+				channel->identifier.buf,
+				apr_hash_count(agent->pending_channel_table));
+	}
+	mrcp_server_agent_unlock(agent);
+
 	if(connection) {
 		mrcp_connection_channel_remove(connection,channel);
 		apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Remove Control Channel <%s> [%d]",
@@ -663,12 +841,6 @@ static apt_bool_t mrcp_server_agent_channel_remove(mrcp_connection_agent_t *agen
 			}
 		}
 	}
-	else {
-		apr_hash_set(agent->pending_channel_table,channel->identifier.buf,channel->identifier.length,NULL);
-		apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Remove Pending Control Channel <%s> [%d]",
-				channel->identifier.buf,
-				apr_hash_count(agent->pending_channel_table));
-	}
 	/* send response */
 	return mrcp_control_channel_remove_respond(agent->vtable,channel,TRUE);
 }
@@ -677,44 +849,50 @@ static apt_bool_t mrcp_server_agent_messsage_send(mrcp_connection_agent_t *agent
 {
 	apt_bool_t status = FALSE;
 	apt_text_stream_t stream;
-	apt_message_status_e result;
+	apt_str_t body;
 	if(!connection || !connection->sock) {
 		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Null MRCPv2 Connection " APT_SIDRES_FMT,MRCP_MESSAGE_SIDRES(message));
 		return FALSE;
 	}
 
-	do {
-		apt_text_stream_init(&stream,connection->tx_buffer,connection->tx_buffer_size);
-		result = mrcp_generator_run(connection->generator,message,&stream);
-		if(result != APT_MESSAGE_STATUS_INVALID) {
-			stream.text.length = stream.pos - stream.text.buf;
-			*stream.pos = '\0';
+	/* generate start-line and header section only, the body is sent from where it is */
+	apt_text_stream_init(&stream,connection->tx_buffer,connection->tx_buffer_size);
+	if(mrcp_generator_header_run(connection->generator,message,&stream,&body) == APT_MESSAGE_STATUS_COMPLETE) {
+		stream.text.length = stream.pos - stream.text.buf;
+		*stream.pos = '\0';
 
-			apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Send MRCPv2 Data %s [%"APR_SIZE_T_FMT" bytes]\n%.*s",
+		if(APT_LOG_ENABLED(APT_PRIO_INFO)) {
+			apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Send MRCPv2 Data %s [%"APR_SIZE_T_FMT" bytes]\n%.*s%.*s",
 					connection->id,
-					stream.text.length,
+					stream.text.length + body.length,
 					connection->verbose == TRUE ? stream.text.length : 0,
-					stream.text.buf);
+					stream.text.buf,
+					connection->verbose == TRUE ? body.length : 0,
+					body.buf);
+		}
+		apt_log_trace(connection->id,APT_LOG_TRACE_SEND,stream.text.buf,stream.text.length);
+		if(body.length) {
+			apt_log_trace(connection->id,APT_LOG_TRACE_SEND,body.buf,body.length);
+		}
 
-			if(apr_socket_send(connection->sock,stream.text.buf,&stream.text.length) == APR_SUCCESS) {
-				status = TRUE;
-			}
-			else {
-				apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Send MRCPv2 Data");
-			}
+		if(mrcp_connection_message_send(connection,&stream.text,&body) == TRUE) {
+			status = TRUE;
 		}
 		else {
-			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Generate MRCPv2 Data");
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Send MRCPv2 Data");
 		}
 	}
-	while(result == APT_MESSAGE_STATUS_INCOMPLETE);
+	else {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Generate MRCPv2 Data");
+	}
 
 	return status;
 }
 
 static apt_bool_t mrcp_server_message_handler(mrcp_connection_t *connection, mrcp_message_t *message, apt_message_status_e status)
 {
-	mrcp_connection_agent_t *agent = connection->agent;
+	mrcp_connection_worker_t *worker = connection->agent;
+	mrcp_connection_agent_t *agent = worker->agent;
 	if(status == APT_MESSAGE_STATUS_COMPLETE) {
 		/* message is completely parsed */
 		mrcp_control_channel_t *channel = mrcp_connection_channel_associate(agent,connection,message);
@@ -750,7 +928,7 @@ static apt_bool_t mrcp_server_message_handler(mrcp_connection_t *connection, mrc
 /* Receive MRCP message through TCP/MRCPv2 connection */
 static apt_bool_t mrcp_server_poller_signal_process(void *obj, const apr_pollfd_t *descriptor)
 {
-	mrcp_connection_agent_t *agent = obj;
+	mrcp_connection_worker_t *worker = obj;
 	mrcp_connection_t *connection = descriptor->client_data;
 	apr_status_t status;
 	apr_size_t offset;
@@ -759,8 +937,8 @@ static apt_bool_t mrcp_server_poller_signal_process(void *obj, const apr_pollfd_
 	mrcp_message_t *message;
 	apt_message_status_e msg_status;
 
-	if(descriptor->desc.s == agent->listen_sock) {
-		return mrcp_server_agent_connection_accept(agent);
+	if(descriptor->desc.s == worker->listen_sock) {
+		return mrcp_server_agent_connection_accept(worker);
 	}
 
 	if(!connection || !connection->sock) {
@@ -776,18 +954,21 @@ static apt_bool_t mrcp_server_poller_signal_process(void *obj, const apr_pollfd_
 	status = apr_socket_recv(connection->sock,stream->pos,&length);
 	if(status == APR_EOF || length == 0) {
 		apt_log(APT_LOG_MARK,APT_PRIO_INFO,"TCP/MRCPv2 Peer Disconnected %s",connection->id);
-		return mrcp_server_agent_connection_close(agent,connection,FALSE);
+		return mrcp_server_agent_connection_close(worker,connection,FALSE);
 	}
 
 	/* calculate actual length of the stream */
 	stream->text.length = offset + length;
 	stream->pos[length] = '\0';
 
-	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Receive MRCPv2 Data %s [%"APR_SIZE_T_FMT" bytes]\n%.*s",
-			connection->id,
-			length,
-			connection->verbose == TRUE ? length : 0,
-			stream->pos);
+	if(APT_LOG_ENABLED(APT_PRIO_INFO)) {
+		apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Receive MRCPv2 Data %s [%"APR_SIZE_T_FMT" bytes]\n%.*s",
+				connection->id,
+				length,
+				connection->verbose == TRUE ? length : 0,
+				stream->pos);
+	}
+	apt_log_trace(connection->id,APT_LOG_TRACE_RECEIVE,stream->pos,length);
 
 	/* reset pos */
 	apt_text_stream_reset(stream);
@@ -809,7 +990,8 @@ static apt_bool_t mrcp_server_poller_signal_process(void *obj, const apr_pollfd_
 static apt_bool_t mrcp_server_agent_msg_process(apt_task_t *task, apt_task_msg_t *task_msg)
 {
 	apt_poller_task_t *poller_task = apt_task_object_get(task);
-	mrcp_connection_agent_t *agent = apt_poller_task_object_get(poller_task);
+	mrcp_connection_worker_t *worker = apt_poller_task_object_get(poller_task);
+	mrcp_connection_agent_t *agent = worker->agent;
 	connection_task_msg_t *msg = (connection_task_msg_t*) task_msg->data;
 	switch(msg->type) {
 		case CONNECTION_TASK_MSG_ADD_CHANNEL:
@@ -819,7 +1001,7 @@ static apt_bool_t mrcp_server_agent_msg_process(apt_task_t *task, apt_task_msg_t
 			mrcp_server_agent_channel_modify(agent,msg->channel,msg->descriptor);
 			break;
 		case CONNECTION_TASK_MSG_REMOVE_CHANNEL:
-			mrcp_server_agent_channel_remove(agent,msg->channel);
+			mrcp_server_agent_channel_remove(worker,msg->channel);
 			break;
 		case CONNECTION_TASK_MSG_SEND_MESSAGE:
 			mrcp_server_agent_messsage_send(agent,msg->channel->connection,msg->message);
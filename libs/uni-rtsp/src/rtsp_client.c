@@ -274,7 +274,7 @@ RTSP_DECLARE(rtsp_client_session_t*) rtsp_client_session_create(
 											const char *resource_location)
 {
 	rtsp_client_session_t *session;
-	apr_pool_t *pool = apt_pool_create();
+	apr_pool_t *pool = apt_pool_acquire();
 	session = apr_palloc(pool,sizeof(rtsp_client_session_t));
 	session->pool = pool;
 	session->obj = NULL;
@@ -302,7 +302,7 @@ RTSP_DECLARE(void) rtsp_client_session_destroy(rtsp_client_session_t *session)
 {
 	apt_log(RTSP_LOG_MARK,APT_PRIO_NOTICE,"Destroy RTSP Handle " APT_PTR_FMT,session);
 	if(session && session->pool) {
-		apr_pool_destroy(session->pool);
+		apt_pool_release(session->pool);
 	}
 }
 
@@ -390,7 +390,7 @@ static apt_bool_t rtsp_client_connection_close(rtsp_client_t *client, rtsp_clien
 static apt_bool_t rtsp_client_connection_create(rtsp_client_t *client, rtsp_client_session_t *session)
 {
 	rtsp_client_connection_t *rtsp_connection;
-	apr_pool_t *pool = apt_pool_create();
+	apr_pool_t *pool = apt_pool_acquire();
 	if(!pool) {
 		return FALSE;
 	}
@@ -403,7 +403,7 @@ static apt_bool_t rtsp_client_connection_create(rtsp_client_t *client, rtsp_clie
 	if(rtsp_client_connect(client,rtsp_connection,session->server_ip.buf,session->server_port) == FALSE) {
 		apt_log(RTSP_LOG_MARK,APT_PRIO_WARNING,"Failed to Connect to RTSP Server %s:%hu",
 			session->server_ip.buf,session->server_port);
-		apr_pool_destroy(pool);
+		apt_pool_release(pool);
 		return FALSE;
 	}
 	rtsp_connection->handle_table = apr_hash_make(pool);
@@ -428,7 +428,7 @@ static apt_bool_t rtsp_client_connection_destroy(rtsp_client_connection_t *rtsp_
 	APR_RING_REMOVE(rtsp_connection,link);
 	rtsp_client_connection_close(client,rtsp_connection);
 	apt_log(RTSP_LOG_MARK,APT_PRIO_NOTICE,"Destroy RTSP Connection %s",rtsp_connection->id);
-	apr_pool_destroy(rtsp_connection->pool);
+	apt_pool_release(rtsp_connection->pool);
 
 	return TRUE;
 }
@@ -339,7 +339,7 @@ RTSP_DECLARE(apt_bool_t) rtsp_server_session_release(rtsp_server_t *server, rtsp
 static rtsp_server_session_t* rtsp_server_session_create(rtsp_server_t *server)
 {
 	rtsp_server_session_t *session;
-	apr_pool_t *pool = apt_pool_create();
+	apr_pool_t *pool = apt_pool_acquire();
 	session = apr_palloc(pool,sizeof(rtsp_server_session_t));
 	session->pool = pool;
 	session->obj = NULL;
@@ -352,7 +352,7 @@ static rtsp_server_session_t* rtsp_server_session_create(rtsp_server_t *server)
 	apt_unique_id_generate(&session->id,RTSP_SESSION_ID_HEX_STRING_LENGTH,pool);
 	apt_log(RTSP_LOG_MARK,APT_PRIO_NOTICE,"Create RTSP Session " APT_SID_FMT,session->id.buf);
 	if(server->vtable->create_session(server,session) != TRUE) {
-		apr_pool_destroy(pool);
+		apt_pool_release(pool);
 		return NULL;
 	}
 	return session;
@@ -364,7 +364,7 @@ static void rtsp_server_session_destroy(rtsp_server_session_t *session)
 	apt_log(RTSP_LOG_MARK,APT_PRIO_NOTICE,"Destroy RTSP Session " APT_SID_FMT,
 		session ? session->id.buf : "(null)");
 	if(session && session->pool) {
-		apr_pool_destroy(session->pool);
+		apt_pool_release(session->pool);
 	}
 }
 
@@ -372,7 +372,7 @@ static void rtsp_server_session_destroy(rtsp_server_session_t *session)
 static void rtsp_server_connection_destroy(rtsp_server_connection_t *rtsp_connection)
 {
 	apt_log(RTSP_LOG_MARK,APT_PRIO_NOTICE,"Destroy RTSP Connection %s",rtsp_connection->id);
-	apr_pool_destroy(rtsp_connection->pool);
+	apt_pool_release(rtsp_connection->pool);
 }
 
 /* Finally terminate RTSP session */
@@ -773,7 +773,7 @@ static apt_bool_t rtsp_server_connection_accept(rtsp_server_t *server)
 	char *remote_ip = NULL;
 	apr_sockaddr_t *l_sockaddr = NULL;
 	apr_sockaddr_t *r_sockaddr = NULL;
-	apr_pool_t *pool = apt_pool_create();
+	apr_pool_t *pool = apt_pool_acquire();
 	if(!pool) {
 		return FALSE;
 	}
@@ -786,14 +786,14 @@ static apt_bool_t rtsp_server_connection_accept(rtsp_server_t *server)
 
 	if(apr_socket_accept(&rtsp_connection->sock,server->listen_sock,rtsp_connection->pool) != APR_SUCCESS) {
 		apt_log(RTSP_LOG_MARK,APT_PRIO_WARNING,"Failed to Accept RTSP Connection");
-		apr_pool_destroy(pool);
+		apt_pool_release(pool);
 		return FALSE;
 	}
 
 	if(apr_socket_addr_get(&l_sockaddr,APR_LOCAL,rtsp_connection->sock) != APR_SUCCESS ||
 		apr_socket_addr_get(&r_sockaddr,APR_REMOTE,rtsp_connection->sock) != APR_SUCCESS) {
 		apt_log(RTSP_LOG_MARK,APT_PRIO_WARNING,"Failed to Get RTSP Socket Address");
-		apr_pool_destroy(pool);
+		apt_pool_release(pool);
 		return FALSE;
 	}
 
@@ -812,7 +812,7 @@ static apt_bool_t rtsp_server_connection_accept(rtsp_server_t *server)
 	if(apt_poller_task_descriptor_add(server->task,&rtsp_connection->sock_pfd) != TRUE) {
 		apt_log(RTSP_LOG_MARK,APT_PRIO_WARNING,"Failed to Add to Pollset %s",rtsp_connection->id);
 		apr_socket_close(rtsp_connection->sock);
-		apr_pool_destroy(pool);
+		apt_pool_release(pool);
 		return FALSE;
 	}
 
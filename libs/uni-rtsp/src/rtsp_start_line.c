@@ -37,6 +37,11 @@ static const apt_str_table_item_t rtsp_method_string_table[] = {
 	{{"OPTIONS",  7},0}
 };
 
+/** Perfect hash of rtsp_method_string_table (generated by strtablegen) */
+static const apr_uint16_t rtsp_method_string_table_hash_seeds[] = {0,0,6};
+static const apr_byte_t rtsp_method_string_table_hash_ids[] = {2,0,1,4,3};
+static const apt_str_table_hash_t rtsp_method_string_table_hash = {3,rtsp_method_string_table_hash_seeds,rtsp_method_string_table_hash_ids};
+
 /** String table of RTSP reason phrases (rtsp_reason_phrase_e) */
 static const apt_str_table_item_t rtsp_reason_string_table[] = {
 	{{"OK",                     2},0},
@@ -216,7 +221,7 @@ RTSP_DECLARE(apt_bool_t) rtsp_start_line_parse(rtsp_start_line_t *start_line, ap
 		rtsp_request_line_init(request_line);
 
 		apt_string_copy(&request_line->method_name,&field,pool);
-		request_line->method_id = apt_string_table_id_find(rtsp_method_string_table,RTSP_METHOD_COUNT,&field);
+		request_line->method_id = apt_string_table_hash_id_find(rtsp_method_string_table,RTSP_METHOD_COUNT,&rtsp_method_string_table_hash,&field);
 
 		if(apt_text_field_read(&line,APT_TOKEN_SP,TRUE,&field) == FALSE) {
 			apt_log(RTSP_LOG_MARK,APT_PRIO_WARNING,"Cannot parse URL in request-line");
@@ -24,7 +24,7 @@
 #include "mrcp_generic_header.h"
 #include "mrcp_client_session.h"
 /* APT includes */
-#include "apt_nlsml_doc.h"
+#include "apt_nlsml_reader.h"
 #include "apt_pool.h"
 
 #include "asr_engine.h"
@@ -461,27 +461,23 @@ static mrcp_message_t* recognize_message_create(asr_session_t *asr_session, int
 /** Get NLSML result, exported for usage with external tools. */
 ASR_CLIENT_DECLARE(const char*) nlsml_result_get(mrcp_message_t *message)
 {
-	nlsml_interpretation_t *interpretation;
-	nlsml_instance_t *instance;
-	nlsml_result_t *result = nlsml_result_parse(message->body.buf, message->body.length, message->pool);
+	const nlsml_flat_interpretation_t *interpretation;
+	nlsml_flat_result_t *result = nlsml_flat_result_read(message->body.buf, message->body.length, message->pool);
 	if(!result) {
 		return NULL;
 	}
 
 	/* get first interpretation */
-	interpretation = nlsml_first_interpretation_get(result);
-	if(!interpretation) {
+	if(!result->interpretation_count) {
 		return NULL;
 	}
+	interpretation = &result->interpretations[0];
 
-	/* get first instance */
-	instance = nlsml_interpretation_first_instance_get(interpretation);
-	if(!instance) {
+	/* get first instance, SWI elements are already suppressed */
+	if(!interpretation->instance_count) {
 		return NULL;
 	}
-
-	nlsml_instance_swi_suppress(instance);
-	return nlsml_instance_content_generate(instance, message->pool);
+	return interpretation->instances[0].buf;
 }
 
 
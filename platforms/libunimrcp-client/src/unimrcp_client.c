@@ -572,6 +572,9 @@ static apt_bool_t unimrcp_client_media_engine_load(unimrcp_client_loader_t *load
 	const apr_xml_elem *elem;
 	mpf_engine_t *media_engine;
 	unsigned long realtime_rate = 1;
+	apr_size_t worker_count = 1;
+	apt_bool_t rtp_poller = FALSE;
+	apr_size_t rtp_batch_size = 0;
 
 	apt_log(APT_LOG_MARK,APT_PRIO_DEBUG,"Loading Media Engine <%s>",id);
 	for(elem = root->first_child; elem; elem = elem->next) {
@@ -581,14 +584,35 @@ static apt_bool_t unimrcp_client_media_engine_load(unimrcp_client_loader_t *load
 				realtime_rate = atol(cdata_text_get(elem));
 			}
 		}
+		else if(strcasecmp(elem->name,"worker-count") == 0) {
+			if(is_cdata_valid(elem) == TRUE) {
+				worker_count = atol(cdata_text_get(elem));
+			}
+		}
+		else if(strcasecmp(elem->name,"rtp-poller") == 0) {
+			if(is_cdata_valid(elem) == TRUE) {
+				rtp_poller = cdata_bool_get(elem);
+			}
+		}
+		else if(strcasecmp(elem->name,"rtp-batch-send") == 0) {
+			if(is_cdata_valid(elem) == TRUE) {
+				rtp_batch_size = atol(cdata_text_get(elem));
+			}
+		}
 		else {
 			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unknown Element <%s>",elem->name);
 		}
 	}
 
-	media_engine = mpf_engine_create(id,loader->pool);
+	media_engine = mpf_engine_create_ex(id,worker_count,loader->pool);
 	if(media_engine) {
 		mpf_engine_scheduler_rate_set(media_engine,realtime_rate);
+		if(rtp_poller == TRUE) {
+			mpf_engine_rtp_poller_enable(media_engine);
+		}
+		if(rtp_batch_size) {
+			mpf_engine_rtp_sender_enable(media_engine,rtp_batch_size);
+		}
 	}
 	return mrcp_client_media_engine_register(loader->client,media_engine);
 }
@@ -780,6 +804,11 @@ static apt_bool_t unimrcp_client_jb_settings_load(unimrcp_client_loader_t *loade
 				jb->time_skew_detection = (apr_byte_t) atol(cdata_text_get(elem));
 			}
 		}
+		else if(strcasecmp(elem->name,"plc") == 0) {
+			if(is_cdata_valid(elem) == TRUE) {
+				jb->plc = (apr_byte_t) atol(cdata_text_get(elem));
+			}
+		}
 		else {
 			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unknown Element <%s>",elem->name);
 		}
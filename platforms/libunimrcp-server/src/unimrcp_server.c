@@ -30,6 +30,7 @@
 #include "mrcp_unirtsp_logger.h"
 #include "mrcp_server_connection.h"
 #include "apt_net.h"
+#include "apt_pool.h"
 #include "apt_log.h"
 
 #define CONF_FILE_NAME            "unimrcpserver.xml"
@@ -111,10 +112,13 @@ MRCP_DECLARE(mrcp_server_t*) unimrcp_server_start(apt_dir_layout_t *dir_layout)
 /** Shutdown UniMRCP server */
 MRCP_DECLARE(apt_bool_t) unimrcp_server_shutdown(mrcp_server_t *server)
 {
+	apt_bool_t status;
 	if(mrcp_server_shutdown(server) == FALSE) {
 		return FALSE;
 	}
-	return mrcp_server_destroy(server);
+	status = mrcp_server_destroy(server);
+	apt_pool_cache_destroy();
+	return status;
 }
 
 
@@ -512,6 +516,7 @@ static apt_bool_t unimrcp_server_mrcpv2_uas_load(unimrcp_server_loader_t *loader
 	apr_size_t termination_timeout = 3; /* sec */
 	apr_size_t rx_buffer_size = 0;
 	apr_size_t tx_buffer_size = 0;
+	apr_size_t worker_count = 1;
 
 	apt_log(APT_LOG_MARK,APT_PRIO_DEBUG,"Loading MRCPv2 Agent <%s>",id);
 	for(elem = root->first_child; elem; elem = elem->next) {
@@ -559,6 +564,11 @@ static apt_bool_t unimrcp_server_mrcpv2_uas_load(unimrcp_server_loader_t *loader
 				tx_buffer_size = atol(cdata_text_get(elem));
 			}
 		}
+		else if(strcasecmp(elem->name,"worker-count") == 0) {
+			if(is_cdata_valid(elem) == TRUE) {
+				worker_count = atol(cdata_text_get(elem));
+			}
+		}
 		else {
 			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unknown Element <%s>",elem->name);
 		}
@@ -569,7 +579,7 @@ static apt_bool_t unimrcp_server_mrcpv2_uas_load(unimrcp_server_loader_t *loader
 		mrcp_ip = apr_pstrdup(loader->pool,loader->ip);
 	}
 
-	agent = mrcp_server_connection_agent_create(id,mrcp_ip,mrcp_port,max_connection_count,force_new_connection,loader->pool);
+	agent = mrcp_server_connection_agent_create_ex(id,mrcp_ip,mrcp_port,max_connection_count,force_new_connection,worker_count,loader->pool);
 	if(agent) {
 		if(rx_buffer_size) {
 			mrcp_server_connection_rx_size_set(agent,rx_buffer_size);
@@ -590,6 +600,9 @@ static apt_bool_t unimrcp_server_media_engine_load(unimrcp_server_loader_t *load
 	const apr_xml_elem *elem;
 	mpf_engine_t *media_engine;
 	unsigned long realtime_rate = 1;
+	apr_size_t worker_count = 1;
+	apt_bool_t rtp_poller = FALSE;
+	apr_size_t rtp_batch_size = 0;
 
 	apt_log(APT_LOG_MARK,APT_PRIO_DEBUG,"Loading Media Engine <%s>",id);
 	for(elem = root->first_child; elem; elem = elem->next) {
@@ -599,14 +612,35 @@ static apt_bool_t unimrcp_server_media_engine_load(unimrcp_server_loader_t *load
 				realtime_rate = atol(cdata_text_get(elem));
 			}
 		}
+		else if(strcasecmp(elem->name,"worker-count") == 0) {
+			if(is_cdata_valid(elem) == TRUE) {
+				worker_count = atol(cdata_text_get(elem));
+			}
+		}
+		else if(strcasecmp(elem->name,"rtp-poller") == 0) {
+			if(is_cdata_valid(elem) == TRUE) {
+				rtp_poller = cdata_bool_get(elem);
+			}
+		}
+		else if(strcasecmp(elem->name,"rtp-batch-send") == 0) {
+			if(is_cdata_valid(elem) == TRUE) {
+				rtp_batch_size = atol(cdata_text_get(elem));
+			}
+		}
 		else {
 			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unknown Element <%s>",elem->name);
 		}
 	}
 
-	media_engine = mpf_engine_create(id,loader->pool);
+	media_engine = mpf_engine_create_ex(id,worker_count,loader->pool);
 	if(media_engine) {
 		mpf_engine_scheduler_rate_set(media_engine,realtime_rate);
+		if(rtp_poller == TRUE) {
+			mpf_engine_rtp_poller_enable(media_engine);
+		}
+		if(rtp_batch_size) {
+			mpf_engine_rtp_sender_enable(media_engine,rtp_batch_size);
+		}
 	}
 	return mrcp_server_media_engine_register(loader->server,media_engine);
 }
@@ -795,6 +829,11 @@ static apt_bool_t unimrcp_server_jb_settings_load(unimrcp_server_loader_t *loade
 				jb->time_skew_detection = (apr_byte_t) atol(cdata_text_get(elem));
 			}
 		}
+		else if(strcasecmp(elem->name,"plc") == 0) {
+			if(is_cdata_valid(elem) == TRUE) {
+				jb->plc = (apr_byte_t) atol(cdata_text_get(elem));
+			}
+		}
 		else {
 			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unknown Element <%s>",elem->name);
 		}
@@ -1086,6 +1125,75 @@ static apt_bool_t unimrcp_server_mrcpv1_profile_load(unimrcp_server_loader_t *lo
 }
 
 
+/** Load settings of the cache of session arenas */
+static apt_bool_t unimrcp_server_pool_cache_load(unimrcp_server_loader_t *loader, const apr_xml_elem *root)
+{
+	const apr_xml_elem *elem;
+	apr_size_t max_count = 256;
+	apr_size_t thread_max_count = 16;
+	apr_size_t preload_count = 0;
+	apr_size_t max_free_size = 0;
+
+	apt_log(APT_LOG_MARK,APT_PRIO_DEBUG,"Loading Pool Cache Settings");
+	for(elem = root->first_child; elem; elem = elem->next) {
+		apt_log(APT_LOG_MARK,APT_PRIO_DEBUG,"Loading Element <%s>",elem->name);
+		if(strcasecmp(elem->name,"max-count") == 0) {
+			if(is_cdata_valid(elem) == TRUE) {
+				max_count = atol(cdata_text_get(elem));
+			}
+		}
+		else if(strcasecmp(elem->name,"thread-max-count") == 0) {
+			if(is_cdata_valid(elem) == TRUE) {
+				thread_max_count = atol(cdata_text_get(elem));
+			}
+		}
+		else if(strcasecmp(elem->name,"preload-count") == 0) {
+			if(is_cdata_valid(elem) == TRUE) {
+				preload_count = atol(cdata_text_get(elem));
+			}
+		}
+		else if(strcasecmp(elem->name,"max-free-size") == 0) {
+			if(is_cdata_valid(elem) == TRUE) {
+				max_free_size = atol(cdata_text_get(elem));
+			}
+		}
+		else {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unknown Element <%s>",elem->name);
+		}
+	}
+	return apt_pool_cache_create(max_count,thread_max_count,preload_count,max_free_size);
+}
+
+/** Load settings of the grammar cache shared by the engines */
+static apt_bool_t unimrcp_server_grammar_cache_load(unimrcp_server_loader_t *loader, const apr_xml_elem *root)
+{
+	const apr_xml_elem *elem;
+	mrcp_grammar_cache_t *grammar_cache;
+	apr_size_t max_size = MRCP_GRAMMAR_CACHE_DEFAULT_MAX_SIZE;
+	apr_size_t max_count = MRCP_GRAMMAR_CACHE_DEFAULT_MAX_COUNT;
+
+	apt_log(APT_LOG_MARK,APT_PRIO_DEBUG,"Loading Grammar Cache Settings");
+	for(elem = root->first_child; elem; elem = elem->next) {
+		apt_log(APT_LOG_MARK,APT_PRIO_DEBUG,"Loading Element <%s>",elem->name);
+		if(strcasecmp(elem->name,"max-size") == 0) {
+			if(is_cdata_valid(elem) == TRUE) {
+				max_size = atol(cdata_text_get(elem));
+			}
+		}
+		else if(strcasecmp(elem->name,"max-count") == 0) {
+			if(is_cdata_valid(elem) == TRUE) {
+				max_count = atol(cdata_text_get(elem));
+			}
+		}
+		else {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unknown Element <%s>",elem->name);
+		}
+	}
+
+	grammar_cache = mrcp_grammar_cache_create(max_size,max_count,loader->pool);
+	return mrcp_server_grammar_cache_register(loader->server,grammar_cache);
+}
+
 /** Load properties */
 static apt_bool_t unimrcp_server_properties_load(unimrcp_server_loader_t *loader, const apr_xml_elem *root)
 {
@@ -1102,6 +1210,19 @@ static apt_bool_t unimrcp_server_properties_load(unimrcp_server_loader_t *loader
 			loader->ext_ip = unimrcp_server_ip_address_get(loader,elem);
 			apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Set Property ext-ip:%s",loader->ext_ip);
 		}
+		else if(strcasecmp(elem->name,"worker-count") == 0) {
+			if(is_cdata_valid(elem) == TRUE) {
+				apr_size_t worker_count = atol(cdata_text_get(elem));
+				apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Set Property worker-count:%"APR_SIZE_T_FMT,worker_count);
+				mrcp_server_worker_count_set(loader->server,worker_count);
+			}
+		}
+		else if(strcasecmp(elem->name,"pool-cache") == 0) {
+			unimrcp_server_pool_cache_load(loader,elem);
+		}
+		else if(strcasecmp(elem->name,"grammar-cache") == 0) {
+			unimrcp_server_grammar_cache_load(loader,elem);
+		}
 		else {
 			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unknown Element <%s>",elem->name);
 		}
@@ -244,6 +244,12 @@ int main(int argc, const char * const *argv)
 		apt_syslog_open(log_prefix,logfile_conf_path,pool);
 	}
 
+	if(apt_log_trace_enabled() == TRUE) {
+		/* open the binary trace of MRCP messages */
+		const char *log_dir_path = apt_dir_layout_path_get(dir_layout,APT_LAYOUT_LOG_DIR);
+		apt_log_trace_open(log_dir_path,log_prefix,pool);
+	}
+
 	if(options.foreground == TRUE) {
 		if(options.cmd_line == TRUE) {
 			/* run command line */
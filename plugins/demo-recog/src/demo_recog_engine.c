@@ -28,6 +28,7 @@
  */
 
 #include "mrcp_recog_engine.h"
+#include "mrcp_audio_writer.h"
 #include "mpf_activity_detector.h"
 #include "apt_consumer_task.h"
 #include "apt_log.h"
@@ -85,6 +86,8 @@ static const mpf_audio_stream_vtable_t audio_stream_vtable = {
 /** Declaration of demo recognizer engine */
 struct demo_recog_engine_t {
 	apt_consumer_task_t    *task;
+	/** Writer of utterances, which keeps disk I/O off the media thread */
+	mrcp_audio_writer_t    *audio_writer;
 };
 
 /** Declaration of demo recognizer channel */
@@ -103,7 +106,9 @@ struct demo_recog_channel_t {
 	/** Voice activity detector */
 	mpf_activity_detector_t *detector;
 	/** File to write utterance to */
-	FILE                    *audio_out;
+	mrcp_audio_file_t       *audio_out;
+	/** Last defined grammar acquired from the grammar cache */
+	mrcp_grammar_t          *grammar;
 };
 
 typedef enum {
@@ -144,6 +149,7 @@ MRCP_PLUGIN_DECLARE(mrcp_engine_t*) mrcp_plugin_create(apr_pool_t *pool)
 	apt_task_msg_pool_t *msg_pool;
 
 	msg_pool = apt_task_msg_pool_create_dynamic(sizeof(demo_recog_msg_t),pool);
+	demo_engine->audio_writer = NULL;
 	demo_engine->task = apt_consumer_task_create(demo_engine,msg_pool,pool);
 	if(!demo_engine->task) {
 		return NULL;
@@ -183,6 +189,7 @@ static apt_bool_t demo_recog_engine_open(mrcp_engine_t *engine)
 		apt_task_t *task = apt_consumer_task_base_get(demo_engine->task);
 		apt_task_start(task);
 	}
+	demo_engine->audio_writer = mrcp_audio_writer_create(0,engine->pool);
 	return mrcp_engine_open_respond(engine,TRUE);
 }
 
@@ -194,6 +201,10 @@ static apt_bool_t demo_recog_engine_close(mrcp_engine_t *engine)
 		apt_task_t *task = apt_consumer_task_base_get(demo_engine->task);
 		apt_task_terminate(task,TRUE);
 	}
+	if(demo_engine->audio_writer) {
+		mrcp_audio_writer_destroy(demo_engine->audio_writer);
+		demo_engine->audio_writer = NULL;
+	}
 	return mrcp_engine_close_respond(engine);
 }
 
@@ -209,6 +220,7 @@ static mrcp_engine_channel_t* demo_recog_engine_channel_create(mrcp_engine_t *en
 	recog_channel->stop_response = NULL;
 	recog_channel->detector = mpf_activity_detector_create(pool);
 	recog_channel->audio_out = NULL;
+	recog_channel->grammar = NULL;
 
 	capabilities = mpf_sink_stream_capabilities_create(pool);
 	mpf_codec_capabilities_add(
@@ -237,7 +249,11 @@ static mrcp_engine_channel_t* demo_recog_engine_channel_create(mrcp_engine_t *en
 /** Destroy engine channel */
 static apt_bool_t demo_recog_channel_destroy(mrcp_engine_channel_t *channel)
 {
-	/* nothing to destrtoy */
+	demo_recog_channel_t *recog_channel = channel->method_obj;
+	if(recog_channel->grammar) {
+		mrcp_engine_grammar_release(channel->engine,recog_channel->grammar);
+		recog_channel->grammar = NULL;
+	}
 	return TRUE;
 }
 
@@ -305,9 +321,9 @@ static apt_bool_t demo_recog_channel_recognize(mrcp_engine_channel_t *channel, m
 							descriptor->sampling_rate/1000,
 							request->channel_id.session_id.buf);
 		char *file_path = apt_vardir_filepath_get(dir_layout,file_name,channel->pool);
-		if(file_path) {
+		if(file_path && recog_channel->demo_engine->audio_writer) {
 			apt_log(RECOG_LOG_MARK,APT_PRIO_INFO,"Open Utterance Output File [%s] for Writing",file_path);
-			recog_channel->audio_out = fopen(file_path,"wb");
+			recog_channel->audio_out = mrcp_audio_file_open(recog_channel->demo_engine->audio_writer,file_path,NULL);
 			if(!recog_channel->audio_out) {
 				apt_log(RECOG_LOG_MARK,APT_PRIO_WARNING,"Failed to Open Utterance Output File [%s] for Writing",file_path);
 			}
@@ -331,6 +347,32 @@ static apt_bool_t demo_recog_channel_stop(mrcp_engine_channel_t *channel, mrcp_m
 	return TRUE;
 }
 
+/** Process DEFINE-GRAMMAR request */
+static apt_bool_t demo_recog_channel_grammar_define(mrcp_engine_channel_t *channel, mrcp_message_t *request, mrcp_message_t *response)
+{
+	demo_recog_channel_t *recog_channel = channel->method_obj;
+	mrcp_grammar_t *grammar = mrcp_engine_grammar_acquire(channel->engine,request);
+	if(!grammar) {
+		/* no grammar cache configured */
+		return FALSE;
+	}
+
+	if(!mrcp_grammar_handle_get(grammar,channel->engine)) {
+		/* the grammar is defined for the first time across the sessions;
+		   there is nothing to compile in the demo, the grammar itself stands for the compiled one */
+		apt_log(RECOG_LOG_MARK,APT_PRIO_INFO,"Compile Grammar [%s] " APT_SIDRES_FMT,
+			grammar->digest,
+			MRCP_MESSAGE_SIDRES(request));
+		mrcp_grammar_handle_attach(grammar,channel->engine,grammar,NULL);
+	}
+
+	if(recog_channel->grammar) {
+		mrcp_engine_grammar_release(channel->engine,recog_channel->grammar);
+	}
+	recog_channel->grammar = grammar;
+	return mrcp_engine_channel_message_send(channel,response);
+}
+
 /** Process START-INPUT-TIMERS request */
 static apt_bool_t demo_recog_channel_timers_start(mrcp_engine_channel_t *channel, mrcp_message_t *request, mrcp_message_t *response)
 {
@@ -350,6 +392,7 @@ static apt_bool_t demo_recog_channel_request_dispatch(mrcp_engine_channel_t *cha
 		case RECOGNIZER_GET_PARAMS:
 			break;
 		case RECOGNIZER_DEFINE_GRAMMAR:
+			processed = demo_recog_channel_grammar_define(channel,request,response);
 			break;
 		case RECOGNIZER_RECOGNIZE:
 			processed = demo_recog_channel_recognize(channel,request,response);
@@ -525,7 +568,7 @@ static apt_bool_t demo_recog_stream_write(mpf_audio_stream_t *stream, const mpf_
 		}
 
 		if(recog_channel->audio_out) {
-			fwrite(frame->codec_frame.buffer,1,frame->codec_frame.size,recog_channel->audio_out);
+			mrcp_audio_file_write(recog_channel->audio_out,frame->codec_frame.buffer,frame->codec_frame.size);
 		}
 	}
 	return TRUE;
@@ -564,7 +607,7 @@ static apt_bool_t demo_recog_msg_process(apt_task_t *task, apt_task_msg_t *msg)
 			/* close channel, make sure there is no activity and send asynch response */
 			demo_recog_channel_t *recog_channel = demo_msg->channel->method_obj;
 			if(recog_channel->audio_out) {
-				fclose(recog_channel->audio_out);
+				mrcp_audio_file_close(recog_channel->audio_out);
 				recog_channel->audio_out = NULL;
 			}
 
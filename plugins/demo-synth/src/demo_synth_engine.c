@@ -28,6 +28,7 @@
  */
 
 #include "mrcp_synth_engine.h"
+#include "mrcp_prompt_cache.h"
 #include "apt_consumer_task.h"
 #include "apt_log.h"
 
@@ -84,6 +85,8 @@ static const mpf_audio_stream_vtable_t audio_stream_vtable = {
 /** Declaration of demo synthesizer engine */
 struct demo_synth_engine_t {
 	apt_consumer_task_t    *task;
+	/** Prompts shared by all the channels of the engine */
+	mrcp_prompt_cache_t    *prompt_cache;
 };
 
 /** Declaration of demo synthesizer channel */
@@ -102,7 +105,9 @@ struct demo_synth_channel_t {
 	/** Is paused */
 	apt_bool_t             paused;
 	/** Speech source (used instead of actual synthesis) */
-	FILE                  *audio_file;
+	mrcp_prompt_t         *prompt;
+	/** Offset of the next frame in the prompt */
+	apr_size_t             prompt_offset;
 };
 
 typedef enum {
@@ -146,6 +151,7 @@ MRCP_PLUGIN_DECLARE(mrcp_engine_t*) mrcp_plugin_create(apr_pool_t *pool)
 
 	/* create task/thread to run demo engine in the context of this task */
 	msg_pool = apt_task_msg_pool_create_dynamic(sizeof(demo_synth_msg_t),pool);
+	demo_engine->prompt_cache = mrcp_prompt_cache_create(0,pool);
 	demo_engine->task = apt_consumer_task_create(demo_engine,msg_pool,pool);
 	if(!demo_engine->task) {
 		return NULL;
@@ -174,6 +180,10 @@ static apt_bool_t demo_synth_engine_destroy(mrcp_engine_t *engine)
 		apt_task_destroy(task);
 		demo_engine->task = NULL;
 	}
+	if(demo_engine->prompt_cache) {
+		mrcp_prompt_cache_destroy(demo_engine->prompt_cache);
+		demo_engine->prompt_cache = NULL;
+	}
 	return TRUE;
 }
 
@@ -212,7 +222,8 @@ static mrcp_engine_channel_t* demo_synth_engine_channel_create(mrcp_engine_t *en
 	synth_channel->stop_response = NULL;
 	synth_channel->time_to_complete = 0;
 	synth_channel->paused = FALSE;
-	synth_channel->audio_file = NULL;
+	synth_channel->prompt = NULL;
+	synth_channel->prompt_offset = 0;
 	
 	capabilities = mpf_source_stream_capabilities_create(pool);
 	mpf_codec_capabilities_add(
@@ -282,8 +293,10 @@ static apt_bool_t demo_synth_channel_speak(mrcp_engine_channel_t *channel, mrcp_
 		file_path = apt_datadir_filepath_get(channel->engine->dir_layout,file_name,channel->pool);
 	}
 	if(file_path) {
-		synth_channel->audio_file = fopen(file_path,"rb");
-		if(synth_channel->audio_file) {
+		/* the prompt is mapped once and shared by all the channels, no file I/O is done on the media thread */
+		synth_channel->prompt = mrcp_prompt_cache_acquire(synth_channel->demo_engine->prompt_cache,file_path,descriptor);
+		synth_channel->prompt_offset = 0;
+		if(synth_channel->prompt) {
 			apt_log(SYNTH_LOG_MARK,APT_PRIO_INFO,"Set [%s] as Speech Source " APT_SIDRES_FMT,
 				file_path,
 				MRCP_MESSAGE_SIDRES(request));
@@ -440,9 +453,20 @@ static apt_bool_t demo_synth_stream_open(mpf_audio_stream_t *stream, mpf_codec_t
 	return TRUE;
 }
 
+/** Release the prompt played by the channel, called from MPF engine context only, as the prompt is read there */
+static void demo_synth_prompt_release(demo_synth_channel_t *synth_channel)
+{
+	if(synth_channel->prompt) {
+		mrcp_prompt_cache_release(synth_channel->demo_engine->prompt_cache,synth_channel->prompt);
+		synth_channel->prompt = NULL;
+	}
+}
+
 /** Callback is called from MPF engine context to perform any action after close */
 static apt_bool_t demo_synth_stream_close(mpf_audio_stream_t *stream)
 {
+	/* the stream is no longer read, release the prompt of the SPEAK request interrupted by channel close */
+	demo_synth_prompt_release(stream->obj);
 	return TRUE;
 }
 
@@ -452,15 +476,14 @@ static apt_bool_t demo_synth_stream_read(mpf_audio_stream_t *stream, mpf_frame_t
 	demo_synth_channel_t *synth_channel = stream->obj;
 	/* check if STOP was requested */
 	if(synth_channel->stop_response) {
-		/* send asynchronous response to STOP request */
-		mrcp_engine_channel_message_send(synth_channel->channel,synth_channel->stop_response);
+		mrcp_message_t *stop_response = synth_channel->stop_response;
 		synth_channel->stop_response = NULL;
 		synth_channel->speak_request = NULL;
 		synth_channel->paused = FALSE;
-		if(synth_channel->audio_file) {
-			fclose(synth_channel->audio_file);
-			synth_channel->audio_file = NULL;
-		}
+		/* release before the response, a subsequent SPEAK acquires the prompt anew */
+		demo_synth_prompt_release(synth_channel);
+		/* send asynchronous response to STOP request */
+		mrcp_engine_channel_message_send(synth_channel->channel,stop_response);
 		return TRUE;
 	}
 
@@ -468,10 +491,12 @@ static apt_bool_t demo_synth_stream_read(mpf_audio_stream_t *stream, mpf_frame_t
 	if(synth_channel->speak_request && synth_channel->paused == FALSE) {
 		/* normal processing */
 		apt_bool_t completed = FALSE;
-		if(synth_channel->audio_file) {
-			/* read speech from file */
+		if(synth_channel->prompt) {
+			/* read speech from the mapped prompt */
 			apr_size_t size = frame->codec_frame.size;
-			if(fread(frame->codec_frame.buffer,1,size,synth_channel->audio_file) == size) {
+			if(synth_channel->prompt_offset + size <= synth_channel->prompt->size) {
+				memcpy(frame->codec_frame.buffer,synth_channel->prompt->data + synth_channel->prompt_offset,size);
+				synth_channel->prompt_offset += size;
 				frame->type |= MEDIA_FRAME_TYPE_AUDIO;
 			}
 			else {
@@ -508,10 +533,7 @@ static apt_bool_t demo_synth_stream_read(mpf_audio_stream_t *stream, mpf_frame_t
 				message->start_line.request_state = MRCP_REQUEST_STATE_COMPLETE;
 
 				synth_channel->speak_request = NULL;
-				if(synth_channel->audio_file) {
-					fclose(synth_channel->audio_file);
-					synth_channel->audio_file = NULL;
-				}
+				demo_synth_prompt_release(synth_channel);
 				/* send asynch event */
 				mrcp_engine_channel_message_send(synth_channel->channel,message);
 			}
@@ -28,6 +28,7 @@
  */
 
 #include "mrcp_verifier_engine.h"
+#include "mrcp_audio_writer.h"
 #include "mpf_activity_detector.h"
 #include "apt_consumer_task.h"
 #include "apt_log.h"
@@ -85,6 +86,8 @@ static const mpf_audio_stream_vtable_t audio_stream_vtable = {
 /** Declaration of demo verification engine */
 struct demo_verifier_engine_t {
 	apt_consumer_task_t    *task;
+	/** Writer of utterances, which keeps disk I/O off the media thread */
+	mrcp_audio_writer_t    *audio_writer;
 };
 
 /** Declaration of demo verification channel */
@@ -103,7 +106,7 @@ struct demo_verifier_channel_t {
 	/** Voice activity detector */
 	mpf_activity_detector_t *detector;
 	/** File to write voiceprint to */
-	FILE                    *audio_out;
+	mrcp_audio_file_t       *audio_out;
 };
 
 typedef enum {
@@ -146,6 +149,7 @@ MRCP_PLUGIN_DECLARE(mrcp_engine_t*) mrcp_plugin_create(apr_pool_t *pool)
 	apt_task_msg_pool_t *msg_pool;
 
 	msg_pool = apt_task_msg_pool_create_dynamic(sizeof(demo_verifier_msg_t),pool);
+	demo_engine->audio_writer = NULL;
 	demo_engine->task = apt_consumer_task_create(demo_engine,msg_pool,pool);
 	if(!demo_engine->task) {
 		return NULL;
@@ -185,6 +189,7 @@ static apt_bool_t demo_verifier_engine_open(mrcp_engine_t *engine)
 		apt_task_t *task = apt_consumer_task_base_get(demo_engine->task);
 		apt_task_start(task);
 	}
+	demo_engine->audio_writer = mrcp_audio_writer_create(0,engine->pool);
 	return mrcp_engine_open_respond(engine,TRUE);
 }
 
@@ -196,6 +201,10 @@ static apt_bool_t demo_verifier_engine_close(mrcp_engine_t *engine)
 		apt_task_t *task = apt_consumer_task_base_get(demo_engine->task);
 		apt_task_terminate(task,TRUE);
 	}
+	if(demo_engine->audio_writer) {
+		mrcp_audio_writer_destroy(demo_engine->audio_writer);
+		demo_engine->audio_writer = NULL;
+	}
 	return mrcp_engine_close_respond(engine);
 }
 
@@ -297,9 +306,9 @@ static apt_bool_t demo_verifier_channel_verify(mrcp_engine_channel_t *channel, m
 							descriptor->sampling_rate/1000,
 							request->channel_id.session_id.buf);
 		char *file_path = apt_vardir_filepath_get(dir_layout,file_name,channel->pool);
-		if(file_path) {
+		if(file_path && verifier_channel->demo_engine->audio_writer) {
 			apt_log(VERIF_LOG_MARK,APT_PRIO_INFO,"Open Utterance Output File [%s] for Writing",file_path);
-			verifier_channel->audio_out = fopen(file_path,"wb");
+			verifier_channel->audio_out = mrcp_audio_file_open(verifier_channel->demo_engine->audio_writer,file_path,NULL);
 			if(!verifier_channel->audio_out) {
 				apt_log(VERIF_LOG_MARK,APT_PRIO_WARNING,"Failed to Open Utterance Output File [%s] for Writing",file_path);
 			}
@@ -540,7 +549,7 @@ static apt_bool_t demo_verifier_stream_write(mpf_audio_stream_t *stream, const m
 		}
 
 		if(verifier_channel->audio_out) {
-			fwrite(frame->codec_frame.buffer,1,frame->codec_frame.size,verifier_channel->audio_out);
+			mrcp_audio_file_write(verifier_channel->audio_out,frame->codec_frame.buffer,frame->codec_frame.size);
 		}
 	}
 	return TRUE;
@@ -579,7 +588,7 @@ static apt_bool_t demo_verifier_msg_process(apt_task_t *task, apt_task_msg_t *ms
 			/* close channel, make sure there is no activity and send asynch response */
 			demo_verifier_channel_t *verifier_channel = demo_msg->channel->method_obj;
 			if(verifier_channel->audio_out) {
-				fclose(verifier_channel->audio_out);
+				mrcp_audio_file_close(verifier_channel->audio_out);
 				verifier_channel->audio_out = NULL;
 			}
 
@@ -28,6 +28,7 @@
  */
 
 #include "mrcp_recorder_engine.h"
+#include "mrcp_audio_writer.h"
 #include "mpf_activity_detector.h"
 #include "apt_log.h"
 
@@ -101,7 +102,11 @@ struct recorder_channel_t {
 	/** File name of the recording */
 	const char              *file_name;
 	/** File to write to */
-	FILE                    *audio_out;
+	mrcp_audio_file_t       *audio_out;
+	/** File being flushed and closed by the I/O thread */
+	mrcp_audio_file_t       *closing_file;
+	/** Message referencing the recording, held until the closing file is complete */
+	mrcp_message_t          *closing_message;
 };
 
 /** Declare this macro to set plugin version */
@@ -137,12 +142,19 @@ static apt_bool_t recorder_engine_destroy(mrcp_engine_t *engine)
 /** Open recorder engine */
 static apt_bool_t recorder_engine_open(mrcp_engine_t *engine)
 {
-	return mrcp_engine_open_respond(engine,TRUE);
+	/* recordings are written by the I/O thread of the audio writer, never by the media thread */
+	engine->obj = mrcp_audio_writer_create(0,engine->pool);
+	return mrcp_engine_open_respond(engine,engine->obj ? TRUE : FALSE);
 }
 
 /** Close recorder engine */
 static apt_bool_t recorder_engine_close(mrcp_engine_t *engine)
 {
+	mrcp_audio_writer_t *audio_writer = engine->obj;
+	if(audio_writer) {
+		mrcp_audio_writer_destroy(audio_writer);
+		engine->obj = NULL;
+	}
 	return mrcp_engine_close_respond(engine);
 }
 
@@ -161,6 +173,8 @@ static mrcp_engine_channel_t* recorder_engine_channel_create(mrcp_engine_t *engi
 	recorder_channel->cur_size = 0;
 	recorder_channel->file_name = NULL;
 	recorder_channel->audio_out = NULL;
+	recorder_channel->closing_file = NULL;
+	recorder_channel->closing_message = NULL;
 
 	capabilities = mpf_sink_stream_capabilities_create(pool);
 	mpf_codec_capabilities_add(
@@ -231,12 +245,12 @@ static apt_bool_t recorder_file_open(recorder_channel_t *recorder_channel, mrcp_
 	}
 
 	if(recorder_channel->audio_out) {
-		fclose(recorder_channel->audio_out);
+		mrcp_audio_file_close(recorder_channel->audio_out);
 		recorder_channel->audio_out = NULL;
 	}
 
 	apt_log(RECORD_LOG_MARK,APT_PRIO_INFO,"Open Utterance Output File [%s] for Writing",file_path);
-	recorder_channel->audio_out = fopen(file_path,"wb");
+	recorder_channel->audio_out = mrcp_audio_file_open(channel->engine->obj,file_path,NULL);
 	if(!recorder_channel->audio_out) {
 		apt_log(RECORD_LOG_MARK,APT_PRIO_WARNING,"Failed to Open Utterance Output File [%s] for Writing",file_path);
 		return FALSE;
@@ -355,6 +369,34 @@ static apt_bool_t recorder_channel_request_process(mrcp_engine_channel_t *channe
 	return TRUE;
 }
 
+/** Close the file to record to, the message referencing the recording is sent once the file is complete */
+static apt_bool_t recorder_file_close(recorder_channel_t *recorder_channel, mrcp_message_t *message)
+{
+	if(!recorder_channel->audio_out) {
+		return mrcp_engine_channel_message_send(recorder_channel->channel,message);
+	}
+
+	mrcp_audio_file_close_begin(recorder_channel->audio_out);
+	recorder_channel->closing_file = recorder_channel->audio_out;
+	recorder_channel->closing_message = message;
+	recorder_channel->audio_out = NULL;
+	return TRUE;
+}
+
+/** Send the held message if the closing file is flushed and closed by the I/O thread */
+static apt_bool_t recorder_file_close_check(recorder_channel_t *recorder_channel)
+{
+	if(mrcp_audio_file_is_closed(recorder_channel->closing_file) == FALSE) {
+		return FALSE;
+	}
+
+	mrcp_audio_file_release(recorder_channel->closing_file);
+	recorder_channel->closing_file = NULL;
+	mrcp_engine_channel_message_send(recorder_channel->channel,recorder_channel->closing_message);
+	recorder_channel->closing_message = NULL;
+	return TRUE;
+}
+
 /* Raise START-OF-INPUT event */
 static apt_bool_t recorder_start_of_input(recorder_channel_t *recorder_channel)
 {
@@ -386,11 +428,6 @@ static apt_bool_t recorder_record_complete(recorder_channel_t *recorder_channel,
 		return FALSE;
 	}
 
-	if(recorder_channel->audio_out) {
-		fclose(recorder_channel->audio_out);
-		recorder_channel->audio_out = NULL;
-	}
-
 	/* get/allocate recorder header */
 	recorder_header = mrcp_resource_header_prepare(message);
 	if(recorder_header) {
@@ -404,8 +441,8 @@ static apt_bool_t recorder_record_complete(recorder_channel_t *recorder_channel,
 	message->start_line.request_state = MRCP_REQUEST_STATE_COMPLETE;
 
 	recorder_channel->record_request = NULL;
-	/* send asynch event */
-	return mrcp_engine_channel_message_send(recorder_channel->channel,message);
+	/* send asynch event once the recording is complete */
+	return recorder_file_close(recorder_channel,message);
 }
 
 /** Callback is called from MPF engine context to destroy any additional data associated with audio stream */
@@ -423,6 +460,17 @@ static apt_bool_t recorder_stream_open(mpf_audio_stream_t *stream, mpf_codec_t *
 /** Callback is called from MPF engine context to perform any action after close */
 static apt_bool_t recorder_stream_close(mpf_audio_stream_t *stream)
 {
+	recorder_channel_t *recorder_channel = stream->obj;
+	if(recorder_channel->audio_out) {
+		mrcp_audio_file_close(recorder_channel->audio_out);
+		recorder_channel->audio_out = NULL;
+	}
+	if(recorder_channel->closing_file) {
+		/* the channel is being closed, the held message is dropped */
+		mrcp_audio_file_release(recorder_channel->closing_file);
+		recorder_channel->closing_file = NULL;
+		recorder_channel->closing_message = NULL;
+	}
 	return TRUE;
 }
 
@@ -430,20 +478,22 @@ static apt_bool_t recorder_stream_close(mpf_audio_stream_t *stream)
 static apt_bool_t recorder_stream_write(mpf_audio_stream_t *stream, const mpf_frame_t *frame)
 {
 	recorder_channel_t *recorder_channel = stream->obj;
+	mrcp_message_t *stop_response;
+	if(recorder_channel->closing_file && recorder_file_close_check(recorder_channel) == FALSE) {
+		/* a pending STOP is responded after the held message */
+		return TRUE;
+	}
+
 	if(recorder_channel->stop_response) {
-		if(recorder_channel->audio_out) {
-			fclose(recorder_channel->audio_out);
-			recorder_channel->audio_out = NULL;
-		}
-		
+		stop_response = recorder_channel->stop_response;
 		if(recorder_channel->record_request){
 			/* set record-uri */
-			recorder_channel_uri_set(recorder_channel,recorder_channel->stop_response);
+			recorder_channel_uri_set(recorder_channel,stop_response);
 		}
-		/* send asynchronous response to STOP request */
-		mrcp_engine_channel_message_send(recorder_channel->channel,recorder_channel->stop_response);
 		recorder_channel->stop_response = NULL;
 		recorder_channel->record_request = NULL;
+		/* send asynchronous response to STOP request once the recording is complete */
+		recorder_file_close(recorder_channel,stop_response);
 		return TRUE;
 	}
 
@@ -472,9 +522,10 @@ static apt_bool_t recorder_stream_write(mpf_audio_stream_t *stream, const mpf_fr
 		}
 
 		if(recorder_channel->audio_out) {
-			fwrite(frame->codec_frame.buffer,1,frame->codec_frame.size,recorder_channel->audio_out);
-			
-			recorder_channel->cur_size += frame->codec_frame.size;
+			if(mrcp_audio_file_write(recorder_channel->audio_out,frame->codec_frame.buffer,frame->codec_frame.size) == TRUE) {
+				/* the size reported by Record-URI is the size of the file */
+				recorder_channel->cur_size += frame->codec_frame.size;
+			}
 			recorder_channel->cur_time += stream->tx_descriptor->frame_duration;
 			if(recorder_channel->max_time && recorder_channel->cur_time >= recorder_channel->max_time) {
 				recorder_record_complete(recorder_channel,RECORDER_COMPLETION_CAUSE_SUCCESS_MAXTIME);
@@ -0,0 +1,199 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <apr_thread_proc.h>
+#include <apr_thread_mutex.h>
+#include "apt_test_suite.h"
+#include "apt_mpsc_queue.h"
+#include "apt_cyclic_queue.h"
+#include "apt_log.h"
+
+/** Default number of producer threads */
+#define MPSC_PRODUCER_COUNT  4
+/** Default number of objects pushed by each producer */
+#define MPSC_OBJECT_COUNT    1000000
+/** Max number of producers, the producer id is kept in the low byte of the object */
+#define MPSC_MAX_PRODUCERS   255
+
+typedef struct mpsc_test_t mpsc_test_t;
+typedef struct mpsc_producer_t mpsc_producer_t;
+
+/** Queue under test, either the lock-free one or the mutex guarded cyclic one */
+struct mpsc_test_t {
+	apt_mpsc_queue_t    *mpsc_queue;
+	apt_cyclic_queue_t  *cyclic_queue;
+	apr_thread_mutex_t  *guard;
+	apr_size_t           object_count;
+};
+
+/** Producer thread */
+struct mpsc_producer_t {
+	mpsc_test_t  *test;
+	apr_size_t    id;
+	apr_thread_t *thread;
+};
+
+/** Objects are not dereferenced, encode the producer id and the sequence number in the pointer */
+#define MPSC_OBJECT_MAKE(id,seq) ((void*)(((apr_size_t)(seq) << 8) | ((id) + 1)))
+
+static apt_bool_t mpsc_test_push(mpsc_test_t *test, void *obj)
+{
+	apt_bool_t status;
+	if(test->mpsc_queue) {
+		return apt_mpsc_queue_push(test->mpsc_queue,obj);
+	}
+
+	apr_thread_mutex_lock(test->guard);
+	status = apt_cyclic_queue_push(test->cyclic_queue,obj);
+	apr_thread_mutex_unlock(test->guard);
+	return status;
+}
+
+static void* mpsc_test_pop(mpsc_test_t *test)
+{
+	void *obj;
+	if(test->mpsc_queue) {
+		return apt_mpsc_queue_pop(test->mpsc_queue);
+	}
+
+	apr_thread_mutex_lock(test->guard);
+	obj = apt_cyclic_queue_pop(test->cyclic_queue);
+	apr_thread_mutex_unlock(test->guard);
+	return obj;
+}
+
+static void* APR_THREAD_FUNC mpsc_producer_run(apr_thread_t *thread, void *data)
+{
+	mpsc_producer_t *producer = data;
+	mpsc_test_t *test = producer->test;
+	apr_size_t seq;
+
+	for(seq=0; seq<test->object_count; seq++) {
+		while(mpsc_test_push(test,MPSC_OBJECT_MAKE(producer->id,seq)) == FALSE) {
+			/* the bounded queue is full, let the consumer run */
+			apr_thread_yield();
+		}
+	}
+	apr_thread_exit(thread,APR_SUCCESS);
+	return NULL;
+}
+
+/** Run producers against the single consumer and check no object is lost or reordered */
+static apt_bool_t mpsc_test_measure(mpsc_test_t *test, const char *name, apr_size_t producer_count, apr_pool_t *pool)
+{
+	apr_size_t i;
+	apr_size_t id;
+	apr_size_t total;
+	apr_size_t received = 0;
+	apr_size_t mismatch_count = 0;
+	apr_size_t *expected_seqs;
+	apr_status_t retval;
+	apr_time_t start;
+	apr_time_t elapsed_time;
+	void *obj;
+	mpsc_producer_t *producers = apr_palloc(pool,sizeof(mpsc_producer_t) * producer_count);
+
+	expected_seqs = apr_pcalloc(pool,sizeof(apr_size_t) * producer_count);
+	total = producer_count * test->object_count;
+
+	start = apr_time_now();
+	for(i=0; i<producer_count; i++) {
+		producers[i].test = test;
+		producers[i].id = i;
+		if(apr_thread_create(&producers[i].thread,NULL,mpsc_producer_run,&producers[i],pool) != APR_SUCCESS) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Create Producer Thread");
+			return FALSE;
+		}
+	}
+
+	while(received < total) {
+		obj = mpsc_test_pop(test);
+		if(!obj) {
+			/* the queue is empty, let the producers run */
+			apr_thread_yield();
+			continue;
+		}
+		id = ((apr_size_t)obj & 0xFF) - 1;
+		if(id >= producer_count || ((apr_size_t)obj >> 8) != expected_seqs[id]) {
+			mismatch_count++;
+		}
+		else {
+			expected_seqs[id]++;
+		}
+		received++;
+	}
+	elapsed_time = apr_time_now() - start;
+
+	for(i=0; i<producer_count; i++) {
+		apr_thread_join(&retval,producers[i].thread);
+	}
+
+	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Queue [%s] Producers [%"APR_SIZE_T_FMT"] Objects [%"APR_SIZE_T_FMT"] Elapsed [%.1f nsec/object]",
+		name,
+		producer_count,
+		total,
+		(double)elapsed_time * 1000 / total);
+
+	if(mismatch_count || mpsc_test_pop(test) != NULL) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Objects Lost or Reordered [%"APR_SIZE_T_FMT"]",mismatch_count);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+static apt_bool_t mpsc_queue_test_run(apt_test_suite_t *suite, int argc, const char * const *argv)
+{
+	mpsc_test_t test;
+	apt_bool_t status;
+	apr_size_t producer_count = MPSC_PRODUCER_COUNT;
+
+	test.object_count = MPSC_OBJECT_COUNT;
+	if(argc > 0) {
+		/* the number of producer threads */
+		producer_count = atol(argv[0]);
+	}
+	if(argc > 1) {
+		/* the number of objects pushed by each producer */
+		test.object_count = atol(argv[1]);
+	}
+	if(!producer_count || producer_count > MPSC_MAX_PRODUCERS || !test.object_count) {
+		return FALSE;
+	}
+
+	/* the cyclic queue guarded by mutex, as used by the media engine before */
+	test.mpsc_queue = NULL;
+	test.cyclic_queue = apt_cyclic_queue_create(CYCLIC_QUEUE_DEFAULT_SIZE);
+	apr_thread_mutex_create(&test.guard,APR_THREAD_MUTEX_UNNESTED,suite->pool);
+	status = mpsc_test_measure(&test,"mutex+cyclic",producer_count,suite->pool);
+	apr_thread_mutex_destroy(test.guard);
+	apt_cyclic_queue_destroy(test.cyclic_queue);
+	if(status == FALSE) {
+		return FALSE;
+	}
+
+	/* the lock-free queue */
+	test.cyclic_queue = NULL;
+	test.guard = NULL;
+	test.mpsc_queue = apt_mpsc_queue_create(MPSC_QUEUE_DEFAULT_SIZE,suite->pool);
+	return mpsc_test_measure(&test,"mpsc",producer_count,suite->pool);
+}
+
+apt_test_suite_t* mpsc_queue_test_suite_create(apr_pool_t *pool)
+{
+	apt_test_suite_t *suite = apt_test_suite_create(pool,"mpsc-queue",NULL,mpsc_queue_test_run);
+	return suite;
+}
@@ -0,0 +1,269 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <apr_file_io.h>
+#include "apt_test_suite.h"
+#include "apt_nlsml_doc.h"
+#include "apt_nlsml_reader.h"
+#include "apt_log.h"
+
+/** Default number of times each document is parsed */
+#define NLSML_ITERATION_COUNT  10000
+
+/** Default documents, relative to the root of the source tree */
+static const char *nlsml_default_files[] = {
+	"data/result.xml",
+	"data/result-verification.xml"
+};
+
+/** N-best result with the vendor specific SWI elements and a structured instance */
+static const char nlsml_nbest_sample[] =
+	"<?xml version=\"1.0\"?>\r\n"
+	"<!-- n-best result -->\r\n"
+	"<result grammar=\"session:request1@form-level.store\">\r\n"
+	"  <interpretation grammar=\"#main\" confidence=\"87\">\r\n"
+	"    <instance><SWI_literal>boston</SWI_literal><SWI_meaning>{SWI_literal:boston}</SWI_meaning></instance>\r\n"
+	"    <input mode=\"speech\" confidence=\"0.87\" timestamp-start=\"2015-01-01T10:00:00\" timestamp-end=\"2015-01-01T10:00:01\">boston</input>\r\n"
+	"  </interpretation>\r\n"
+	"  <interpretation grammar=\"#main\" confidence=\"0.42\">\r\n"
+	"    <instance>\r\n"
+	"      <city>austin</city>\r\n"
+	"      <state>texas</state>\r\n"
+	"    </instance>\r\n"
+	"    <input mode=\"speech\">austin texas</input>\r\n"
+	"  </interpretation>\r\n"
+	"</result>";
+
+/** Compare optional strings */
+static apt_bool_t nlsml_string_compare(const char *str1, const char *str2)
+{
+	if(!str1 || !str2) {
+		return (str1 == str2) ? TRUE : FALSE;
+	}
+	return (strcmp(str1,str2) == 0) ? TRUE : FALSE;
+}
+
+/** Compare the result read in a single pass to the one parsed into XML tree */
+static apt_bool_t nlsml_results_compare(nlsml_result_t *result, const nlsml_flat_result_t *flat_result, apr_pool_t *pool)
+{
+	apr_size_t i = 0;
+	apr_size_t j;
+	nlsml_interpretation_t *interpretation;
+	nlsml_instance_t *instance;
+	nlsml_input_t *input;
+	const nlsml_flat_interpretation_t *flat_interpretation;
+
+	if(!result || !flat_result) {
+		return (!result && !flat_result) ? TRUE : FALSE;
+	}
+	if(nlsml_string_compare(nlsml_result_grammar_get(result),flat_result->grammar) == FALSE) {
+		return FALSE;
+	}
+
+	for(interpretation = nlsml_first_interpretation_get(result);
+		interpretation;
+		interpretation = nlsml_next_interpretation_get(result,interpretation), i++) {
+
+		if(i >= flat_result->interpretation_count) {
+			return FALSE;
+		}
+		flat_interpretation = &flat_result->interpretations[i];
+		if(nlsml_string_compare(nlsml_interpretation_grammar_get(interpretation),flat_interpretation->grammar) == FALSE ||
+			nlsml_interpretation_confidence_get(interpretation) != flat_interpretation->confidence) {
+			return FALSE;
+		}
+
+		j = 0;
+		for(instance = nlsml_interpretation_first_instance_get(interpretation);
+			instance;
+			instance = nlsml_interpretation_next_instance_get(interpretation,instance), j++) {
+
+			if(j >= flat_interpretation->instance_count) {
+				return FALSE;
+			}
+			nlsml_instance_swi_suppress(instance);
+			if(nlsml_string_compare(nlsml_instance_content_generate(instance,pool),flat_interpretation->instances[j].buf) == FALSE) {
+				apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Mismatch of Instance [%s] [%s]",
+					nlsml_instance_content_generate(instance,pool),
+					flat_interpretation->instances[j].buf);
+				return FALSE;
+			}
+		}
+		if(j != flat_interpretation->instance_count) {
+			return FALSE;
+		}
+
+		input = nlsml_interpretation_input_get(interpretation);
+		if(!input) {
+			if(flat_interpretation->input.buf) {
+				return FALSE;
+			}
+			continue;
+		}
+		if(nlsml_string_compare(nlsml_input_content_generate(input,pool),flat_interpretation->input.buf) == FALSE ||
+			nlsml_string_compare(nlsml_input_mode_get(input),flat_interpretation->input_mode) == FALSE ||
+			nlsml_input_confidence_get(input) != flat_interpretation->input_confidence ||
+			nlsml_string_compare(nlsml_input_timestamp_start_get(input),flat_interpretation->input_timestamp_start) == FALSE ||
+			nlsml_string_compare(nlsml_input_timestamp_end_get(input),flat_interpretation->input_timestamp_end) == FALSE) {
+			return FALSE;
+		}
+	}
+	return (i == flat_result->interpretation_count) ? TRUE : FALSE;
+}
+
+/** Get the first instance, as the ASR client library does */
+static const char* nlsml_first_instance_parse(const char *data, apr_size_t length, apr_pool_t *pool)
+{
+	nlsml_interpretation_t *interpretation;
+	nlsml_instance_t *instance;
+	nlsml_result_t *result = nlsml_result_parse(data,length,pool);
+	if(!result) {
+		return NULL;
+	}
+	interpretation = nlsml_first_interpretation_get(result);
+	if(!interpretation) {
+		return NULL;
+	}
+	instance = nlsml_interpretation_first_instance_get(interpretation);
+	if(!instance) {
+		return NULL;
+	}
+	nlsml_instance_swi_suppress(instance);
+	return nlsml_instance_content_generate(instance,pool);
+}
+
+/** Get the first instance by the reader */
+static const char* nlsml_first_instance_read(const char *data, apr_size_t length, apr_pool_t *pool)
+{
+	nlsml_flat_result_t *result = nlsml_flat_result_read(data,length,pool);
+	if(!result || !result->interpretation_count || !result->interpretations[0].instance_count) {
+		return NULL;
+	}
+	return result->interpretations[0].instances[0].buf;
+}
+
+/** Compare the results of the document and measure the time both parsers take */
+static apt_bool_t nlsml_document_test(const char *name, const char *data, apr_size_t length, apr_size_t iteration_count, apr_pool_t *pool)
+{
+	apr_size_t i;
+	apr_pool_t *subpool;
+	apr_time_t start;
+	apr_time_t tree_time;
+	apr_time_t flat_time;
+	apt_bool_t status;
+
+	if(apr_pool_create(&subpool,pool) != APR_SUCCESS) {
+		return FALSE;
+	}
+
+	status = nlsml_results_compare(
+				nlsml_result_parse(data,length,subpool),
+				nlsml_flat_result_read(data,length,subpool),
+				subpool);
+
+	start = apr_time_now();
+	for(i=0; i<iteration_count; i++) {
+		apr_pool_clear(subpool);
+		nlsml_first_instance_parse(data,length,subpool);
+	}
+	tree_time = apr_time_now() - start;
+
+	start = apr_time_now();
+	for(i=0; i<iteration_count; i++) {
+		apr_pool_clear(subpool);
+		nlsml_first_instance_read(data,length,subpool);
+	}
+	flat_time = apr_time_now() - start;
+
+	apr_pool_destroy(subpool);
+
+	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"NLSML [%s] Size [%"APR_SIZE_T_FMT" bytes] Match [%s] Tree [%.2f usec/doc] Flat [%.2f usec/doc]",
+		name,
+		length,
+		status == TRUE ? "yes" : "no",
+		(double)tree_time / iteration_count,
+		(double)flat_time / iteration_count);
+	return status;
+}
+
+/** Load the document from file */
+static char* nlsml_file_load(const char *file_path, apr_size_t *length, apr_pool_t *pool)
+{
+	apr_file_t *file;
+	apr_finfo_t finfo;
+	char *data = NULL;
+
+	if(apr_file_open(&file,file_path,APR_FOPEN_READ | APR_FOPEN_BINARY,APR_OS_DEFAULT,pool) != APR_SUCCESS) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Open File [%s]",file_path);
+		return NULL;
+	}
+
+	if(apr_file_info_get(&finfo,APR_FINFO_SIZE,file) == APR_SUCCESS && finfo.size > 0) {
+		*length = (apr_size_t)finfo.size;
+		data = apr_palloc(pool,*length);
+		if(apr_file_read_full(file,data,*length,length) != APR_SUCCESS) {
+			data = NULL;
+		}
+	}
+	apr_file_close(file);
+	return data;
+}
+
+static apt_bool_t nlsml_test_run(apt_test_suite_t *suite, int argc, const char * const *argv)
+{
+	apr_size_t iteration_count = NLSML_ITERATION_COUNT;
+	const char * const *files = nlsml_default_files;
+	apr_size_t file_count = sizeof(nlsml_default_files) / sizeof(nlsml_default_files[0]);
+	apr_size_t mismatch_count = 0;
+	apr_size_t length;
+	apr_size_t i;
+	char *data;
+
+	if(argc > 0) {
+		/* the number of times each document is parsed */
+		iteration_count = atol(argv[0]);
+	}
+	if(argc > 1) {
+		/* the documents to parse instead of the default ones */
+		files = argv + 1;
+		file_count = argc - 1;
+	}
+	if(!iteration_count) {
+		return FALSE;
+	}
+
+	for(i=0; i<file_count; i++) {
+		data = nlsml_file_load(files[i],&length,suite->pool);
+		if(!data) {
+			return FALSE;
+		}
+		if(nlsml_document_test(files[i],data,length,iteration_count,suite->pool) == FALSE) {
+			mismatch_count++;
+		}
+	}
+
+	if(nlsml_document_test("n-best",nlsml_nbest_sample,sizeof(nlsml_nbest_sample)-1,iteration_count,suite->pool) == FALSE) {
+		mismatch_count++;
+	}
+	return mismatch_count ? FALSE : TRUE;
+}
+
+apt_test_suite_t* nlsml_test_suite_create(apr_pool_t *pool)
+{
+	apt_test_suite_t *suite = apt_test_suite_create(pool,"nlsml",NULL,nlsml_test_run);
+	return suite;
+}
@@ -0,0 +1,159 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <apr_thread_proc.h>
+#include "apt_test_suite.h"
+#include "apt_pool.h"
+#include "apt_log.h"
+
+/** Default number of threads */
+#define POOL_THREAD_COUNT    4
+/** Default number of pools acquired and released by each thread */
+#define POOL_CYCLE_COUNT     100000
+/** Number of allocations made from each pool, similar to a session */
+#define POOL_ALLOC_COUNT     16
+/** Size of each allocation */
+#define POOL_ALLOC_SIZE      1024
+
+/** Thread acquiring and releasing pools */
+typedef struct pool_thread_t pool_thread_t;
+struct pool_thread_t {
+	apr_size_t    cycle_count;
+	apr_size_t    failure_count;
+	apr_thread_t *thread;
+};
+
+static void* APR_THREAD_FUNC pool_thread_run(apr_thread_t *thread, void *data)
+{
+	pool_thread_t *pool_thread = data;
+	apr_pool_t *pool;
+	apr_size_t i;
+	apr_size_t n;
+	char *buf;
+
+	for(n=0; n<pool_thread->cycle_count; n++) {
+		pool = apt_pool_acquire();
+		if(!pool) {
+			pool_thread->failure_count++;
+			continue;
+		}
+		for(i=0; i<POOL_ALLOC_COUNT; i++) {
+			buf = apr_palloc(pool,POOL_ALLOC_SIZE);
+			buf[0] = (char)i;
+		}
+		apt_pool_release(pool);
+	}
+	apr_thread_exit(thread,APR_SUCCESS);
+	return NULL;
+}
+
+/** Run the threads and return the elapsed time */
+static apr_time_t pool_test_measure(apr_size_t thread_count, apr_size_t cycle_count, apr_size_t *failure_count, apr_pool_t *pool)
+{
+	apr_size_t i;
+	apr_status_t retval;
+	apr_time_t start;
+	pool_thread_t *threads = apr_pcalloc(pool,sizeof(pool_thread_t) * thread_count);
+
+	start = apr_time_now();
+	for(i=0; i<thread_count; i++) {
+		threads[i].cycle_count = cycle_count;
+		if(apr_thread_create(&threads[i].thread,NULL,pool_thread_run,&threads[i],pool) != APR_SUCCESS) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Create Thread");
+			threads[i].thread = NULL;
+			(*failure_count)++;
+		}
+	}
+	for(i=0; i<thread_count; i++) {
+		if(threads[i].thread) {
+			apr_thread_join(&retval,threads[i].thread);
+			*failure_count += threads[i].failure_count;
+		}
+	}
+	return apr_time_now() - start;
+}
+
+/** Check that the arena of a released pool is reused by the next acquired one */
+static apt_bool_t pool_test_recycle(void)
+{
+	apr_pool_t *pool;
+	apr_pool_t *arena;
+	apt_bool_t status;
+
+	pool = apt_pool_acquire();
+	if(!pool) {
+		return FALSE;
+	}
+	arena = apr_pool_parent_get(pool);
+	apt_pool_release(pool);
+
+	pool = apt_pool_acquire();
+	if(!pool) {
+		return FALSE;
+	}
+	status = (apr_pool_parent_get(pool) == arena) ? TRUE : FALSE;
+	apt_pool_release(pool);
+	return status;
+}
+
+static apt_bool_t pool_test_run(apt_test_suite_t *suite, int argc, const char * const *argv)
+{
+	apr_size_t thread_count = POOL_THREAD_COUNT;
+	apr_size_t cycle_count = POOL_CYCLE_COUNT;
+	apr_size_t failure_count = 0;
+	apr_time_t plain_time;
+	apr_time_t cached_time;
+	apt_bool_t recycled;
+
+	if(argc > 0) {
+		/* the number of threads */
+		thread_count = atol(argv[0]);
+	}
+	if(argc > 1) {
+		/* the number of cycles per thread */
+		cycle_count = atol(argv[1]);
+	}
+	if(!thread_count || !cycle_count) {
+		return FALSE;
+	}
+
+	/* no cache, a new allocator per pool */
+	plain_time = pool_test_measure(thread_count,cycle_count,&failure_count,suite->pool);
+
+	if(apt_pool_cache_create(thread_count * 4,4,thread_count,0) == FALSE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Create Pool Cache");
+		return FALSE;
+	}
+	recycled = pool_test_recycle();
+	cached_time = pool_test_measure(thread_count,cycle_count,&failure_count,suite->pool);
+	apt_pool_cache_destroy();
+
+	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Pool Threads [%"APR_SIZE_T_FMT"] Cycles [%"APR_SIZE_T_FMT"] Failures [%"APR_SIZE_T_FMT"] Recycled [%s] Plain [%.1f nsec/cycle] Cached [%.1f nsec/cycle]",
+		thread_count,
+		cycle_count,
+		failure_count,
+		recycled == TRUE ? "yes" : "no",
+		(double)plain_time * 1000 / cycle_count,
+		(double)cached_time * 1000 / cycle_count);
+	return (!failure_count && recycled == TRUE) ? TRUE : FALSE;
+}
+
+apt_test_suite_t* pool_cache_test_suite_create(apr_pool_t *pool)
+{
+	apt_test_suite_t *suite = apt_test_suite_create(pool,"pool-cache",NULL,pool_test_run);
+	return suite;
+}
@@ -0,0 +1,168 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include "apt_test_suite.h"
+#include "apt_timer_queue.h"
+#include "apt_log.h"
+
+/** Default number of live timers */
+#define TIMER_COUNT        100000
+/** Max timeout of the timers in msec */
+#define TIMER_MAX_TIMEOUT  60000
+/** Number of msec to advance the queue by, the same as the timer resolution of the media engine */
+#define TIMER_TICK         10
+
+typedef struct timer_test_t timer_test_t;
+typedef struct timer_entry_t timer_entry_t;
+
+/** Timer entry, the expected time to elapse at is kept along with the timer */
+struct timer_entry_t {
+	apt_timer_t  *timer;
+	timer_test_t *test;
+	apr_uint32_t  expected_time;
+};
+
+/** Timer test */
+struct timer_test_t {
+	timer_entry_t *entries;
+	apr_size_t     count;
+	apr_uint32_t   elapsed_time;
+	apr_uint32_t   seed;
+	apr_size_t     elapsed_count;
+	apr_size_t     mismatch_count;
+};
+
+static apr_uint32_t timer_random_get(timer_test_t *test, apr_uint32_t max)
+{
+	test->seed = test->seed * 1103515245 + 12345;
+	return (test->seed >> 8) % max;
+}
+
+static void timer_entry_set(timer_entry_t *entry)
+{
+	timer_test_t *test = entry->test;
+	apr_uint32_t timeout = 1 + timer_random_get(test,TIMER_MAX_TIMEOUT);
+	entry->expected_time = test->elapsed_time + timeout;
+	apt_timer_set(entry->timer,timeout);
+}
+
+static void timer_proc(apt_timer_t *timer, void *obj)
+{
+	timer_entry_t *entry = obj;
+	timer_test_t *test = entry->test;
+
+	/* the queue is advanced by ticks, the timer must elapse within the tick it is scheduled at */
+	if(entry->expected_time > test->elapsed_time || entry->expected_time + TIMER_TICK <= test->elapsed_time) {
+		test->mismatch_count++;
+	}
+	test->elapsed_count++;
+
+	/* re-arm the timer to keep the number of live timers constant */
+	timer_entry_set(entry);
+}
+
+static apt_bool_t timer_test_run(apt_test_suite_t *suite, int argc, const char * const *argv)
+{
+	timer_test_t test;
+	timer_entry_t *entry;
+	apr_size_t i;
+	apr_uint32_t timeout;
+	apr_uint32_t nearest;
+	apr_size_t tick_count;
+	apr_time_t start;
+	apr_time_t set_time;
+	apr_time_t kill_time;
+	apr_time_t advance_time;
+	apt_timer_queue_t *timer_queue = apt_timer_queue_create(suite->pool);
+
+	test.count = TIMER_COUNT;
+	if(argc > 0) {
+		/* the number of live timers */
+		test.count = atol(argv[0]);
+	}
+	if(!test.count) {
+		return FALSE;
+	}
+	test.entries = apr_palloc(suite->pool,sizeof(timer_entry_t) * test.count);
+	test.elapsed_time = 0;
+	test.seed = 1;
+	test.elapsed_count = 0;
+	test.mismatch_count = 0;
+
+	for(i=0; i<test.count; i++) {
+		entry = &test.entries[i];
+		entry->test = &test;
+		entry->timer = apt_timer_create(timer_queue,timer_proc,entry,suite->pool);
+	}
+
+	/* set all the timers */
+	start = apr_time_now();
+	for(i=0; i<test.count; i++) {
+		timer_entry_set(&test.entries[i]);
+	}
+	set_time = apr_time_now() - start;
+
+	/* check the nearest timeout */
+	nearest = TIMER_MAX_TIMEOUT;
+	for(i=0; i<test.count; i++) {
+		if(test.entries[i].expected_time < nearest) {
+			nearest = test.entries[i].expected_time;
+		}
+	}
+	if(apt_timer_queue_timeout_get(timer_queue,&timeout) == FALSE || timeout != nearest) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Wrong Timeout [%u] Expected [%u]",timeout,nearest);
+		return FALSE;
+	}
+
+	/* advance the queue by ticks through the whole range of timeouts, the elapsed timers are re-armed */
+	tick_count = TIMER_MAX_TIMEOUT / TIMER_TICK * 2;
+	start = apr_time_now();
+	for(i=0; i<tick_count; i++) {
+		test.elapsed_time += TIMER_TICK;
+		apt_timer_queue_advance(timer_queue,TIMER_TICK);
+	}
+	advance_time = apr_time_now() - start;
+
+	/* kill all the timers */
+	start = apr_time_now();
+	for(i=0; i<test.count; i++) {
+		apt_timer_kill(test.entries[i].timer);
+	}
+	kill_time = apr_time_now() - start;
+
+	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Timers [%"APR_SIZE_T_FMT"] Set [%.1f nsec/timer] Kill [%.1f nsec/timer]",
+		test.count,
+		(double)set_time * 1000 / test.count,
+		(double)kill_time * 1000 / test.count);
+	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Ticks [%"APR_SIZE_T_FMT"] Elapsed [%"APR_SIZE_T_FMT"] Advance [%.1f usec/tick]",
+		tick_count,
+		test.elapsed_count,
+		(double)advance_time / tick_count);
+
+	if(test.mismatch_count || apt_timer_queue_is_empty(timer_queue) == FALSE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Timers Elapsed at Wrong Time [%"APR_SIZE_T_FMT"]",test.mismatch_count);
+		return FALSE;
+	}
+	apt_timer_queue_destroy(timer_queue);
+	return TRUE;
+}
+
+apt_test_suite_t* timer_test_suite_create(apr_pool_t *pool)
+{
+	apt_test_suite_t *suite = apt_test_suite_create(pool,"timer",NULL,timer_test_run);
+	return suite;
+}
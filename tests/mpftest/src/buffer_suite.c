@@ -0,0 +1,130 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include "apt_test_suite.h"
+#include "apt_log.h"
+#include "mpf_buffer.h"
+
+/** Size of a 20 msec frame of 16 kHz linear PCM */
+#define BUFFER_FRAME_SIZE       640
+/** Default duration of the streamed prompt in minutes */
+#define BUFFER_PROMPT_DURATION  10
+/** Max size of the audio written at once by the producer */
+#define BUFFER_MAX_WRITE_SIZE   4000
+/** High-water mark of the buffer, 1 sec of audio */
+#define BUFFER_HIGH_WATER_MARK  (BUFFER_FRAME_SIZE * 50)
+/** Number of writes after which an event is written */
+#define BUFFER_EVENT_INTERVAL   100
+
+/** Stream a long prompt through the buffer as a TTS engine would, and check the frames read out */
+static apt_bool_t buffer_test_run(apt_test_suite_t *suite, int argc, const char * const *argv)
+{
+	apr_size_t i;
+	apr_size_t size;
+	apr_size_t total_size;
+	apr_size_t written_size = 0;
+	apr_size_t read_size = 0;
+	apr_size_t max_size = 0;
+	apr_size_t write_count = 0;
+	apr_size_t written_events = 0;
+	apr_size_t read_events = 0;
+	apr_size_t mismatch_count = 0;
+	apr_uint32_t seed = 1;
+	apr_byte_t data[BUFFER_MAX_WRITE_SIZE];
+	apr_byte_t frame_data[BUFFER_FRAME_SIZE];
+	mpf_frame_t frame;
+	apr_size_t duration = BUFFER_PROMPT_DURATION;
+	mpf_buffer_t *buffer;
+
+	if(argc > 0) {
+		/* the duration of the prompt in minutes */
+		duration = atol(argv[0]);
+	}
+	total_size = duration * 60 * 50 * BUFFER_FRAME_SIZE;
+	buffer = mpf_buffer_create_ex(MPF_BUFFER_DEFAULT_CHUNK_SIZE,BUFFER_HIGH_WATER_MARK,suite->pool);
+
+	frame.codec_frame.buffer = frame_data;
+	while(read_size < total_size) {
+		/* the producer writes as long as the buffer is not full */
+		while(written_size < total_size && mpf_buffer_is_full(buffer) == FALSE) {
+			seed = seed * 1103515245 + 12345;
+			size = 1 + (seed >> 8) % BUFFER_MAX_WRITE_SIZE;
+			if(size > total_size - written_size) {
+				size = total_size - written_size;
+			}
+			for(i=0; i<size; i++) {
+				data[i] = (apr_byte_t)(written_size + i);
+			}
+			mpf_buffer_audio_write(buffer,data,size);
+			written_size += size;
+
+			if(++write_count % BUFFER_EVENT_INTERVAL == 0) {
+				mpf_buffer_event_write(buffer,MEDIA_FRAME_TYPE_EVENT);
+				written_events++;
+			}
+		}
+		if(mpf_buffer_get_size(buffer) > max_size) {
+			max_size = mpf_buffer_get_size(buffer);
+		}
+
+		/* the media thread reads a frame per tick */
+		frame.type = MEDIA_FRAME_TYPE_NONE;
+		frame.codec_frame.size = BUFFER_FRAME_SIZE;
+		mpf_buffer_frame_read(buffer,&frame);
+		if(frame.type & MEDIA_FRAME_TYPE_EVENT) {
+			read_events++;
+		}
+		size = BUFFER_FRAME_SIZE;
+		if(size > total_size - read_size) {
+			size = total_size - read_size;
+		}
+		for(i=0; i<size; i++) {
+			if(frame_data[i] != (apr_byte_t)(read_size + i)) {
+				mismatch_count++;
+				break;
+			}
+		}
+		read_size += size;
+	}
+
+	/* the events written after the last audio */
+	frame.type = MEDIA_FRAME_TYPE_NONE;
+	frame.codec_frame.size = BUFFER_FRAME_SIZE;
+	mpf_buffer_frame_read(buffer,&frame);
+	if(frame.type & MEDIA_FRAME_TYPE_EVENT) {
+		read_events++;
+	}
+
+	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Streamed [%"APR_SIZE_T_FMT" bytes] Max Buffered [%"APR_SIZE_T_FMT" bytes] Events [%"APR_SIZE_T_FMT"/%"APR_SIZE_T_FMT"]",
+		total_size,
+		max_size,
+		read_events,
+		written_events);
+
+	mpf_buffer_destroy(buffer);
+	if(mismatch_count || read_events != written_events || max_size >= BUFFER_HIGH_WATER_MARK + BUFFER_MAX_WRITE_SIZE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Mismatch of Frames Read [%"APR_SIZE_T_FMT"]",mismatch_count);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+apt_test_suite_t* buffer_test_suite_create(apr_pool_t *pool)
+{
+	apt_test_suite_t *suite = apt_test_suite_create(pool,"buffer",NULL,buffer_test_run);
+	return suite;
+}
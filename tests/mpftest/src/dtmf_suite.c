@@ -0,0 +1,213 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <math.h>
+#include "apt_test_suite.h"
+#include "apt_log.h"
+#include "mpf_dtmf_detector.h"
+
+#ifndef M_PI
+#	define M_PI 3.141592653589793238462643
+#endif
+
+/** Number of samples in a 20 msec frame at 8 kHz */
+#define DTMF_FRAME_SAMPLES     160
+/** Number of samples of a digit slot: 100 msec of tone and 100 msec of silence */
+#define DTMF_SLOT_SAMPLES      1600
+/** Number of digits in the generated signal */
+#define DTMF_DIGIT_COUNT       16
+/** Default number of channels */
+#define DTMF_CHANNEL_COUNT     64
+/** Default duration of the signal in seconds */
+#define DTMF_DURATION          20
+/** Amplitude of each of the two tones */
+#define DTMF_AMPLITUDE         8000
+
+/** Digits of the generated signal */
+static const char dtmf_digits[DTMF_DIGIT_COUNT+1] = "123A456B789C*0#D";
+/** Row and column frequencies of the digits */
+static const double dtmf_rows[4] = {697, 770, 852, 941};
+static const double dtmf_cols[4] = {1209, 1336, 1477, 1633};
+
+/** Generate the digits in their slots followed by silence, with a low noise added */
+static apr_int16_t* dtmf_signal_generate(apr_pool_t *pool)
+{
+	apr_size_t i;
+	apr_size_t d;
+	apr_uint32_t seed = 1;
+	apr_int16_t *signal = apr_palloc(pool,sizeof(apr_int16_t) * DTMF_SLOT_SAMPLES * DTMF_DIGIT_COUNT);
+
+	for(d=0; d<DTMF_DIGIT_COUNT; d++) {
+		double row = dtmf_rows[d / 4];
+		double col = dtmf_cols[d % 4];
+		apr_int16_t *slot = signal + d * DTMF_SLOT_SAMPLES;
+		for(i=0; i<DTMF_SLOT_SAMPLES; i++) {
+			double value = 0;
+			if(i < DTMF_SLOT_SAMPLES / 2) {
+				value = DTMF_AMPLITUDE * (sin(2 * M_PI * row * i / 8000) + sin(2 * M_PI * col * i / 8000));
+			}
+			seed = seed * 1103515245 + 12345;
+			value += (apr_int32_t)((seed >> 16) & 0xFF) - 128;
+			slot[i] = (apr_int16_t)value;
+		}
+	}
+	return signal;
+}
+
+/** Create detectors of in-band digits at 8 kHz */
+static mpf_dtmf_detector_t** dtmf_detectors_create(apr_size_t count, apr_pool_t *pool)
+{
+	apr_size_t i;
+	mpf_audio_stream_t *stream = apr_pcalloc(pool,sizeof(mpf_audio_stream_t));
+	mpf_dtmf_detector_t **detectors = apr_palloc(pool,sizeof(mpf_dtmf_detector_t*) * count);
+
+	stream->tx_descriptor = mpf_codec_descriptor_create(pool);
+	stream->tx_descriptor->sampling_rate = 8000;
+	stream->tx_descriptor->channel_count = 1;
+	for(i=0; i<count; i++) {
+		detectors[i] = mpf_dtmf_detector_create_ex(stream,MPF_DTMF_DETECTOR_INBAND,pool);
+	}
+	return detectors;
+}
+
+/** Collect the digits detected so far */
+static void dtmf_digits_collect(mpf_dtmf_detector_t *detector, char *digits, apr_size_t *count, apr_size_t max_count)
+{
+	char digit;
+	while((digit = mpf_dtmf_detector_digit_get(detector)) != 0) {
+		if(*count < max_count) {
+			digits[(*count)++] = digit;
+		}
+	}
+}
+
+/** Feed every channel its frames either one by one or in batches, and check the detected digits */
+static apt_bool_t dtmf_test_run(apt_test_suite_t *suite, int argc, const char * const *argv)
+{
+	apr_size_t i;
+	apr_size_t c;
+	apr_size_t n;
+	apr_size_t channel_count = DTMF_CHANNEL_COUNT;
+	apr_size_t frame_count;
+	apr_size_t digit_count;
+	apr_size_t mismatch_count = 0;
+	apr_size_t duration = DTMF_DURATION;
+	apr_size_t signal_samples = DTMF_SLOT_SAMPLES * DTMF_DIGIT_COUNT;
+	apr_int16_t *signal;
+	mpf_frame_t *frames;
+	const mpf_frame_t **frame_ptrs;
+	mpf_dtmf_detector_t **single;
+	mpf_dtmf_detector_t **batch;
+	char **single_digits;
+	char **batch_digits;
+	apr_size_t *single_count;
+	apr_size_t *batch_count;
+	apr_time_t start;
+	apr_time_t single_time = 0;
+	apr_time_t batch_time = 0;
+
+	if(argc > 0) {
+		/* the number of channels */
+		channel_count = atol(argv[0]);
+	}
+	if(argc > 1) {
+		/* the duration of the signal in seconds */
+		duration = atol(argv[1]);
+	}
+	if(!channel_count) {
+		return FALSE;
+	}
+	frame_count = duration * 8000 / DTMF_FRAME_SAMPLES;
+	digit_count = duration * 8000 / DTMF_SLOT_SAMPLES;
+
+	signal = dtmf_signal_generate(suite->pool);
+	single = dtmf_detectors_create(channel_count,suite->pool);
+	batch = dtmf_detectors_create(channel_count,suite->pool);
+	if(!single[0] || !batch[0]) {
+		return FALSE;
+	}
+	frames = apr_pcalloc(suite->pool,sizeof(mpf_frame_t) * channel_count);
+	frame_ptrs = apr_palloc(suite->pool,sizeof(mpf_frame_t*) * channel_count);
+	single_digits = apr_palloc(suite->pool,sizeof(char*) * channel_count);
+	batch_digits = apr_palloc(suite->pool,sizeof(char*) * channel_count);
+	single_count = apr_pcalloc(suite->pool,sizeof(apr_size_t) * channel_count);
+	batch_count = apr_pcalloc(suite->pool,sizeof(apr_size_t) * channel_count);
+	for(c=0; c<channel_count; c++) {
+		frames[c].type = MEDIA_FRAME_TYPE_AUDIO;
+		frames[c].codec_frame.size = DTMF_FRAME_SAMPLES * sizeof(apr_int16_t);
+		frame_ptrs[c] = &frames[c];
+		single_digits[c] = apr_pcalloc(suite->pool,digit_count + 1);
+		batch_digits[c] = apr_pcalloc(suite->pool,digit_count + 1);
+	}
+
+	for(n=0; n<frame_count; n++) {
+		for(c=0; c<channel_count; c++) {
+			/* every channel starts from another digit */
+			apr_size_t offset = (n * DTMF_FRAME_SAMPLES + c * DTMF_SLOT_SAMPLES) % signal_samples;
+			frames[c].codec_frame.buffer = signal + offset;
+		}
+
+		start = apr_time_now();
+		for(c=0; c<channel_count; c++) {
+			mpf_dtmf_detector_get_frame(single[c],&frames[c]);
+		}
+		single_time += apr_time_now() - start;
+
+		start = apr_time_now();
+		mpf_dtmf_detector_get_frames(batch,frame_ptrs,channel_count);
+		batch_time += apr_time_now() - start;
+
+		for(c=0; c<channel_count; c++) {
+			dtmf_digits_collect(single[c],single_digits[c],&single_count[c],digit_count);
+			dtmf_digits_collect(batch[c],batch_digits[c],&batch_count[c],digit_count);
+		}
+	}
+
+	for(c=0; c<channel_count; c++) {
+		apt_bool_t match = (single_count[c] == digit_count && batch_count[c] == digit_count) ? TRUE : FALSE;
+		for(i=0; i<digit_count && match == TRUE; i++) {
+			char expected = dtmf_digits[(c + i) % DTMF_DIGIT_COUNT];
+			if(single_digits[c][i] != expected || batch_digits[c][i] != expected) {
+				match = FALSE;
+			}
+		}
+		if(match == FALSE) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Mismatch of Digits Channel [%"APR_SIZE_T_FMT"] Single [%s] Batch [%s]",
+				c,single_digits[c],batch_digits[c]);
+			mismatch_count++;
+		}
+	}
+
+	for(c=0; c<channel_count; c++) {
+		mpf_dtmf_detector_destroy(single[c]);
+		mpf_dtmf_detector_destroy(batch[c]);
+	}
+
+	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"DTMF Channels [%"APR_SIZE_T_FMT"] Digits [%"APR_SIZE_T_FMT"] Mismatches [%"APR_SIZE_T_FMT"] Single [%.2f nsec/sample] Batch [%.2f nsec/sample]",
+		channel_count,
+		digit_count,
+		mismatch_count,
+		(double)single_time * 1000 / (frame_count * channel_count * DTMF_FRAME_SAMPLES),
+		(double)batch_time * 1000 / (frame_count * channel_count * DTMF_FRAME_SAMPLES));
+	return mismatch_count ? FALSE : TRUE;
+}
+
+apt_test_suite_t* dtmf_test_suite_create(apr_pool_t *pool)
+{
+	apt_test_suite_t *suite = apt_test_suite_create(pool,"dtmf",NULL,dtmf_test_run);
+	return suite;
+}
@@ -0,0 +1,196 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <apr_thread_proc.h>
+#include "apt_test_suite.h"
+#include "apt_log.h"
+#include "mpf_frame_buffer.h"
+
+/** Size of a 10 msec frame of 8 kHz linear PCM */
+#define FRAME_BUFFER_FRAME_SIZE   160
+/** Number of frames the buffer holds */
+#define FRAME_BUFFER_FRAME_COUNT  20
+/** Default number of frames to stream */
+#define FRAME_BUFFER_TOTAL_COUNT  1000000
+
+typedef struct frame_buffer_test_t frame_buffer_test_t;
+
+/** Frame buffer test */
+struct frame_buffer_test_t {
+	mpf_frame_buffer_t *buffer;
+	apr_uint32_t        total_count;
+};
+
+/** Writer thread, fills the frame slots in place as a streaming ASR application would */
+static void* APR_THREAD_FUNC frame_buffer_writer_run(apr_thread_t *thread, void *data)
+{
+	frame_buffer_test_t *test = data;
+	mpf_frame_t *frame;
+	apr_uint32_t seq = 0;
+
+	while(seq < test->total_count) {
+		frame = mpf_frame_buffer_frame_acquire(test->buffer);
+		if(!frame) {
+			/* buffer is full, let the reader run */
+			apr_thread_yield();
+			continue;
+		}
+		frame->type = MEDIA_FRAME_TYPE_AUDIO;
+		memset(frame->codec_frame.buffer,(apr_byte_t)seq,frame->codec_frame.size);
+		memcpy(frame->codec_frame.buffer,&seq,sizeof(seq));
+		mpf_frame_buffer_frame_commit(test->buffer);
+		seq++;
+	}
+	apr_thread_exit(thread,APR_SUCCESS);
+	return NULL;
+}
+
+/** Fill the buffer, restart it and check the writer may refill it at once and the reader gets the new frames only */
+static apt_bool_t frame_buffer_restart_test(apr_pool_t *pool)
+{
+	mpf_frame_buffer_t *buffer = mpf_frame_buffer_create(FRAME_BUFFER_FRAME_SIZE,FRAME_BUFFER_FRAME_COUNT,pool);
+	apr_byte_t data[FRAME_BUFFER_FRAME_SIZE];
+	mpf_frame_t frame;
+	apr_uint32_t seq;
+	apr_uint32_t value;
+
+	frame.type = MEDIA_FRAME_TYPE_AUDIO;
+	frame.marker = MPF_MARKER_NONE;
+	frame.codec_frame.buffer = data;
+	frame.codec_frame.size = FRAME_BUFFER_FRAME_SIZE;
+
+	for(seq=0; seq<FRAME_BUFFER_FRAME_COUNT; seq++) {
+		frame.type = MEDIA_FRAME_TYPE_AUDIO;
+		frame.codec_frame.size = FRAME_BUFFER_FRAME_SIZE;
+		memcpy(data,&seq,sizeof(seq));
+		if(mpf_frame_buffer_write(buffer,&frame) != TRUE) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Write Frame [%u] before Restart",seq);
+			return FALSE;
+		}
+	}
+	if(mpf_frame_buffer_write(buffer,&frame) == TRUE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Frame Written to Full Buffer");
+		return FALSE;
+	}
+
+	/* the writer must not wait for the reader to skip the dropped frames */
+	mpf_frame_buffer_restart(buffer);
+	for(seq=FRAME_BUFFER_FRAME_COUNT; seq<2*FRAME_BUFFER_FRAME_COUNT; seq++) {
+		frame.type = MEDIA_FRAME_TYPE_AUDIO;
+		frame.codec_frame.size = FRAME_BUFFER_FRAME_SIZE;
+		memcpy(data,&seq,sizeof(seq));
+		if(mpf_frame_buffer_write(buffer,&frame) != TRUE) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Write Frame [%u] after Restart",seq);
+			return FALSE;
+		}
+	}
+
+	for(seq=FRAME_BUFFER_FRAME_COUNT; seq<2*FRAME_BUFFER_FRAME_COUNT; seq++) {
+		frame.codec_frame.size = FRAME_BUFFER_FRAME_SIZE;
+		mpf_frame_buffer_read(buffer,&frame);
+		memcpy(&value,data,sizeof(value));
+		if(frame.type != MEDIA_FRAME_TYPE_AUDIO || value != seq) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unexpected Frame after Restart [%u]",seq);
+			return FALSE;
+		}
+	}
+	mpf_frame_buffer_read(buffer,&frame);
+	if(frame.type != MEDIA_FRAME_TYPE_NONE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Frame Read from Empty Buffer");
+		return FALSE;
+	}
+
+	mpf_frame_buffer_destroy(buffer);
+	return TRUE;
+}
+
+/** Stream frames from the writer thread to the reader and check no frame is lost, reordered or torn */
+static apt_bool_t frame_buffer_test_run(apt_test_suite_t *suite, int argc, const char * const *argv)
+{
+	frame_buffer_test_t test;
+	apr_thread_t *thread;
+	apr_status_t retval;
+	apr_byte_t data[FRAME_BUFFER_FRAME_SIZE];
+	mpf_frame_t frame;
+	apr_uint32_t seq = 0;
+	apr_uint32_t value;
+	apr_size_t i;
+	apr_size_t mismatch_count = 0;
+	apr_time_t start;
+	apr_time_t elapsed_time;
+
+	test.total_count = FRAME_BUFFER_TOTAL_COUNT;
+	if(argc > 0) {
+		/* the number of frames to stream */
+		test.total_count = atol(argv[0]);
+	}
+	if(frame_buffer_restart_test(suite->pool) == FALSE) {
+		return FALSE;
+	}
+
+	test.buffer = mpf_frame_buffer_create(FRAME_BUFFER_FRAME_SIZE,FRAME_BUFFER_FRAME_COUNT,suite->pool);
+
+	start = apr_time_now();
+	if(apr_thread_create(&thread,NULL,frame_buffer_writer_run,&test,suite->pool) != APR_SUCCESS) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Create Writer Thread");
+		return FALSE;
+	}
+
+	frame.codec_frame.buffer = data;
+	while(seq < test.total_count) {
+		frame.codec_frame.size = FRAME_BUFFER_FRAME_SIZE;
+		mpf_frame_buffer_read(test.buffer,&frame);
+		if(frame.type == MEDIA_FRAME_TYPE_NONE) {
+			/* buffer is empty, let the writer run */
+			apr_thread_yield();
+			continue;
+		}
+
+		memcpy(&value,data,sizeof(value));
+		if(value != seq || frame.codec_frame.size != FRAME_BUFFER_FRAME_SIZE) {
+			mismatch_count++;
+		}
+		else {
+			for(i=sizeof(value); i<FRAME_BUFFER_FRAME_SIZE; i++) {
+				if(data[i] != (apr_byte_t)seq) {
+					mismatch_count++;
+					break;
+				}
+			}
+		}
+		seq++;
+	}
+	elapsed_time = apr_time_now() - start;
+	apr_thread_join(&retval,thread);
+
+	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Frames [%u] Elapsed [%.1f nsec/frame]",
+		test.total_count,
+		(double)elapsed_time * 1000 / test.total_count);
+
+	mpf_frame_buffer_destroy(test.buffer);
+	if(mismatch_count) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Frames Lost or Torn [%"APR_SIZE_T_FMT"]",mismatch_count);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+apt_test_suite_t* frame_buffer_test_suite_create(apr_pool_t *pool)
+{
+	apt_test_suite_t *suite = apt_test_suite_create(pool,"frame-buffer",NULL,frame_buffer_test_run);
+	return suite;
+}
@@ -0,0 +1,145 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include "apt_test_suite.h"
+#include "apt_log.h"
+#include "mpf_g711_kernel.h"
+
+/** Number of samples in a 20 msec frame at 8 kHz */
+#define G711_FRAME_SAMPLES   160
+/** Default number of frames to convert per kernel and direction */
+#define G711_FRAME_COUNT     200000
+/** Number of all 16-bit linear samples */
+#define G711_LINEAR_COUNT    65536
+
+/** Check the kernel against the scalar one over all the possible input values */
+static apt_bool_t g711_kernel_verify(const mpf_g711_kernel_t *kernel, const mpf_g711_kernel_t *reference, apr_pool_t *pool)
+{
+	apr_size_t i;
+	apr_int16_t *linear = apr_palloc(pool,sizeof(apr_int16_t) * G711_LINEAR_COUNT);
+	apr_int16_t *linear_ref = apr_palloc(pool,sizeof(apr_int16_t) * G711_LINEAR_COUNT);
+	apr_byte_t *encoded = apr_palloc(pool,G711_LINEAR_COUNT);
+	apr_byte_t *encoded_ref = apr_palloc(pool,G711_LINEAR_COUNT);
+
+	for(i=0; i<G711_LINEAR_COUNT; i++) {
+		linear[i] = (apr_int16_t)i;
+	}
+
+	kernel->ulaw_encode(linear,encoded,G711_LINEAR_COUNT);
+	reference->ulaw_encode(linear,encoded_ref,G711_LINEAR_COUNT);
+	if(memcmp(encoded,encoded_ref,G711_LINEAR_COUNT) != 0) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Mismatch of u-law Encoder [%s]",kernel->name);
+		return FALSE;
+	}
+	kernel->alaw_encode(linear,encoded,G711_LINEAR_COUNT);
+	reference->alaw_encode(linear,encoded_ref,G711_LINEAR_COUNT);
+	if(memcmp(encoded,encoded_ref,G711_LINEAR_COUNT) != 0) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Mismatch of A-law Encoder [%s]",kernel->name);
+		return FALSE;
+	}
+
+	/* walk through all the encoded values */
+	for(i=0; i<G711_LINEAR_COUNT; i++) {
+		encoded[i] = (apr_byte_t)i;
+	}
+	kernel->alaw_decode(encoded,linear,G711_LINEAR_COUNT);
+	reference->alaw_decode(encoded,linear_ref,G711_LINEAR_COUNT);
+	if(memcmp(linear,linear_ref,sizeof(apr_int16_t) * G711_LINEAR_COUNT) != 0) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Mismatch of A-law Decoder [%s]",kernel->name);
+		return FALSE;
+	}
+	kernel->ulaw_decode(encoded,linear,G711_LINEAR_COUNT);
+	reference->ulaw_decode(encoded,linear_ref,G711_LINEAR_COUNT);
+	if(memcmp(linear,linear_ref,sizeof(apr_int16_t) * G711_LINEAR_COUNT) != 0) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Mismatch of u-law Decoder [%s]",kernel->name);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/** Measure the time the kernel takes to convert frames of speech-like signal */
+static void g711_kernel_measure(const mpf_g711_kernel_t *kernel, apr_size_t frame_count)
+{
+	apr_size_t i;
+	apr_int16_t linear[G711_FRAME_SAMPLES];
+	apr_byte_t encoded[G711_FRAME_SAMPLES];
+	apr_time_t start;
+	apr_time_t encode_time;
+	apr_time_t decode_time;
+	apr_uint32_t seed = 1;
+
+	for(i=0; i<G711_FRAME_SAMPLES; i++) {
+		/* pseudo random samples spread over all the segments */
+		seed = seed * 1103515245 + 12345;
+		linear[i] = (apr_int16_t)((apr_int32_t)(seed >> 16) >> (seed & 0x7));
+	}
+
+	start = apr_time_now();
+	for(i=0; i<frame_count; i++) {
+		kernel->ulaw_encode(linear,encoded,G711_FRAME_SAMPLES);
+		kernel->alaw_encode(linear,encoded,G711_FRAME_SAMPLES);
+	}
+	encode_time = apr_time_now() - start;
+
+	start = apr_time_now();
+	for(i=0; i<frame_count; i++) {
+		kernel->ulaw_decode(encoded,linear,G711_FRAME_SAMPLES);
+		kernel->alaw_decode(encoded,linear,G711_FRAME_SAMPLES);
+	}
+	decode_time = apr_time_now() - start;
+
+	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"G.711 Kernel [%s] Encode [%.2f nsec/sample] Decode [%.2f nsec/sample]",
+		kernel->name,
+		(double)encode_time * 1000 / (frame_count * G711_FRAME_SAMPLES * 2),
+		(double)decode_time * 1000 / (frame_count * G711_FRAME_SAMPLES * 2));
+}
+
+static apt_bool_t g711_test_run(apt_test_suite_t *suite, int argc, const char * const *argv)
+{
+	int type;
+	apt_bool_t status = TRUE;
+	apr_size_t frame_count = G711_FRAME_COUNT;
+	const mpf_g711_kernel_t *kernel;
+	const mpf_g711_kernel_t *reference = mpf_g711_kernel_get(MPF_G711_KERNEL_SCALAR);
+
+	if(argc > 0) {
+		/* the number of frames to convert */
+		frame_count = atol(argv[0]);
+	}
+
+	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Default G.711 Kernel [%s]",mpf_g711_kernel_default_get()->name);
+	for(type=0; type<MPF_G711_KERNEL_COUNT; type++) {
+		kernel = mpf_g711_kernel_get(type);
+		if(!kernel) {
+			apt_log(APT_LOG_MARK,APT_PRIO_INFO,"G.711 Kernel [%d] Not Supported",type);
+			continue;
+		}
+
+		if(g711_kernel_verify(kernel,reference,suite->pool) == FALSE) {
+			status = FALSE;
+			continue;
+		}
+		g711_kernel_measure(kernel,frame_count);
+	}
+	return status;
+}
+
+apt_test_suite_t* g711_test_suite_create(apr_pool_t *pool)
+{
+	apt_test_suite_t *suite = apt_test_suite_create(pool,"g711",NULL,g711_test_run);
+	return suite;
+}
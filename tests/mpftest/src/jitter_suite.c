@@ -0,0 +1,229 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#define APR_WANT_BYTEFUNC
+#include <apr_want.h>
+#include "apt_test_suite.h"
+#include "apt_log.h"
+#include "mpf_jitter_buffer.h"
+
+/** Number of samples in a 20 msec frame at 8 kHz */
+#define JB_FRAME_SAMPLES       160
+/** Frame duration in msec */
+#define JB_FRAME_DURATION      20
+/** Default duration of the stream in seconds */
+#define JB_DURATION            60
+/** Max duration of the stream in seconds (frames are numbered by 14 bits) */
+#define JB_MAX_DURATION        300
+/** Number of frames in a talkspurt */
+#define JB_TALKSPURT_FRAMES    150
+/** Number of frames of silence (no packets) between talkspurts */
+#define JB_SILENCE_FRAMES      50
+/** Packet loss in percents */
+#define JB_LOSS_RATE           2
+/** Interval of network stalls in frames */
+#define JB_STALL_INTERVAL      400
+/** Duration of a network stall in frames, the packets are delivered at once after */
+#define JB_STALL_FRAMES        5
+
+/** Statistics of a stream played out */
+typedef struct jb_stat_t jb_stat_t;
+struct jb_stat_t {
+	/** Number of packets sent (not lost) */
+	apr_size_t sent_count;
+	/** Number of frames played out as sent */
+	apr_size_t played_count;
+	/** Number of frames played out concealed */
+	apr_size_t concealed_count;
+	/** Number of frames played out of order */
+	apr_size_t misorder_count;
+	/** Sum of the playout delays (msec) */
+	apr_size_t delay_sum;
+};
+
+mpf_codec_t* mpf_codec_l16_create(apr_pool_t *pool);
+
+/** Packet of the frame n is lost */
+static apt_bool_t jb_packet_lost(apr_size_t n)
+{
+	apr_uint32_t seed = (apr_uint32_t)n * 2654435761u;
+	seed ^= seed >> 16;
+	return (seed % 100) < JB_LOSS_RATE ? TRUE : FALSE;
+}
+
+/** Get the tick the packet of the frame n arrives at */
+static apr_size_t jb_packet_arrival_get(apr_size_t n)
+{
+	apr_uint32_t seed = (apr_uint32_t)n * 2246822519u;
+	/* most packets arrive in time, others on the next tick */
+	apr_size_t arrival = n + ((seed >> 13) & 1);
+	if(n % JB_STALL_INTERVAL < JB_STALL_FRAMES) {
+		/* the network stalls, then delivers the pending packets at once */
+		apr_size_t stall_end = n - n % JB_STALL_INTERVAL + JB_STALL_FRAMES;
+		if(arrival < stall_end) {
+			arrival = stall_end;
+		}
+	}
+	return arrival;
+}
+
+/** Packet of the frame n is sent */
+static apt_bool_t jb_packet_sent(apr_size_t n)
+{
+	if(n % (JB_TALKSPURT_FRAMES + JB_SILENCE_FRAMES) >= JB_TALKSPURT_FRAMES) {
+		return FALSE;
+	}
+	return jb_packet_lost(n) == TRUE ? FALSE : TRUE;
+}
+
+/** Play out the stream through the jitter buffer of the given mode */
+static apt_bool_t jb_stream_play(apr_byte_t adaptive, apr_byte_t plc, apr_size_t frame_count, jb_stat_t *stat, apr_pool_t *pool)
+{
+	apr_size_t t;
+	apr_size_t n;
+	apr_size_t i;
+	apr_uint16_t last_seq = 0;
+	apr_int16_t packet[JB_FRAME_SAMPLES];
+	apr_int16_t buffer[JB_FRAME_SAMPLES];
+	mpf_frame_t frame;
+	mpf_jitter_buffer_t *jb;
+	mpf_codec_t *codec = mpf_codec_l16_create(pool);
+	mpf_codec_descriptor_t *descriptor = mpf_codec_descriptor_create(pool);
+	mpf_jb_config_t *jb_config = apr_palloc(pool,sizeof(mpf_jb_config_t));
+
+	mpf_jb_config_init(jb_config);
+	jb_config->adaptive = adaptive;
+	jb_config->plc = plc;
+	jb_config->initial_playout_delay = 50;
+	jb_config->max_playout_delay = 600;
+
+	descriptor->sampling_rate = 8000;
+	descriptor->rtp_sampling_rate = 8000;
+	descriptor->channel_count = 1;
+	descriptor->frame_duration = JB_FRAME_DURATION;
+	jb = mpf_jitter_buffer_create(jb_config,descriptor,codec,pool);
+	if(!jb) {
+		return FALSE;
+	}
+
+	memset(stat,0,sizeof(jb_stat_t));
+	for(t=0; t<frame_count + JB_STALL_FRAMES + 2; t++) {
+		/* write the packets arriving on this tick */
+		for(n = t > JB_STALL_FRAMES + 1 ? t - JB_STALL_FRAMES - 1 : 0; n<=t && n<frame_count; n++) {
+			if(jb_packet_sent(n) == FALSE || jb_packet_arrival_get(n) != t) {
+				continue;
+			}
+			/* the first two samples carry the number of the frame, the second one is a check */
+			packet[0] = (apr_int16_t)htons((apr_uint16_t)(n + 1));
+			packet[1] = (apr_int16_t)htons((apr_uint16_t)(0x4000 | (n + 1)));
+			for(i=2; i<JB_FRAME_SAMPLES; i++) {
+				packet[i] = (apr_int16_t)htons(1000);
+			}
+			mpf_jitter_buffer_write(
+				jb,
+				packet,
+				sizeof(packet),
+				(apr_uint32_t)(n * JB_FRAME_SAMPLES),
+				n % (JB_TALKSPURT_FRAMES + JB_SILENCE_FRAMES) == 0 ? 1 : 0);
+			stat->sent_count++;
+		}
+
+		/* read a frame on every tick */
+		frame.type = MEDIA_FRAME_TYPE_NONE;
+		frame.marker = MPF_MARKER_NONE;
+		frame.codec_frame.buffer = buffer;
+		frame.codec_frame.size = sizeof(buffer);
+		mpf_jitter_buffer_read(jb,&frame);
+		if(frame.type & MEDIA_FRAME_TYPE_AUDIO) {
+			apr_uint16_t seq = ntohs(buffer[0]);
+			apr_uint16_t check = ntohs(buffer[1]);
+			if(check != (0x4000 | seq) || seq == last_seq) {
+				/* faded or repeated */
+				stat->concealed_count++;
+			}
+			else {
+				if(seq < last_seq) {
+					stat->misorder_count++;
+				}
+				last_seq = seq;
+				stat->played_count++;
+			}
+		}
+		stat->delay_sum += mpf_jitter_buffer_playout_delay_get(jb);
+	}
+
+	mpf_jitter_buffer_destroy(jb);
+	return TRUE;
+}
+
+static void jb_stat_log(const char *name, const jb_stat_t *stat, apr_size_t frame_count)
+{
+	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"JB %s Sent [%"APR_SIZE_T_FMT"] Played [%"APR_SIZE_T_FMT"] Concealed [%"APR_SIZE_T_FMT"] Misordered [%"APR_SIZE_T_FMT"] Mean Delay [%.1f msec]",
+		name,
+		stat->sent_count,
+		stat->played_count,
+		stat->concealed_count,
+		stat->misorder_count,
+		(double)stat->delay_sum / (frame_count + JB_STALL_FRAMES + 2));
+}
+
+/** Play out the same stream in the adaptive and the delay minimizing modes, and compare them */
+static apt_bool_t jb_test_run(apt_test_suite_t *suite, int argc, const char * const *argv)
+{
+	apr_size_t duration = JB_DURATION;
+	apr_size_t frame_count;
+	jb_stat_t adaptive;
+	jb_stat_t minimizing;
+
+	if(argc > 0) {
+		/* the duration of the stream in seconds */
+		duration = atol(argv[0]);
+	}
+	if(!duration || duration > JB_MAX_DURATION) {
+		return FALSE;
+	}
+	frame_count = duration * 1000 / JB_FRAME_DURATION;
+
+	if(jb_stream_play(1,0,frame_count,&adaptive,suite->pool) == FALSE ||
+		jb_stream_play(2,1,frame_count,&minimizing,suite->pool) == FALSE) {
+		return FALSE;
+	}
+
+	jb_stat_log("Adaptive",&adaptive,frame_count);
+	jb_stat_log("Minimizing",&minimizing,frame_count);
+
+	if(adaptive.misorder_count || minimizing.misorder_count) {
+		return FALSE;
+	}
+	if(adaptive.concealed_count || !minimizing.concealed_count) {
+		return FALSE;
+	}
+	/* the delay is lower, while the most of the packets are still played out */
+	if(minimizing.delay_sum >= adaptive.delay_sum) {
+		return FALSE;
+	}
+	if(minimizing.played_count * 100 < minimizing.sent_count * 95) {
+		return FALSE;
+	}
+	return TRUE;
+}
+
+apt_test_suite_t* jitter_test_suite_create(apr_pool_t *pool)
+{
+	apt_test_suite_t *suite = apt_test_suite_create(pool,"jitter",NULL,jb_test_run);
+	return suite;
+}
@@ -18,6 +18,13 @@
 #include "apt_log.h"
 
 apt_test_suite_t* mpf_suite_create(apr_pool_t *pool);
+apt_test_suite_t* g711_test_suite_create(apr_pool_t *pool);
+apt_test_suite_t* buffer_test_suite_create(apr_pool_t *pool);
+apt_test_suite_t* frame_buffer_test_suite_create(apr_pool_t *pool);
+apt_test_suite_t* dtmf_test_suite_create(apr_pool_t *pool);
+apt_test_suite_t* jitter_test_suite_create(apr_pool_t *pool);
+apt_test_suite_t* rtp_sender_test_suite_create(apr_pool_t *pool);
+apt_test_suite_t* mixer_test_suite_create(apr_pool_t *pool);
 
 int main(int argc, const char * const *argv)
 {
@@ -38,6 +45,27 @@ int main(int argc, const char * const *argv)
 	test_suite = mpf_suite_create(pool);
 	apt_test_framework_suite_add(test_framework,test_suite);
 
+	test_suite = g711_test_suite_create(pool);
+	apt_test_framework_suite_add(test_framework,test_suite);
+
+	test_suite = buffer_test_suite_create(pool);
+	apt_test_framework_suite_add(test_framework,test_suite);
+
+	test_suite = frame_buffer_test_suite_create(pool);
+	apt_test_framework_suite_add(test_framework,test_suite);
+
+	test_suite = dtmf_test_suite_create(pool);
+	apt_test_framework_suite_add(test_framework,test_suite);
+
+	test_suite = jitter_test_suite_create(pool);
+	apt_test_framework_suite_add(test_framework,test_suite);
+
+	test_suite = rtp_sender_test_suite_create(pool);
+	apt_test_framework_suite_add(test_framework,test_suite);
+
+	test_suite = mixer_test_suite_create(pool);
+	apt_test_framework_suite_add(test_framework,test_suite);
+
 	/* run tests */
 	apt_test_framework_run(test_framework,argc,argv);
 
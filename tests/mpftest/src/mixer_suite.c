@@ -0,0 +1,307 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include "apt_test_suite.h"
+#include "apt_log.h"
+#include "mpf_mixer.h"
+#include "mpf_stream.h"
+
+/** Default number of sources */
+#define MIXER_SOURCE_COUNT     8
+/** Default number of frames to mix */
+#define MIXER_FRAME_COUNT      1000
+/** Max number of samples in a frame */
+#define MIXER_FRAME_SAMPLES    320
+/** Amplitude of the loud sources, the mix of which is out of the range of samples */
+#define MIXER_LOUD_AMPLITUDE   30000
+/** Amplitude of the quiet sources, the mix of which is within the range of samples */
+#define MIXER_QUIET_AMPLITUDE  1000
+/** Max number of frames for the gain to recover after the loud mix */
+#define MIXER_RECOVERY_FRAMES  200
+
+/** Test source, which reads either noise or a constant signal */
+typedef struct mixer_source_t mixer_source_t;
+struct mixer_source_t {
+	/** Index of the source */
+	apr_size_t   index;
+	/** Seed of the noise, used unless the amplitude is set */
+	apr_uint32_t seed;
+	/** Amplitude of the constant signal, alternating its sign by sample */
+	apr_int16_t  amplitude;
+	/** Number of frames read */
+	apr_size_t   frame_count;
+	/** Last frame read, kept for the reference mix */
+	apr_int16_t  samples[MIXER_FRAME_SAMPLES];
+	/** Whether the last frame read has audio */
+	apt_bool_t   audio;
+};
+
+/** Test sink, which keeps the last frame written */
+typedef struct mixer_sink_t mixer_sink_t;
+struct mixer_sink_t {
+	/** Last frame written */
+	apr_int16_t  samples[MIXER_FRAME_SAMPLES];
+	/** Whether the last frame written has audio */
+	apt_bool_t   audio;
+};
+
+static apt_bool_t mixer_source_read(mpf_audio_stream_t *stream, mpf_frame_t *frame)
+{
+	mixer_source_t *source = stream->obj;
+	apr_int16_t *samples = frame->codec_frame.buffer;
+	apr_size_t count = frame->codec_frame.size / sizeof(apr_int16_t);
+	apr_size_t i;
+
+	/* every source but the first one skips a frame once in a while */
+	source->frame_count++;
+	source->audio = (source->index == 0 || source->frame_count % (source->index + 2) != 0) ? TRUE : FALSE;
+	if(source->audio == FALSE) {
+		return TRUE;
+	}
+
+	for(i=0; i<count; i++) {
+		if(source->amplitude) {
+			samples[i] = (i & 1) ? -source->amplitude : source->amplitude;
+		}
+		else {
+			source->seed = source->seed * 1103515245 + 12345;
+			samples[i] = (apr_int16_t)(source->seed >> 16);
+		}
+	}
+	memcpy(source->samples,samples,frame->codec_frame.size);
+	frame->type |= MEDIA_FRAME_TYPE_AUDIO;
+	return TRUE;
+}
+
+static apt_bool_t mixer_sink_write(mpf_audio_stream_t *stream, const mpf_frame_t *frame)
+{
+	mixer_sink_t *sink = stream->obj;
+	sink->audio = (frame->type & MEDIA_FRAME_TYPE_AUDIO) == MEDIA_FRAME_TYPE_AUDIO ? TRUE : FALSE;
+	memcpy(sink->samples,frame->codec_frame.buffer,frame->codec_frame.size);
+	return TRUE;
+}
+
+static const mpf_audio_stream_vtable_t mixer_source_vtable = {
+	NULL,
+	NULL,
+	NULL,
+	mixer_source_read,
+	NULL,
+	NULL,
+	NULL,
+	NULL
+};
+
+static const mpf_audio_stream_vtable_t mixer_sink_vtable = {
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	mixer_sink_write,
+	NULL
+};
+
+/** Create the mixer of the test sources and sink of linear PCM */
+static mpf_object_t* mixer_create(mixer_source_t *sources, apr_size_t source_count, mixer_sink_t *sink, apr_uint16_t sampling_rate, mpf_mixer_mode_e mode, apr_pool_t *pool)
+{
+	apr_size_t i;
+	mpf_audio_stream_t *sink_stream;
+	mpf_audio_stream_t **source_arr = apr_palloc(pool,sizeof(mpf_audio_stream_t*) * source_count);
+	for(i=0; i<source_count; i++) {
+		source_arr[i] = mpf_audio_stream_create(&sources[i],&mixer_source_vtable,mpf_source_stream_capabilities_create(pool),pool);
+		source_arr[i]->rx_descriptor = mpf_codec_lpcm_descriptor_create(sampling_rate,1,CODEC_FRAME_TIME_BASE,pool);
+	}
+	sink_stream = mpf_audio_stream_create(sink,&mixer_sink_vtable,mpf_sink_stream_capabilities_create(pool),pool);
+	sink_stream->tx_descriptor = mpf_codec_lpcm_descriptor_create(sampling_rate,1,CODEC_FRAME_TIME_BASE,pool);
+	return mpf_mixer_create_ex(source_arr,source_count,sink_stream,NULL,mode,"Test Mixer",pool);
+}
+
+/** Mix the last frames of the sources with audio in 32 bits and saturate the sums, as a scalar reference */
+static apt_bool_t mixer_reference_mix(const mixer_source_t *sources, apr_size_t source_count, apr_int16_t *samples, apr_size_t count)
+{
+	apr_size_t i;
+	apr_size_t k;
+	apr_int32_t sum;
+	apt_bool_t audio = FALSE;
+	for(i=0; i<count; i++) {
+		sum = 0;
+		for(k=0; k<source_count; k++) {
+			if(sources[k].audio == TRUE) {
+				sum += sources[k].samples[i];
+				audio = TRUE;
+			}
+		}
+		if(sum > 32767) sum = 32767;
+		else if(sum < -32768) sum = -32768;
+		samples[i] = (apr_int16_t)sum;
+	}
+	return audio;
+}
+
+/** Check the mix of noise matches the scalar reference, which clips the sums instead of wrapping them around */
+static apt_bool_t mixer_saturate_test(apr_size_t source_count, apr_size_t frame_count, apr_uint16_t sampling_rate, apr_pool_t *pool)
+{
+	apr_size_t i;
+	apr_size_t n;
+	apr_size_t count = sampling_rate * CODEC_FRAME_TIME_BASE / 1000;
+	apr_size_t clip_count = 0;
+	apr_int16_t expected[MIXER_FRAME_SAMPLES];
+	apt_bool_t audio;
+	mixer_sink_t sink;
+	mpf_object_t *mixer;
+	mixer_source_t *sources = apr_pcalloc(pool,sizeof(mixer_source_t) * source_count);
+	for(i=0; i<source_count; i++) {
+		sources[i].index = i;
+		sources[i].seed = (apr_uint32_t)i + 1;
+	}
+
+	mixer = mixer_create(sources,source_count,&sink,sampling_rate,MPF_MIXER_MODE_SATURATE,pool);
+	if(!mixer) {
+		return FALSE;
+	}
+
+	for(n=0; n<frame_count; n++) {
+		mpf_object_process(mixer);
+		audio = mixer_reference_mix(sources,source_count,expected,count);
+
+		if(sink.audio != audio || memcmp(sink.samples,expected,count * sizeof(apr_int16_t)) != 0) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Mismatch of Mix Frame [%"APR_SIZE_T_FMT"] Rate [%d]",n,sampling_rate);
+			mpf_object_destroy(mixer);
+			return FALSE;
+		}
+		for(i=0; i<count; i++) {
+			if(expected[i] == 32767 || expected[i] == -32768) {
+				clip_count++;
+			}
+		}
+	}
+	mpf_object_destroy(mixer);
+
+	if(source_count > 1 && !clip_count) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"No Samples Clipped");
+		return FALSE;
+	}
+	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Mix Sources [%"APR_SIZE_T_FMT"] Rate [%d] Frames [%"APR_SIZE_T_FMT"] Clipped [%"APR_SIZE_T_FMT"]",
+		source_count,
+		sampling_rate,
+		frame_count,
+		clip_count);
+	return TRUE;
+}
+
+/** Check the loud mix is attenuated at once without clipping, and the gain recovers gradually for the quiet one */
+static apt_bool_t mixer_normalize_test(apr_pool_t *pool)
+{
+	apr_size_t i;
+	apr_size_t n;
+	apr_size_t count = 8000 * CODEC_FRAME_TIME_BASE / 1000;
+	apr_int16_t level;
+	apr_int16_t prev_level;
+	mixer_sink_t sink;
+	mixer_source_t sources[2];
+	mpf_object_t *mixer;
+
+	/* the index of the second source is large enough for it to read every frame of the test */
+	memset(sources,0,sizeof(sources));
+	sources[0].amplitude = MIXER_LOUD_AMPLITUDE;
+	sources[1].index = 2 * MIXER_RECOVERY_FRAMES;
+	sources[1].amplitude = MIXER_LOUD_AMPLITUDE;
+	mixer = mixer_create(sources,2,&sink,8000,MPF_MIXER_MODE_NORMALIZE,pool);
+	if(!mixer) {
+		return FALSE;
+	}
+
+	mpf_object_process(mixer);
+	for(i=0; i<count; i++) {
+		apr_int16_t expected = (i & 1) ? -32767 : 32767;
+		if(sink.samples[i] < expected - 1 || sink.samples[i] > expected + 1) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Loud Mix Not Attenuated [%d]",sink.samples[i]);
+			mpf_object_destroy(mixer);
+			return FALSE;
+		}
+	}
+
+	/* the mix of two quiet sources is within the range, the gain goes up frame by frame */
+	sources[0].amplitude = MIXER_QUIET_AMPLITUDE;
+	sources[1].amplitude = MIXER_QUIET_AMPLITUDE;
+	prev_level = 0;
+	for(n=0; n<MIXER_RECOVERY_FRAMES; n++) {
+		mpf_object_process(mixer);
+		level = sink.samples[0];
+		if(level < prev_level || level > 2 * MIXER_QUIET_AMPLITUDE || sink.samples[1] != -level) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unexpected Level [%d] after [%d]",level,prev_level);
+			break;
+		}
+		if(n == 0 && level == 2 * MIXER_QUIET_AMPLITUDE) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Gain Recovered at Once");
+			break;
+		}
+		if(level == 2 * MIXER_QUIET_AMPLITUDE) {
+			apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Gain Recovered in [%"APR_SIZE_T_FMT"] frames",n + 1);
+			break;
+		}
+		prev_level = level;
+	}
+	mpf_object_destroy(mixer);
+	return (n < MIXER_RECOVERY_FRAMES && level == 2 * MIXER_QUIET_AMPLITUDE) ? TRUE : FALSE;
+}
+
+static apt_bool_t mixer_test_run(apt_test_suite_t *suite, int argc, const char * const *argv)
+{
+	/* 11025 Hz leaves a tail of a frame, which is not a multiple of the vector size */
+	static const apr_uint16_t rates[] = {8000, 11025, 16000};
+	apr_size_t source_count = MIXER_SOURCE_COUNT;
+	apr_size_t frame_count = MIXER_FRAME_COUNT;
+	apr_size_t i;
+	apr_size_t k;
+
+	if(argc > 0) {
+		/* the number of sources */
+		source_count = atol(argv[0]);
+	}
+	if(argc > 1) {
+		/* the number of frames */
+		frame_count = atol(argv[1]);
+	}
+	if(!source_count) {
+		return FALSE;
+	}
+
+	for(i=0; i<sizeof(rates)/sizeof(rates[0]); i++) {
+		/* mix odd and even numbers of sources, which are summed by pairs */
+		for(k=1; k<=source_count; k++) {
+			if(mixer_saturate_test(k,frame_count,rates[i],suite->pool) == FALSE) {
+				apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Mixer Saturate Test Failed");
+				return FALSE;
+			}
+		}
+	}
+
+	if(mixer_normalize_test(suite->pool) == FALSE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Mixer Normalize Test Failed");
+		return FALSE;
+	}
+	return TRUE;
+}
+
+apt_test_suite_t* mixer_test_suite_create(apr_pool_t *pool)
+{
+	apt_test_suite_t *suite = apt_test_suite_create(pool,"mixer",NULL,mixer_test_run);
+	return suite;
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <apr_network_io.h>
+#include "apt_test_suite.h"
+#include "apt_log.h"
+#include "mpf_rtp_sender.h"
+
+/** Size of RTP header without CSRC */
+#define RTP_SENDER_HEADER_SIZE   12
+/** Size of L16 packet at 16 kHz with 60 msec ptime, larger than the default max size */
+#define RTP_SENDER_PACKET_SIZE   (RTP_SENDER_HEADER_SIZE + 16 * 60 * 2)
+/** Number of packets sent at once */
+#define RTP_SENDER_BATCH_SIZE    3
+/** Max time to wait for a packet */
+#define RTP_SENDER_TIMEOUT       (apr_time_from_sec(1))
+
+/** Create UDP socket bound to an ephemeral loopback port */
+static apr_socket_t* rtp_sender_socket_create(apr_sockaddr_t **sockaddr, apr_pool_t *pool)
+{
+	apr_socket_t *socket;
+	apr_sockaddr_t *l_sockaddr;
+	if(apr_sockaddr_info_get(&l_sockaddr,"127.0.0.1",APR_INET,0,0,pool) != APR_SUCCESS) {
+		return NULL;
+	}
+	if(apr_socket_create(&socket,APR_INET,SOCK_DGRAM,APR_PROTO_UDP,pool) != APR_SUCCESS) {
+		return NULL;
+	}
+	if(apr_socket_bind(socket,l_sockaddr) != APR_SUCCESS ||
+		apr_socket_addr_get(sockaddr,APR_LOCAL,socket) != APR_SUCCESS) {
+		apr_socket_close(socket);
+		return NULL;
+	}
+	apr_socket_timeout_set(socket,RTP_SENDER_TIMEOUT);
+	return socket;
+}
+
+/** Fill the packet i with a pattern to verify on receipt */
+static void rtp_sender_packet_fill(char *data, apr_size_t size, apr_size_t i)
+{
+	apr_size_t j;
+	for(j=0; j<size; j++) {
+		data[j] = (char)(i + j);
+	}
+}
+
+/** Check the packets larger than the default max size are batched by the sender sized for them */
+static apt_bool_t rtp_sender_large_packet_test(apr_socket_t *tx_socket, apr_socket_t *rx_socket, apr_sockaddr_t *rx_sockaddr, apr_pool_t *pool)
+{
+	char data[RTP_SENDER_PACKET_SIZE];
+	char received[RTP_SENDER_PACKET_SIZE + 1];
+	apr_size_t packet_count = 0;
+	apr_size_t octet_count = 0;
+	apr_size_t size;
+	apr_size_t i;
+	mpf_rtp_sender_t *sender;
+
+	/* the default max size is too small for the packet, which is left to the caller to send */
+	sender = mpf_rtp_sender_create(RTP_SENDER_BATCH_SIZE,0,0,pool);
+	rtp_sender_packet_fill(data,sizeof(data),0);
+	if(mpf_rtp_sender_packet_add(sender,tx_socket,rx_sockaddr,data,sizeof(data)) == TRUE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Packet [%d bytes] Exceeding Max Size Queued",RTP_SENDER_PACKET_SIZE);
+		return FALSE;
+	}
+
+	sender = mpf_rtp_sender_create(RTP_SENDER_BATCH_SIZE,RTP_SENDER_PACKET_SIZE,0,pool);
+	for(i=0; i<RTP_SENDER_BATCH_SIZE; i++) {
+		rtp_sender_packet_fill(data,sizeof(data),i);
+		if(mpf_rtp_sender_packet_add(sender,tx_socket,rx_sockaddr,data,sizeof(data)) == FALSE) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Queue Packet [%d bytes]",RTP_SENDER_PACKET_SIZE);
+			return FALSE;
+		}
+	}
+	if(mpf_rtp_sender_is_full(sender) == FALSE) {
+		return FALSE;
+	}
+	mpf_rtp_sender_flush(sender,&packet_count,&octet_count);
+	if(packet_count != RTP_SENDER_BATCH_SIZE || octet_count != RTP_SENDER_BATCH_SIZE * RTP_SENDER_PACKET_SIZE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Sent [%"APR_SIZE_T_FMT" packets %"APR_SIZE_T_FMT" octets]",
+			packet_count,octet_count);
+		return FALSE;
+	}
+
+	for(i=0; i<RTP_SENDER_BATCH_SIZE; i++) {
+		size = sizeof(received);
+		if(apr_socket_recv(rx_socket,received,&size) != APR_SUCCESS) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Receive Packet [%"APR_SIZE_T_FMT"]",i);
+			return FALSE;
+		}
+		rtp_sender_packet_fill(data,sizeof(data),i);
+		if(size != RTP_SENDER_PACKET_SIZE || memcmp(received,data,size) != 0) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unexpected Packet [%"APR_SIZE_T_FMT"] Received",i);
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+static apt_bool_t rtp_sender_test_run(apt_test_suite_t *suite, int argc, const char * const *argv)
+{
+	apt_bool_t status;
+	apr_sockaddr_t *tx_sockaddr;
+	apr_sockaddr_t *rx_sockaddr;
+	apr_socket_t *tx_socket;
+	apr_socket_t *rx_socket;
+
+	tx_socket = rtp_sender_socket_create(&tx_sockaddr,suite->pool);
+	if(!tx_socket) {
+		return FALSE;
+	}
+	rx_socket = rtp_sender_socket_create(&rx_sockaddr,suite->pool);
+	if(!rx_socket) {
+		apr_socket_close(tx_socket);
+		return FALSE;
+	}
+
+	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Batch Send by Single System Call [%s]",
+		mpf_rtp_sender_is_supported() == TRUE ? "yes" : "no");
+	status = rtp_sender_large_packet_test(tx_socket,rx_socket,rx_sockaddr,suite->pool);
+
+	apr_socket_close(rx_socket);
+	apr_socket_close(tx_socket);
+	return status;
+}
+
+apt_test_suite_t* rtp_sender_test_suite_create(apr_pool_t *pool)
+{
+	apt_test_suite_t *suite = apt_test_suite_create(pool,"rtp-sender",NULL,rtp_sender_test_run);
+	return suite;
+}
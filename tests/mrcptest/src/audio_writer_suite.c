@@ -0,0 +1,205 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <apr_file_io.h>
+#include "apt_test_suite.h"
+#include "apt_log.h"
+#include "mrcp_audio_writer.h"
+
+/** Default file to write, relative to the working directory */
+#define AUDIO_WRITER_FILE_PATH   "audio-writer-test.wav"
+/** Size of each of the two buffers, a multiple of the frame size */
+#define AUDIO_WRITER_BUFFER_SIZE 3200
+/** Size of each of the two buffers, which leaves frames split between the buffers */
+#define AUDIO_WRITER_ODD_BUFFER_SIZE 3000
+/** Size of 10 msec frame of 8kHz linear PCM */
+#define AUDIO_WRITER_FRAME_SIZE  160
+/** Number of frames to write, several buffers in total */
+#define AUDIO_WRITER_FRAME_COUNT 100
+/** Size of canonical WAV header */
+#define AUDIO_WRITER_HEADER_SIZE 44
+/** Max time to wait for the I/O thread in msec */
+#define AUDIO_WRITER_TIMEOUT     5000
+
+/** Write the frames, waiting for the I/O thread to drain the buffers instead of dropping the audio */
+static apt_bool_t audio_writer_frames_write(mrcp_audio_file_t *file)
+{
+	apr_byte_t frame[AUDIO_WRITER_FRAME_SIZE];
+	apr_size_t i;
+	apr_size_t timeout;
+
+	for(i=0; i<AUDIO_WRITER_FRAME_COUNT; i++) {
+		memset(frame,(int)i,sizeof(frame));
+		/* the frame is written as a whole or dropped, then written again */
+		for(timeout = 0; mrcp_audio_file_write(file,frame,sizeof(frame)) == FALSE; timeout++) {
+			if(timeout == AUDIO_WRITER_TIMEOUT) {
+				return FALSE;
+			}
+			apr_sleep(1000);
+		}
+	}
+	return TRUE;
+}
+
+/** Get little-endian 32-bit field of WAV header */
+static apr_uint32_t audio_writer_field_get(const apr_byte_t *data)
+{
+	return data[0] | (data[1] << 8) | (data[2] << 16) | ((apr_uint32_t)data[3] << 24);
+}
+
+/** Check the file has the WAV header with the actual sizes followed by all the frames written */
+static apt_bool_t audio_writer_file_verify(const char *file_path, apr_pool_t *pool)
+{
+	apr_file_t *fp;
+	apr_byte_t *data;
+	apr_size_t data_size = AUDIO_WRITER_FRAME_COUNT * AUDIO_WRITER_FRAME_SIZE;
+	apr_size_t size = AUDIO_WRITER_HEADER_SIZE + data_size;
+	apr_size_t read_size = 0;
+	apr_size_t i;
+	char extra;
+
+	if(apr_file_open(&fp,file_path,APR_FOPEN_READ | APR_FOPEN_BINARY,APR_OS_DEFAULT,pool) != APR_SUCCESS) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Open File [%s]",file_path);
+		return FALSE;
+	}
+	data = apr_palloc(pool,size);
+	apr_file_read_full(fp,data,size,&read_size);
+	i = 1;
+	if(apr_file_read(fp,&extra,&i) == APR_SUCCESS && i) {
+		read_size++;
+	}
+	apr_file_close(fp);
+
+	if(read_size != size) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unexpected Size of File [%s]",file_path);
+		return FALSE;
+	}
+	if(memcmp(data,"RIFF",4) != 0 ||
+		audio_writer_field_get(data+4) != data_size + 36 ||
+		memcmp(data+36,"data",4) != 0 ||
+		audio_writer_field_get(data+40) != data_size) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unexpected WAV Header of File [%s]",file_path);
+		return FALSE;
+	}
+	for(i=0; i<data_size; i++) {
+		if(data[AUDIO_WRITER_HEADER_SIZE + i] != (apr_byte_t)(i / AUDIO_WRITER_FRAME_SIZE)) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unexpected Audio of File [%s]",file_path);
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+/** Check the file is complete as soon as it is reported closed, as RECORD-COMPLETE relies on */
+static apt_bool_t audio_writer_close_test(mrcp_audio_writer_t *writer, const mpf_codec_descriptor_t *descriptor, const char *file_path, apr_pool_t *pool)
+{
+	apr_size_t timeout;
+	apt_bool_t status;
+	mrcp_audio_file_t *file = mrcp_audio_file_open(writer,file_path,descriptor);
+	if(!file) {
+		return FALSE;
+	}
+
+	status = audio_writer_frames_write(file);
+	mrcp_audio_file_close_begin(file);
+	for(timeout = 0; mrcp_audio_file_is_closed(file) == FALSE; timeout++) {
+		if(timeout == AUDIO_WRITER_TIMEOUT) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Timed out Waiting for File [%s] to Close",file_path);
+			status = FALSE;
+			break;
+		}
+		apr_sleep(1000);
+	}
+
+	if(status == TRUE) {
+		status = audio_writer_file_verify(file_path,pool);
+	}
+	mrcp_audio_file_release(file);
+	return status;
+}
+
+/** Check the file released before it is closed is still completed by the I/O thread */
+static apt_bool_t audio_writer_release_test(const mpf_codec_descriptor_t *descriptor, const char *file_path, apr_pool_t *pool)
+{
+	apt_bool_t status;
+	mrcp_audio_file_t *file;
+	mrcp_audio_writer_t *writer = mrcp_audio_writer_create(AUDIO_WRITER_BUFFER_SIZE,pool);
+	if(!writer) {
+		return FALSE;
+	}
+
+	file = mrcp_audio_file_open(writer,file_path,descriptor);
+	if(!file) {
+		mrcp_audio_writer_destroy(writer);
+		return FALSE;
+	}
+	status = audio_writer_frames_write(file);
+	mrcp_audio_file_close_begin(file);
+	mrcp_audio_file_release(file);
+
+	/* the files closed so far are flushed before the writer is destroyed */
+	mrcp_audio_writer_destroy(writer);
+	if(status == TRUE) {
+		status = audio_writer_file_verify(file_path,pool);
+	}
+	return status;
+}
+
+static apt_bool_t audio_writer_test_run(apt_test_suite_t *suite, int argc, const char * const *argv)
+{
+	static const apr_size_t buffer_sizes[] = {AUDIO_WRITER_BUFFER_SIZE, AUDIO_WRITER_ODD_BUFFER_SIZE};
+	const char *file_path = AUDIO_WRITER_FILE_PATH;
+	mpf_codec_descriptor_t *descriptor;
+	mrcp_audio_writer_t *writer;
+	apt_bool_t status;
+	apr_size_t i;
+
+	if(argc > 0) {
+		/* the file to write instead of the default one */
+		file_path = argv[0];
+	}
+
+	descriptor = mpf_codec_descriptor_create(suite->pool);
+	descriptor->sampling_rate = 8000;
+	descriptor->channel_count = 1;
+
+	for(i=0; i<sizeof(buffer_sizes)/sizeof(buffer_sizes[0]); i++) {
+		writer = mrcp_audio_writer_create(buffer_sizes[i],suite->pool);
+		if(!writer) {
+			return FALSE;
+		}
+		status = audio_writer_close_test(writer,descriptor,file_path,suite->pool);
+		mrcp_audio_writer_destroy(writer);
+		if(status == FALSE) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Audio Writer Close Test Failed Buffer [%"APR_SIZE_T_FMT" bytes]",buffer_sizes[i]);
+			return FALSE;
+		}
+	}
+
+	if(audio_writer_release_test(descriptor,file_path,suite->pool) == FALSE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Audio Writer Release Test Failed");
+		return FALSE;
+	}
+
+	apr_file_remove(file_path,suite->pool);
+	return TRUE;
+}
+
+apt_test_suite_t* audio_writer_test_suite_create(apr_pool_t *pool)
+{
+	apt_test_suite_t *suite = apt_test_suite_create(pool,"audio-writer",NULL,audio_writer_test_run);
+	return suite;
+}
@@ -0,0 +1,187 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <apr_thread_proc.h>
+#include <apr_network_io.h>
+#include "apt_test_suite.h"
+#include "apt_log.h"
+#include "mrcp_connection.h"
+
+/** Default size of the body, many times the size of the socket buffers */
+#define CONNECTION_BODY_SIZE    (256 * 1024)
+/** Size of the socket buffers, small enough for the body to be sent by many partial writes */
+#define CONNECTION_SOCKET_BUFFER_SIZE 4096
+/** Size of the chunks the receiver reads the message by */
+#define CONNECTION_RECV_SIZE    512
+/** Max time to wait for the socket to get ready */
+#define CONNECTION_TIMEOUT      (apr_time_from_sec(5))
+
+/** Sample header of the message */
+static const char connection_header[] =
+	"MRCP/2.0 000000 RECOGNITION-COMPLETE 1 IN-PROGRESS\r\n"
+	"Channel-Identifier: 32AECB23433801@speechrecog\r\n"
+	"Content-Type: application/nlsml+xml\r\n"
+	"\r\n";
+
+/** Receiver of the message on the other end of the connection */
+typedef struct connection_receiver_t connection_receiver_t;
+struct connection_receiver_t {
+	/** Accepted socket */
+	apr_socket_t *sock;
+	/** Buffer of the message received */
+	char         *buffer;
+	/** Size of the message expected */
+	apr_size_t    size;
+	/** Size of the message received */
+	apr_size_t    received;
+};
+
+static void* APR_THREAD_FUNC connection_receiver_run(apr_thread_t *thread, void *data)
+{
+	connection_receiver_t *receiver = data;
+	apr_size_t length;
+	while(receiver->received < receiver->size) {
+		length = receiver->size - receiver->received;
+		if(length > CONNECTION_RECV_SIZE) {
+			length = CONNECTION_RECV_SIZE;
+		}
+		if(apr_socket_recv(receiver->sock,receiver->buffer + receiver->received,&length) != APR_SUCCESS) {
+			break;
+		}
+		receiver->received += length;
+	}
+	apr_thread_exit(thread,APR_SUCCESS);
+	return NULL;
+}
+
+/** Connect the socket of the connection to the listening socket and accept the other end */
+static apt_bool_t connection_sockets_create(mrcp_connection_t *connection, apr_socket_t **accepted_sock, apr_pool_t *pool)
+{
+	apr_sockaddr_t *sockaddr;
+	apr_socket_t *listen_sock;
+	apt_bool_t status = FALSE;
+
+	if(apr_sockaddr_info_get(&sockaddr,"127.0.0.1",APR_INET,0,0,pool) != APR_SUCCESS) {
+		return FALSE;
+	}
+	if(apr_socket_create(&listen_sock,APR_INET,SOCK_STREAM,APR_PROTO_TCP,pool) != APR_SUCCESS) {
+		return FALSE;
+	}
+	if(apr_socket_bind(listen_sock,sockaddr) != APR_SUCCESS ||
+		apr_socket_listen(listen_sock,1) != APR_SUCCESS ||
+		apr_socket_addr_get(&sockaddr,APR_LOCAL,listen_sock) != APR_SUCCESS) {
+		apr_socket_close(listen_sock);
+		return FALSE;
+	}
+
+	if(apr_socket_create(&connection->sock,APR_INET,SOCK_STREAM,APR_PROTO_TCP,connection->pool) == APR_SUCCESS) {
+		apr_socket_opt_set(connection->sock,APR_SO_SNDBUF,CONNECTION_SOCKET_BUFFER_SIZE);
+		if(apr_socket_connect(connection->sock,sockaddr) == APR_SUCCESS &&
+			apr_socket_accept(accepted_sock,listen_sock,pool) == APR_SUCCESS) {
+			apr_socket_opt_set(*accepted_sock,APR_SO_RCVBUF,CONNECTION_SOCKET_BUFFER_SIZE);
+			/* with the timeout set, a write which does not fit the buffers is partial */
+			apr_socket_timeout_set(connection->sock,CONNECTION_TIMEOUT);
+			apr_socket_timeout_set(*accepted_sock,CONNECTION_TIMEOUT);
+			status = TRUE;
+		}
+		else {
+			apr_socket_close(connection->sock);
+			connection->sock = NULL;
+		}
+	}
+	apr_socket_close(listen_sock);
+	return status;
+}
+
+/** Check the header and the body larger than the socket buffers are received as a whole, in order */
+static apt_bool_t connection_message_send_test(mrcp_connection_t *connection, apr_socket_t *accepted_sock, apr_size_t body_size, apr_pool_t *pool)
+{
+	connection_receiver_t receiver;
+	apr_thread_t *thread;
+	apr_status_t retval;
+	apt_str_t header;
+	apt_str_t body;
+	apt_bool_t status;
+	apr_size_t i;
+
+	apt_string_assign_n(&header,connection_header,sizeof(connection_header) - 1,pool);
+	body.length = body_size;
+	body.buf = apr_palloc(pool,body_size);
+	for(i=0; i<body_size; i++) {
+		body.buf[i] = 'a' + (char)(i % 26);
+	}
+
+	receiver.sock = accepted_sock;
+	receiver.size = header.length + body.length;
+	receiver.buffer = apr_palloc(pool,receiver.size);
+	receiver.received = 0;
+	if(apr_thread_create(&thread,NULL,connection_receiver_run,&receiver,pool) != APR_SUCCESS) {
+		return FALSE;
+	}
+
+	status = mrcp_connection_message_send(connection,&header,&body);
+	apr_thread_join(&retval,thread);
+	if(status == FALSE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Send Message [%"APR_SIZE_T_FMT" bytes]",receiver.size);
+		return FALSE;
+	}
+
+	if(receiver.received != receiver.size ||
+		memcmp(receiver.buffer,header.buf,header.length) != 0 ||
+		memcmp(receiver.buffer + header.length,body.buf,body.length) != 0) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unexpected Message Received [%"APR_SIZE_T_FMT" of %"APR_SIZE_T_FMT" bytes]",
+			receiver.received,receiver.size);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+static apt_bool_t connection_test_run(apt_test_suite_t *suite, int argc, const char * const *argv)
+{
+	apr_size_t body_size = CONNECTION_BODY_SIZE;
+	apr_socket_t *accepted_sock;
+	mrcp_connection_t *connection;
+	apt_bool_t status;
+
+	if(argc > 0) {
+		/* the size of the body */
+		body_size = atol(argv[0]);
+	}
+
+	connection = mrcp_connection_create();
+	if(!connection) {
+		return FALSE;
+	}
+	if(connection_sockets_create(connection,&accepted_sock,suite->pool) == FALSE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Connect");
+		mrcp_connection_destroy(connection);
+		return FALSE;
+	}
+
+	status = connection_message_send_test(connection,accepted_sock,body_size,suite->pool);
+
+	apr_socket_close(accepted_sock);
+	apr_socket_close(connection->sock);
+	mrcp_connection_destroy(connection);
+	return status;
+}
+
+apt_test_suite_t* connection_test_suite_create(apr_pool_t *pool)
+{
+	apt_test_suite_t *suite = apt_test_suite_create(pool,"mrcp-connection",NULL,connection_test_run);
+	return suite;
+}
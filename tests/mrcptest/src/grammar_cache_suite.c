@@ -0,0 +1,292 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "apt_test_suite.h"
+#include "apt_log.h"
+#include "mrcp_grammar_cache.h"
+
+/** Max size of the cache small enough to evict every grammar not in use */
+#define GRAMMAR_CACHE_TINY_SIZE 1
+
+/** Sample grammar, the content type and the content are hashed together */
+typedef struct grammar_sample_t grammar_sample_t;
+struct grammar_sample_t {
+	const char *content_type;
+	const char *content;
+};
+
+/** Owner of the handles attached by the test */
+static const char grammar_owner[] = "test";
+
+/** Destroy the handle, which counts the times it is destroyed */
+static void grammar_handle_destroy(void *handle)
+{
+	(*(int*)handle)++;
+}
+
+/** Acquire the sample grammar */
+static mrcp_grammar_t* grammar_acquire(mrcp_grammar_cache_t *cache, const grammar_sample_t *sample)
+{
+	apt_str_t content_type;
+	apt_str_t content;
+	apt_string_set(&content_type,sample->content_type);
+	apt_string_set(&content,sample->content);
+	return mrcp_grammar_cache_acquire(cache,&content_type,&content,NULL);
+}
+
+/** Check the grammar is cached (the same one with the handle attached), keep it acquired */
+static apt_bool_t grammar_cached_check(mrcp_grammar_cache_t *cache, const grammar_sample_t *sample, mrcp_grammar_t *grammar, int *handle)
+{
+	mrcp_grammar_t *cached = grammar_acquire(cache,sample);
+	if(cached != grammar || mrcp_grammar_handle_get(cached,grammar_owner) != handle) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Grammar [%s] Not Cached",sample->content_type);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/** Check the lookups, the digest and the handles attached */
+static apt_bool_t grammar_hit_miss_test(apr_pool_t *pool)
+{
+	static const grammar_sample_t srgs = {"application/srgs+xml","<grammar/>"};
+	static const grammar_sample_t gsl = {"application/x-nuance-gsl","<grammar/>"};
+	int handle = 0;
+	int other_handle = 0;
+	apt_bool_t status = FALSE;
+	mrcp_grammar_t *grammar;
+	mrcp_grammar_t *other;
+	mrcp_grammar_cache_t *cache = mrcp_grammar_cache_create(0,0,pool);
+
+	grammar = grammar_acquire(cache,&srgs);
+	other = grammar_acquire(cache,&gsl);
+	if(!grammar || !other || grammar == other || strcmp(grammar->digest,other->digest) == 0) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Same Content of Another Type Not Told Apart");
+		goto exit;
+	}
+	if(strlen(grammar->digest) != MRCP_GRAMMAR_DIGEST_LENGTH) {
+		goto exit;
+	}
+
+	if(mrcp_grammar_handle_get(grammar,grammar_owner) ||
+		mrcp_grammar_handle_attach(grammar,grammar_owner,&handle,grammar_handle_destroy) != &handle) {
+		goto exit;
+	}
+	/* the handle attached first is kept */
+	if(mrcp_grammar_handle_attach(grammar,grammar_owner,&other_handle,grammar_handle_destroy) != &handle) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Handle Attached Twice");
+		goto exit;
+	}
+	if(grammar_cached_check(cache,&srgs,grammar,&handle) == FALSE) {
+		goto exit;
+	}
+	mrcp_grammar_cache_release(cache,grammar);
+	status = TRUE;
+exit:
+	if(grammar) {
+		mrcp_grammar_cache_release(cache,grammar);
+	}
+	if(other) {
+		mrcp_grammar_cache_release(cache,other);
+	}
+	mrcp_grammar_cache_destroy(cache);
+	if(status == TRUE && (handle != 1 || other_handle != 0)) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Handle Destroyed [%d] times on Cache Destroy",handle);
+		status = FALSE;
+	}
+	return status;
+}
+
+/** Check the grammars of the same hash are chained, and stay found once one of them is evicted */
+static apt_bool_t grammar_collision_test(apr_pool_t *pool)
+{
+	/* the content type and the content are hashed as "a\nb\nc\nd" for all the samples */
+	static const grammar_sample_t samples[] = {
+		{"a","b\nc\nd"},
+		{"a\nb","c\nd"},
+		{"a\nb\nc","d"}
+	};
+	enum { a, b, c, count };
+	mrcp_grammar_t *grammars[count];
+	int handles[count] = {0};
+	apt_bool_t status = TRUE;
+	int i;
+	/* the grammars in use are kept beyond the limit */
+	mrcp_grammar_cache_t *cache = mrcp_grammar_cache_create(0,count-1,pool);
+
+	for(i=0; i<count; i++) {
+		grammars[i] = grammar_acquire(cache,&samples[i]);
+		mrcp_grammar_handle_attach(grammars[i],grammar_owner,&handles[i],grammar_handle_destroy);
+		if(i && strcmp(grammars[i]->digest,grammars[0]->digest) != 0) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Samples Not Colliding");
+			status = FALSE;
+		}
+	}
+	for(i=0; i<count && status == TRUE; i++) {
+		status = grammar_cached_check(cache,&samples[i],grammars[i],&handles[i]);
+		mrcp_grammar_cache_release(cache,grammars[i]);
+	}
+	if(status == FALSE) {
+		goto exit;
+	}
+
+	/* evict the last added grammar, which is the first one of the chain */
+	mrcp_grammar_cache_release(cache,grammars[c]);
+	if(handles[c] != 1 ||
+		grammar_cached_check(cache,&samples[a],grammars[a],&handles[a]) == FALSE ||
+		grammar_cached_check(cache,&samples[b],grammars[b],&handles[b]) == FALSE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Chain Broken by Eviction of First Grammar");
+		status = FALSE;
+	}
+	mrcp_grammar_cache_release(cache,grammars[a]);
+	mrcp_grammar_cache_release(cache,grammars[b]);
+	if(status == FALSE) {
+		goto exit;
+	}
+
+	/* add the grammar again, then evict the one in the middle of the chain */
+	handles[c] = 0;
+	grammars[c] = grammar_acquire(cache,&samples[c]);
+	mrcp_grammar_handle_attach(grammars[c],grammar_owner,&handles[c],grammar_handle_destroy);
+	mrcp_grammar_cache_release(cache,grammars[b]);
+	if(handles[b] != 1 ||
+		grammar_cached_check(cache,&samples[a],grammars[a],&handles[a]) == FALSE ||
+		grammar_cached_check(cache,&samples[c],grammars[c],&handles[c]) == FALSE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Chain Broken by Eviction of Middle Grammar");
+		status = FALSE;
+	}
+	mrcp_grammar_cache_release(cache,grammars[a]);
+	mrcp_grammar_cache_release(cache,grammars[c]);
+	mrcp_grammar_cache_release(cache,grammars[a]);
+	mrcp_grammar_cache_release(cache,grammars[c]);
+exit:
+	mrcp_grammar_cache_destroy(cache);
+	return status;
+}
+
+/** Check the least recently used grammar is evicted by the count limit */
+static apt_bool_t grammar_lru_test(apr_pool_t *pool)
+{
+	static const grammar_sample_t samples[] = {
+		{"application/srgs+xml","<grammar>x</grammar>"},
+		{"application/srgs+xml","<grammar>y</grammar>"},
+		{"application/srgs+xml","<grammar>z</grammar>"}
+	};
+	enum { x, y, z, count };
+	mrcp_grammar_t *grammars[count];
+	int handles[count] = {0};
+	apt_bool_t status = TRUE;
+	int i;
+	mrcp_grammar_cache_t *cache = mrcp_grammar_cache_create(0,count-1,pool);
+
+	for(i=x; i<=y; i++) {
+		grammars[i] = grammar_acquire(cache,&samples[i]);
+		mrcp_grammar_handle_attach(grammars[i],grammar_owner,&handles[i],grammar_handle_destroy);
+		mrcp_grammar_cache_release(cache,grammars[i]);
+	}
+	/* use x again, so that y is the least recently used */
+	if(grammar_cached_check(cache,&samples[x],grammars[x],&handles[x]) == FALSE) {
+		status = FALSE;
+	}
+	mrcp_grammar_cache_release(cache,grammars[x]);
+
+	grammars[z] = grammar_acquire(cache,&samples[z]);
+	mrcp_grammar_handle_attach(grammars[z],grammar_owner,&handles[z],grammar_handle_destroy);
+	mrcp_grammar_cache_release(cache,grammars[z]);
+	if(handles[x] != 0 || handles[y] != 1 || handles[z] != 0) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Not Least Recently Used Grammar Evicted");
+		status = FALSE;
+	}
+	else if(grammar_cached_check(cache,&samples[x],grammars[x],&handles[x]) == FALSE ||
+		grammar_cached_check(cache,&samples[z],grammars[z],&handles[z]) == FALSE) {
+		status = FALSE;
+	}
+	else {
+		mrcp_grammar_cache_release(cache,grammars[x]);
+		mrcp_grammar_cache_release(cache,grammars[z]);
+	}
+	mrcp_grammar_cache_destroy(cache);
+	return status;
+}
+
+/** Check the grammars in use are kept beyond the size limit, and evicted once released */
+static apt_bool_t grammar_size_test(apr_pool_t *pool)
+{
+	static const grammar_sample_t samples[] = {
+		{"application/srgs+xml","<grammar>x</grammar>"},
+		{"application/srgs+xml","<grammar>y</grammar>"}
+	};
+	enum { x, y, count };
+	mrcp_grammar_t *grammars[count];
+	mrcp_grammar_t *grammar;
+	int handles[count] = {0};
+	apt_bool_t status = TRUE;
+	int i;
+	mrcp_grammar_cache_t *cache = mrcp_grammar_cache_create(GRAMMAR_CACHE_TINY_SIZE,0,pool);
+
+	for(i=0; i<count; i++) {
+		grammars[i] = grammar_acquire(cache,&samples[i]);
+		mrcp_grammar_handle_attach(grammars[i],grammar_owner,&handles[i],grammar_handle_destroy);
+	}
+	for(i=0; i<count && status == TRUE; i++) {
+		status = grammar_cached_check(cache,&samples[i],grammars[i],&handles[i]);
+		mrcp_grammar_cache_release(cache,grammars[i]);
+	}
+
+	mrcp_grammar_cache_release(cache,grammars[x]);
+	if(handles[x] != 1 || handles[y] != 0) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Released Grammar Not Evicted by Size");
+		status = FALSE;
+	}
+	/* the evicted grammar is added anew, without the handle */
+	grammar = grammar_acquire(cache,&samples[x]);
+	if(mrcp_grammar_handle_get(grammar,grammar_owner)) {
+		status = FALSE;
+	}
+	mrcp_grammar_cache_release(cache,grammar);
+	mrcp_grammar_cache_release(cache,grammars[y]);
+	if(handles[y] != 1) {
+		status = FALSE;
+	}
+	mrcp_grammar_cache_destroy(cache);
+	return status;
+}
+
+static apt_bool_t grammar_cache_test_run(apt_test_suite_t *suite, int argc, const char * const *argv)
+{
+	if(grammar_hit_miss_test(suite->pool) == FALSE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Grammar Cache Hit/Miss Test Failed");
+		return FALSE;
+	}
+	if(grammar_collision_test(suite->pool) == FALSE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Grammar Cache Collision Test Failed");
+		return FALSE;
+	}
+	if(grammar_lru_test(suite->pool) == FALSE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Grammar Cache LRU Test Failed");
+		return FALSE;
+	}
+	if(grammar_size_test(suite->pool) == FALSE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Grammar Cache Size Test Failed");
+		return FALSE;
+	}
+	return TRUE;
+}
+
+apt_test_suite_t* grammar_cache_test_suite_create(apr_pool_t *pool)
+{
+	apt_test_suite_t *suite = apt_test_suite_create(pool,"grammar-cache",NULL,grammar_cache_test_run);
+	return suite;
+}
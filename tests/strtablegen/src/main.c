@@ -52,6 +52,128 @@ static apt_bool_t string_table_key_generate(apt_str_table_item_t table[], apr_si
 	return TRUE;
 }
 
+/** Max number of items in the table */
+#define TABLE_MAX_SIZE 100
+
+/** Perfect hash of the table being generated */
+typedef struct {
+	apr_size_t   bucket_count;
+	apr_uint16_t seeds[TABLE_MAX_SIZE];
+	apr_byte_t   ids[TABLE_MAX_SIZE];
+} string_table_hash_t;
+
+/** Find the seed of the bucket, which maps its items to distinct free slots */
+static apt_bool_t string_table_bucket_place(const apr_uint32_t hashes[], const apr_size_t items[], apr_size_t item_count,
+											apr_size_t size, apt_bool_t occupied[], apr_uint16_t *seed)
+{
+	apr_size_t slots[TABLE_MAX_SIZE];
+	apr_size_t i,j;
+	apr_uint32_t s;
+	for(s=0; s<=0xFFFF; s++) {
+		for(i=0; i<item_count; i++) {
+			slots[i] = apt_string_table_hash_slot(hashes[items[i]],s,size);
+			if(occupied[slots[i]] == TRUE) {
+				break;
+			}
+			for(j=0; j<i; j++) {
+				if(slots[j] == slots[i]) {
+					break;
+				}
+			}
+			if(j < i) {
+				break;
+			}
+		}
+		if(i == item_count) {
+			for(i=0; i<item_count; i++) {
+				occupied[slots[i]] = TRUE;
+			}
+			*seed = (apr_uint16_t)s;
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+/** Generate minimal perfect hash of the table (hash and displace), placing the largest buckets first */
+static apt_bool_t string_table_hash_generate(const apt_str_table_item_t table[], apr_size_t count, string_table_hash_t *hash)
+{
+	apr_uint32_t hashes[TABLE_MAX_SIZE];
+	apr_size_t items[TABLE_MAX_SIZE];
+	apr_size_t item_count;
+	apt_bool_t occupied[TABLE_MAX_SIZE];
+	apt_bool_t placed[TABLE_MAX_SIZE];
+	apr_size_t i,b;
+	apr_size_t largest;
+	apr_size_t largest_count;
+
+	if(!count) {
+		return FALSE;
+	}
+	for(i=0; i<count; i++) {
+		hashes[i] = apt_string_table_hash_calc(&table[i].value);
+	}
+
+	for(hash->bucket_count = count / 2 + 1; hash->bucket_count <= count; hash->bucket_count++) {
+		for(i=0; i<count; i++) {
+			occupied[i] = FALSE;
+		}
+		for(b=0; b<hash->bucket_count; b++) {
+			hash->seeds[b] = 0;
+			placed[b] = FALSE;
+		}
+
+		do {
+			/* find the largest bucket not placed yet */
+			largest = hash->bucket_count;
+			largest_count = 0;
+			for(b=0; b<hash->bucket_count; b++) {
+				if(placed[b] == TRUE) continue;
+				item_count = 0;
+				for(i=0; i<count; i++) {
+					if(apt_string_table_hash_bucket(hashes[i],hash->bucket_count) == b) {
+						item_count++;
+					}
+				}
+				if(largest == hash->bucket_count || item_count > largest_count) {
+					largest = b;
+					largest_count = item_count;
+				}
+			}
+			if(largest == hash->bucket_count || !largest_count) {
+				break;
+			}
+
+			item_count = 0;
+			for(i=0; i<count; i++) {
+				if(apt_string_table_hash_bucket(hashes[i],hash->bucket_count) == largest) {
+					items[item_count++] = i;
+				}
+			}
+			if(string_table_bucket_place(hashes,items,item_count,count,occupied,&hash->seeds[largest]) == FALSE) {
+				break;
+			}
+			placed[largest] = TRUE;
+		}
+		while(largest_count);
+
+		for(i=0; i<count; i++) {
+			if(occupied[i] == FALSE) {
+				break;
+			}
+		}
+		if(i == count) {
+			/* all the slots are occupied, fill in the ids */
+			for(i=0; i<count; i++) {
+				b = apt_string_table_hash_bucket(hashes[i],hash->bucket_count);
+				hash->ids[apt_string_table_hash_slot(hashes[i],hash->seeds[b],count)] = (apr_byte_t)i;
+			}
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
 #define TEST_BUFFER_SIZE 2048
 static char parse_buffer[TEST_BUFFER_SIZE];
 
@@ -93,10 +215,30 @@ static apt_bool_t string_table_write(const apt_str_table_item_t table[], apr_siz
 	return TRUE;
 }
 
+static apt_bool_t string_table_hash_write(const string_table_hash_t *hash, apr_size_t count, const char *name, FILE *file)
+{
+	apr_size_t i;
+	fprintf(file,"\r\n/** Perfect hash of %s (generated by strtablegen) */\r\n",name);
+	fprintf(file,"static const apr_uint16_t %s_hash_seeds[] = {",name);
+	for(i=0; i<hash->bucket_count; i++) {
+		fprintf(file,"%s%d",i ? "," : "",hash->seeds[i]);
+	}
+	fprintf(file,"};\r\n");
+	fprintf(file,"static const apr_byte_t %s_hash_ids[] = {",name);
+	for(i=0; i<count; i++) {
+		fprintf(file,"%s%d",i ? "," : "",hash->ids[i]);
+	}
+	fprintf(file,"};\r\n");
+	fprintf(file,"static const apt_str_table_hash_t %s_hash = {%"APR_SIZE_T_FMT",%s_hash_seeds,%s_hash_ids};\r\n",
+		name, hash->bucket_count, name, name);
+	return TRUE;
+}
+
 int main(int argc, char *argv[])
 {
 	apr_pool_t *pool = NULL;
-	apt_str_table_item_t table[100];
+	apt_str_table_item_t table[TABLE_MAX_SIZE];
+	string_table_hash_t hash;
 	apr_size_t count;
 	FILE *file_in, *file_out;
 
@@ -107,7 +249,7 @@ int main(int argc, char *argv[])
 	pool = apt_pool_create();
 
 	if(argc < 2) {
-		printf("usage: stringtablegen stringtable.in [stringtable.out]\n");
+		printf("usage: stringtablegen stringtable.in [stringtable.out] [table_name]\n");
 		return 0;
 	}
 	file_in = fopen(argv[1], "rb");
@@ -124,7 +266,7 @@ int main(int argc, char *argv[])
 	}
 
 	/* read items (strings) from the file */
-	count = string_table_read(table,100,file_in,pool);
+	count = string_table_read(table,TABLE_MAX_SIZE,file_in,pool);
 
 	/* generate string table */
 	string_table_key_generate(table,count);
@@ -132,6 +274,16 @@ int main(int argc, char *argv[])
 	/* dump string table to the file */
 	string_table_write(table,count,file_out);
 
+	if(argc > 3) {
+		/* generate and dump perfect hash of the string table */
+		if(string_table_hash_generate(table,count,&hash) == TRUE) {
+			string_table_hash_write(&hash,count,argv[3],file_out);
+		}
+		else {
+			printf("cannot generate perfect hash of %s\n", argv[3]);
+		}
+	}
+
 	fclose(file_in);
 	if(file_out != stdout) {
 		fclose(file_out);